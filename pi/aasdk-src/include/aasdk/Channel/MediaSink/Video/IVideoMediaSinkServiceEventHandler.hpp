@@ -24,6 +24,7 @@
 #include <aap_protobuf/service/media/shared/message/Config.pb.h>
 #include <aap_protobuf/service/control/message/ChannelOpenRequest.pb.h>
 #include "aasdk/Messenger/Timestamp.hpp"
+#include "aasdk/Messenger/Message.hpp"
 #include "aasdk/Common/Data.hpp"
 #include "aasdk/Error/Error.hpp"
 #include <aap_protobuf/service/media/video/message/VideoFocusRequestNotification.pb.h>
@@ -51,6 +52,18 @@ namespace aasdk::channel::mediasink::video {
 
     virtual void onMediaIndication(const common::DataConstBuffer &buffer) = 0;
 
+    // Same as the two above, with the message that owns buffer. Handlers that keep the
+    // payload beyond the call can hold on to the message instead of copying it.
+    virtual void onMediaWithTimestampMessage(messenger::Timestamp::ValueType timestamp,
+                                             const common::DataConstBuffer &buffer,
+                                             messenger::Message::Pointer) {
+      this->onMediaWithTimestampIndication(timestamp, buffer);
+    }
+
+    virtual void onMediaMessage(const common::DataConstBuffer &buffer, messenger::Message::Pointer) {
+      this->onMediaIndication(buffer);
+    }
+
     virtual void onVideoFocusRequest(
         const aap_protobuf::service::media::video::message::VideoFocusRequestNotification &request) = 0;
 
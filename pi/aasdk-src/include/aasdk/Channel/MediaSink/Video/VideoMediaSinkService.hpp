@@ -80,6 +80,7 @@ namespace aasdk::channel::mediasink::video {
                                   IVideoMediaSinkServiceEventHandler::Pointer eventHandler);
 
     void handleMediaWithTimestampIndication(const common::DataConstBuffer &payload,
+                                            messenger::Message::Pointer message,
                                             IVideoMediaSinkServiceEventHandler::Pointer eventHandler);
 
     void handleVideoFocusRequest(const common::DataConstBuffer &payload,
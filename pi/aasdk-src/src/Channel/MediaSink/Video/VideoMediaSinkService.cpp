@@ -119,10 +119,10 @@ namespace aasdk::channel::mediasink::video {
         this->handleStopIndication(payload, std::move(eventHandler));
         break;
       case aap_protobuf::service::media::sink::MediaMessageId::MEDIA_MESSAGE_CODEC_CONFIG:
-        eventHandler->onMediaIndication(payload);
+        eventHandler->onMediaMessage(payload, std::move(message));
         break;
       case aap_protobuf::service::media::sink::MediaMessageId::MEDIA_MESSAGE_DATA:
-        this->handleMediaWithTimestampIndication(payload, std::move(eventHandler));
+        this->handleMediaWithTimestampIndication(payload, std::move(message), std::move(eventHandler));
         break;
       case aap_protobuf::service::media::sink::MediaMessageId::MEDIA_MESSAGE_VIDEO_FOCUS_REQUEST:
         this->handleVideoFocusRequest(payload, std::move(eventHandler));
@@ -179,13 +179,15 @@ namespace aasdk::channel::mediasink::video {
   }
 
   void VideoMediaSinkService::handleMediaWithTimestampIndication(const common::DataConstBuffer &payload,
+                                                                 messenger::Message::Pointer message,
                                                                  IVideoMediaSinkServiceEventHandler::Pointer eventHandler) {
     AASDK_LOG_CHANNEL_MEDIA_SINK(debug, "handleMediaWithTimestampIndication()");
     if (payload.size >= sizeof(messenger::Timestamp::ValueType)) {
       messenger::Timestamp timestamp(payload);
-      eventHandler->onMediaWithTimestampIndication(timestamp.getValue(),
-                                                   common::DataConstBuffer(payload.cdata, payload.size,
-                                                                           sizeof(messenger::Timestamp::ValueType)));
+      eventHandler->onMediaWithTimestampMessage(timestamp.getValue(),
+                                                common::DataConstBuffer(payload.cdata, payload.size,
+                                                                        sizeof(messenger::Timestamp::ValueType)),
+                                                std::move(message));
     } else {
       eventHandler->onChannelError(error::Error(error::ErrorCode::PARSE_PAYLOAD));
     }
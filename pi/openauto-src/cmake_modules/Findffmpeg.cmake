@@ -0,0 +1,78 @@
+#
+#  This file is part of openauto project.
+#  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+#
+#  openauto is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 3 of the License, or
+#  (at your option) any later version.
+
+#  openauto is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+#
+
+if (FFMPEG_LIBRARIES AND FFMPEG_INCLUDE_DIRS)
+  # in cache already
+  set(FFMPEG_FOUND TRUE)
+else (FFMPEG_LIBRARIES AND FFMPEG_INCLUDE_DIRS)
+  find_path(FFMPEG_INCLUDE_DIR
+    NAMES
+        libavcodec/avcodec.h
+    PATHS
+      /usr/include
+      /usr/local/include
+      /opt/local/include
+      /sw/include
+	PATH_SUFFIXES
+          ffmpeg
+  )
+
+  foreach (FFMPEG_COMPONENT avcodec avutil swscale)
+    string(TOUPPER ${FFMPEG_COMPONENT} FFMPEG_COMPONENT_UPPER)
+    find_library(FFMPEG_${FFMPEG_COMPONENT_UPPER}_LIBRARY
+      NAMES
+        ${FFMPEG_COMPONENT}
+      PATHS
+        /usr/lib
+        /usr/local/lib
+        /opt/local/lib
+        /sw/lib
+    )
+  endforeach ()
+
+  set(FFMPEG_INCLUDE_DIRS
+    ${FFMPEG_INCLUDE_DIR}
+  )
+
+  if (FFMPEG_AVCODEC_LIBRARY AND FFMPEG_AVUTIL_LIBRARY AND FFMPEG_SWSCALE_LIBRARY)
+    set(FFMPEG_LIBRARIES
+      ${FFMPEG_AVCODEC_LIBRARY}
+      ${FFMPEG_SWSCALE_LIBRARY}
+      ${FFMPEG_AVUTIL_LIBRARY}
+    )
+  endif ()
+
+  if (FFMPEG_INCLUDE_DIRS AND FFMPEG_LIBRARIES)
+     set(FFMPEG_FOUND TRUE)
+  endif (FFMPEG_INCLUDE_DIRS AND FFMPEG_LIBRARIES)
+
+  if (FFMPEG_FOUND)
+    if (NOT ffmpeg_FIND_QUIETLY)
+      message(STATUS "Found ffmpeg:")
+          message(STATUS " - Includes: ${FFMPEG_INCLUDE_DIRS}")
+          message(STATUS " - Libraries: ${FFMPEG_LIBRARIES}")
+    endif (NOT ffmpeg_FIND_QUIETLY)
+  else (FFMPEG_FOUND)
+    if (ffmpeg_FIND_REQUIRED)
+      message(FATAL_ERROR "Could not find ffmpeg (libavcodec, libavutil, libswscale)")
+    endif (ffmpeg_FIND_REQUIRED)
+  endif (FFMPEG_FOUND)
+
+    mark_as_advanced(FFMPEG_INCLUDE_DIRS FFMPEG_LIBRARIES)
+
+endif (FFMPEG_LIBRARIES AND FFMPEG_INCLUDE_DIRS)
@@ -0,0 +1,70 @@
+#
+#  This file is part of openauto project.
+#  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+#
+#  openauto is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 3 of the License, or
+#  (at your option) any later version.
+
+#  openauto is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+#
+
+if (LIBDRM_LIBRARIES AND LIBDRM_INCLUDE_DIRS)
+  # in cache already
+  set(LIBDRM_FOUND TRUE)
+else (LIBDRM_LIBRARIES AND LIBDRM_INCLUDE_DIRS)
+  find_path(LIBDRM_INCLUDE_DIR
+    NAMES
+        xf86drm.h
+    PATHS
+      /usr/include
+      /usr/local/include
+      /opt/local/include
+      /sw/include
+	PATH_SUFFIXES
+          libdrm
+  )
+
+  find_library(LIBDRM_LIBRARY
+    NAMES
+      drm
+    PATHS
+      /usr/lib
+      /usr/local/lib
+      /opt/local/lib
+      /sw/lib
+  )
+
+  set(LIBDRM_INCLUDE_DIRS
+    ${LIBDRM_INCLUDE_DIR}
+  )
+  set(LIBDRM_LIBRARIES
+    ${LIBDRM_LIBRARY}
+)
+
+  if (LIBDRM_INCLUDE_DIRS AND LIBDRM_LIBRARIES)
+     set(LIBDRM_FOUND TRUE)
+  endif (LIBDRM_INCLUDE_DIRS AND LIBDRM_LIBRARIES)
+
+  if (LIBDRM_FOUND)
+    if (NOT libdrm_FIND_QUIETLY)
+      message(STATUS "Found libdrm:")
+          message(STATUS " - Includes: ${LIBDRM_INCLUDE_DIRS}")
+          message(STATUS " - Libraries: ${LIBDRM_LIBRARIES}")
+    endif (NOT libdrm_FIND_QUIETLY)
+  else (LIBDRM_FOUND)
+    if (libdrm_FIND_REQUIRED)
+      message(FATAL_ERROR "Could not find libdrm")
+    endif (libdrm_FIND_REQUIRED)
+  endif (LIBDRM_FOUND)
+
+    mark_as_advanced(LIBDRM_INCLUDE_DIRS LIBDRM_LIBRARIES)
+
+endif (LIBDRM_LIBRARIES AND LIBDRM_INCLUDE_DIRS)
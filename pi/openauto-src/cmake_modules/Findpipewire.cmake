@@ -0,0 +1,81 @@
+#
+#  This file is part of openauto project.
+#  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+#
+#  openauto is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 3 of the License, or
+#  (at your option) any later version.
+
+#  openauto is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+#
+
+if (PIPEWIRE_LIBRARIES AND PIPEWIRE_INCLUDE_DIRS)
+  # in cache already
+  set(PIPEWIRE_FOUND TRUE)
+else (PIPEWIRE_LIBRARIES AND PIPEWIRE_INCLUDE_DIRS)
+  find_path(PIPEWIRE_INCLUDE_DIR
+    NAMES
+        pipewire/pipewire.h
+    PATHS
+      /usr/include
+      /usr/local/include
+	PATH_SUFFIXES
+          pipewire-0.3
+  )
+
+  # the SPA headers (pod builder, audio formats) ship separately
+  find_path(SPA_INCLUDE_DIR
+    NAMES
+        spa/param/audio/format-utils.h
+    PATHS
+      /usr/include
+      /usr/local/include
+	PATH_SUFFIXES
+          spa-0.2
+  )
+
+  find_library(PIPEWIRE_LIBRARY
+    NAMES
+      pipewire-0.3
+    PATHS
+      /usr/lib
+      /usr/local/lib
+  )
+
+  if (PIPEWIRE_INCLUDE_DIR AND SPA_INCLUDE_DIR)
+    set(PIPEWIRE_INCLUDE_DIRS
+      ${PIPEWIRE_INCLUDE_DIR}
+      ${SPA_INCLUDE_DIR}
+    )
+  endif ()
+
+  set(PIPEWIRE_LIBRARIES
+    ${PIPEWIRE_LIBRARY}
+  )
+
+  if (PIPEWIRE_INCLUDE_DIRS AND PIPEWIRE_LIBRARIES)
+     set(PIPEWIRE_FOUND TRUE)
+  endif (PIPEWIRE_INCLUDE_DIRS AND PIPEWIRE_LIBRARIES)
+
+  if (PIPEWIRE_FOUND)
+    if (NOT pipewire_FIND_QUIETLY)
+      message(STATUS "Found pipewire:")
+          message(STATUS " - Includes: ${PIPEWIRE_INCLUDE_DIRS}")
+          message(STATUS " - Libraries: ${PIPEWIRE_LIBRARIES}")
+    endif (NOT pipewire_FIND_QUIETLY)
+  else (PIPEWIRE_FOUND)
+    if (pipewire_FIND_REQUIRED)
+      message(FATAL_ERROR "Could not find pipewire (libpipewire-0.3, spa-0.2)")
+    endif (pipewire_FIND_REQUIRED)
+  endif (PIPEWIRE_FOUND)
+
+    mark_as_advanced(PIPEWIRE_INCLUDE_DIRS PIPEWIRE_LIBRARIES)
+
+endif (PIPEWIRE_LIBRARIES AND PIPEWIRE_INCLUDE_DIRS)
@@ -0,0 +1,198 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace f1x::openauto::common {
+
+  // Bounded wait-free byte ring for exactly one producer and one consumer
+  // thread. Data moves with at most two memcpy calls per side. The latency
+  // bound caps how much may be queued: once a write pushes the fill above it,
+  // the consumer skips the oldest bytes on its next read, so playback catches
+  // up instead of lagging further. Storage is twice the bound so the producer
+  // never has to touch the consumer's position; only when the consumer stops
+  // reading altogether is new data refused.
+  class SpscByteRing : boost::noncopyable {
+  public:
+    struct Statistics {
+      size_t fill = 0;
+      size_t peakFill = 0;
+      uint64_t writtenBytes = 0;
+      uint64_t readBytes = 0;
+      // oldest bytes skipped to honour the latency bound
+      uint64_t droppedBytes = 0;
+      // new bytes refused because the storage was full
+      uint64_t refusedBytes = 0;
+    };
+
+    // alignment keeps drops on whole frames (e.g. 4 for 16 bit stereo PCM)
+    SpscByteRing(size_t latencyBound, size_t alignment = 1)
+        : alignment_(std::max<size_t>(alignment, 1)), storage_(std::max(roundUp(latencyBound, alignment_), alignment_) * 2),
+          latencyBound_(storage_.size() / 2), head_(0), tail_(0), dropUntil_(0), peakFill_(0),
+          droppedBytes_(0), refusedBytes_(0) {
+    }
+
+    // Producer side. Returns the number of bytes taken.
+    size_t write(const void *data, size_t length) {
+      const auto tail = tail_.load(std::memory_order_relaxed);
+      const auto head = head_.load(std::memory_order_acquire);
+      const auto free = storage_.size() - static_cast<size_t>(tail - head);
+
+      auto count = length;
+      if (count > free) {
+        count = free - free % alignment_;
+        refusedBytes_.fetch_add(length - count, std::memory_order_relaxed);
+      }
+
+      this->copyIn(tail, static_cast<const uint8_t *>(data), count);
+      tail_.store(tail + count, std::memory_order_release);
+
+      const auto fill = static_cast<size_t>(tail + count - head);
+      const auto bound = latencyBound_.load(std::memory_order_relaxed);
+      if (fill > bound) {
+        dropUntil_.store(tail + count - bound, std::memory_order_release);
+      }
+      if (fill > peakFill_.load(std::memory_order_relaxed)) {
+        peakFill_.store(std::min(fill, storage_.size()), std::memory_order_relaxed);
+      }
+
+      return count;
+    }
+
+    // Consumer side. Returns the number of bytes copied to data.
+    size_t read(void *data, size_t length) {
+      auto head = this->skipStale();
+      const auto available = static_cast<size_t>(tail_.load(std::memory_order_acquire) - head);
+      const auto count = std::min(length, available);
+
+      this->copyOut(head, static_cast<uint8_t *>(data), count);
+      head_.store(head + count, std::memory_order_release);
+      return count;
+    }
+
+    // Consumer side (or with both sides stopped): forgets everything queued.
+    void clear() {
+      const auto head = head_.load(std::memory_order_relaxed);
+      const auto tail = tail_.load(std::memory_order_acquire);
+      droppedBytes_.fetch_add(tail - head, std::memory_order_relaxed);
+      head_.store(tail, std::memory_order_release);
+    }
+
+    // Either side; only a snapshot while the other side is running.
+    size_t size() const {
+      const auto head = head_.load(std::memory_order_acquire);
+      return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head);
+    }
+
+    bool empty() const {
+      return this->size() == 0;
+    }
+
+    size_t capacity() const {
+      return storage_.size();
+    }
+
+    // Stream positions, counted in bytes since construction: where the next
+    // write() goes (producer side) and the next read() starts (consumer side),
+    // the latter before any stale bytes are skipped.
+    uint64_t getWritePosition() const {
+      return tail_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getReadPosition() const {
+      return head_.load(std::memory_order_relaxed);
+    }
+
+    size_t getLatencyBound() const {
+      return latencyBound_.load(std::memory_order_relaxed);
+    }
+
+    // Either side; between one frame and the storage allocated at construction.
+    void setLatencyBound(size_t bound) {
+      latencyBound_.store(std::clamp(roundUp(bound, alignment_), alignment_, storage_.size()), std::memory_order_relaxed);
+    }
+
+    Statistics getStatistics() const {
+      Statistics statistics;
+      const auto head = head_.load(std::memory_order_acquire);
+      const auto tail = tail_.load(std::memory_order_acquire);
+      statistics.fill = static_cast<size_t>(tail - head);
+      statistics.peakFill = peakFill_.load(std::memory_order_relaxed);
+      statistics.writtenBytes = tail;
+      statistics.droppedBytes = droppedBytes_.load(std::memory_order_relaxed);
+      statistics.readBytes = head - statistics.droppedBytes;
+      statistics.refusedBytes = refusedBytes_.load(std::memory_order_relaxed);
+      return statistics;
+    }
+
+  private:
+    static size_t roundUp(size_t value, size_t alignment) {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // positions only grow, the index wraps
+    size_t index(uint64_t position) const {
+      return static_cast<size_t>(position % storage_.size());
+    }
+
+    uint64_t skipStale() {
+      auto head = head_.load(std::memory_order_relaxed);
+      const auto dropUntil = dropUntil_.load(std::memory_order_acquire);
+      if (dropUntil > head) {
+        const auto tail = tail_.load(std::memory_order_acquire);
+        const auto skip = std::min<uint64_t>(roundUp(static_cast<size_t>(dropUntil - head), alignment_), tail - head);
+        head += skip;
+        droppedBytes_.fetch_add(skip, std::memory_order_relaxed);
+      }
+      return head;
+    }
+
+    void copyIn(uint64_t position, const uint8_t *data, size_t count) {
+      const auto offset = this->index(position);
+      const auto first = std::min(count, storage_.size() - offset);
+      std::memcpy(storage_.data() + offset, data, first);
+      std::memcpy(storage_.data(), data + first, count - first);
+    }
+
+    void copyOut(uint64_t position, uint8_t *data, size_t count) const {
+      const auto offset = this->index(position);
+      const auto first = std::min(count, storage_.size() - offset);
+      std::memcpy(data, storage_.data() + offset, first);
+      std::memcpy(data + first, storage_.data(), count - first);
+    }
+
+    const size_t alignment_;
+    std::vector<uint8_t> storage_;
+    std::atomic<size_t> latencyBound_;
+    alignas(64) std::atomic<uint64_t> head_;
+    alignas(64) std::atomic<uint64_t> tail_;
+    std::atomic<uint64_t> dropUntil_;
+    std::atomic<size_t> peakFill_;
+    alignas(64) std::atomic<uint64_t> droppedBytes_;
+    std::atomic<uint64_t> refusedBytes_;
+  };
+
+}
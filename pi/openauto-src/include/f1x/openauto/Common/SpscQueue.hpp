@@ -0,0 +1,92 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace f1x::openauto::common {
+
+  // Bounded wait-free queue for exactly one producer and one consumer thread.
+  // Slots are allocated once; elements are moved in and out, so a queue of
+  // shared pointers hands buffers over without copying them.
+  template<typename T>
+  class SpscQueue : boost::noncopyable {
+  public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(capacity + 1), head_(0), tail_(0) {
+    }
+
+    // Producer side. On failure (queue full) value is left untouched.
+    bool push(T &&value) {
+      const auto tail = tail_.load(std::memory_order_relaxed);
+      const auto next = this->increment(tail);
+      if (next == head_.load(std::memory_order_acquire)) {
+        return false;
+      }
+
+      slots_[tail] = std::move(value);
+      tail_.store(next, std::memory_order_release);
+      return true;
+    }
+
+    // Consumer side.
+    bool pop(T &value) {
+      const auto head = head_.load(std::memory_order_relaxed);
+      if (head == tail_.load(std::memory_order_acquire)) {
+        return false;
+      }
+
+      value = std::move(slots_[head]);
+      // leave an empty element behind so the slot does not keep resources alive
+      slots_[head] = T();
+      head_.store(this->increment(head), std::memory_order_release);
+      return true;
+    }
+
+    // Either side; only a snapshot while the other side is running.
+    bool empty() const {
+      return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+      const auto head = head_.load(std::memory_order_acquire);
+      const auto tail = tail_.load(std::memory_order_acquire);
+      return tail >= head ? tail - head : tail + slots_.size() - head;
+    }
+
+    size_t capacity() const {
+      return slots_.size() - 1;
+    }
+
+  private:
+    size_t increment(size_t index) const {
+      return index + 1 == slots_.size() ? 0 : index + 1;
+    }
+
+    // one slot stays free to tell full from empty
+    std::vector<T> slots_;
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+  };
+
+}
@@ -30,7 +30,11 @@ namespace configuration
 enum class AudioOutputBackendType
 {
     RTAUDIO,
-    QT
+    QT,
+    // straight to snd_pcm, only in builds with -DALSA=ON
+    ALSA,
+    // a pw_stream per channel, only in builds with -DPIPEWIRE=ON
+    PIPEWIRE
 };
 
 }
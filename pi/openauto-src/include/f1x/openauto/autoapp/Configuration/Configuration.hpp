@@ -99,6 +99,24 @@ public:
     int32_t getOMXLayerIndex() const override;
     void setVideoMargins(QRect value) override;
     QRect getVideoMargins() const override;
+    uint32_t getVideoDecodeQueueDepth() const override;
+    void setVideoDecodeQueueDepth(uint32_t value) override;
+    uint32_t getVideoMaxUnacked() const override;
+    void setVideoMaxUnacked(uint32_t value) override;
+    bool getVideoAdaptiveFlowControl() const override;
+    void setVideoAdaptiveFlowControl(bool value) override;
+    bool getVideoPersistentDecoder() const override;
+    void setVideoPersistentDecoder(bool value) override;
+    bool getVideoAdaptiveQuality() const override;
+    void setVideoAdaptiveQuality(bool value) override;
+    bool getVideoStatisticsOverlay() const override;
+    void setVideoStatisticsOverlay(bool value) override;
+    bool getVideoFramePacing() const override;
+    void setVideoFramePacing(bool value) override;
+    VideoOutputBackendType getVideoOutputBackendType() const override;
+    void setVideoOutputBackendType(VideoOutputBackendType value) override;
+    std::string getVideoOutputFile() const override;
+    void setVideoOutputFile(const std::string& value) override;
 
     bool getTouchscreenEnabled() const override;
     void setTouchscreenEnabled(bool value) override;
@@ -125,6 +143,23 @@ public:
 
     AudioOutputBackendType getAudioOutputBackendType() const override;
     void setAudioOutputBackendType(AudioOutputBackendType value) override;
+    uint32_t getAudioMaxUnacked() const override;
+    void setAudioMaxUnacked(uint32_t value) override;
+    bool getAudioSoftwareMixer() const override;
+    void setAudioSoftwareMixer(bool value) override;
+    uint32_t getAudioDuckingLevel() const override;
+    void setAudioDuckingLevel(uint32_t value) override;
+    std::string getAudioAlsaDevice() const override;
+    void setAudioAlsaDevice(const std::string& value) override;
+    uint32_t getAudioAlsaPeriodSize() const override;
+    void setAudioAlsaPeriodSize(uint32_t value) override;
+    uint32_t getAudioAlsaBufferSize() const override;
+    void setAudioAlsaBufferSize(uint32_t value) override;
+    uint32_t getAudioPipeWireQuantum() const override;
+    void setAudioPipeWireQuantum(uint32_t value) override;
+
+    uint32_t getThreadCpuStatsInterval() const override;
+    void setThreadCpuStatsInterval(uint32_t value) override;
 private:
     void readButtonCodes(boost::property_tree::ptree& iniConfig);
     void insertButtonCode(boost::property_tree::ptree& iniConfig, const std::string& buttonCodeKey, aap_protobuf::service::media::sink::message::KeyCode buttonCode);
@@ -155,6 +190,15 @@ private:
     size_t screenDPI_;
     int32_t omxLayerIndex_;
     QRect videoMargins_;
+    uint32_t videoDecodeQueueDepth_;
+    uint32_t videoMaxUnacked_;
+    bool videoAdaptiveFlowControl_;
+    bool videoPersistentDecoder_;
+    bool videoAdaptiveQuality_;
+    bool videoStatisticsOverlay_;
+    bool videoFramePacing_;
+    VideoOutputBackendType videoOutputBackendType_;
+    std::string videoOutputFile_;
     bool enableTouchscreen_;
     bool enablePlayerControl_;
     ButtonCodes buttonCodes_;
@@ -168,6 +212,17 @@ private:
     bool _audioChannelEnabledTelephony;
 
     AudioOutputBackendType audioOutputBackendType_;
+    uint32_t audioMaxUnacked_;
+    bool audioSoftwareMixer_;
+    // media volume in percent while guidance speaks
+    uint32_t audioDuckingLevel_;
+    std::string audioAlsaDevice_;
+    // frames
+    uint32_t audioAlsaPeriodSize_;
+    uint32_t audioAlsaBufferSize_;
+    // frames per graph cycle asked of PipeWire
+    uint32_t audioPipeWireQuantum_;
+    uint32_t threadCpuStatsInterval_;
 
     static const std::string cConfigFileName;
 
@@ -199,6 +254,15 @@ private:
     static const std::string cVideoOMXLayerIndexKey;
     static const std::string cVideoMarginWidth;
     static const std::string cVideoMarginHeight;
+    static const std::string cVideoDecodeQueueDepthKey;
+    static const std::string cVideoMaxUnackedKey;
+    static const std::string cVideoAdaptiveFlowControlKey;
+    static const std::string cVideoPersistentDecoderKey;
+    static const std::string cVideoAdaptiveQualityKey;
+    static const std::string cVideoStatisticsOverlayKey;
+    static const std::string cVideoFramePacingKey;
+    static const std::string cVideoOutputBackendTypeKey;
+    static const std::string cVideoOutputFileKey;
 
     static const std::string cAudioChannelMediaEnabled;
     static const std::string cAudioChannelGuidanceEnabled;
@@ -206,6 +270,15 @@ private:
     static const std::string cAudioChannelTelephonyEnabled;
 
     static const std::string cAudioOutputBackendType;
+    static const std::string cAudioMaxUnackedKey;
+    static const std::string cAudioSoftwareMixerKey;
+    static const std::string cAudioDuckingLevelKey;
+    static const std::string cAudioAlsaDeviceKey;
+    static const std::string cAudioAlsaPeriodSizeKey;
+    static const std::string cAudioAlsaBufferSizeKey;
+    static const std::string cAudioPipeWireQuantumKey;
+
+    static const std::string cDiagnosticsThreadCpuStatsIntervalKey;
 
     static const std::string cBluetoothAdapterTypeKey;
     static const std::string cBluetoothAdapterAddressKey;
@@ -26,6 +26,7 @@
 #include <f1x/openauto/autoapp/Configuration/BluetoothAdapterType.hpp>
 #include <f1x/openauto/autoapp/Configuration/HandednessOfTrafficType.hpp>
 #include <f1x/openauto/autoapp/Configuration/AudioOutputBackendType.hpp>
+#include <f1x/openauto/autoapp/Configuration/VideoOutputBackendType.hpp>
 
 namespace f1x
 {
@@ -102,6 +103,24 @@ public:
     virtual int32_t getOMXLayerIndex() const = 0;
     virtual void setVideoMargins(QRect value) = 0;
     virtual QRect getVideoMargins() const = 0;
+    virtual uint32_t getVideoDecodeQueueDepth() const = 0;
+    virtual void setVideoDecodeQueueDepth(uint32_t value) = 0;
+    virtual uint32_t getVideoMaxUnacked() const = 0;
+    virtual void setVideoMaxUnacked(uint32_t value) = 0;
+    virtual bool getVideoAdaptiveFlowControl() const = 0;
+    virtual void setVideoAdaptiveFlowControl(bool value) = 0;
+    virtual bool getVideoPersistentDecoder() const = 0;
+    virtual void setVideoPersistentDecoder(bool value) = 0;
+    virtual bool getVideoAdaptiveQuality() const = 0;
+    virtual void setVideoAdaptiveQuality(bool value) = 0;
+    virtual bool getVideoStatisticsOverlay() const = 0;
+    virtual void setVideoStatisticsOverlay(bool value) = 0;
+    virtual bool getVideoFramePacing() const = 0;
+    virtual void setVideoFramePacing(bool value) = 0;
+    virtual VideoOutputBackendType getVideoOutputBackendType() const = 0;
+    virtual void setVideoOutputBackendType(VideoOutputBackendType value) = 0;
+    virtual std::string getVideoOutputFile() const = 0;
+    virtual void setVideoOutputFile(const std::string& value) = 0;
 
     virtual bool getTouchscreenEnabled() const = 0;
     virtual void setTouchscreenEnabled(bool value) = 0;
@@ -127,6 +146,23 @@ public:
     virtual void setTelephonyAudioChannelEnabled(bool value) = 0;
     virtual AudioOutputBackendType getAudioOutputBackendType() const = 0;
     virtual void setAudioOutputBackendType(AudioOutputBackendType value) = 0;
+    virtual uint32_t getAudioMaxUnacked() const = 0;
+    virtual void setAudioMaxUnacked(uint32_t value) = 0;
+    virtual bool getAudioSoftwareMixer() const = 0;
+    virtual void setAudioSoftwareMixer(bool value) = 0;
+    virtual uint32_t getAudioDuckingLevel() const = 0;
+    virtual void setAudioDuckingLevel(uint32_t value) = 0;
+    virtual std::string getAudioAlsaDevice() const = 0;
+    virtual void setAudioAlsaDevice(const std::string& value) = 0;
+    virtual uint32_t getAudioAlsaPeriodSize() const = 0;
+    virtual void setAudioAlsaPeriodSize(uint32_t value) = 0;
+    virtual uint32_t getAudioAlsaBufferSize() const = 0;
+    virtual void setAudioAlsaBufferSize(uint32_t value) = 0;
+    virtual uint32_t getAudioPipeWireQuantum() const = 0;
+    virtual void setAudioPipeWireQuantum(uint32_t value) = 0;
+
+    virtual uint32_t getThreadCpuStatsInterval() const = 0;
+    virtual void setThreadCpuStatsInterval(uint32_t value) = 0;
 };
 
 }
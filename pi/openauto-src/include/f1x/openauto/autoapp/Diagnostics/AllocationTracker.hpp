@@ -0,0 +1,77 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace diagnostics
+{
+
+struct AllocationSite
+{
+    const void* address;
+    uint64_t count;
+    uint64_t bytes;
+};
+
+// Process-wide heap allocation counters. The counting operator new is only
+// compiled in when the project is configured with -DALLOC_TRACKING=ON; in
+// regular builds every query returns zero and isEnabled() is false.
+class AllocationTracker
+{
+public:
+    static bool isEnabled();
+
+    static uint64_t getAllocationCount();
+    static uint64_t getAllocatedBytes();
+
+    // Frame accounting, so allocations can be expressed per received video frame.
+    static void markFrame();
+    static uint64_t getFrameCount();
+
+    // Starts a steady-state window; getAllocationsPerFrame() only looks at
+    // allocations and frames that happened after the last call.
+    static void beginSteadyState();
+    static double getAllocationsPerFrame();
+
+    static std::vector<AllocationSite> getTopSites(size_t limit);
+    static std::string describeSite(const void* address);
+    static void logReport(size_t limit);
+    static void reset();
+};
+
+}
+}
+}
+}
+
+#ifdef OPENAUTO_ALLOCATION_TRACKING
+#define OPENAUTO_ALLOCATION_FRAME() f1x::openauto::autoapp::diagnostics::AllocationTracker::markFrame()
+#else
+#define OPENAUTO_ALLOCATION_FRAME()
+#endif
@@ -0,0 +1,89 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace diagnostics
+{
+
+// Names the calling thread so it shows up in top -H and in the CPU report.
+// Linux truncates names to 15 characters.
+void setCurrentThreadName(const std::string& name);
+
+struct ThreadCpuSample
+{
+    int32_t tid;
+    std::string name;
+    uint64_t cpuTicks;
+};
+
+struct ThreadCpuUsage
+{
+    std::string name;
+    double percent;
+};
+
+// Periodically samples utime + stime of every thread in /proc/self/task and
+// logs how much of one core each thread (and each thread group, e.g. all
+// usb-worker-N together) used since the previous sample.
+class ThreadCpuMonitor: public std::enable_shared_from_this<ThreadCpuMonitor>
+{
+public:
+    typedef std::shared_ptr<ThreadCpuMonitor> Pointer;
+
+    ThreadCpuMonitor(boost::asio::io_service& ioService, std::chrono::seconds interval);
+
+    void start();
+    void stop();
+
+    static std::vector<ThreadCpuSample> sample();
+    static std::vector<ThreadCpuUsage> groupByName(const std::vector<ThreadCpuUsage>& usage);
+
+private:
+    using std::enable_shared_from_this<ThreadCpuMonitor>::shared_from_this;
+
+    void scheduleSample();
+    void onTimer(const boost::system::error_code& error);
+    void report(const std::vector<ThreadCpuSample>& samples, std::chrono::steady_clock::duration elapsed);
+
+    boost::asio::io_service::strand strand_;
+    boost::asio::steady_timer timer_;
+    std::chrono::seconds interval_;
+    std::map<int32_t, uint64_t> previousTicks_;
+    std::chrono::steady_clock::time_point previousTime_;
+    bool running_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,96 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace diagnostics
+{
+
+// Process-wide per-frame counters of the projection video, written from the
+// video service strand, the decode thread and the outputs without locking.
+// Whoever wants rates (the statistics overlay) keeps the previous sample and
+// calls rates() on two of them.
+class VideoStatistics
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Counters
+    {
+        Clock::time_point time;
+        uint64_t receivedFrames = 0;
+        uint64_t receivedBytes = 0;
+        uint64_t decodedFrames = 0;
+        uint64_t decodeLatencyMicroseconds = 0;
+        // largest single latency since the previous sample()
+        uint64_t maxDecodeLatencyMicroseconds = 0;
+        uint64_t shownFrames = 0;
+        uint64_t droppedFrames = 0;
+        int64_t roundTripMicroseconds = 0;
+        uint64_t qualityDecisions = 0;
+        bool lastQualityDowngrade = false;
+        uint64_t pixelRateLimit = 0;
+    };
+
+    struct Rates
+    {
+        double receivedFps = 0;
+        double decodedFps = 0;
+        double shownFps = 0;
+        uint64_t droppedFrames = 0;
+        double bitrateKbps = 0;
+        double decodeLatencyMs = 0;
+        double maxDecodeLatencyMs = 0;
+        double roundTripMs = 0;
+        // adaptive quality, passed through: decisions so far, the last one
+        // and the limit it set for the next session (0 is unlimited)
+        uint64_t qualityDecisions = 0;
+        bool lastQualityDowngrade = false;
+        double pixelRateLimitMpx = 0;
+    };
+
+    static void onFrameReceived(size_t bytes);
+    // latency from reception until the output accepted the frame; for the
+    // synchronous decoders that includes decoding it
+    static void onFrameDecoded(std::chrono::microseconds latency);
+    static void onFrameShown();
+    static void onFrameDropped();
+    static void setRoundTrip(std::chrono::microseconds roundTrip);
+    static void onQualityDecision(bool downgrade, uint64_t pixelRateLimit);
+
+    // Also starts a new window for the maximum latency.
+    static Counters sample(Clock::time_point now = Clock::now());
+    static Rates rates(const Counters& previous, const Counters& current);
+    static void reset();
+};
+
+}
+}
+}
+}
@@ -0,0 +1,129 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_ALSA
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/Common/SpscByteRing.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioFillMonitor.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioRenderer.hpp>
+
+typedef struct _snd_pcm snd_pcm_t;
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Plays straight into an ALSA PCM, without PulseAudio in between. A feeder
+// thread with realtime priority copies from a wait-free ring (or pulls from a
+// renderer) into the mmap'ed device buffer one period at a time and plays
+// silence when nothing is queued, so the device never runs dry. XRUNs and
+// suspends are recovered from and counted. "null" and the snd-aloop
+// "hw:Loopback,0" devices work as well, for tests without a sound card.
+class AlsaAudioOutput: public IAudioOutput, boost::noncopyable
+{
+public:
+    struct Statistics
+    {
+        uint64_t writtenFrames = 0;
+        uint64_t xruns = 0;
+        // gaps while a stream was playing
+        uint64_t underruns = 0;
+        uint64_t silentFrames = 0;
+        // negotiated with the device, in frames
+        uint32_t periodSize = 0;
+        uint32_t bufferSize = 0;
+        bool mmap = false;
+    };
+
+    // periodSize and bufferSize in frames, the device may round them
+    AlsaAudioOutput(std::string device, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate,
+                    uint32_t periodSize, uint32_t bufferSize,
+                    std::chrono::milliseconds latencyBound = std::chrono::milliseconds(500));
+    // renderer has to outlive the output
+    AlsaAudioOutput(IAudioRenderer& renderer, std::string device, uint32_t channelCount, uint32_t sampleSize,
+                    uint32_t sampleRate, uint32_t periodSize, uint32_t bufferSize);
+    ~AlsaAudioOutput() override;
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void suspend() override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+
+    Statistics getStatistics() const;
+
+private:
+    // with mutex_ held
+    bool openDevice();
+    bool configure();
+    void close();
+    void run();
+    // one period into the device; 0 or a negative ALSA error
+    long writePeriod();
+    void fill(uint8_t* target, size_t frames);
+    bool recover(long error);
+
+    const std::string device_;
+    const uint32_t channelCount_;
+    const uint32_t sampleSize_;
+    const uint32_t sampleRate_;
+    const uint32_t bytesPerFrame_;
+    uint32_t periodSize_;
+    uint32_t bufferSize_;
+    common::SpscByteRing audioBuffer_;
+    IAudioRenderer* renderer_;
+
+    snd_pcm_t* pcm_;
+    bool mmap_;
+    // one period for devices that do not mmap
+    std::vector<uint8_t> period_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+
+    // written by the feeder thread only
+    std::atomic<uint64_t> writtenFrames_;
+    std::atomic<uint64_t> xruns_;
+    AudioFillMonitor fillMonitor_;
+
+    // control calls only, never taken by the feeder thread
+    std::mutex mutex_;
+};
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Bookkeeping the device outputs share on their audio thread. The thread is
+// named the first time it calls in, also when it belongs to the sound server
+// or RtAudio. A short read is padded with silence and counted as an underrun
+// only when it is a gap in a running stream; before the first data and after
+// the end it is just idle. The counters may be read from any thread, the rest
+// belongs to the audio thread or to a stream that does not run.
+class AudioFillMonitor
+{
+public:
+    AudioFillMonitor(std::string threadName, uint32_t bytesPerFrame);
+
+    // first thing in every callback
+    void enter();
+    // count of size bytes at target were filled
+    void fill(void* target, size_t count, size_t size);
+    // the stream starts over, a short first read is idle again
+    void restart();
+    void resetCounters();
+
+    uint64_t getUnderruns() const;
+    uint64_t getSilentFrames() const;
+
+private:
+    const std::string threadName_;
+    const uint32_t bytesPerFrame_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> silentFrames_;
+    bool starving_;
+};
+
+}
+}
+}
+}
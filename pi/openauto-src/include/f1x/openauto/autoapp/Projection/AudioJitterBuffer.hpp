@@ -0,0 +1,122 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Sizes the queue of one audio channel from how its messages arrive. The
+// writer reports every message; compared with the earliest a message of that
+// stream could have come, the latest ones tell how much has to be queued
+// before playing starts so none of them runs the channel dry. That lateness
+// is taken at once and forgotten slowly. The reader holds playback back until
+// the target is queued. When the queue runs dry anyway, the last 10 ms played
+// are repeated while fading out, and the queue fills up to the target again
+// before the channel goes on. onArrival() is called from the writer, the
+// statistics from any thread, everything else from the reader.
+class AudioJitterBuffer: boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Statistics
+    {
+        // what playback waits for after a start or an underrun
+        std::chrono::microseconds target{0};
+        // mean difference between the lateness of consecutive messages
+        std::chrono::microseconds jitter{0};
+        // queued at the last read
+        std::chrono::microseconds latency{0};
+        // times the queue ran dry while playing
+        uint64_t underruns = 0;
+        uint64_t concealedFrames = 0;
+    };
+
+    // channelCount and sampleRate: the format conceal() repeats in
+    AudioJitterBuffer(uint32_t channelCount, uint32_t sampleRate, std::chrono::milliseconds minTarget,
+                      std::chrono::milliseconds maxTarget);
+
+    // Writer: a message of duration arrived.
+    void onArrival(std::chrono::microseconds duration, Clock::time_point arrival);
+
+    // Reader: whether to read on with queued waiting. draining: the writer
+    // stopped, what is left plays without waiting for the target.
+    bool canRead(std::chrono::microseconds queued, bool draining);
+    // Reader: the queue is empty. Returns true when that is an underrun,
+    // conceal() then has something to play.
+    bool onEmpty(bool playing);
+    // Reader: keeps the end of what was just played for conceal().
+    void remember(const int16_t* samples, size_t frames);
+    // Reader: up to frames of faded repetition, zero once it has faded out.
+    size_t conceal(int16_t* output, size_t frames);
+
+    // With writer and reader stopped.
+    void reset();
+
+    std::chrono::microseconds getTarget() const;
+    Statistics getStatistics() const;
+
+private:
+    const uint32_t channelCount_;
+    const int64_t minTarget_;
+    const int64_t maxTarget_;
+
+    // writer side, microseconds
+    bool arrived_;
+    int64_t start_;
+    int64_t mediaTime_;
+    int64_t lastArrival_;
+    int64_t floor_;
+    int64_t peak_;
+    int64_t lastLateness_;
+    int64_t jitter_;
+
+    // reader side
+    bool primed_;
+    bool started_;
+    std::vector<int16_t> history_;
+    size_t historyFrames_;
+    size_t historyPosition_;
+    size_t concealPosition_;
+    size_t concealFrames_;
+
+    std::atomic<int64_t> target_;
+    std::atomic<int64_t> jitterStatistic_;
+    std::atomic<int64_t> latency_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> concealed_;
+};
+
+}
+}
+}
+}
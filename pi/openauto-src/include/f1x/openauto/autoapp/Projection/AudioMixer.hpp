@@ -0,0 +1,155 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/Common/SpscByteRing.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioRenderer.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioResampler.hpp>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+#include <f1x/openauto/autoapp/Projection/PlayoutScheduler.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Mixes the audio channels of a session into one 48 kHz stereo stream, so a
+// single output (and a single realtime thread) plays all of them. Each channel
+// gets an IAudioOutput of its own format from createInput(); what is written
+// there goes through a wait-free ring to render(), which the device output
+// calls from its realtime thread. Other rates go through AudioResampler, mono
+// is spread on both sides. Each channel waits until its AudioJitterBuffer
+// has as much queued as the arrivals of the channel need, and covers a gap
+// with what it played last. Media is ducked while guidance plays or the phone asked for
+// transient focus that may duck. The media timestamps are followed through the
+// mix: the MediaClock tells when each one is heard, and the media queue is
+// held steady against clock drift by stretching the stream a few ppm.
+class AudioMixer: public IAudioRenderer, public std::enable_shared_from_this<AudioMixer>, boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<AudioMixer> Pointer;
+
+    enum class Channel
+    {
+        MEDIA,
+        GUIDANCE,
+        SYSTEM
+    };
+
+    struct Statistics
+    {
+        uint64_t renderedFrames = 0;
+        // frames a playing channel could not provide in time
+        std::array<uint64_t, 3> underrunFrames{};
+        std::array<common::SpscByteRing::Statistics, 3> buffers{};
+        std::array<AudioJitterBuffer::Statistics, 3> jitter{};
+        PlayoutScheduler::Statistics media;
+        // from the start indication of a channel to its first sample heard, the last one and the longest
+        std::array<std::chrono::microseconds, 3> firstSample{};
+        std::array<std::chrono::microseconds, 3> maxFirstSample{};
+    };
+
+    static constexpr uint32_t cSampleRate = 48000;
+    static constexpr uint32_t cChannelCount = 2;
+    static constexpr uint32_t cSampleSize = 16;
+    // Q15, 1.0 is kept exact by the mix kernel
+    static constexpr int32_t cUnityGain = 32768;
+
+    // duckingLevel: media volume in percent while ducked; latencyBound caps
+    // what each channel may queue
+    AudioMixer(uint32_t duckingLevel, std::chrono::milliseconds latencyBound = std::chrono::milliseconds(500));
+    ~AudioMixer() override;
+
+    // The one stream the mix is played on, pulling render(). It is opened with
+    // the first channel and closed with the last one. The mixer keeps the
+    // device alive, so the device may refer back to the mixer.
+    void setDevice(IAudioOutput::Pointer device);
+    // Opens the device ahead of the first channel and keeps it playing
+    // silence from then on, so no channel waits for it. A channel closed
+    // while the device runs fades out instead. False when it cannot be opened.
+    bool warmUp();
+    // sampleRate from 8 to 192 kHz, channelCount 1 or 2. A channel keeps
+    // its format for the lifetime of the mixer; later calls for the same
+    // channel share its buffer.
+    IAudioOutput::Pointer createInput(Channel channel, uint32_t channelCount, uint32_t sampleRate);
+    // audio focus granted to the phone for a transient sound that lets media go on quietly
+    void setFocusDucking(bool value);
+    void setDuckingLevel(uint32_t duckingLevel);
+
+    size_t render(void* buffer, size_t frames) override;
+    void setOutputLatency(std::chrono::microseconds latency) override;
+    Statistics getStatistics() const;
+    // follows the media channel, for the video pacer
+    MediaClock::Pointer getMediaClock() const;
+
+    // dst = saturate(dst + src * gain / 32768) on count samples, with the
+    // NEON or SSE2 kernel where the build has one
+    static void mix(int16_t* dst, const int16_t* src, size_t count, int32_t gain);
+    // the portable kernel the SIMD ones are exact copies of
+    static void mixScalar(int16_t* dst, const int16_t* src, size_t count, int32_t gain);
+
+private:
+    class Input;
+    struct Source;
+
+    bool openInput(Source& source);
+    void closeInput(Source& source);
+    // under the mutex
+    void openDevice();
+    void resetSources();
+    // playout: when output[0] is heard
+    void mixSource(Source& source, int16_t* output, size_t frames, std::chrono::steady_clock::time_point playout);
+    bool stage(Source& source, std::chrono::steady_clock::time_point playout);
+
+    const std::chrono::milliseconds latencyBound_;
+    std::array<std::unique_ptr<Source>, 3> sources_;
+    // what render() sees; set once per channel, never reset
+    std::array<std::atomic<Source*>, 3> activeSources_;
+    std::atomic<int32_t> duckingGain_;
+    std::atomic<bool> focusDucking_;
+    std::atomic<uint64_t> renderedFrames_;
+    // microseconds, as reported by the device
+    std::atomic<int64_t> outputLatency_;
+    const MediaClock::Pointer mediaClock_;
+
+    // control calls only, never taken by render()
+    mutable std::mutex mutex_;
+    IAudioOutput::Pointer device_;
+    size_t openInputs_;
+    bool deviceOpen_;
+    bool warm_;
+};
+
+}
+}
+}
+}
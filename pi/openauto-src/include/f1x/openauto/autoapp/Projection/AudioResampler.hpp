@@ -0,0 +1,105 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Polyphase FIR sample rate converter for interleaved signed 16 bit PCM, any
+// rational ratio (16 -> 48 kHz is 3/1, 44.1 -> 48 kHz 160/147). Mono can be
+// spread to stereo and stereo folded to mono on the way. Coefficients are Q15
+// and accumulate in 32 bit integers, so the NEON and SSE2 kernels give
+// exactly what the scalar one gives. The filter state carries over from one
+// process() call to the next; nothing is allocated after construction.
+class AudioResampler: boost::noncopyable
+{
+public:
+    enum class Kernel
+    {
+        // NEON or SSE2 when the build targets it
+        NATIVE,
+        // the portable reference
+        SCALAR
+    };
+
+    static constexpr size_t cDefaultTapsPerPhase = 32;
+
+    AudioResampler(uint32_t inputRate, uint32_t inputChannels, uint32_t outputRate, uint32_t outputChannels,
+                   Kernel kernel = Kernel::NATIVE, size_t tapsPerPhase = cDefaultTapsPerPhase);
+
+    // Converts inputFrames interleaved frames. Writes the output frames they
+    // complete and returns how many; output has to hold getMaxOutputFrames(inputFrames).
+    size_t process(const int16_t* input, size_t inputFrames, int16_t* output);
+    size_t getMaxOutputFrames(size_t inputFrames) const;
+    // forgets the signal, the next input starts from silence
+    void reset();
+
+    // group delay of the filter, zero when only channels are converted
+    std::chrono::microseconds getLatency() const;
+    uint32_t getInputRate() const;
+    uint32_t getOutputRate() const;
+
+    // sum of samples[i] * coefficients[i] over count (a multiple of 8)
+    static int32_t dot(const int16_t* samples, const int16_t* coefficients, size_t count);
+    static int32_t dotScalar(const int16_t* samples, const int16_t* coefficients, size_t count);
+    // "neon", "sse2" or "scalar", what Kernel::NATIVE runs on
+    static const char* getNativeKernelName();
+
+private:
+    typedef int32_t (*DotFunction)(const int16_t*, const int16_t*, size_t);
+
+    void design();
+    size_t convertChannels(const int16_t* input, size_t inputFrames, int16_t* output) const;
+
+    const uint32_t inputRate_;
+    const uint32_t inputChannels_;
+    const uint32_t outputRate_;
+    const uint32_t outputChannels_;
+    // interpolation and decimation factor, outputRate / inputRate = up_ / down_
+    uint32_t up_;
+    uint32_t down_;
+    size_t taps_;
+    // per phase, in reverse order so each output is one contiguous dot product
+    std::vector<int16_t> coefficients_;
+    DotFunction dot_;
+
+    // filtered channels: two for stereo to stereo, one otherwise
+    size_t filterChannels_;
+    // per filtered channel: taps_ - 1 frames of history followed by a chunk of input
+    std::vector<std::vector<int16_t>> history_;
+    // position of the next output in 1/up_ input frames, from the first new input frame
+    uint64_t time_;
+};
+
+}
+}
+}
+}
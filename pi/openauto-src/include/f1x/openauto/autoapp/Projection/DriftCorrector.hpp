@@ -0,0 +1,70 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Stretches or squeezes interleaved signed 16 bit PCM (mono or stereo) by up
+// to cMaxSkew parts per million, to make up for the phone's clock running at
+// another speed than the sound card's. A change that small needs no filter:
+// each output frame is interpolated linearly between its two neighbours, and
+// at zero skew the input comes out unchanged, one frame late. The fractional
+// position carries over from one process() call to the next.
+class DriftCorrector: boost::noncopyable
+{
+public:
+    static constexpr int32_t cMaxSkew = 1000;
+
+    explicit DriftCorrector(uint32_t channelCount);
+
+    // ppm; positive consumes the input faster than it plays, so less comes out
+    void setSkew(int32_t skew);
+    int32_t getSkew() const;
+
+    // Consumes all inputFrames; output has to hold getMaxOutputFrames(inputFrames).
+    size_t process(const int16_t* input, size_t inputFrames, int16_t* output);
+    static size_t getMaxOutputFrames(size_t inputFrames);
+    void reset();
+
+private:
+    const uint32_t channelCount_;
+    int32_t skew_;
+    // input frames per output frame, Q32
+    uint64_t step_;
+    // of the next output frame, Q32, counted from the last frame of the previous call
+    uint64_t position_;
+    std::array<int16_t, 2> history_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,186 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_V4L2
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <QRect>
+#include <f1x/openauto/autoapp/Projection/FramePacer.hpp>
+#include <f1x/openauto/autoapp/Projection/V4L2DecodedFrame.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoOverlay.hpp>
+
+struct _drmModeAtomicReq;
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Scans decoded DMABUF frames out on a DRM overlay plane with atomic
+// modesetting. Frames are imported as framebuffers (no copy) and every commit
+// blocks until the flip happened on vblank, after which the frame that was on
+// screen before can go back to the decoder.
+//
+// The layer index (Video.OMXLayerIndex) keeps its OMX meaning: it is relative
+// to the plane Qt draws the UI on, positive values place the video above the
+// UI and values <= 0 below it (the UI then has to be transparent there).
+//
+// Only the content rect of a frame is scanned out, the plane scales it to the
+// display and leaves black bars where the aspect ratios differ.
+//
+// An overlay image (statistics) goes onto a second, ARGB plane stacked right
+// above the video. Changes to it ride along with the next video commit.
+//
+// Atomic commits require DRM master. Pass the descriptor of the client that
+// owns the display (e.g. Qt eglfs_kms) or run without another KMS client;
+// open() refuses a descriptor that is not master. Should commits keep failing
+// anyway (e.g. the VT was switched away) the presenter gives up and calls its
+// failure handler, so the next session can use another output.
+class DrmPresenter
+{
+public:
+    typedef std::shared_ptr<DrmPresenter> Pointer;
+    typedef std::function<void()> FailureHandler;
+
+    DrmPresenter(int32_t layerIndex, std::string devicePath = std::string());
+    DrmPresenter(int32_t layerIndex, int sharedFd);
+    ~DrmPresenter();
+
+    bool open();
+    // Called once, from the presenting thread, when the presenter gives up.
+    void setFailureHandler(FailureHandler handler);
+    bool hasFailed() const;
+    bool present(const V4L2DecodedFrame& frame, std::optional<V4L2DecodedFrame>& released);
+    // Takes the plane off the screen; returns the frame that was scanned out so
+    // a decoder that keeps running can have its buffer back.
+    std::optional<V4L2DecodedFrame> clear();
+    void setOverlay(VideoOverlay::Pointer overlay);
+    // Part of the frames to show, see VideoGeometry; an empty rect shows all of them.
+    void setContentRect(const QRect& contentRect);
+    // size of the mode of the CRTC, empty until opened
+    QRect getDisplayGeometry() const;
+    // Last vblank of the CRTC and the refresh period of its mode, for pacing.
+    // Called from the presenting thread.
+    FramePacer::VBlankClock getVBlankClock() const;
+
+    uint64_t getPresentedFrameCount() const;
+    uint32_t getPlaneId() const;
+    // 0 until an overlay image was shown
+    uint32_t getOverlayPlaneId() const;
+    uint64_t getZPosition() const;
+    static std::string findDevice();
+
+private:
+    struct PlaneProperties
+    {
+        uint32_t fbId = 0;
+        uint32_t crtcId = 0;
+        uint32_t srcX = 0;
+        uint32_t srcY = 0;
+        uint32_t srcW = 0;
+        uint32_t srcH = 0;
+        uint32_t crtcX = 0;
+        uint32_t crtcY = 0;
+        uint32_t crtcW = 0;
+        uint32_t crtcH = 0;
+        uint32_t zpos = 0;
+    };
+
+    struct OverlayBuffer
+    {
+        uint32_t handle = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t pitch = 0;
+        uint64_t size = 0;
+        uint32_t framebuffer = 0;
+        void* map = nullptr;
+    };
+
+    bool findCrtc();
+    bool findPlane(uint32_t drmFormat);
+    uint32_t findFreePlane(uint32_t drmFormat, uint32_t excludedPlaneId) const;
+    void readPlaneProperties(uint32_t planeId, PlaneProperties& properties) const;
+    bool setupZPosition();
+    uint32_t importFrame(const V4L2DecodedFrame& frame);
+    void removeFramebuffers(bool keepScannedOut);
+    // adds the overlay plane to a commit when the image changed; false when nothing was added
+    bool addOverlay(_drmModeAtomicReq* request);
+    bool createOverlayBuffers(uint32_t width, uint32_t height);
+    void destroyOverlayBuffers();
+    uint32_t propertyId(uint32_t objectId, uint32_t objectType, const char* name) const;
+
+    int32_t layerIndex_;
+    std::string devicePath_;
+    int fd_;
+    bool ownsFd_;
+    uint32_t crtcId_;
+    uint32_t crtcIndex_;
+    uint32_t displayWidth_;
+    uint32_t displayHeight_;
+    QRect contentRect_;
+    FramePacer::Clock::duration refreshPeriod_;
+    // when the last blocking commit returned, in case vblank queries are not supported
+    FramePacer::Clock::time_point lastFlip_;
+    uint32_t planeId_;
+    uint32_t planeFormat_;
+    uint64_t zPosition_;
+    PlaneProperties properties_;
+
+    // (generation, capture index) -> framebuffer, capture buffers are recycled
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> framebuffers_;
+    std::optional<V4L2DecodedFrame> scannedOut_;
+    uint32_t scannedOutFramebuffer_;
+    uint64_t presentedFrames_;
+
+    VideoOverlay::Pointer overlay_;
+    VideoOverlay::Image overlayImage_;
+    uint64_t overlayGeneration_;
+    uint32_t overlayPlaneId_;
+    PlaneProperties overlayProperties_;
+    // double buffered, the one not scanned out is drawn into
+    OverlayBuffer overlayBuffers_[2];
+    uint32_t overlayBack_;
+    bool overlayVisible_;
+    // set after a commit with the overlay failed, video goes on without it
+    bool overlayDisabled_;
+    // in a row; at cMaxCommitFailures nothing is presented any more
+    uint32_t commitFailures_;
+    std::atomic<bool> failed_;
+    FailureHandler failureHandler_;
+    std::mutex mutex_;
+};
+
+}
+}
+}
+}
+
+#endif
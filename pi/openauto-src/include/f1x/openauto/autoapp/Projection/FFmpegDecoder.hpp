@@ -0,0 +1,88 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_FFMPEG
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <boost/noncopyable.hpp>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Thin libavcodec wrapper that decodes one Android Auto media message (a
+// complete access unit, parameter sets included) per call. The context is set
+// up for low delay: every packet is expected to produce its picture right away.
+//
+// Slice threading is used by default. Frame threading spreads better over the
+// cores but holds back threadCount - 1 pictures, which is only acceptable for
+// benchmarking or streams that are encoded with a single slice per picture.
+class FFmpegDecoder: boost::noncopyable
+{
+public:
+    typedef std::function<void(const AVFrame*)> FrameHandler;
+
+    struct Statistics
+    {
+        uint64_t frames = 0;
+        uint64_t errors = 0;
+        uint64_t totalMicroseconds = 0;
+        uint64_t maxMicroseconds = 0;
+    };
+
+    FFmpegDecoder();
+    ~FFmpegDecoder();
+
+    // threadCount 0 uses every online core.
+    bool open(AVCodecID codecId = AV_CODEC_ID_H264, int threadCount = 0, bool frameThreading = false);
+    bool decode(uint64_t timestamp, const uint8_t* data, size_t size, const FrameHandler& handler);
+    void close();
+
+    bool isOpen() const;
+    Statistics getStatistics() const;
+
+private:
+    void receiveFrames(std::chrono::steady_clock::time_point begin, const FrameHandler& handler);
+    void report();
+
+    AVCodecContext* context_;
+    AVPacket* packet_;
+    AVFrame* frame_;
+    Statistics statistics_;
+    Statistics window_;
+};
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_FFMPEG
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <QImage>
+#include <QSize>
+#include <QTimer>
+#include <QWidget>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/FFmpegDecoder.hpp>
+#include <f1x/openauto/autoapp/Projection/FramePacer.hpp>
+#include <f1x/openauto/autoapp/Projection/H264Parser.hpp>
+#include <f1x/openauto/autoapp/Projection/PresentationPolicy.hpp>
+
+struct SwsContext;
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Software decode fallback for builds without OMX/V4L2. Every media message is
+// decoded as it arrives and its content (the margins left out) converted
+// straight to the size it has on the fullscreen widget, so nothing is buffered
+// between the phone and the screen. When the GUI thread falls behind, only the
+// newest picture is kept. A paced picture waits for its due time on the GUI
+// thread, the decoding side never sleeps.
+class FFmpegVideoOutput: public QObject, public VideoOutput, boost::noncopyable
+{
+    Q_OBJECT
+
+public:
+    FFmpegVideoOutput(configuration::IConfiguration::Pointer configuration);
+    ~FFmpegVideoOutput() override;
+
+    bool open() override;
+    bool init() override;
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void stop() override;
+    bool suspend() override;
+    void resume() override;
+    // H.264 and H.265 as far as libavcodec has them; until a session measured the
+    // throughput only the configured mode is assumed to be sustainable
+    VideoCapabilities getCapabilities() override;
+    void setVideoMode(const VideoMode& mode) override;
+
+    FFmpegDecoder::Statistics getDecodeStatistics();
+
+signals:
+    void startPlayback();
+    void stopPlayback();
+    void frameReady();
+
+protected slots:
+    void createVideoOutput();
+    void onStartPlayback();
+    void onStopPlayback();
+    void onFrameReady();
+    void onPresentTimeout();
+
+private:
+    class FrameWidget;
+
+    void convertFrame(const AVFrame* frame);
+    // GUI thread
+    void showFrame(QImage frame);
+    void storeThroughput();
+
+    std::mutex mutex_;
+    FFmpegDecoder decoder_;
+    PresentationPolicy presentationPolicy_;
+    const bool framePacing_;
+    FramePacer framePacer_;
+    // of the screen the widget is on, the refresh phase is not known to Qt
+    FramePacer::Clock::duration refreshPeriod_;
+    // outlives the decoder, so a reopened one starts configured
+    H264ParameterSets parameterSets_;
+    SwsContext* scaler_;
+    QSize outputSize_;
+
+    std::mutex frameMutex_;
+    QImage pendingFrame_;
+    FramePacer::Clock::time_point pendingDue_;
+    std::atomic<bool> framePending_;
+    // suspended: decoding goes on so the references stay valid, conversion is skipped
+    std::atomic<bool> hidden_;
+    std::unique_ptr<FrameWidget> videoWidget_;
+    // GUI thread: the paced picture waiting for its due time
+    std::unique_ptr<QTimer> presentTimer_;
+    QImage scheduledFrame_;
+};
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <f1x/openauto/autoapp/Projection/NullVideoOutput.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Writes the stream as it arrives to a raw Annex-B file (H.264 or H.265, as the
+// phone picked) and next to it, in path + cIndexSuffix, one line per media
+// message: "<timestamp> <offset> <size>". The replay benchmark reads both to
+// play a recorded session back with its original framing and timing. Both files
+// are rewritten every time the output is opened.
+class FileVideoOutput: public NullVideoOutput
+{
+public:
+    FileVideoOutput(std::string path,
+                    aap_protobuf::service::media::sink::message::VideoCodecResolutionType resolution,
+                    aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate,
+                    size_t screenDPI);
+
+    bool open() override;
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void stop() override;
+
+    static const std::string cIndexSuffix;
+
+private:
+    const std::string path_;
+    std::mutex fileMutex_;
+    std::ofstream stream_;
+    std::ofstream index_;
+    uint64_t offset_;
+};
+
+}
+}
+}
+}
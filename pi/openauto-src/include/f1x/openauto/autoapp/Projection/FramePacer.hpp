@@ -0,0 +1,108 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Puts decoded frames on display refreshes so motion stays even although the
+// frames arrive with network jitter. Android Auto timestamps are mapped to
+// the local clock through the smallest arrival offset seen over the last few
+// seconds (the frame that was delayed least), plus a jitter margin that jumps
+// up to every delay observed and slowly decays again. A frame is due on the
+// first refresh at or after its mapped time, or stays in the cadence of the
+// frames before it while that is within half a refresh. The margin never grows
+// beyond maxDelay, so at most maxDelay plus one and a half refreshes are added.
+// While media audio plays on a MediaClock, frames are put where the clock
+// says their timestamp is heard instead, as long as that is plausibly the
+// same timeline (within cMaxSyncOffset of the arrival based time).
+//
+// Not thread safe, it lives next to the presenter it schedules for.
+class FramePacer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // A recent refresh and the refresh period. Without a known phase
+    // (last == time_point()) the first frame anchors the grid.
+    struct VBlankClock
+    {
+        Clock::time_point last;
+        Clock::duration period = std::chrono::microseconds(16667);
+    };
+
+    struct Statistics
+    {
+        uint64_t frames = 0;
+        // would have needed more than maxDelay of buffering
+        uint64_t late = 0;
+        uint64_t resyncs = 0;
+        // scheduled by the media clock
+        uint64_t synced = 0;
+    };
+
+    explicit FramePacer(std::chrono::milliseconds maxDelay = std::chrono::milliseconds(50));
+
+    // The refresh the frame should appear on, never before the one following now.
+    Clock::time_point schedule(uint64_t timestamp, Clock::time_point now, const VBlankClock& vblank);
+    void reset();
+    // the audio timeline to follow, may be nullptr
+    void setMediaClock(MediaClock::Pointer clock);
+
+    std::chrono::microseconds getMargin() const;
+    Statistics getStatistics() const;
+    std::string describe() const;
+
+private:
+    static constexpr size_t cWindow = 128;
+    static constexpr std::chrono::milliseconds cMaxSyncOffset = std::chrono::milliseconds(500);
+
+    void addOffset(int64_t offset);
+
+    int64_t maxDelay_;
+    // arrival minus timestamp, microseconds
+    std::array<int64_t, cWindow> offsets_;
+    size_t offsetCount_;
+    size_t offsetNext_;
+    int64_t baseOffset_;
+    int64_t margin_;
+    uint64_t lastTimestamp_;
+    Clock::time_point anchor_;
+    Clock::time_point lastDue_;
+    Statistics statistics_;
+    MediaClock::Pointer mediaClock_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,175 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+enum class H264NalType: uint8_t
+{
+    UNSPECIFIED = 0,
+    SLICE = 1,
+    SLICE_PARTITION_A = 2,
+    SLICE_PARTITION_B = 3,
+    SLICE_PARTITION_C = 4,
+    SLICE_IDR = 5,
+    SEI = 6,
+    SPS = 7,
+    PPS = 8,
+    ACCESS_UNIT_DELIMITER = 9,
+    END_OF_SEQUENCE = 10,
+    END_OF_STREAM = 11,
+    FILLER = 12
+};
+
+// One NAL unit of an Annex-B stream, data starts at the NAL header and does not
+// include the start code.
+struct H264NalUnit
+{
+    H264NalType type = H264NalType::UNSPECIFIED;
+    uint8_t refIdc = 0;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+struct H264SequenceInfo
+{
+    uint8_t profileIdc = 0;
+    uint8_t constraintFlags = 0;
+    uint8_t levelIdc = 0;
+    uint32_t id = 0;
+    uint32_t chromaFormatIdc = 1;
+    uint32_t maxReferenceFrames = 0;
+    bool frameMbsOnly = true;
+    // visible size, after the frame cropping of the SPS
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+struct H264AccessUnitInfo
+{
+    bool hasSlice = false;
+    bool isIdr = false;
+    bool isReference = false;
+    // first_mb_in_slice of the first slice is 0, or the unit starts with a delimiter
+    bool isPictureStart = false;
+    bool hasParameterSets = false;
+    // only reported when inspected with a parameter set cache
+    bool sequenceChanged = false;
+};
+
+// Latest SPS and PPS seen in the stream. Android Auto uses a single pair per
+// session, so one of each is kept; a decoder that is opened again can be fed
+// these before the next frame instead of waiting for the phone's next IDR.
+class H264ParameterSets
+{
+public:
+    // Returns true when the SPS differs from the cached one.
+    bool update(const H264NalUnit& nal);
+    void clear();
+
+    bool isComplete() const;
+    const H264SequenceInfo& getSequenceInfo() const;
+    // SPS followed by PPS, with start codes
+    const aasdk::common::Data& getAnnexB() const;
+
+private:
+    static bool store(aasdk::common::Data& target, const H264NalUnit& nal);
+    void rebuild();
+
+    aasdk::common::Data sps_;
+    aasdk::common::Data pps_;
+    aasdk::common::Data annexB_;
+    H264SequenceInfo sequenceInfo_;
+};
+
+// Cheap look into Android Auto's Annex-B H.264: finds NAL units, reads the
+// fields of SPS and slice headers that matter for scheduling and decoder setup,
+// nothing beyond that.
+class H264Parser
+{
+public:
+    // Calls handler(const H264NalUnit&) for every NAL unit until it returns false.
+    template<typename Handler>
+    static void forEachNalUnit(const uint8_t* data, size_t size, Handler&& handler);
+
+    // Looks at an access unit up to its first slice, everything after that is
+    // slice data. SPS and PPS on the way are stored in parameterSets if given.
+    static H264AccessUnitInfo inspect(const uint8_t* data, size_t size, H264ParameterSets* parameterSets = nullptr);
+    // The same for H.265, which shares the Annex-B framing; only the NAL
+    // headers are read, parameter sets are reported but not parsed.
+    static H264AccessUnitInfo inspectH265(const uint8_t* data, size_t size);
+
+    static bool parseSequenceParameterSet(const H264NalUnit& nal, H264SequenceInfo& info);
+    static bool parseFirstMbInSlice(const H264NalUnit& nal, uint32_t& firstMbInSlice);
+
+    static const char* profileName(uint8_t profileIdc);
+    // "1280x720, high profile, level 3.1"
+    static std::string describe(const H264SequenceInfo& info);
+
+private:
+    // offset of the first byte after the next 00 00 01 at or after offset, size if there is none
+    static size_t findStartCode(const uint8_t* data, size_t size, size_t offset);
+};
+
+template<typename Handler>
+void H264Parser::forEachNalUnit(const uint8_t* data, size_t size, Handler&& handler)
+{
+    size_t begin = findStartCode(data, size, 0);
+    while(begin < size)
+    {
+        const size_t next = findStartCode(data, size, begin);
+        size_t end = next < size ? next - 3 : size;
+        // the leading zero of a four byte start code belongs to the next unit
+        while(end > begin && data[end - 1] == 0 && next < size)
+        {
+            --end;
+        }
+
+        H264NalUnit nal;
+        nal.type = static_cast<H264NalType>(data[begin] & 0x1F);
+        nal.refIdc = (data[begin] >> 5) & 0x03;
+        nal.data = data + begin;
+        nal.size = end - begin;
+
+        if(nal.size > 0 && !handler(static_cast<const H264NalUnit&>(nal)))
+        {
+            return;
+        }
+
+        begin = next;
+    }
+}
+
+}
+}
+}
+}
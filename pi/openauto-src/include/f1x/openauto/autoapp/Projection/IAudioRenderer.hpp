@@ -0,0 +1,51 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Produces PCM on demand for an output that pulls from its own realtime
+// thread. render() must not lock, allocate or block.
+class IAudioRenderer
+{
+public:
+    virtual ~IAudioRenderer() = default;
+
+    // Fills frames interleaved frames in the format of the output; returns
+    // how many were produced, the output plays silence for the rest.
+    virtual size_t render(void* buffer, size_t frames) = 0;
+    // Told by the output once it is open: how long after render() returns
+    // a frame is heard, as far as the backend reports it.
+    virtual void setOutputLatency(std::chrono::microseconds) {}
+};
+
+}
+}
+}
+}
@@ -45,6 +45,8 @@ public:
     virtual ButtonCodes getSupportedButtonCodes() const = 0;
     virtual bool hasTouchscreen() const = 0;
     virtual QRect getTouchscreenGeometry() const = 0;
+    // part of the video frame the phone draws into (margins left out), touches are reported in frame coordinates
+    virtual void setVideoGeometry(const QRect& videoGeometry) = 0;
 };
 
 }
@@ -24,6 +24,8 @@
 #include <aasdk/Messenger/Timestamp.hpp>
 #include <aap_protobuf/service/media/sink/message/VideoFrameRateType.pb.h>
 #include <aap_protobuf/service/media/sink/message/VideoCodecResolutionType.pb.h>
+#include <f1x/openauto/autoapp/Projection/VideoCapabilities.hpp>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
 
 namespace f1x
 {
@@ -46,11 +48,27 @@ public:
     virtual bool init() = 0;
     virtual void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) = 0;
     virtual void stop() = 0;
+    // Takes the picture off the screen but keeps the decoder configured, so that
+    // resume() can show the stream again without rebuilding it. Returns false
+    // when the output can only be stopped.
+    virtual bool suspend() = 0;
+    virtual void resume() = 0;
+
+    // Probed before the service discovery answer; the mode the phone was told to
+    // use is set before init().
+    virtual VideoCapabilities getCapabilities() = 0;
+    virtual void setVideoMode(const VideoMode& mode) = 0;
+    // The audio timeline frames are paced to where the output paces at all;
+    // set before open().
+    virtual void setMediaClock(MediaClock::Pointer clock) = 0;
 
     virtual aap_protobuf::service::media::sink::message::VideoFrameRateType getVideoFPS() const = 0;
     virtual aap_protobuf::service::media::sink::message::VideoCodecResolutionType getVideoResolution() const = 0;
     virtual size_t getScreenDPI() const = 0;
-    virtual QRect getVideoMargins() const = 0;
+    // Margins of the given mode, see VideoGeometry.
+    virtual QRect getVideoMargins(const VideoMode& mode) const = 0;
+    // Size of the screen the video is shown on, empty when not known.
+    virtual QRect getDisplayGeometry() const = 0;
 
 };
 
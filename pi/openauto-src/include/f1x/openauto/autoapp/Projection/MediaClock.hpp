@@ -0,0 +1,72 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Where the phone's media timeline is in local time. The audio side tells it
+// when the sample with a given timestamp is heard; the video pacer asks when a
+// frame with a given timestamp is due, so pictures follow the sound. The
+// offset is smoothed over the jitter of the audio callbacks and jumps to a new
+// value when the timeline restarts. One thread updates, any thread maps,
+// nothing locks.
+class MediaClock: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<MediaClock> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    MediaClock();
+
+    // Writer: the sample with timestamp (microseconds) is heard at playout.
+    void update(uint64_t timestamp, Clock::time_point playout);
+    // Any thread: the timeline stopped, e.g. playback was closed.
+    void invalidate();
+
+    // Reader: false when the last sample mapped was heard more than cMaxAge ago.
+    bool map(uint64_t timestamp, Clock::time_point now, Clock::time_point& playout) const;
+    uint64_t getResyncCount() const;
+
+    static constexpr std::chrono::milliseconds cMaxAge = std::chrono::milliseconds(200);
+
+private:
+    // local playout minus timestamp, microseconds
+    std::atomic<int64_t> offset_;
+    // playout of the last update, zero while invalid
+    std::atomic<int64_t> lastPlayout_;
+    std::atomic<uint64_t> resyncs_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,97 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/autoapp/Projection/IVideoOutput.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Stands in for a decoder where there is no display (CI machines, benchmarks):
+// frames are counted and timestamped, nothing is decoded. Every codec and size
+// up to the given resolution is accepted, and no part of Qt GUI is needed.
+class NullVideoOutput: public IVideoOutput, boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Statistics
+    {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        // stream timestamps (microseconds) of the first and last frame
+        uint64_t firstTimestamp = 0;
+        uint64_t lastTimestamp = 0;
+        // when they were written
+        Clock::time_point firstWrite;
+        Clock::time_point lastWrite;
+        // longest time between two writes, the stall a display would have shown
+        Clock::duration maxInterval{};
+    };
+
+    NullVideoOutput(aap_protobuf::service::media::sink::message::VideoCodecResolutionType resolution,
+                    aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate,
+                    size_t screenDPI);
+
+    bool open() override;
+    bool init() override;
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void stop() override;
+    bool suspend() override;
+    void resume() override;
+    VideoCapabilities getCapabilities() override;
+    void setVideoMode(const VideoMode& mode) override;
+    // nothing is paced
+    void setMediaClock(MediaClock::Pointer clock) override;
+
+    aap_protobuf::service::media::sink::message::VideoFrameRateType getVideoFPS() const override;
+    aap_protobuf::service::media::sink::message::VideoCodecResolutionType getVideoResolution() const override;
+    size_t getScreenDPI() const override;
+    QRect getVideoMargins(const VideoMode& mode) const override;
+    QRect getDisplayGeometry() const override;
+
+    // of the frames since the last open()
+    Statistics getStatistics() const;
+    VideoMode getVideoMode() const;
+    static std::string describe(const Statistics& statistics);
+
+private:
+    const aap_protobuf::service::media::sink::message::VideoCodecResolutionType resolution_;
+    const aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate_;
+    const size_t screenDPI_;
+
+    mutable std::mutex mutex_;
+    VideoMode videoMode_;
+    Statistics statistics_;
+};
+
+}
+}
+}
+}
@@ -29,6 +29,8 @@ extern "C"
 #include <thread>
 #include <boost/circular_buffer.hpp>
 #include <f1x/openauto/autoapp/Projection/VideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/H264Parser.hpp>
+#include <f1x/openauto/autoapp/Projection/PresentationPolicy.hpp>
 
 namespace f1x
 {
@@ -48,13 +50,17 @@ public:
     bool init() override;
     void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
     void stop() override;
+    bool suspend() override;
+    void resume() override;
+    VideoCapabilities getCapabilities() override;
 
 private:
     bool createComponents();
     bool initClock();
     bool setupTunnels();
     bool enablePortBuffers();
-    bool setupDisplayRegion();
+    bool setupDisplayRegion(bool visible);
+    void submit(uint64_t timestamp, const uint8_t* data, size_t size, OMX_U32 flags);
 
     std::mutex mutex_;
     bool isActive_;
@@ -62,6 +68,9 @@ private:
     ILCLIENT_T* client_;
     COMPONENT_T* components_[5];
     TUNNEL_T tunnels_[4];
+    PresentationPolicy presentationPolicy_;
+    // replayed into the decoder on resume, the phone restarts with a keyframe that may not carry them
+    H264ParameterSets parameterSets_;
 };
 
 }
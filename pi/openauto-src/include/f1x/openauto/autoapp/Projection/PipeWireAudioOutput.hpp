@@ -0,0 +1,110 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_PIPEWIRE
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/Common/SpscByteRing.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioFillMonitor.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
+
+struct pw_thread_loop;
+struct pw_stream;
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// One pw_stream on the local PipeWire daemon. The process callback runs on the
+// realtime data thread and only copies from a wait-free ring, playing silence
+// and counting an underrun when it runs dry. The stream carries media.role
+// ("Music", "Navigation", ...), so the session manager can duck one channel
+// under another, and asks for a small quantum through node.latency.
+class PipeWireAudioOutput: public IAudioOutput, boost::noncopyable
+{
+public:
+    struct Statistics
+    {
+        uint64_t processedFrames = 0;
+        // gaps while a stream was playing
+        uint64_t underruns = 0;
+        uint64_t silentFrames = 0;
+        // frames the graph asked for in the last cycle
+        uint32_t quantum = 0;
+        bool streaming = false;
+    };
+
+    // quantum in frames; the graph may run with another one if a different
+    // client asks for less or the daemon limits it
+    PipeWireAudioOutput(std::string role, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate,
+                        uint32_t quantum, std::chrono::milliseconds latencyBound = std::chrono::milliseconds(500));
+    ~PipeWireAudioOutput() override;
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void suspend() override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+
+    Statistics getStatistics() const;
+
+private:
+    // the pw_stream_events handlers, defined next to the PipeWire includes
+    struct Events;
+    void process();
+
+    const std::string role_;
+    const uint32_t channelCount_;
+    const uint32_t sampleSize_;
+    const uint32_t sampleRate_;
+    const uint32_t bytesPerFrame_;
+    const uint32_t quantum_;
+    common::SpscByteRing audioBuffer_;
+
+    pw_thread_loop* threadLoop_;
+    pw_stream* stream_;
+
+    // written on the data thread only
+    std::atomic<uint64_t> processedFrames_;
+    std::atomic<uint32_t> lastQuantum_;
+    AudioFillMonitor fillMonitor_;
+    std::atomic<bool> streaming_;
+
+    // control calls only, never taken by the data thread
+    std::mutex mutex_;
+};
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+#include <f1x/openauto/Common/SpscQueue.hpp>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Follows a timestamped channel through its byte ring. The writer marks where
+// each message starts in the stream; the reader says which stream position
+// is about to play, when it will be heard and how much is queued behind it.
+// From that the scheduler publishes the timestamp being heard to the
+// MediaClock, and it keeps the queue at the length it settled at after the
+// start, or at the one a jitter buffer asks for. To do that it returns a skew for DriftCorrector, from a slow PI
+// loop, so the queue neither grows nor runs dry when the phone's clock
+// drifts against the sound card. mark() is called from one thread and
+// everything else from the reader.
+class PlayoutScheduler: boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Statistics
+    {
+        // ppm, what the drift corrector is told
+        int32_t skew = 0;
+        // smoothed queue length and the one it is held at, zero while settling
+        std::chrono::microseconds queued{0};
+        std::chrono::microseconds target{0};
+    };
+
+    PlayoutScheduler(uint32_t sampleRate, uint32_t bytesPerFrame, MediaClock::Pointer clock);
+
+    // Writer: the bytes from stream position on carry timestamp (microseconds).
+    void mark(uint64_t timestamp, uint64_t position);
+    // Reader: the bytes from stream position on are heard at playout and
+    // queuedBytes wait behind them. Returns the skew in ppm.
+    int32_t onPlay(uint64_t position, Clock::time_point playout, size_t queuedBytes);
+    // Reader: the queue length to hold once settled, zero for the settled one.
+    void setTarget(std::chrono::microseconds target);
+    // Reader, or with the writer stopped.
+    void reset();
+
+    Statistics getStatistics() const;
+
+private:
+    struct Mark
+    {
+        uint64_t timestamp = 0;
+        uint64_t position = 0;
+    };
+
+    const uint32_t sampleRate_;
+    const uint32_t bytesPerFrame_;
+    MediaClock::Pointer clock_;
+    common::SpscQueue<Mark> marks_;
+
+    // reader side
+    Mark current_;
+    Mark next_;
+    bool hasCurrent_;
+    bool hasNext_;
+    uint64_t plays_;
+    double queued_;
+    double target_;
+    double requestedTarget_;
+    double integral_;
+
+    std::atomic<int32_t> skew_;
+    std::atomic<int64_t> queuedStatistic_;
+    std::atomic<int64_t> targetStatistic_;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,102 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <f1x/openauto/autoapp/Projection/H264Parser.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+enum class PresentationDecision
+{
+    DECODE,
+    DROP,
+    // decode, and everything still queued in front of this IDR may be discarded
+    RESYNC
+};
+
+// Keeps the backlog in front of a decoder bounded. Each media message is
+// checked against a wall-clock target derived from its Android Auto timestamp
+// when it is about to be submitted. Frames nothing depends on are skipped once
+// the stream is late; when it is far behind, everything up to the next IDR is
+// skipped so the picture catches up in one step instead of crawling.
+//
+// Not thread safe, it lives next to the decoder it feeds.
+class PresentationPolicy
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    typedef H264AccessUnitInfo FrameInfo;
+
+    struct Statistics
+    {
+        uint64_t frames = 0;
+        uint64_t late = 0;
+        uint64_t dropped = 0;
+        uint64_t resyncs = 0;
+        int64_t maxLatenessMicroseconds = 0;
+    };
+
+    PresentationPolicy(std::chrono::milliseconds lateThreshold = std::chrono::milliseconds(50),
+                       std::chrono::milliseconds resyncThreshold = std::chrono::milliseconds(250),
+                       std::chrono::milliseconds maxIdrWait = std::chrono::milliseconds(1000));
+
+    PresentationDecision onFrame(uint64_t timestamp, const FrameInfo& info, Clock::time_point now = Clock::now());
+    // The decoder lost (part of) an access unit: what follows may refer to it,
+    // so everything up to the next IDR is skipped.
+    void skipToIdr(Clock::time_point now = Clock::now());
+    void reset();
+
+    Statistics getStatistics() const;
+    std::string describe() const;
+
+    // Looks at the NAL unit headers of an Annex-B access unit, see H264Parser::inspect.
+    static FrameInfo inspect(const uint8_t* data, size_t size, H264ParameterSets* parameterSets = nullptr);
+
+private:
+    void anchor(uint64_t timestamp, Clock::time_point now);
+
+    std::chrono::microseconds lateThreshold_;
+    std::chrono::microseconds resyncThreshold_;
+    std::chrono::microseconds maxIdrWait_;
+
+    bool anchored_;
+    uint64_t anchorTimestamp_;
+    Clock::time_point anchorTime_;
+    uint64_t lastTimestamp_;
+    bool waitingForIdr_;
+    Clock::time_point waitingSince_;
+    Statistics statistics_;
+};
+
+}
+}
+}
+}
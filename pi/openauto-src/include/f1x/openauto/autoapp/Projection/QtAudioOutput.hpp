@@ -21,7 +21,6 @@
 #include <QAudioOutput>
 #include <QAudioFormat>
 #include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
-#include <f1x/openauto/autoapp/Projection/SequentialBuffer.hpp>
 
 namespace f1x
 {
@@ -22,7 +22,7 @@
 #include <QVideoWidget>
 #include <boost/noncopyable.hpp>
 #include <f1x/openauto/autoapp/Projection/VideoOutput.hpp>
-#include <f1x/openauto/autoapp/Projection/SequentialBuffer.hpp>
+#include <f1x/openauto/autoapp/Projection/RingBufferDevice.hpp>
 
 namespace f1x
 {
@@ -43,6 +43,8 @@ public:
     bool init() override;
     void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
     void stop() override;
+    // QMediaPlayer shows whole frames, margins would only be stretched black bars
+    QRect getVideoMargins(const VideoMode& mode) const override;
 
 signals:
     void startPlayback();
@@ -54,7 +56,7 @@ protected slots:
     void onStopPlayback();
 
 private:
-    SequentialBuffer videoBuffer_;
+    RingBufferDevice videoBuffer_;
     std::unique_ptr<QVideoWidget> videoWidget_;
     std::unique_ptr<QMediaPlayer> mediaPlayer_;
 };
@@ -18,10 +18,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <QIODevice>
-#include <mutex>
-#include <boost/circular_buffer.hpp>
-#include <aasdk/Common/Data.hpp>
+#include <f1x/openauto/Common/SpscByteRing.hpp>
 
 namespace f1x
 {
@@ -32,10 +31,19 @@ namespace autoapp
 namespace projection
 {
 
-class SequentialBuffer: public QIODevice
+// Endless sequential device between a stream writer (the service strand) and
+// a reader on another thread (the media player or the audio callback). Reads
+// and writes go straight to a wait-free ring, QIODevice's own buffering is
+// switched off. Whatever exceeds the latency bound is dropped oldest first.
+// readyRead is coalesced: it is emitted again only after the reader has been
+// back for more.
+class RingBufferDevice: public QIODevice
 {
 public:
-    SequentialBuffer();
+    typedef common::SpscByteRing::Statistics Statistics;
+
+    RingBufferDevice(size_t latencyBound, size_t alignment = 1);
+
     bool isSequential() const override;
     qint64 size() const override;
     qint64 pos() const override;
@@ -46,13 +54,16 @@ public:
     qint64 bytesAvailable() const override;
     bool open(OpenMode mode) override;
 
+    void setLatencyBound(size_t latencyBound);
+    Statistics getStatistics() const;
+
 protected:
     qint64 readData(char *data, qint64 maxlen) override;
     qint64 writeData(const char *data, qint64 len) override;
 
 private:
-    boost::circular_buffer<aasdk::common::Data::value_type> data_;
-    mutable std::mutex mutex_;
+    common::SpscByteRing ring_;
+    std::atomic<bool> readyReadPending_;
 };
 
 }
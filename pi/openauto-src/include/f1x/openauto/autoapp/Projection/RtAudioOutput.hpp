@@ -24,8 +24,14 @@
 #  include <RtAudio.h>
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <f1x/openauto/Common/SpscByteRing.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioFillMonitor.hpp>
 #include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
-#include <f1x/openauto/autoapp/Projection/SequentialBuffer.hpp>
+#include <f1x/openauto/autoapp/Projection/IAudioRenderer.hpp>
 
 namespace f1x
 {
@@ -36,10 +42,18 @@ namespace autoapp
 namespace projection
 {
 
+// PCM goes from write() to the realtime callback of RtAudio through a wait-free
+// ring; the callback never locks or allocates. What the ring cannot provide is
+// played as silence and counted as an underrun. Built on a renderer, the
+// callback pulls from it instead and write() is not used.
 class RtAudioOutput: public IAudioOutput
 {
 public:
-    RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    // latencyBound caps the queued audio, anything older is skipped
+    RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate,
+                  std::chrono::milliseconds latencyBound = std::chrono::milliseconds(500));
+    // renderer has to outlive the output
+    RtAudioOutput(IAudioRenderer& renderer, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
     bool open() override;
     void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
     void start() override;
@@ -57,8 +71,12 @@ private:
     uint32_t channelCount_;
     uint32_t sampleSize_;
     uint32_t sampleRate_;
-    SequentialBuffer audioBuffer_;
+    const uint32_t bytesPerFrame_;
+    common::SpscByteRing audioBuffer_;
+    IAudioRenderer* renderer_;
+    AudioFillMonitor fillMonitor_;
     std::unique_ptr<RtAudio> dac_;
+    // control calls only, never taken by the callback
     std::mutex mutex_;
 };
 
@@ -0,0 +1,55 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <linux/videodev2.h>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// A decoded picture that still lives in a capture buffer of the decoder. The
+// DMABUF descriptors stay owned by the decoder; generation changes every time
+// the capture queue is reallocated, which invalidates older indices.
+struct V4L2DecodedFrame
+{
+    uint32_t index;
+    uint32_t generation;
+    uint32_t width;
+    uint32_t height;
+    uint32_t visibleWidth;
+    uint32_t visibleHeight;
+    uint32_t pixelFormat;
+    uint32_t planeCount;
+    int dmabufFd[VIDEO_MAX_PLANES];
+    uint32_t bytesPerLine[VIDEO_MAX_PLANES];
+    uint32_t planeOffset[VIDEO_MAX_PLANES];
+    uint64_t timestamp;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,153 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_V4L2
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <linux/videodev2.h>
+#include <f1x/openauto/autoapp/Projection/VideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/V4L2DecodedFrame.hpp>
+#include <f1x/openauto/autoapp/Projection/PresentationPolicy.hpp>
+#include <f1x/openauto/autoapp/Projection/DrmPresenter.hpp>
+#include <f1x/openauto/autoapp/Projection/FramePacer.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Stateful V4L2 memory-to-memory decoder (Raspberry Pi 4 bcm2835-codec,
+// Rockchip/Allwinner hantro, vicodec for testing). Compressed data is copied
+// into MMAP OUTPUT buffers, decoded pictures come back on CAPTURE buffers that
+// are exported as DMABUF so a presenter can scan them out without a copy.
+// While a frame is on screen its buffer is held back from the decoder.
+class V4L2VideoOutput: public VideoOutput
+{
+public:
+    typedef std::function<void(const V4L2DecodedFrame&)> FrameHandler;
+
+    // An empty device path picks the first M2M device that can decode codedFormat.
+    V4L2VideoOutput(configuration::IConfiguration::Pointer configuration,
+                    std::string devicePath = std::string(),
+                    uint32_t codedFormat = V4L2_PIX_FMT_H264);
+    ~V4L2VideoOutput() override;
+
+    bool open() override;
+    bool init() override;
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void stop() override;
+    bool suspend() override;
+    void resume() override;
+    VideoCapabilities getCapabilities() override;
+    void setVideoMode(const VideoMode& mode) override;
+    // the mode of the DRM display, once there is a presenter
+    QRect getDisplayGeometry() const override;
+
+    void setFrameHandler(FrameHandler handler);
+    void setPresenter(DrmPresenter::Pointer presenter);
+    uint64_t getDecodedFrameCount() const;
+    static std::string findDecoder(uint32_t codedFormat);
+
+private:
+    struct MappedBuffer
+    {
+        void* address[VIDEO_MAX_PLANES];
+        size_t length[VIDEO_MAX_PLANES];
+        int dmabufFd[VIDEO_MAX_PLANES];
+        uint32_t planeCount;
+    };
+
+    bool configureOutput();
+    // the presenter cuts the margins of mode off
+    void applyContentRect(const DrmPresenter::Pointer& presenter, const VideoMode& mode) const;
+    bool setupCapture();
+    void releaseCapture();
+    void releaseOutput();
+    bool queueCaptureBuffer(uint32_t index);
+    // false when the access unit was dropped, nothing of it is queued then unless qbuf failed half way
+    bool queueBitstream(uint64_t timestamp, const uint8_t* data, size_t size, std::unique_lock<std::mutex>& lock);
+    void fillFrame(const v4l2_buffer& buffer, const v4l2_plane* planes, V4L2DecodedFrame& frame) const;
+    void eventLoop();
+    void wakeup();
+    // event thread: the frame on screen goes back to the decoder
+    void clearScreen();
+    void handleEvents();
+    void dequeueCapture();
+    // event thread: on screen, or back to the decoder when nothing is shown
+    void presentFrame(const V4L2DecodedFrame& frame);
+    void dequeueOutput();
+    void prepareBuffer(v4l2_buffer& buffer, v4l2_plane* planes, uint32_t type, uint32_t index) const;
+
+    std::string devicePath_;
+    uint32_t codedFormat_;
+    int fd_;
+    int wakeupFd_;
+    bool multiPlanar_;
+    uint32_t outputType_;
+    uint32_t captureType_;
+
+    std::vector<MappedBuffer> outputBuffers_;
+    std::vector<uint32_t> freeOutputBuffers_;
+    std::vector<MappedBuffer> captureBuffers_;
+    v4l2_format captureFormat_;
+    v4l2_rect visibleRect_;
+    uint32_t captureGeneration_;
+    bool captureStreaming_;
+
+    std::mutex mutex_;
+    std::condition_variable outputAvailable_;
+    std::thread eventThread_;
+    std::atomic<bool> isActive_;
+    std::atomic<uint64_t> decodedFrames_;
+    FrameHandler frameHandler_;
+    DrmPresenter::Pointer presenter_;
+    PresentationPolicy presentationPolicy_;
+    // only touched by the event thread (or while it is stopped)
+    const bool framePacing_;
+    FramePacer framePacer_;
+    // paced frame waiting for its commit; the event loop polls until then so
+    // output buffers keep coming back, and dequeues no further capture buffers
+    std::optional<V4L2DecodedFrame> pendingFrame_;
+    FramePacer::Clock::time_point commitTime_;
+    // kept across open/stop; a decoder opened mid-stream is fed these before its first frame
+    H264ParameterSets parameterSets_;
+    bool primePending_;
+    // suspended: frames are still decoded so the references stay valid, nothing is presented
+    std::atomic<bool> hidden_;
+    // suspend() asks the event thread to take the picture off the screen
+    std::atomic<bool> clearPending_;
+};
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <aap_protobuf/service/media/shared/message/MediaCodecType.pb.h>
+#include <aap_protobuf/service/media/sink/message/VideoFrameRateType.pb.h>
+#include <aap_protobuf/service/media/sink/message/VideoCodecResolutionType.pb.h>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// One entry of the video_configs list sent to the phone.
+struct VideoMode
+{
+    aap_protobuf::service::media::shared::message::MediaCodecType codec = aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H264_BP;
+    aap_protobuf::service::media::sink::message::VideoCodecResolutionType resolution = aap_protobuf::service::media::sink::message::VIDEO_800x480;
+    aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate = aap_protobuf::service::media::sink::message::VIDEO_FPS_30;
+};
+
+struct DecoderCapability
+{
+    aap_protobuf::service::media::shared::message::MediaCodecType codec = aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H264_BP;
+    uint32_t maxWidth = 0;
+    uint32_t maxHeight = 0;
+    // luma samples per second the decoder keeps up with, 0 when only the size limit is known
+    uint64_t maxPixelRate = 0;
+};
+
+// What the decoders behind a video output can take, probed once per session
+// before the service discovery answer. Software decoders have no fixed limit;
+// for them the throughput measured in earlier sessions (decoded pixels per
+// second of decode time) is what decides.
+class VideoCapabilities
+{
+public:
+    void add(const DecoderCapability& capability);
+    bool hasCodec(aap_protobuf::service::media::shared::message::MediaCodecType codec) const;
+    const std::vector<DecoderCapability>& getDecoders() const;
+
+    void setMeasuredPixelRate(aap_protobuf::service::media::shared::message::MediaCodecType codec, uint64_t pixelRate);
+    uint64_t getMeasuredPixelRate(aap_protobuf::service::media::shared::message::MediaCodecType codec) const;
+
+    // an upper bound on top of the decoders, e.g. while the link is congested; 0 lifts it
+    void setPixelRateLimit(uint64_t pixelRate);
+    // sizes beyond the smallest one that covers the display only cost bandwidth; 0 lifts it
+    void setDisplaySize(uint32_t width, uint32_t height);
+    bool supports(const VideoMode& mode) const;
+
+    // Every mode up to the configured resolution and frame rate that a decoder
+    // can sustain, best first: H.265 before H.264, larger before smaller. A mode
+    // that is too much at 60 fps may still be offered at 30 fps. Falls back to
+    // H.264 at the configured settings when nothing fits.
+    std::vector<VideoMode> selectModes(aap_protobuf::service::media::sink::message::VideoCodecResolutionType maxResolution,
+                                       aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate) const;
+
+    // Throughput of earlier sessions, kept in cMeasurementFileName next to openauto.ini.
+    void loadMeasurements();
+    static void storeMeasurement(aap_protobuf::service::media::shared::message::MediaCodecType codec, uint64_t pixelRate);
+
+    static void resolutionSize(aap_protobuf::service::media::sink::message::VideoCodecResolutionType resolution, uint32_t& width, uint32_t& height);
+    static uint32_t framesPerSecond(aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate);
+    static std::string describe(const VideoMode& mode);
+
+    static const std::string cMeasurementFileName;
+
+private:
+    std::vector<DecoderCapability> decoders_;
+    std::map<aap_protobuf::service::media::shared::message::MediaCodecType, uint64_t> measuredPixelRates_;
+    uint64_t pixelRateLimit_ = 0;
+    uint32_t displayWidth_ = 0;
+    uint32_t displayHeight_ = 0;
+};
+
+}
+}
+}
+}
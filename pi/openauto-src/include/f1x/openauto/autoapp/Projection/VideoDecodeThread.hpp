@@ -0,0 +1,96 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <boost/noncopyable.hpp>
+#include <aasdk/Common/Data.hpp>
+#include <f1x/openauto/Common/SpscQueue.hpp>
+#include <f1x/openauto/autoapp/Projection/IVideoOutput.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// One media message on its way to the decoder. The buffer points into memory
+// kept alive by owner (usually the received aasdk message), nothing is copied.
+struct QueuedVideoFrame
+{
+    uint64_t timestamp = 0;
+    aasdk::common::DataConstBuffer buffer;
+    std::shared_ptr<const void> owner;
+    // when the service got it, for the latency statistics
+    std::chrono::steady_clock::time_point received;
+};
+
+// Runs IVideoOutput::write on its own thread so a slow decoder no longer holds
+// up the strand that receives the channel. push() is called from one thread
+// (the service strand) only.
+class VideoDecodeThread: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<VideoDecodeThread> Pointer;
+    typedef std::function<void()> SpaceHandler;
+
+    VideoDecodeThread(IVideoOutput::Pointer videoOutput, size_t depth);
+    ~VideoDecodeThread();
+
+    void start();
+    void stop();
+
+    // Returns false when the queue is full; frame is left untouched then and
+    // spaceHandler is called from the decode thread once a slot frees up.
+    bool push(QueuedVideoFrame&& frame);
+    void setSpaceHandler(SpaceHandler handler);
+
+    size_t getDepth() const;
+    size_t getQueuedFrameCount() const;
+    uint64_t getWrittenFrameCount() const;
+
+private:
+    void run();
+
+    IVideoOutput::Pointer videoOutput_;
+    common::SpscQueue<QueuedVideoFrame> queue_;
+    SpaceHandler spaceHandler_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::atomic<bool> running_;
+    std::atomic<bool> sleeping_;
+    std::atomic<bool> spaceWanted_;
+    std::atomic<uint64_t> writtenFrames_;
+};
+
+}
+}
+}
+}
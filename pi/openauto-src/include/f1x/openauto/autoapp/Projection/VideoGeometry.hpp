@@ -0,0 +1,57 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <QRect>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Where the picture of the phone ends up on the display. The phone draws its
+// UI into the codec size minus the margins of the video config, centered, and
+// leaves the margins black. The margins are cut off and the rest is scaled to
+// the display by the display hardware (DRM plane, OMX renderer), so neither
+// takes CPU time nor needs a re-encode.
+class VideoGeometry
+{
+public:
+    // Margins (as the size of the rect) that give the drawn area the aspect ratio
+    // of the display, so it fills the display undistorted. Multiples of 4, so
+    // that both halves start on a chroma sample. Empty for an unknown display.
+    static QRect fitMargins(uint32_t codecWidth, uint32_t codecHeight, uint32_t displayWidth, uint32_t displayHeight);
+    // Margins given for one codec size, for another one of the same orientation.
+    static QRect scaleMargins(const QRect& margins, uint32_t fromWidth, uint32_t fromHeight, uint32_t toWidth, uint32_t toHeight);
+    // The part of a frame the phone draws into.
+    static QRect contentRect(uint32_t codecWidth, uint32_t codecHeight, const QRect& margins);
+    // Where content of the given size goes on the display: all of it when the
+    // aspect ratios agree to a pixel, otherwise centered between black bars.
+    static QRect displayRect(uint32_t contentWidth, uint32_t contentHeight, uint32_t displayWidth, uint32_t displayHeight);
+};
+
+}
+}
+}
+}
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
 #include <f1x/openauto/autoapp/Projection/IVideoOutput.hpp>
 
@@ -35,13 +37,38 @@ class VideoOutput: public IVideoOutput
 public:
     VideoOutput(configuration::IConfiguration::Pointer configuration);
 
+    bool suspend() override;
+    void resume() override;
+    // H.264 up to the configured resolution
+    VideoCapabilities getCapabilities() override;
+    void setVideoMode(const VideoMode& mode) override;
+    void setMediaClock(MediaClock::Pointer clock) override;
     aap_protobuf::service::media::sink::message::VideoFrameRateType getVideoFPS() const override;
     aap_protobuf::service::media::sink::message::VideoCodecResolutionType getVideoResolution() const override;
     size_t getScreenDPI() const override;
-    QRect getVideoMargins() const override;
+    // The configured margins scaled to the mode; without any configured, the
+    // ones that fit the mode to the display.
+    QRect getVideoMargins(const VideoMode& mode) const override;
+    // the primary screen
+    QRect getDisplayGeometry() const override;
 
 protected:
+    // resume-to-first-frame measurement, started in resume() and stopped by
+    // whichever point of the pipeline first has a picture on screen again
+    void startResumeTimer();
+    // called for every picture put on screen, and for every frame skipped in front of the decoder
+    void onPictureShown();
+    void onFrameDropped();
+    VideoMode getVideoMode() const;
+
     configuration::IConfiguration::Pointer configuration_;
+    MediaClock::Pointer mediaClock_;
+
+private:
+    std::atomic<std::chrono::steady_clock::rep> resumeStart_;
+    VideoMode videoMode_;
+    // taken when created, the decode threads must not ask Qt
+    QRect displayGeometry_;
 };
 
 }
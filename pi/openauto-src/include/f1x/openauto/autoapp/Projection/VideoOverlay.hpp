@@ -0,0 +1,69 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+// Latest picture of something drawn on top of the projection (the statistics
+// overlay) for video outputs that compose it on their own plane. Written by
+// the UI, read by the presenter; a generation counter tells it whether there
+// is anything new, so an unchanged overlay costs one lock per frame.
+class VideoOverlay
+{
+public:
+    typedef std::shared_ptr<VideoOverlay> Pointer;
+
+    // premultiplied ARGB, one 32 bit word per pixel, rows packed
+    struct Image
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint32_t> pixels;
+    };
+
+    VideoOverlay();
+
+    // an empty image takes the overlay off the screen
+    void update(Image image);
+    // copies the image and returns true when it changed since generation
+    bool fetch(uint64_t& generation, Image& image) const;
+
+private:
+    mutable std::mutex mutex_;
+    Image image_;
+    uint64_t generation_;
+};
+
+}
+}
+}
+}
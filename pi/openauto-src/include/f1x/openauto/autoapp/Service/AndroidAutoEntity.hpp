@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <boost/asio.hpp>
 #include <aasdk/Transport/ITransport.hpp>
 #include <aasdk/Channel/Control/IControlServiceChannel.hpp>
@@ -27,6 +28,7 @@
 #include <f1x/openauto/autoapp/Service/IAndroidAutoEntity.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
 #include <f1x/openauto/autoapp/Service/IPinger.hpp>
+#include <f1x/openauto/autoapp/Service/RoundTripEstimator.hpp>
 #include <Transport/ITransport.hpp>
 #include <aap_protobuf/service/control/message/AudioFocusRequestType.pb.h>
 #include <aap_protobuf/service/control/message/AudioFocusStateType.pb.h>
@@ -44,15 +46,21 @@ namespace service
 class AndroidAutoEntity: public IAndroidAutoEntity, public aasdk::channel::control::IControlServiceChannelEventHandler, public std::enable_shared_from_this<AndroidAutoEntity>
 {
 public:
+    typedef std::function<void(aap_protobuf::service::control::message::AudioFocusRequestType)> AudioFocusHandler;
+
     AndroidAutoEntity(boost::asio::io_service& ioService,
                       aasdk::messenger::ICryptor::Pointer cryptor,
                       aasdk::transport::ITransport::Pointer transport,
                       aasdk::messenger::IMessenger::Pointer messenger,
                       configuration::IConfiguration::Pointer configuration,
                       ServiceList serviceList,
-                      IPinger::Pointer pinger);
+                      IPinger::Pointer pinger,
+                      RoundTripEstimator::Pointer roundTripEstimator);
     ~AndroidAutoEntity() override;
 
+    // told about each focus request before it is answered
+    void setAudioFocusHandler(AudioFocusHandler handler);
+
     void start(IAndroidAutoEntityEventHandler& eventHandler) override;
     void stop() override;
     void pause() override;
@@ -85,7 +93,9 @@ private:
     configuration::IConfiguration::Pointer configuration_;
     ServiceList serviceList_;
     IPinger::Pointer pinger_;
+    RoundTripEstimator::Pointer roundTripEstimator_;
     IAndroidAutoEntityEventHandler* eventHandler_;
+    AudioFocusHandler audioFocusHandler_;
 };
 
 }
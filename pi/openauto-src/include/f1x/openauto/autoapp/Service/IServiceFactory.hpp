@@ -20,6 +20,8 @@
 
 #include <aasdk/Messenger/IMessenger.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
+#include <f1x/openauto/autoapp/Service/RoundTripEstimator.hpp>
+#include <aap_protobuf/service/control/message/AudioFocusRequestType.pb.h>
 
 namespace f1x
 {
@@ -35,7 +37,10 @@ class IServiceFactory
 public:
     virtual ~IServiceFactory() = default;
 
-    virtual ServiceList create(aasdk::messenger::IMessenger::Pointer messenger) = 0;
+    virtual ServiceList create(aasdk::messenger::IMessenger::Pointer messenger,
+                               RoundTripEstimator::Pointer roundTripEstimator) = 0;
+    // focus the phone asked for, passed on by the entity of the running session
+    virtual void onAudioFocusRequest(aap_protobuf::service::control::message::AudioFocusRequestType type) = 0;
 };
 
 }
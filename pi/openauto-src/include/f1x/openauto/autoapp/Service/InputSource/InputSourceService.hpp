@@ -62,6 +62,9 @@ namespace f1x {
             boost::asio::io_service::strand strand_;
             aasdk::channel::inputsource::InputSourceService::Pointer channel_;
             projection::IInputDevice::Pointer inputDevice_;
+            // key bindings were accepted; the device is detached while paused
+            bool inputDeviceStarted_;
+            bool paused_;
           };
 
         }
@@ -22,6 +22,7 @@
 #include <aasdk/Channel/MediaSink/Audio/IAudioMediaSinkServiceEventHandler.hpp>
 #include <f1x/openauto/autoapp/Projection/IAudioOutput.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
+#include <f1x/openauto/autoapp/Service/MediaSink/MediaFlowController.hpp>
 
 namespace f1x {
   namespace openauto {
@@ -35,10 +36,11 @@ namespace f1x {
           public:
             typedef std::shared_ptr<AudioMediaSinkService> Pointer;
 
-            // General Constructor
+            // General Constructor; without a flow controller every frame is acked on its own with max_unacked 1
             AudioMediaSinkService(boost::asio::io_service& ioService,
                              aasdk::channel::mediasink::audio::IAudioMediaSinkService::Pointer channel,
-                             projection::IAudioOutput::Pointer audioOutput);
+                             projection::IAudioOutput::Pointer audioOutput,
+                             MediaFlowController::Pointer flowController = nullptr);
 
             void start() override;
             void stop() override;
@@ -70,6 +72,7 @@ namespace f1x {
             aasdk::channel::mediasink::audio::IAudioMediaSinkService::Pointer channel_;
             projection::IAudioOutput::Pointer audioOutput_;
             int32_t session_;
+            MediaFlowController::Pointer flowController_;
           };
         }
       }
@@ -31,7 +31,8 @@ namespace f1x {
           public:
             MediaAudioService(boost::asio::io_service &ioService,
                               aasdk::messenger::IMessenger::Pointer messenger,
-                              projection::IAudioOutput::Pointer audioOutput);
+                              projection::IAudioOutput::Pointer audioOutput,
+                              MediaFlowController::Pointer flowController = nullptr);
           };
 
         }
@@ -0,0 +1,73 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <f1x/openauto/autoapp/Service/RoundTripEstimator.hpp>
+
+namespace f1x::openauto::autoapp::service::mediasink {
+
+  // Credit based flow control of a media sink channel. The phone may have up to
+  // max_unacked frames without an ack in flight; this advertises that limit once
+  // at setup and then decides how many consumed frames to acknowledge, in
+  // batches. With adaptive set the effective window is kept between one frame
+  // and max_unacked by withholding part of the acks: it grows until it covers a
+  // ping round trip worth of frames and shrinks while the decoder backs up.
+  // Not thread safe, used on the owning service strand only.
+  class MediaFlowController {
+  public:
+    typedef std::shared_ptr<MediaFlowController> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    MediaFlowController(uint32_t maxUnacked, bool adaptive,
+                        RoundTripEstimator::Pointer roundTripEstimator = nullptr);
+
+    // value for Config.max_unacked
+    uint32_t getMaxUnacked() const;
+    uint32_t getWindow() const;
+    // smoothed ping round trip, zero without an estimator or before the first ping
+    std::chrono::microseconds getRoundTrip() const;
+
+    // new session, nothing is in flight anymore
+    void reset();
+
+    void onReceived(Clock::time_point now = Clock::now());
+
+    // A received frame has been handed to the output. backlog is the number of
+    // frames received but not decoded yet. Returns how many frames to ack now.
+    uint32_t onConsumed(size_t backlog = 0);
+
+  private:
+    void adapt(size_t backlog);
+
+    const uint32_t maxUnacked_;
+    const bool adaptive_;
+    RoundTripEstimator::Pointer roundTripEstimator_;
+
+    uint32_t window_;
+    uint32_t roundFrames_;
+    uint64_t consumed_;
+    uint64_t acked_;
+    Clock::time_point lastArrival_;
+    std::chrono::microseconds arrivalInterval_;
+  };
+
+}
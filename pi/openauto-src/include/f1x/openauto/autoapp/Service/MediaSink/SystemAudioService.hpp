@@ -30,7 +30,8 @@ namespace f1x {
           public:
             SystemAudioService(boost::asio::io_service &ioService,
                                aasdk::messenger::IMessenger::Pointer messenger,
-                               projection::IAudioOutput::Pointer audioOutput);
+                               projection::IAudioOutput::Pointer audioOutput,
+                               MediaFlowController::Pointer flowController = nullptr);
 
           protected:
             projection::IAudioOutput::Pointer audioOutput_;
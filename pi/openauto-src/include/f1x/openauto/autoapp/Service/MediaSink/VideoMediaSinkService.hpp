@@ -21,8 +21,14 @@
 #include <aasdk/Messenger/IMessenger.hpp>
 #include <aasdk/Channel/MediaSink/Video/IVideoMediaSinkService.hpp>
 #include <aasdk/Channel/MediaSink/Video/IVideoMediaSinkServiceEventHandler.hpp>
+#include <deque>
+#include <functional>
+#include <vector>
 #include <f1x/openauto/autoapp/Projection/IVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoDecodeThread.hpp>
 #include <f1x/openauto/autoapp/Service/IService.hpp>
+#include <f1x/openauto/autoapp/Service/MediaSink/MediaFlowController.hpp>
+#include <f1x/openauto/autoapp/Service/MediaSink/VideoQualityController.hpp>
 
 namespace f1x {
   namespace openauto {
@@ -36,11 +42,17 @@ namespace f1x {
               public std::enable_shared_from_this<VideoMediaSinkService> {
           public:
               typedef std::shared_ptr<VideoMediaSinkService> Pointer;
+              typedef std::function<void(const projection::VideoMode&)> VideoModeHandler;
 
-            // General Constructor
+            // General Constructor; decodeQueueDepth 0 writes to the video output on the strand,
+            // without a flow controller every frame is acked on its own with max_unacked 1;
+            // persistentDecoder keeps the video output alive but hidden between pause() and resume()
             VideoMediaSinkService(boost::asio::io_service& ioService,
                                   aasdk::channel::mediasink::video::IVideoMediaSinkService::Pointer channel,
-                                  projection::IVideoOutput::Pointer videoOutput);
+                                  projection::IVideoOutput::Pointer videoOutput,
+                                  size_t decodeQueueDepth = 0,
+                                  MediaFlowController::Pointer flowController = nullptr,
+                                  bool persistentDecoder = false);
 
             void start() override;
             void stop() override;
@@ -64,16 +76,49 @@ namespace f1x {
 
             void onMediaIndication(const aasdk::common::DataConstBuffer &buffer) override;
 
+            void onMediaWithTimestampMessage(aasdk::messenger::Timestamp::ValueType timestamp,
+                                             const aasdk::common::DataConstBuffer &buffer,
+                                             aasdk::messenger::Message::Pointer message) override;
+
+            void onMediaMessage(const aasdk::common::DataConstBuffer &buffer,
+                                aasdk::messenger::Message::Pointer message) override;
+
             void onChannelError(const aasdk::error::Error &e) override;
 
             void onVideoFocusRequest(const aap_protobuf::service::media::video::message::VideoFocusRequestNotification &request) override;
             void sendVideoFocusIndication();
+            // called with the config the phone was told to use, e.g. to map touches onto it
+            void setVideoModeHandler(VideoModeHandler handler);
+            // limits the advertised configs and is fed with the pressure on the stream
+            void setQualityController(VideoQualityController::Pointer qualityController);
           protected:
+            void sendVideoFocusNotification(aap_protobuf::service::media::video::message::VideoFocusMode focus,
+                                            bool unsolicited);
+            // acks the consumed frame once the flow controller releases it
+            void sendMediaAckIndication();
+            void onDecodeQueueSpace();
+            void sampleQuality(size_t backlog);
+
             using std::enable_shared_from_this<VideoMediaSinkService>::shared_from_this;
             boost::asio::io_service::strand strand_;
             aasdk::channel::mediasink::video::IVideoMediaSinkService::Pointer channel_;
             projection::IVideoOutput::Pointer videoOutput_;
             int32_t session_;
+            projection::VideoDecodeThread::Pointer decodeThread_;
+            // frames that did not fit into the decode queue; they are acked once they do
+            std::deque<projection::QueuedVideoFrame> overflow_;
+            MediaFlowController::Pointer flowController_;
+            bool persistentDecoder_;
+            bool suspended_;
+            bool outputStopped_;
+            aap_protobuf::service::media::video::message::VideoFocusMode videoFocus_;
+            // advertised video_configs, in the order of their indices
+            std::vector<projection::VideoMode> videoModes_;
+            VideoModeHandler videoModeHandler_;
+            VideoQualityController::Pointer qualityController_;
+            // reception times of the frames not handed to the output yet
+            std::deque<MediaFlowController::Clock::time_point> receiveTimes_;
+            std::chrono::microseconds frameInterval_;
           };
         }
       }
@@ -0,0 +1,106 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <f1x/openauto/autoapp/Projection/VideoCapabilities.hpp>
+
+namespace f1x::openauto::autoapp::service::mediasink {
+
+  // Steps the video configs offered to the phone down while the stream stays
+  // under pressure (decode backlog, ack latency or ping round trip) and back up
+  // after it has been healthy for a while. Android Auto fixes the config for
+  // the lifetime of the channel, so a decision only lowers or raises the pixel
+  // rate limit used for the next service discovery. One instance outlives the
+  // sessions; samples come from the video service strand, the limit is read
+  // when the features are filled, hence the mutex. Each decision also goes to
+  // diagnostics::VideoStatistics, which the statistics overlay shows.
+  class VideoQualityController {
+  public:
+    typedef std::shared_ptr<VideoQualityController> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    struct Sample {
+      // frames waiting in front of the decoder, in stream time
+      std::chrono::microseconds decodeLag{0};
+      // from reception until the ack of the oldest frame in an ack batch
+      std::chrono::microseconds ackLatency{0};
+      std::chrono::microseconds roundTrip{0};
+    };
+
+    enum class Action {
+      DOWNGRADE,
+      UPGRADE
+    };
+
+    struct Decision {
+      Clock::time_point time;
+      Action action = Action::DOWNGRADE;
+      // luma samples per second, 0 is unlimited
+      uint64_t previousLimit = 0;
+      uint64_t limit = 0;
+      // the mode streamed when it was taken and the smoothed samples that led to it
+      projection::VideoMode mode;
+      Sample smoothed;
+    };
+
+    VideoQualityController(std::chrono::seconds sustainPeriod = std::chrono::seconds(10),
+                           std::chrono::seconds recoveryPeriod = std::chrono::seconds(60));
+
+    // the phone streams this mode now; pressure is judged per mode
+    void onModeSelected(const projection::VideoMode &mode);
+    void onSample(const Sample &sample, Clock::time_point now = Clock::now());
+
+    // for VideoCapabilities::setPixelRateLimit
+    uint64_t getPixelRateLimit() const;
+    // the last cMaxDecisions decisions, oldest first
+    std::vector<Decision> getDecisions() const;
+
+    static std::string describe(const Decision &decision);
+
+    static constexpr size_t cMaxDecisions = 32;
+
+  private:
+    void decide(Action action, uint64_t limit, Clock::time_point now);
+
+    const std::chrono::seconds sustainPeriod_;
+    const std::chrono::seconds recoveryPeriod_;
+
+    mutable std::mutex mutex_;
+    projection::VideoMode mode_;
+    uint64_t modePixelRate_;
+    uint64_t limit_;
+    // limits in force before each downgrade, an upgrade restores the last one
+    std::vector<uint64_t> previousLimits_;
+    // one decision per mode; the next one needs a new config to judge
+    bool decided_;
+    Sample smoothed_;
+    Clock::time_point pressureSince_;
+    Clock::time_point healthySince_;
+    std::deque<Decision> decisions_;
+  };
+
+}
@@ -31,7 +31,10 @@ namespace f1x {
           public:
             VideoService(boost::asio::io_service &ioService,
                                aasdk::messenger::IMessenger::Pointer messenger,
-                               projection::IVideoOutput::Pointer videoOutput);
+                               projection::IVideoOutput::Pointer videoOutput,
+                               size_t decodeQueueDepth = 0,
+                               MediaFlowController::Pointer flowController = nullptr,
+                               bool persistentDecoder = false);
 
           protected:
             projection::IVideoOutput::Pointer videoOutput;
@@ -0,0 +1,46 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace f1x::openauto::autoapp::service {
+
+  // Smoothed round trip time of the control channel pings. Written on the
+  // entity strand, read from any media service strand.
+  class RoundTripEstimator {
+  public:
+    typedef std::shared_ptr<RoundTripEstimator> Pointer;
+    typedef std::chrono::high_resolution_clock Clock;
+
+    RoundTripEstimator();
+
+    // requestTimestamp is the microsecond timestamp sent in the ping request and echoed by the phone
+    void onPingResponse(int64_t requestTimestamp, Clock::time_point now = Clock::now());
+
+    // zero until the first response arrived
+    std::chrono::microseconds get() const;
+
+  private:
+    std::atomic<int64_t> smoothed_;
+  };
+
+}
@@ -18,8 +18,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <f1x/openauto/autoapp/Service/IServiceFactory.hpp>
 #include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
+#include <f1x/openauto/autoapp/Projection/IInputDevice.hpp>
+#include <f1x/openauto/autoapp/Projection/IVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/AudioMixer.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoOverlay.hpp>
+#include <f1x/openauto/autoapp/Service/MediaSink/VideoQualityController.hpp>
 
 namespace f1x {
   namespace openauto {
@@ -29,17 +35,35 @@ namespace f1x {
         class ServiceFactory : public IServiceFactory {
         public:
           ServiceFactory(boost::asio::io_service &ioService, configuration::IConfiguration::Pointer configuration);
-          ServiceList create(aasdk::messenger::IMessenger::Pointer messenger) override;
+          ServiceList create(aasdk::messenger::IMessenger::Pointer messenger,
+                             RoundTripEstimator::Pointer roundTripEstimator) override;
+          void onAudioFocusRequest(aap_protobuf::service::control::message::AudioFocusRequestType type) override;
+          // shown on the DRM overlay plane by video outputs that present on their own
+          void setVideoOverlay(projection::VideoOverlay::Pointer overlay);
 
         private:
           IService::Pointer createBluetoothService(aasdk::messenger::IMessenger::Pointer messenger);
           IService::Pointer createGenericNotificationService(aasdk::messenger::IMessenger::Pointer messenger);
-          IService::Pointer createInputService(aasdk::messenger::IMessenger::Pointer messenger);
+          projection::IInputDevice::Pointer createInputDevice();
+          IService::Pointer createInputService(aasdk::messenger::IMessenger::Pointer messenger,
+                                               projection::IInputDevice::Pointer inputDevice);
           IService::Pointer createMediaBrowserService(aasdk::messenger::IMessenger::Pointer messenger);
           IService::Pointer createMediaPlaybackStatusService(aasdk::messenger::IMessenger::Pointer messenger);
 
-          void createMediaSinkServices(ServiceList &serviceList, aasdk::messenger::IMessenger::Pointer messenger);
+          void createMediaSinkServices(ServiceList &serviceList, aasdk::messenger::IMessenger::Pointer messenger,
+                                       RoundTripEstimator::Pointer roundTripEstimator,
+                                       projection::IInputDevice::Pointer inputDevice);
+          // an input of the mixer when there is one, a device output of its own otherwise
+          projection::IAudioOutput::Pointer createAudioOutput(projection::AudioMixer::Channel channel,
+                                                              uint32_t channelCount, uint32_t sampleRate);
+          // an output of its own on the configured backend, pulling from renderer when one is given;
+          // channel picks the stream role where the backend has one (PipeWire never gets a renderer)
+          projection::IAudioOutput::Pointer createDeviceAudioOutput(projection::AudioMixer::Channel channel,
+                                                                    uint32_t channelCount, uint32_t sampleRate,
+                                                                    projection::IAudioRenderer *renderer);
           void createMediaSourceServices(ServiceList &serviceList, aasdk::messenger::IMessenger::Pointer messenger);
+          // the decoder of the build unless Video.OutputBackendType asks for a headless one
+          projection::IVideoOutput::Pointer createVideoOutput();
 
           IService::Pointer createNavigationStatusService(aasdk::messenger::IMessenger::Pointer messenger);
           IService::Pointer createPhoneStatusService(aasdk::messenger::IMessenger::Pointer messenger);
@@ -50,6 +74,13 @@ namespace f1x {
 
           boost::asio::io_service &ioService_;
           configuration::IConfiguration::Pointer configuration_;
+          // kept across sessions, its decisions apply to the next one
+          mediasink::VideoQualityController::Pointer videoQualityController_;
+          projection::VideoOverlay::Pointer videoOverlay_;
+          // one output stream for all audio channels, kept across sessions
+          projection::AudioMixer::Pointer audioMixer_;
+          // set from the presenting thread once a DRM presenter gave up; later sessions use Qt
+          std::atomic<bool> drmPresenterFailed_;
         };
 
       }
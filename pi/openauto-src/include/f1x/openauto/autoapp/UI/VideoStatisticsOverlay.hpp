@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QImage>
+#include <QTimer>
+#include <QWidget>
+#include <f1x/openauto/autoapp/Configuration/IConfiguration.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoOverlay.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace ui
+{
+
+// Frame rates, drops, bitrate, decode latency, round trip and CPU load of the
+// projection and the last adaptive quality decision, refreshed once a second.
+// Shown as a frameless window above the Qt video outputs and handed to the DRM
+// presenter through the VideoOverlay, which puts it on a plane of its own above
+// the hardware video. Enabled by Video.StatisticsOverlay or by touching
+// /tmp/videostatistics.
+class VideoStatisticsOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    VideoStatisticsOverlay(configuration::IConfiguration::Pointer configuration,
+                           projection::VideoOverlay::Pointer overlay, QWidget *parent = nullptr);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void refresh();
+
+private:
+    bool isRequested() const;
+    double sampleCpuLoad();
+    void render(const diagnostics::VideoStatistics::Rates& rates, double cpuLoad);
+
+    configuration::IConfiguration::Pointer configuration_;
+    projection::VideoOverlay::Pointer overlay_;
+    QTimer timer_;
+    QImage image_;
+    bool active_;
+    diagnostics::VideoStatistics::Counters previous_;
+    uint64_t previousCpuTicks_;
+};
+
+}
+}
+}
+}
@@ -191,8 +191,12 @@ namespace f1x::openauto::autoapp {
 
   void App::pause() {
     strand_.dispatch([this, self = this->shared_from_this()]() {
-      OPENAUTO_LOG(info) << "[App] pause...";
-      androidAutoEntity_->pause();
+      if (androidAutoEntity_ != nullptr) {
+        OPENAUTO_LOG(info) << "[App] pause...";
+        androidAutoEntity_->pause();
+      } else {
+        OPENAUTO_LOG(info) << "[App] Ignore pause -> no androidAutoEntity_ ...";
+      }
     });
   }
 
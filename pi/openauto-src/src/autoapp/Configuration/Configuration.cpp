@@ -16,6 +16,7 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <f1x/openauto/autoapp/Configuration/Configuration.hpp>
 #include <f1x/openauto/Common/Log.hpp>
 #include <QTouchDevice>
@@ -56,6 +57,15 @@ const std::string Configuration::cVideoScreenDPIKey = "Video.ScreenDPI";
 const std::string Configuration::cVideoOMXLayerIndexKey = "Video.OMXLayerIndex";
 const std::string Configuration::cVideoMarginWidth = "Video.MarginWidth";
 const std::string Configuration::cVideoMarginHeight = "Video.MarginHeight";
+const std::string Configuration::cVideoDecodeQueueDepthKey = "Video.DecodeQueueDepth";
+const std::string Configuration::cVideoMaxUnackedKey = "Video.MaxUnacked";
+const std::string Configuration::cVideoAdaptiveFlowControlKey = "Video.AdaptiveFlowControl";
+const std::string Configuration::cVideoPersistentDecoderKey = "Video.PersistentDecoder";
+const std::string Configuration::cVideoAdaptiveQualityKey = "Video.AdaptiveQuality";
+const std::string Configuration::cVideoStatisticsOverlayKey = "Video.StatisticsOverlay";
+const std::string Configuration::cVideoFramePacingKey = "Video.FramePacing";
+const std::string Configuration::cVideoOutputBackendTypeKey = "Video.OutputBackendType";
+const std::string Configuration::cVideoOutputFileKey = "Video.OutputFile";
 
 const std::string Configuration::cAudioChannelMediaEnabled = "AudioChannel.MediaEnabled";
 const std::string Configuration::cAudioChannelGuidanceEnabled = "AudioChannel.GuidanceEnabled";
@@ -63,6 +73,15 @@ const std::string Configuration::cAudioChannelSystemEnabled = "AudioChannel.Syst
 const std::string Configuration::cAudioChannelTelephonyEnabled = "AudioChannel.TelephonyEnabled";
 
 const std::string Configuration::cAudioOutputBackendType = "Audio.OutputBackendType";
+const std::string Configuration::cAudioMaxUnackedKey = "Audio.MaxUnacked";
+const std::string Configuration::cAudioSoftwareMixerKey = "Audio.SoftwareMixer";
+const std::string Configuration::cAudioDuckingLevelKey = "Audio.DuckingLevel";
+const std::string Configuration::cAudioAlsaDeviceKey = "Audio.AlsaDevice";
+const std::string Configuration::cAudioAlsaPeriodSizeKey = "Audio.AlsaPeriodSize";
+const std::string Configuration::cAudioAlsaBufferSizeKey = "Audio.AlsaBufferSize";
+const std::string Configuration::cAudioPipeWireQuantumKey = "Audio.PipeWireQuantum";
+
+const std::string Configuration::cDiagnosticsThreadCpuStatsIntervalKey = "Diagnostics.ThreadCpuStatsInterval";
 
 const std::string Configuration::cBluetoothAdapterTypeKey = "Bluetooth.AdapterType";
 const std::string Configuration::cBluetoothAdapterAddressKey = "Bluetooth.AdapterAddress";
@@ -130,6 +149,15 @@ void Configuration::load()
 
         omxLayerIndex_ = iniConfig.get<int32_t>(cVideoOMXLayerIndexKey, 1);
         videoMargins_ = QRect(0, 0, iniConfig.get<int32_t>(cVideoMarginWidth, 0), iniConfig.get<int32_t>(cVideoMarginHeight, 0));
+        videoDecodeQueueDepth_ = iniConfig.get<uint32_t>(cVideoDecodeQueueDepthKey, 4);
+        videoMaxUnacked_ = iniConfig.get<uint32_t>(cVideoMaxUnackedKey, 4);
+        videoAdaptiveFlowControl_ = iniConfig.get<bool>(cVideoAdaptiveFlowControlKey, true);
+        videoPersistentDecoder_ = iniConfig.get<bool>(cVideoPersistentDecoderKey, true);
+        videoAdaptiveQuality_ = iniConfig.get<bool>(cVideoAdaptiveQualityKey, true);
+        videoStatisticsOverlay_ = iniConfig.get<bool>(cVideoStatisticsOverlayKey, false);
+        videoFramePacing_ = iniConfig.get<bool>(cVideoFramePacingKey, false);
+        videoOutputBackendType_ = static_cast<VideoOutputBackendType>(iniConfig.get<uint32_t>(cVideoOutputBackendTypeKey, static_cast<uint32_t>(VideoOutputBackendType::DECODER)));
+        videoOutputFile_ = iniConfig.get<std::string>(cVideoOutputFileKey, "openauto_video.h264");
 
         enableTouchscreen_ = iniConfig.get<bool>(cInputEnableTouchscreenKey, true);
         enablePlayerControl_ = iniConfig.get<bool>(cInputEnablePlayerControlKey, false);
@@ -148,6 +176,15 @@ void Configuration::load()
         _audioChannelEnabledTelephony = iniConfig.get<bool>(cAudioChannelTelephonyEnabled, true);
 
          audioOutputBackendType_ = static_cast<AudioOutputBackendType>(iniConfig.get<uint32_t>(cAudioOutputBackendType, static_cast<uint32_t>(AudioOutputBackendType::RTAUDIO)));
+        audioMaxUnacked_ = iniConfig.get<uint32_t>(cAudioMaxUnackedKey, 2);
+        audioSoftwareMixer_ = iniConfig.get<bool>(cAudioSoftwareMixerKey, true);
+        audioDuckingLevel_ = std::min<uint32_t>(iniConfig.get<uint32_t>(cAudioDuckingLevelKey, 30), 100);
+        audioAlsaDevice_ = iniConfig.get<std::string>(cAudioAlsaDeviceKey, "default");
+        audioAlsaPeriodSize_ = iniConfig.get<uint32_t>(cAudioAlsaPeriodSizeKey, 256);
+        audioAlsaBufferSize_ = iniConfig.get<uint32_t>(cAudioAlsaBufferSizeKey, 1024);
+        audioPipeWireQuantum_ = iniConfig.get<uint32_t>(cAudioPipeWireQuantumKey, 256);
+
+        threadCpuStatsInterval_ = iniConfig.get<uint32_t>(cDiagnosticsThreadCpuStatsIntervalKey, 0);
     }
     catch(const boost::property_tree::ini_parser_error& e)
     {
@@ -183,6 +220,15 @@ void Configuration::reset()
     screenDPI_ = 140;
     omxLayerIndex_ = 1;
     videoMargins_ = QRect(0, 0, 0, 0);
+    videoDecodeQueueDepth_ = 4;
+    videoMaxUnacked_ = 4;
+    videoAdaptiveFlowControl_ = true;
+    videoPersistentDecoder_ = true;
+    videoAdaptiveQuality_ = true;
+    videoStatisticsOverlay_ = false;
+    videoFramePacing_ = false;
+    videoOutputBackendType_ = VideoOutputBackendType::DECODER;
+    videoOutputFile_ = "openauto_video.h264";
     enableTouchscreen_ = true;
     enablePlayerControl_ = false;
     buttonCodes_.clear();
@@ -195,7 +241,15 @@ void Configuration::reset()
    _audioChannelEnabledTelephony = true;
 
     audioOutputBackendType_ = AudioOutputBackendType::QT;
+    audioMaxUnacked_ = 2;
+    audioSoftwareMixer_ = true;
+    audioDuckingLevel_ = 30;
+    audioAlsaDevice_ = "default";
+    audioAlsaPeriodSize_ = 256;
+    audioAlsaBufferSize_ = 1024;
+    audioPipeWireQuantum_ = 256;
     wirelessProjectionEnabled_ = true;
+    threadCpuStatsInterval_ = 0;
 }
 
 void Configuration::save()
@@ -227,6 +281,15 @@ void Configuration::save()
     iniConfig.put<int32_t>(cVideoOMXLayerIndexKey, omxLayerIndex_);
     iniConfig.put<uint32_t>(cVideoMarginWidth, videoMargins_.width());
     iniConfig.put<uint32_t>(cVideoMarginHeight, videoMargins_.height());
+    iniConfig.put<uint32_t>(cVideoDecodeQueueDepthKey, videoDecodeQueueDepth_);
+    iniConfig.put<uint32_t>(cVideoMaxUnackedKey, videoMaxUnacked_);
+    iniConfig.put<bool>(cVideoAdaptiveFlowControlKey, videoAdaptiveFlowControl_);
+    iniConfig.put<bool>(cVideoPersistentDecoderKey, videoPersistentDecoder_);
+    iniConfig.put<bool>(cVideoAdaptiveQualityKey, videoAdaptiveQuality_);
+    iniConfig.put<bool>(cVideoStatisticsOverlayKey, videoStatisticsOverlay_);
+    iniConfig.put<bool>(cVideoFramePacingKey, videoFramePacing_);
+    iniConfig.put<uint32_t>(cVideoOutputBackendTypeKey, static_cast<uint32_t>(videoOutputBackendType_));
+    iniConfig.put<std::string>(cVideoOutputFileKey, videoOutputFile_);
 
     iniConfig.put<bool>(cInputEnableTouchscreenKey, enableTouchscreen_);
     iniConfig.put<bool>(cInputEnablePlayerControlKey, enablePlayerControl_);
@@ -242,6 +305,15 @@ void Configuration::save()
     iniConfig.put<bool>(cAudioChannelTelephonyEnabled, _audioChannelEnabledTelephony);
 
   iniConfig.put<uint32_t>(cAudioOutputBackendType, static_cast<uint32_t>(audioOutputBackendType_));
+    iniConfig.put<uint32_t>(cAudioMaxUnackedKey, audioMaxUnacked_);
+    iniConfig.put<bool>(cAudioSoftwareMixerKey, audioSoftwareMixer_);
+    iniConfig.put<uint32_t>(cAudioDuckingLevelKey, audioDuckingLevel_);
+    iniConfig.put<std::string>(cAudioAlsaDeviceKey, audioAlsaDevice_);
+    iniConfig.put<uint32_t>(cAudioAlsaPeriodSizeKey, audioAlsaPeriodSize_);
+    iniConfig.put<uint32_t>(cAudioAlsaBufferSizeKey, audioAlsaBufferSize_);
+    iniConfig.put<uint32_t>(cAudioPipeWireQuantumKey, audioPipeWireQuantum_);
+
+    iniConfig.put<uint32_t>(cDiagnosticsThreadCpuStatsIntervalKey, threadCpuStatsInterval_);
     boost::property_tree::ini_parser::write_ini(cConfigFileName, iniConfig);
 }
 
@@ -494,6 +566,96 @@ QRect Configuration::getVideoMargins() const
     return videoMargins_;
 }
 
+uint32_t Configuration::getVideoDecodeQueueDepth() const
+{
+    return videoDecodeQueueDepth_;
+}
+
+void Configuration::setVideoDecodeQueueDepth(uint32_t value)
+{
+    videoDecodeQueueDepth_ = value;
+}
+
+uint32_t Configuration::getVideoMaxUnacked() const
+{
+    return videoMaxUnacked_;
+}
+
+void Configuration::setVideoMaxUnacked(uint32_t value)
+{
+    videoMaxUnacked_ = value;
+}
+
+bool Configuration::getVideoAdaptiveFlowControl() const
+{
+    return videoAdaptiveFlowControl_;
+}
+
+void Configuration::setVideoAdaptiveFlowControl(bool value)
+{
+    videoAdaptiveFlowControl_ = value;
+}
+
+bool Configuration::getVideoPersistentDecoder() const
+{
+    return videoPersistentDecoder_;
+}
+
+void Configuration::setVideoPersistentDecoder(bool value)
+{
+    videoPersistentDecoder_ = value;
+}
+
+bool Configuration::getVideoAdaptiveQuality() const
+{
+    return videoAdaptiveQuality_;
+}
+
+void Configuration::setVideoAdaptiveQuality(bool value)
+{
+    videoAdaptiveQuality_ = value;
+}
+
+bool Configuration::getVideoStatisticsOverlay() const
+{
+    return videoStatisticsOverlay_;
+}
+
+void Configuration::setVideoStatisticsOverlay(bool value)
+{
+    videoStatisticsOverlay_ = value;
+}
+
+bool Configuration::getVideoFramePacing() const
+{
+    return videoFramePacing_;
+}
+
+void Configuration::setVideoFramePacing(bool value)
+{
+    videoFramePacing_ = value;
+}
+
+VideoOutputBackendType Configuration::getVideoOutputBackendType() const
+{
+    return videoOutputBackendType_;
+}
+
+void Configuration::setVideoOutputBackendType(VideoOutputBackendType value)
+{
+    videoOutputBackendType_ = value;
+}
+
+std::string Configuration::getVideoOutputFile() const
+{
+    return videoOutputFile_;
+}
+
+void Configuration::setVideoOutputFile(const std::string& value)
+{
+    videoOutputFile_ = value;
+}
+
 bool Configuration::getTouchscreenEnabled() const
 {
     return enableTouchscreen_;
@@ -602,6 +764,86 @@ void Configuration::setAudioOutputBackendType(AudioOutputBackendType value)
     audioOutputBackendType_ = value;
 }
 
+uint32_t Configuration::getAudioMaxUnacked() const
+{
+    return audioMaxUnacked_;
+}
+
+void Configuration::setAudioMaxUnacked(uint32_t value)
+{
+    audioMaxUnacked_ = value;
+}
+
+bool Configuration::getAudioSoftwareMixer() const
+{
+    return audioSoftwareMixer_;
+}
+
+void Configuration::setAudioSoftwareMixer(bool value)
+{
+    audioSoftwareMixer_ = value;
+}
+
+uint32_t Configuration::getAudioDuckingLevel() const
+{
+    return audioDuckingLevel_;
+}
+
+void Configuration::setAudioDuckingLevel(uint32_t value)
+{
+    audioDuckingLevel_ = std::min<uint32_t>(value, 100);
+}
+
+std::string Configuration::getAudioAlsaDevice() const
+{
+    return audioAlsaDevice_;
+}
+
+void Configuration::setAudioAlsaDevice(const std::string& value)
+{
+    audioAlsaDevice_ = value;
+}
+
+uint32_t Configuration::getAudioAlsaPeriodSize() const
+{
+    return audioAlsaPeriodSize_;
+}
+
+void Configuration::setAudioAlsaPeriodSize(uint32_t value)
+{
+    audioAlsaPeriodSize_ = value;
+}
+
+uint32_t Configuration::getAudioAlsaBufferSize() const
+{
+    return audioAlsaBufferSize_;
+}
+
+void Configuration::setAudioAlsaBufferSize(uint32_t value)
+{
+    audioAlsaBufferSize_ = value;
+}
+
+uint32_t Configuration::getAudioPipeWireQuantum() const
+{
+    return audioPipeWireQuantum_;
+}
+
+void Configuration::setAudioPipeWireQuantum(uint32_t value)
+{
+    audioPipeWireQuantum_ = value;
+}
+
+uint32_t Configuration::getThreadCpuStatsInterval() const
+{
+    return threadCpuStatsInterval_;
+}
+
+void Configuration::setThreadCpuStatsInterval(uint32_t value)
+{
+    threadCpuStatsInterval_ = value;
+}
+
 QString Configuration::getCSValue(QString searchString) const
 {
     using namespace std;
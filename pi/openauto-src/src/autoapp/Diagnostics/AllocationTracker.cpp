@@ -0,0 +1,341 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <f1x/openauto/autoapp/Diagnostics/AllocationTracker.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+#ifdef OPENAUTO_ALLOCATION_TRACKING
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+namespace
+{
+
+constexpr size_t cSiteTableSize = 4096;
+constexpr size_t cSiteProbeLimit = 64;
+constexpr uint64_t cReportFrameInterval = 1800;
+
+struct SiteSlot
+{
+    std::atomic<uintptr_t> address;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> bytes;
+};
+
+// Zero initialised static storage; nothing in here may allocate.
+SiteSlot siteTable[cSiteTableSize];
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<uint64_t> untrackedSites{0};
+std::atomic<uint64_t> frameCount{0};
+std::atomic<uint64_t> steadyStateAllocations{0};
+std::atomic<uint64_t> steadyStateFrames{0};
+
+thread_local bool insideTracker = false;
+
+void recordAllocation(const void* site, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    const auto address = reinterpret_cast<uintptr_t>(site);
+    auto index = static_cast<size_t>((address >> 2) * 0x9E3779B97F4A7C15ULL) & (cSiteTableSize - 1);
+
+    for(size_t probe = 0; probe < cSiteProbeLimit; ++probe, index = (index + 1) & (cSiteTableSize - 1))
+    {
+        auto& slot = siteTable[index];
+        auto current = slot.address.load(std::memory_order_acquire);
+
+        if(current == 0 && slot.address.compare_exchange_strong(current, address, std::memory_order_acq_rel))
+        {
+            current = address;
+        }
+
+        if(current == address)
+        {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            slot.bytes.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    untrackedSites.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* trackedAllocate(size_t size, const void* site)
+{
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if(memory != nullptr && !insideTracker)
+    {
+        insideTracker = true;
+        recordAllocation(site, size);
+        insideTracker = false;
+    }
+
+    return memory;
+}
+
+void* trackedAlignedAllocate(size_t size, std::align_val_t alignment, const void* site)
+{
+    void* memory = nullptr;
+    const auto align = std::max<size_t>(static_cast<size_t>(alignment), sizeof(void*));
+    if(posix_memalign(&memory, align, size == 0 ? 1 : size) != 0)
+    {
+        return nullptr;
+    }
+
+    if(!insideTracker)
+    {
+        insideTracker = true;
+        recordAllocation(site, size);
+        insideTracker = false;
+    }
+
+    return memory;
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+    if(auto* memory = trackedAllocate(size, __builtin_return_address(0)))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if(auto* memory = trackedAllocate(size, __builtin_return_address(0)))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, __builtin_return_address(0));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, __builtin_return_address(0));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if(auto* memory = trackedAlignedAllocate(size, alignment, __builtin_return_address(0)))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if(auto* memory = trackedAlignedAllocate(size, alignment, __builtin_return_address(0)))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+#endif
+
+namespace f1x::openauto::autoapp::diagnostics {
+
+#ifdef OPENAUTO_ALLOCATION_TRACKING
+
+  bool AllocationTracker::isEnabled() {
+    return true;
+  }
+
+  uint64_t AllocationTracker::getAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+  }
+
+  uint64_t AllocationTracker::getAllocatedBytes() {
+    return allocatedBytes.load(std::memory_order_relaxed);
+  }
+
+  void AllocationTracker::markFrame() {
+    const auto frames = frameCount.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if(frames % cReportFrameInterval == 0) {
+      logReport(10);
+    }
+  }
+
+  uint64_t AllocationTracker::getFrameCount() {
+    return frameCount.load(std::memory_order_relaxed);
+  }
+
+  void AllocationTracker::beginSteadyState() {
+    steadyStateAllocations = allocationCount.load(std::memory_order_relaxed);
+    steadyStateFrames = frameCount.load(std::memory_order_relaxed);
+  }
+
+  double AllocationTracker::getAllocationsPerFrame() {
+    const auto frames = frameCount.load(std::memory_order_relaxed) - steadyStateFrames.load();
+    if(frames == 0) {
+      return 0.0;
+    }
+
+    const auto allocations = allocationCount.load(std::memory_order_relaxed) - steadyStateAllocations.load();
+    return static_cast<double>(allocations) / static_cast<double>(frames);
+  }
+
+  std::vector<AllocationSite> AllocationTracker::getTopSites(size_t limit) {
+    std::vector<AllocationSite> sites;
+    sites.reserve(cSiteTableSize);
+
+    for(const auto& slot : siteTable) {
+      const auto address = slot.address.load(std::memory_order_acquire);
+      if(address != 0) {
+        sites.push_back({reinterpret_cast<const void*>(address),
+                         slot.count.load(std::memory_order_relaxed),
+                         slot.bytes.load(std::memory_order_relaxed)});
+      }
+    }
+
+    const auto count = std::min(limit, sites.size());
+    std::partial_sort(sites.begin(), sites.begin() + count, sites.end(),
+                      [](const auto& lhs, const auto& rhs) { return lhs.count > rhs.count; });
+    sites.resize(count);
+    return sites;
+  }
+
+  std::string AllocationTracker::describeSite(const void* address) {
+    std::ostringstream description;
+    Dl_info info{};
+
+    if(dladdr(address, &info) != 0 && info.dli_sname != nullptr) {
+      int status = 0;
+      char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+      description << (status == 0 && demangled != nullptr ? demangled : info.dli_sname)
+                  << "+0x" << std::hex << (reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_saddr));
+      std::free(demangled);
+    } else {
+      description << address;
+    }
+
+    if(info.dli_fname != nullptr) {
+      description << " (" << info.dli_fname << ")";
+    }
+
+    return description.str();
+  }
+
+  void AllocationTracker::logReport(size_t limit) {
+    // keep the report's own string building out of the statistics
+    const bool wasInsideTracker = insideTracker;
+    insideTracker = true;
+
+    OPENAUTO_LOG(info) << "[AllocationTracker] allocations: " << getAllocationCount()
+                       << ", bytes: " << getAllocatedBytes()
+                       << ", frames: " << getFrameCount()
+                       << ", per frame (steady state): " << getAllocationsPerFrame()
+                       << ", untracked: " << untrackedSites.load();
+
+    for(const auto& site : getTopSites(limit)) {
+      OPENAUTO_LOG(info) << "[AllocationTracker]   " << site.count << " allocs, " << site.bytes << " bytes @ "
+                         << describeSite(site.address);
+    }
+
+    insideTracker = wasInsideTracker;
+  }
+
+  void AllocationTracker::reset() {
+    for(auto& slot : siteTable) {
+      slot.count = 0;
+      slot.bytes = 0;
+    }
+
+    allocationCount = 0;
+    allocatedBytes = 0;
+    untrackedSites = 0;
+    frameCount = 0;
+    steadyStateAllocations = 0;
+    steadyStateFrames = 0;
+  }
+
+#else
+
+  bool AllocationTracker::isEnabled() {
+    return false;
+  }
+
+  uint64_t AllocationTracker::getAllocationCount() {
+    return 0;
+  }
+
+  uint64_t AllocationTracker::getAllocatedBytes() {
+    return 0;
+  }
+
+  void AllocationTracker::markFrame() {
+  }
+
+  uint64_t AllocationTracker::getFrameCount() {
+    return 0;
+  }
+
+  void AllocationTracker::beginSteadyState() {
+  }
+
+  double AllocationTracker::getAllocationsPerFrame() {
+    return 0.0;
+  }
+
+  std::vector<AllocationSite> AllocationTracker::getTopSites(size_t) {
+    return {};
+  }
+
+  std::string AllocationTracker::describeSite(const void*) {
+    return {};
+  }
+
+  void AllocationTracker::logReport(size_t) {
+    OPENAUTO_LOG(info) << "[AllocationTracker] not compiled in, configure with -DALLOC_TRACKING=ON.";
+  }
+
+  void AllocationTracker::reset() {
+  }
+
+#endif
+
+}
@@ -0,0 +1,222 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <f1x/openauto/autoapp/Diagnostics/ThreadCpuMonitor.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x::openauto::autoapp::diagnostics {
+
+  namespace {
+    // pthread_setname_np rejects anything longer than 16 bytes including the terminator
+    constexpr size_t cMaxThreadNameLength = 15;
+
+    bool readTaskStat(int32_t tid, ThreadCpuSample& sample) {
+      std::ifstream stat("/proc/self/task/" + std::to_string(tid) + "/stat");
+      std::string line;
+      if (!std::getline(stat, line)) {
+        return false;
+      }
+
+      // "tid (comm) state ppid ..." - comm may contain spaces and parentheses
+      const auto open = line.find('(');
+      const auto close = line.rfind(')');
+      if (open == std::string::npos || close == std::string::npos || close < open) {
+        return false;
+      }
+
+      std::istringstream fields(line.substr(close + 2));
+      std::string field;
+      uint64_t utime = 0;
+      uint64_t stime = 0;
+
+      // fields(0) is the state (3rd column of the stat file), utime and stime are columns 14 and 15
+      for (int index = 0; index <= 12 && fields >> field; ++index) {
+        if (index == 11) {
+          utime = std::stoull(field);
+        } else if (index == 12) {
+          stime = std::stoull(field);
+        }
+      }
+
+      sample.tid = tid;
+      sample.name = line.substr(open + 1, close - open - 1);
+      sample.cpuTicks = utime + stime;
+      return true;
+    }
+
+    std::string groupName(const std::string& name) {
+      const auto dash = name.find_last_of('-');
+      if (dash == std::string::npos || dash + 1 == name.size()) {
+        return name;
+      }
+
+      const bool numbered = std::all_of(name.begin() + dash + 1, name.end(),
+                                        [](unsigned char c) { return std::isdigit(c); });
+      return numbered ? name.substr(0, dash) : name;
+    }
+  }
+
+  void setCurrentThreadName(const std::string& name) {
+    const auto truncated = name.substr(0, cMaxThreadNameLength);
+    if (pthread_setname_np(pthread_self(), truncated.c_str()) != 0) {
+      OPENAUTO_LOG(warning) << "[ThreadCpuMonitor] unable to name thread " << truncated;
+    }
+  }
+
+  ThreadCpuMonitor::ThreadCpuMonitor(boost::asio::io_service& ioService, std::chrono::seconds interval)
+      : strand_(ioService)
+      , timer_(ioService)
+      , interval_(interval)
+      , running_(false) {
+  }
+
+  void ThreadCpuMonitor::start() {
+    strand_.dispatch([this, self = this->shared_from_this()]() {
+      if (running_ || interval_.count() <= 0) {
+        return;
+      }
+
+      OPENAUTO_LOG(info) << "[ThreadCpuMonitor] sampling thread CPU time every " << interval_.count() << "s";
+      running_ = true;
+      previousTicks_.clear();
+      for (const auto& sample : ThreadCpuMonitor::sample()) {
+        previousTicks_[sample.tid] = sample.cpuTicks;
+      }
+      previousTime_ = std::chrono::steady_clock::now();
+      this->scheduleSample();
+    });
+  }
+
+  void ThreadCpuMonitor::stop() {
+    strand_.dispatch([this, self = this->shared_from_this()]() {
+      running_ = false;
+      timer_.cancel();
+    });
+  }
+
+  std::vector<ThreadCpuSample> ThreadCpuMonitor::sample() {
+    std::vector<ThreadCpuSample> samples;
+    const auto pid = static_cast<int32_t>(getpid());
+
+    DIR* tasks = opendir("/proc/self/task");
+    if (tasks == nullptr) {
+      return samples;
+    }
+
+    while (auto* entry = readdir(tasks)) {
+      if (!std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) {
+        continue;
+      }
+
+      ThreadCpuSample sample{};
+      if (readTaskStat(std::stoi(entry->d_name), sample)) {
+        // the main thread keeps the process name; it runs the Qt event loop
+        if (sample.tid == pid) {
+          sample.name = "qt-gui";
+        }
+        samples.push_back(std::move(sample));
+      }
+    }
+
+    closedir(tasks);
+    return samples;
+  }
+
+  std::vector<ThreadCpuUsage> ThreadCpuMonitor::groupByName(const std::vector<ThreadCpuUsage>& usage) {
+    std::map<std::string, double> groups;
+    for (const auto& thread : usage) {
+      groups[groupName(thread.name)] += thread.percent;
+    }
+
+    std::vector<ThreadCpuUsage> result;
+    for (const auto& group : groups) {
+      result.push_back({group.first, group.second});
+    }
+
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) { return lhs.percent > rhs.percent; });
+    return result;
+  }
+
+  void ThreadCpuMonitor::scheduleSample() {
+    timer_.expires_after(interval_);
+    timer_.async_wait(strand_.wrap([this, self = this->shared_from_this()](const boost::system::error_code& error) {
+      this->onTimer(error);
+    }));
+  }
+
+  void ThreadCpuMonitor::onTimer(const boost::system::error_code& error) {
+    if (error == boost::asio::error::operation_aborted || !running_) {
+      return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto samples = ThreadCpuMonitor::sample();
+    this->report(samples, now - previousTime_);
+
+    previousTicks_.clear();
+    for (const auto& sample : samples) {
+      previousTicks_[sample.tid] = sample.cpuTicks;
+    }
+    previousTime_ = now;
+
+    this->scheduleSample();
+  }
+
+  void ThreadCpuMonitor::report(const std::vector<ThreadCpuSample>& samples, std::chrono::steady_clock::duration elapsed) {
+    static const double ticksPerSecond = static_cast<double>(sysconf(_SC_CLK_TCK));
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    if (seconds <= 0.0) {
+      return;
+    }
+
+    std::vector<ThreadCpuUsage> usage;
+    double total = 0.0;
+
+    for (const auto& sample : samples) {
+      // threads born since the last sample are accounted from the next one on
+      const auto previous = previousTicks_.find(sample.tid);
+      if (previous == previousTicks_.end() || sample.cpuTicks < previous->second) {
+        continue;
+      }
+
+      const double percent = (sample.cpuTicks - previous->second) / ticksPerSecond / seconds * 100.0;
+      usage.push_back({sample.name, percent});
+      total += percent;
+
+      OPENAUTO_LOG(debug) << "[ThreadCpuMonitor] " << sample.tid << " " << sample.name << ": "
+                          << std::fixed << std::setprecision(1) << percent << "%";
+    }
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "total " << total << "%";
+    for (const auto& group : groupByName(usage)) {
+      line << ", " << group.name << " " << group.percent << "%";
+    }
+
+    OPENAUTO_LOG(info) << "[ThreadCpuMonitor] " << line.str();
+  }
+
+}
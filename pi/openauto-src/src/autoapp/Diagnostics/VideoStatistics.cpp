@@ -0,0 +1,154 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace diagnostics
+{
+
+namespace
+{
+
+std::atomic<uint64_t> receivedFrames{0};
+std::atomic<uint64_t> receivedBytes{0};
+std::atomic<uint64_t> decodedFrames{0};
+std::atomic<uint64_t> decodeLatency{0};
+std::atomic<uint64_t> maxDecodeLatency{0};
+std::atomic<uint64_t> shownFrames{0};
+std::atomic<uint64_t> droppedFrames{0};
+std::atomic<int64_t> roundTrip{0};
+std::atomic<uint64_t> qualityDecisions{0};
+std::atomic<bool> lastQualityDowngrade{false};
+std::atomic<uint64_t> pixelRateLimit{0};
+
+}
+
+void VideoStatistics::onFrameReceived(size_t bytes)
+{
+    receivedFrames.fetch_add(1, std::memory_order_relaxed);
+    receivedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void VideoStatistics::onFrameDecoded(std::chrono::microseconds latency)
+{
+    const auto value = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+    decodedFrames.fetch_add(1, std::memory_order_relaxed);
+    decodeLatency.fetch_add(value, std::memory_order_relaxed);
+
+    auto current = maxDecodeLatency.load(std::memory_order_relaxed);
+    while(value > current && !maxDecodeLatency.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+void VideoStatistics::onFrameShown()
+{
+    shownFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void VideoStatistics::onFrameDropped()
+{
+    droppedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void VideoStatistics::setRoundTrip(std::chrono::microseconds value)
+{
+    roundTrip.store(value.count(), std::memory_order_relaxed);
+}
+
+void VideoStatistics::onQualityDecision(bool downgrade, uint64_t limit)
+{
+    lastQualityDowngrade.store(downgrade, std::memory_order_relaxed);
+    pixelRateLimit.store(limit, std::memory_order_relaxed);
+    qualityDecisions.fetch_add(1, std::memory_order_relaxed);
+}
+
+VideoStatistics::Counters VideoStatistics::sample(Clock::time_point now)
+{
+    Counters counters;
+    counters.time = now;
+    counters.receivedFrames = receivedFrames.load(std::memory_order_relaxed);
+    counters.receivedBytes = receivedBytes.load(std::memory_order_relaxed);
+    counters.decodedFrames = decodedFrames.load(std::memory_order_relaxed);
+    counters.decodeLatencyMicroseconds = decodeLatency.load(std::memory_order_relaxed);
+    counters.maxDecodeLatencyMicroseconds = maxDecodeLatency.exchange(0, std::memory_order_relaxed);
+    counters.shownFrames = shownFrames.load(std::memory_order_relaxed);
+    counters.droppedFrames = droppedFrames.load(std::memory_order_relaxed);
+    counters.roundTripMicroseconds = roundTrip.load(std::memory_order_relaxed);
+    counters.qualityDecisions = qualityDecisions.load(std::memory_order_relaxed);
+    counters.lastQualityDowngrade = lastQualityDowngrade.load(std::memory_order_relaxed);
+    counters.pixelRateLimit = pixelRateLimit.load(std::memory_order_relaxed);
+    return counters;
+}
+
+VideoStatistics::Rates VideoStatistics::rates(const Counters& previous, const Counters& current)
+{
+    Rates rates;
+    rates.roundTripMs = current.roundTripMicroseconds / 1000.0;
+    rates.maxDecodeLatencyMs = current.maxDecodeLatencyMicroseconds / 1000.0;
+    rates.qualityDecisions = current.qualityDecisions;
+    rates.lastQualityDowngrade = current.lastQualityDowngrade;
+    rates.pixelRateLimitMpx = current.pixelRateLimit / 1000000.0;
+
+    const double seconds = std::chrono::duration<double>(current.time - previous.time).count();
+    if(seconds <= 0.0)
+    {
+        return rates;
+    }
+
+    rates.receivedFps = (current.receivedFrames - previous.receivedFrames) / seconds;
+    rates.shownFps = (current.shownFrames - previous.shownFrames) / seconds;
+    rates.droppedFrames = current.droppedFrames - previous.droppedFrames;
+    rates.bitrateKbps = (current.receivedBytes - previous.receivedBytes) * 8 / seconds / 1000.0;
+
+    const auto decoded = current.decodedFrames - previous.decodedFrames;
+    rates.decodedFps = decoded / seconds;
+    if(decoded > 0)
+    {
+        rates.decodeLatencyMs = (current.decodeLatencyMicroseconds - previous.decodeLatencyMicroseconds) / 1000.0 / decoded;
+    }
+
+    return rates;
+}
+
+void VideoStatistics::reset()
+{
+    receivedFrames = 0;
+    receivedBytes = 0;
+    decodedFrames = 0;
+    decodeLatency = 0;
+    maxDecodeLatency = 0;
+    shownFrames = 0;
+    droppedFrames = 0;
+    roundTrip = 0;
+    qualityDecisions = 0;
+    lastQualityDowngrade = false;
+    pixelRateLimit = 0;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,417 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_ALSA
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <alsa/asoundlib.h>
+#include <f1x/openauto/autoapp/Projection/AlsaAudioOutput.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// below the priority of the USB and sound interrupt threads
+constexpr int cRealtimePriority = 70;
+constexpr int cWaitTimeout = 100;
+
+}
+
+AlsaAudioOutput::AlsaAudioOutput(std::string device, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate,
+                                 uint32_t periodSize, uint32_t bufferSize, std::chrono::milliseconds latencyBound)
+    : device_(std::move(device))
+    , channelCount_(channelCount)
+    , sampleSize_(sampleSize)
+    , sampleRate_(sampleRate)
+    , bytesPerFrame_((sampleSize / 8) * channelCount)
+    , periodSize_(periodSize)
+    , bufferSize_(bufferSize)
+    , audioBuffer_(sampleRate * latencyBound.count() / 1000 * bytesPerFrame_, bytesPerFrame_)
+    , renderer_(nullptr)
+    , pcm_(nullptr)
+    , mmap_(false)
+    , running_(false)
+    , writtenFrames_(0)
+    , xruns_(0)
+    , fillMonitor_("alsa-" + std::to_string(sampleRate / 1000) + "k", bytesPerFrame_)
+{
+}
+
+AlsaAudioOutput::AlsaAudioOutput(IAudioRenderer& renderer, std::string device, uint32_t channelCount, uint32_t sampleSize,
+                                 uint32_t sampleRate, uint32_t periodSize, uint32_t bufferSize)
+    : AlsaAudioOutput(std::move(device), channelCount, sampleSize, sampleRate, periodSize, bufferSize,
+                      std::chrono::milliseconds(0))
+{
+    renderer_ = &renderer;
+}
+
+AlsaAudioOutput::~AlsaAudioOutput()
+{
+    this->stop();
+}
+
+bool AlsaAudioOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return this->openDevice();
+}
+
+bool AlsaAudioOutput::openDevice()
+{
+    if(pcm_ != nullptr)
+    {
+        return true;
+    }
+
+    if(sampleSize_ != 16)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] unsupported sample size: " << sampleSize_;
+        return false;
+    }
+
+    const auto result = snd_pcm_open(&pcm_, device_.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+    if(result < 0)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] cannot open " << device_ << ": " << snd_strerror(result);
+        pcm_ = nullptr;
+        return false;
+    }
+
+    if(!this->configure())
+    {
+        snd_pcm_close(pcm_);
+        pcm_ = nullptr;
+        return false;
+    }
+
+    if(renderer_ != nullptr)
+    {
+        // the feeder keeps the device buffer full
+        renderer_->setOutputLatency(std::chrono::microseconds(uint64_t(bufferSize_) * 1000000 / sampleRate_));
+    }
+
+    // the feeder is not running yet, so this side may act as the consumer
+    audioBuffer_.clear();
+    fillMonitor_.restart();
+    return true;
+}
+
+bool AlsaAudioOutput::configure()
+{
+    auto check = [this](int result, const char* what) {
+        if(result < 0)
+        {
+            OPENAUTO_LOG(error) << "[AlsaAudioOutput] " << device_ << ": " << what << " failed: " << snd_strerror(result);
+        }
+        return result >= 0;
+    };
+
+    snd_pcm_hw_params_t* hwParams = nullptr;
+    snd_pcm_hw_params_alloca(&hwParams);
+    if(!check(snd_pcm_hw_params_any(pcm_, hwParams), "hw_params_any"))
+    {
+        return false;
+    }
+
+    // plugins like dmix or plug may not offer mmap access, copy into them then
+    mmap_ = snd_pcm_hw_params_set_access(pcm_, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+    if(!mmap_ && !check(snd_pcm_hw_params_set_access(pcm_, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED), "set_access"))
+    {
+        return false;
+    }
+
+    unsigned int rate = sampleRate_;
+    snd_pcm_uframes_t periodSize = periodSize_;
+    snd_pcm_uframes_t bufferSize = std::max(bufferSize_, periodSize_ * 2);
+    if(!check(snd_pcm_hw_params_set_format(pcm_, hwParams, SND_PCM_FORMAT_S16_LE), "set_format")
+       || !check(snd_pcm_hw_params_set_channels(pcm_, hwParams, channelCount_), "set_channels")
+       || !check(snd_pcm_hw_params_set_rate_resample(pcm_, hwParams, 1), "set_rate_resample")
+       || !check(snd_pcm_hw_params_set_rate_near(pcm_, hwParams, &rate, nullptr), "set_rate")
+       || !check(snd_pcm_hw_params_set_period_size_near(pcm_, hwParams, &periodSize, nullptr), "set_period_size")
+       || !check(snd_pcm_hw_params_set_buffer_size_near(pcm_, hwParams, &bufferSize), "set_buffer_size")
+       || !check(snd_pcm_hw_params(pcm_, hwParams), "hw_params"))
+    {
+        return false;
+    }
+
+    if(rate != sampleRate_)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] " << device_ << " cannot play " << sampleRate_ << " Hz, offers " << rate;
+        return false;
+    }
+
+    snd_pcm_hw_params_get_period_size(hwParams, &periodSize, nullptr);
+    snd_pcm_hw_params_get_buffer_size(hwParams, &bufferSize);
+    periodSize_ = static_cast<uint32_t>(periodSize);
+    bufferSize_ = static_cast<uint32_t>(bufferSize);
+
+    // playback begins with the first period, the feeder tops the buffer up right after
+    snd_pcm_sw_params_t* swParams = nullptr;
+    snd_pcm_sw_params_alloca(&swParams);
+    if(!check(snd_pcm_sw_params_current(pcm_, swParams), "sw_params_current")
+       || !check(snd_pcm_sw_params_set_start_threshold(pcm_, swParams, periodSize), "set_start_threshold")
+       || !check(snd_pcm_sw_params_set_avail_min(pcm_, swParams, periodSize), "set_avail_min")
+       || !check(snd_pcm_sw_params(pcm_, swParams), "sw_params"))
+    {
+        return false;
+    }
+
+    period_.assign(mmap_ ? 0 : periodSize_ * bytesPerFrame_, 0);
+
+    OPENAUTO_LOG(info) << "[AlsaAudioOutput] " << device_ << ": " << sampleRate_ << " Hz, " << channelCount_
+                       << " channels, period: " << periodSize_ << " frames, buffer: " << bufferSize_
+                       << " frames, access: " << (mmap_ ? "mmap" : "rw");
+    return true;
+}
+
+void AlsaAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    audioBuffer_.write(buffer.cdata, buffer.size);
+}
+
+void AlsaAudioOutput::start()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(thread_.joinable() && !running_)
+    {
+        // the feeder gave up on a lost device, open it afresh
+        thread_.join();
+        this->close();
+        this->openDevice();
+    }
+
+    if(pcm_ != nullptr && !running_)
+    {
+        writtenFrames_ = 0;
+        xruns_ = 0;
+        fillMonitor_.resetCounters();
+        running_ = true;
+        thread_ = std::thread(&AlsaAudioOutput::run, this);
+    }
+}
+
+void AlsaAudioOutput::stop()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    running_ = false;
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    if(pcm_ != nullptr)
+    {
+        this->close();
+
+        const auto statistics = audioBuffer_.getStatistics();
+        OPENAUTO_LOG(info) << "[AlsaAudioOutput] written: " << writtenFrames_.load() << " frames, xruns: "
+                           << xruns_.load() << ", buffer peak: " << statistics.peakFill << " bytes, dropped: "
+                           << statistics.droppedBytes << ", underruns: " << fillMonitor_.getUnderruns() << " ("
+                           << fillMonitor_.getSilentFrames() * 1000 / sampleRate_ << " ms of silence)";
+    }
+}
+
+void AlsaAudioOutput::suspend()
+{
+    // the feeder keeps the device going with silence
+}
+
+uint32_t AlsaAudioOutput::getSampleSize() const
+{
+    return sampleSize_;
+}
+
+uint32_t AlsaAudioOutput::getChannelCount() const
+{
+    return channelCount_;
+}
+
+uint32_t AlsaAudioOutput::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+AlsaAudioOutput::Statistics AlsaAudioOutput::getStatistics() const
+{
+    Statistics statistics;
+    statistics.writtenFrames = writtenFrames_;
+    statistics.xruns = xruns_;
+    statistics.underruns = fillMonitor_.getUnderruns();
+    statistics.silentFrames = fillMonitor_.getSilentFrames();
+    statistics.periodSize = periodSize_;
+    statistics.bufferSize = bufferSize_;
+    statistics.mmap = mmap_;
+    return statistics;
+}
+
+void AlsaAudioOutput::close()
+{
+    snd_pcm_drop(pcm_);
+    snd_pcm_close(pcm_);
+    pcm_ = nullptr;
+}
+
+void AlsaAudioOutput::run()
+{
+    fillMonitor_.enter();
+
+    sched_param parameters{};
+    parameters.sched_priority = cRealtimePriority;
+    const auto result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+    if(result != 0)
+    {
+        OPENAUTO_LOG(warning) << "[AlsaAudioOutput] no realtime priority for the feeder: " << std::strerror(result);
+    }
+
+    while(running_)
+    {
+        const auto available = snd_pcm_avail_update(pcm_);
+        if(available < 0)
+        {
+            if(!this->recover(available))
+            {
+                break;
+            }
+            continue;
+        }
+
+        if(static_cast<snd_pcm_uframes_t>(available) < periodSize_)
+        {
+            // full; a stream that never reached its start threshold is kicked off by hand
+            const long error = snd_pcm_state(pcm_) == SND_PCM_STATE_PREPARED ? snd_pcm_start(pcm_) : snd_pcm_wait(pcm_, cWaitTimeout);
+            if(error < 0 && !this->recover(error))
+            {
+                break;
+            }
+            continue;
+        }
+
+        const auto error = this->writePeriod();
+        if(error < 0 && !this->recover(error))
+        {
+            break;
+        }
+    }
+
+    // lets the next start() reopen the device after it was lost
+    running_ = false;
+}
+
+long AlsaAudioOutput::writePeriod()
+{
+    if(!mmap_)
+    {
+        this->fill(period_.data(), periodSize_);
+
+        // a signal may cut the write short, the rest follows right away
+        const uint8_t* data = period_.data();
+        snd_pcm_uframes_t remaining = periodSize_;
+        while(remaining > 0)
+        {
+            const auto written = snd_pcm_writei(pcm_, data, remaining);
+            if(written < 0)
+            {
+                return written;
+            }
+
+            writtenFrames_.fetch_add(written, std::memory_order_relaxed);
+            data += written * bytesPerFrame_;
+            remaining -= written;
+        }
+
+        return 0;
+    }
+
+    // the mapped area may wrap around, that takes two rounds
+    snd_pcm_uframes_t remaining = periodSize_;
+    while(remaining > 0)
+    {
+        const snd_pcm_channel_area_t* areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t frames = remaining;
+        const auto result = snd_pcm_mmap_begin(pcm_, &areas, &offset, &frames);
+        if(result < 0)
+        {
+            return result;
+        }
+
+        // interleaved: every channel shares the first area
+        auto target = static_cast<uint8_t*>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+        this->fill(target, frames);
+
+        const auto committed = snd_pcm_mmap_commit(pcm_, offset, frames);
+        if(committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != frames)
+        {
+            return committed < 0 ? committed : -EPIPE;
+        }
+
+        writtenFrames_.fetch_add(frames, std::memory_order_relaxed);
+        remaining -= frames;
+    }
+
+    return 0;
+}
+
+void AlsaAudioOutput::fill(uint8_t* target, size_t frames)
+{
+    const size_t size = frames * bytesPerFrame_;
+    const auto count = renderer_ != nullptr
+                       ? renderer_->render(target, frames) * bytesPerFrame_
+                       : audioBuffer_.read(target, size);
+    fillMonitor_.fill(target, count, size);
+}
+
+bool AlsaAudioOutput::recover(long error)
+{
+    if(error == -EPIPE || error == -ESTRPIPE)
+    {
+        xruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // prepares the stream again after an XRUN and resumes it after a suspend
+    const auto result = snd_pcm_recover(pcm_, static_cast<int>(error), 1);
+    if(result < 0)
+    {
+        OPENAUTO_LOG(error) << "[AlsaAudioOutput] " << device_ << " lost: " << snd_strerror(result);
+        return false;
+    }
+
+    return true;
+}
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,91 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstring>
+#include <f1x/openauto/autoapp/Projection/AudioFillMonitor.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/ThreadCpuMonitor.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+AudioFillMonitor::AudioFillMonitor(std::string threadName, uint32_t bytesPerFrame)
+    : threadName_(std::move(threadName))
+    , bytesPerFrame_(bytesPerFrame)
+    , underruns_(0)
+    , silentFrames_(0)
+    , starving_(true)
+{
+}
+
+void AudioFillMonitor::enter()
+{
+    thread_local bool threadNamed = false;
+    if(!threadNamed)
+    {
+        diagnostics::setCurrentThreadName(threadName_);
+        threadNamed = true;
+    }
+}
+
+void AudioFillMonitor::fill(void* target, size_t count, size_t size)
+{
+    if(count < size)
+    {
+        std::memset(static_cast<uint8_t*>(target) + count, 0, size - count);
+
+        if(count > 0 || !starving_)
+        {
+            underruns_.fetch_add(1, std::memory_order_relaxed);
+            silentFrames_.fetch_add((size - count) / bytesPerFrame_, std::memory_order_relaxed);
+        }
+    }
+    starving_ = count < size;
+}
+
+void AudioFillMonitor::restart()
+{
+    starving_ = true;
+}
+
+void AudioFillMonitor::resetCounters()
+{
+    underruns_ = 0;
+    silentFrames_ = 0;
+}
+
+uint64_t AudioFillMonitor::getUnderruns() const
+{
+    return underruns_;
+}
+
+uint64_t AudioFillMonitor::getSilentFrames() const
+{
+    return silentFrames_;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,221 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// a longer silence is a pause of the stream, not a late message
+constexpr int64_t cIdleGap = 1000000;
+// the earliest arrival may move later by 1000 ppm, more than any phone clock drifts
+constexpr int64_t cFloorCreep = 1000;
+// a late message keeps the target up, forgotten at 2 ms per second
+constexpr int64_t cPeakDecay = 500;
+// RFC 3550 smoothing of the jitter
+constexpr int64_t cJitterSmoothing = 16;
+// what is repeated to cover a gap
+constexpr std::chrono::milliseconds cConcealment(10);
+
+int64_t microseconds(AudioJitterBuffer::Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+}
+
+AudioJitterBuffer::AudioJitterBuffer(uint32_t channelCount, uint32_t sampleRate, std::chrono::milliseconds minTarget,
+                                     std::chrono::milliseconds maxTarget)
+    : channelCount_(channelCount)
+    , minTarget_(std::chrono::microseconds(minTarget).count())
+    , maxTarget_(std::max(minTarget_, static_cast<int64_t>(std::chrono::microseconds(maxTarget).count())))
+    , history_(std::max<size_t>(sampleRate * cConcealment.count() / 1000, 1) * channelCount)
+{
+    this->reset();
+}
+
+void AudioJitterBuffer::onArrival(std::chrono::microseconds duration, Clock::time_point arrival)
+{
+    const auto now = microseconds(arrival);
+    const auto elapsed = now - lastArrival_;
+    if(arrived_)
+    {
+        peak_ = std::max<int64_t>(peak_ - elapsed / cPeakDecay, 0);
+    }
+
+    if(!arrived_ || elapsed > cIdleGap)
+    {
+        // the first message of a stream, or one going on after a pause: its timing starts over
+        arrived_ = true;
+        start_ = now;
+        mediaTime_ = 0;
+        floor_ = 0;
+        lastLateness_ = 0;
+    }
+    else
+    {
+        // how much later than its share of the stream the message came
+        const auto offset = now - start_ - mediaTime_;
+        floor_ = std::min(offset, floor_ + elapsed / cFloorCreep);
+        const auto lateness = offset - floor_;
+        peak_ = std::max(peak_, lateness);
+        jitter_ += (std::llabs(lateness - lastLateness_) - jitter_) / cJitterSmoothing;
+        lastLateness_ = lateness;
+    }
+
+    lastArrival_ = now;
+    mediaTime_ += duration.count();
+    target_.store(std::clamp(peak_ + jitter_, minTarget_, maxTarget_), std::memory_order_relaxed);
+    jitterStatistic_.store(jitter_, std::memory_order_relaxed);
+}
+
+bool AudioJitterBuffer::canRead(std::chrono::microseconds queued, bool draining)
+{
+    latency_.store(queued.count(), std::memory_order_relaxed);
+    if(!primed_ && (draining || queued.count() >= target_.load(std::memory_order_relaxed)))
+    {
+        primed_ = true;
+        // the real thing is back, what is left of a gap is not repeated
+        concealFrames_ = 0;
+    }
+
+    // a start that finds nothing queued has not played yet
+    if(primed_ && !draining && queued.count() > 0)
+    {
+        started_ = true;
+    }
+    return primed_;
+}
+
+bool AudioJitterBuffer::onEmpty(bool playing)
+{
+    const bool underrun = playing && started_ && primed_;
+    primed_ = false;
+
+    if(underrun)
+    {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+        concealPosition_ = 0;
+        concealFrames_ = historyFrames_;
+    }
+    else if(!playing)
+    {
+        // played out, the next start is a new one
+        started_ = false;
+        historyFrames_ = 0;
+    }
+    return underrun;
+}
+
+void AudioJitterBuffer::remember(const int16_t* samples, size_t frames)
+{
+    const auto capacity = history_.size() / channelCount_;
+    if(frames > capacity)
+    {
+        samples += (frames - capacity) * channelCount_;
+        frames = capacity;
+    }
+
+    for(size_t i = 0; i < frames; ++i)
+    {
+        std::copy(samples + i * channelCount_, samples + (i + 1) * channelCount_,
+                  history_.begin() + historyPosition_ * channelCount_);
+        historyPosition_ = historyPosition_ + 1 == capacity ? 0 : historyPosition_ + 1;
+    }
+    historyFrames_ = std::min(historyFrames_ + frames, capacity);
+}
+
+size_t AudioJitterBuffer::conceal(int16_t* output, size_t frames)
+{
+    const auto capacity = history_.size() / channelCount_;
+    size_t produced = 0;
+    while(produced < frames && concealPosition_ < concealFrames_)
+    {
+        // oldest first, faded linearly to nothing
+        const auto index = (historyPosition_ + capacity - concealFrames_ + concealPosition_) % capacity;
+        const auto gain = static_cast<int32_t>((concealFrames_ - concealPosition_) * 32768 / concealFrames_);
+        for(uint32_t channel = 0; channel < channelCount_; ++channel)
+        {
+            output[produced * channelCount_ + channel] =
+                static_cast<int16_t>((history_[index * channelCount_ + channel] * gain) >> 15);
+        }
+        ++produced;
+        ++concealPosition_;
+    }
+
+    concealed_.fetch_add(produced, std::memory_order_relaxed);
+    return produced;
+}
+
+void AudioJitterBuffer::reset()
+{
+    arrived_ = false;
+    start_ = 0;
+    mediaTime_ = 0;
+    lastArrival_ = 0;
+    floor_ = 0;
+    peak_ = 0;
+    lastLateness_ = 0;
+    jitter_ = 0;
+
+    primed_ = false;
+    started_ = false;
+    std::fill(history_.begin(), history_.end(), 0);
+    historyFrames_ = 0;
+    historyPosition_ = 0;
+    concealPosition_ = 0;
+    concealFrames_ = 0;
+
+    target_ = minTarget_;
+    jitterStatistic_ = 0;
+    latency_ = 0;
+    underruns_ = 0;
+    concealed_ = 0;
+}
+
+std::chrono::microseconds AudioJitterBuffer::getTarget() const
+{
+    return std::chrono::microseconds(target_.load(std::memory_order_relaxed));
+}
+
+AudioJitterBuffer::Statistics AudioJitterBuffer::getStatistics() const
+{
+    Statistics statistics;
+    statistics.target = this->getTarget();
+    statistics.jitter = std::chrono::microseconds(jitterStatistic_.load(std::memory_order_relaxed));
+    statistics.latency = std::chrono::microseconds(latency_.load(std::memory_order_relaxed));
+    statistics.underruns = underruns_.load(std::memory_order_relaxed);
+    statistics.concealedFrames = concealed_.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+}
+}
+}
+}
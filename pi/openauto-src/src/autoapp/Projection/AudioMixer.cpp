@@ -0,0 +1,660 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Projection/AudioMixer.hpp>
+#include <f1x/openauto/autoapp/Projection/DriftCorrector.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define OA_MIXER_NEON 1
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#  define OA_MIXER_SSE2 1
+#endif
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// one millisecond of output, the unit channels are converted and gains ramped in
+constexpr size_t cBlockFrames = 48;
+constexpr uint32_t cMinSampleRate = 8000;
+constexpr uint32_t cMaxSampleRate = 192000;
+// a gain change takes 20 ms, fast enough to follow speech without clicks
+constexpr int32_t cGainStep = AudioMixer::cUnityGain / 20;
+// queued before a channel plays, at least a burst of WiFi retries and at most
+// what still passes for lip sync
+constexpr std::chrono::milliseconds cMinJitterTarget(20);
+constexpr std::chrono::milliseconds cMaxJitterTarget(200);
+
+int64_t microseconds(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+const char* channelName(AudioMixer::Channel channel)
+{
+    switch(channel)
+    {
+    case AudioMixer::Channel::MEDIA:
+        return "media";
+    case AudioMixer::Channel::GUIDANCE:
+        return "guidance";
+    default:
+        return "system";
+    }
+}
+
+}
+
+struct AudioMixer::Source
+{
+    Source(Channel channel, uint32_t channelCount, uint32_t sampleRate, size_t latencyBound,
+           std::chrono::milliseconds maxJitterTarget, MediaClock::Pointer clock)
+        : channel(channel)
+        , channelCount(channelCount)
+        , sampleRate(sampleRate)
+        , bytesPerFrame(channelCount * sizeof(int16_t))
+        , buffer(latencyBound, bytesPerFrame)
+        , playing(false)
+        , underrunFrames(0)
+        , resetPending(false)
+        , startTime(0)
+        , firstSample(0)
+        , maxFirstSample(0)
+        , open(false)
+        , jitter(cChannelCount, cSampleRate, cMinJitterTarget, maxJitterTarget)
+        , resampler(sampleRate, channelCount, cSampleRate, cChannelCount)
+        , input(sampleRate * cBlockFrames / cSampleRate * channelCount)
+        , resampled(resampler.getMaxOutputFrames(input.size() / channelCount) * cChannelCount)
+        , staged(DriftCorrector::getMaxOutputFrames(resampled.size() / cChannelCount) * cChannelCount)
+        , drift(cChannelCount)
+    {
+        if(clock != nullptr)
+        {
+            scheduler = std::make_unique<PlayoutScheduler>(sampleRate, bytesPerFrame, std::move(clock));
+        }
+        this->reset();
+    }
+
+    // render side state; only touched while no output pulls, or by render() itself
+    void reset()
+    {
+        startTime = 0;
+        jitter.reset();
+        recovering = false;
+        resampler.reset();
+        drift.reset();
+        drift.setSkew(0);
+        if(scheduler != nullptr)
+        {
+            scheduler->reset();
+        }
+        stagedFrames = 0;
+        stagedPosition = 0;
+        gain = cUnityGain;
+        targetGain = cUnityGain;
+    }
+
+    const Channel channel;
+    const uint32_t channelCount;
+    const uint32_t sampleRate;
+    const uint32_t bytesPerFrame;
+    common::SpscByteRing buffer;
+    // between start and stop indication of the channel
+    std::atomic<bool> playing;
+    std::atomic<uint64_t> underrunFrames;
+    // set when the channel closes while the device runs; render side fades
+    // out, starts the channel over and clears it. The writer drops what comes
+    // in meanwhile, so nothing of the next session is cleared with the last.
+    std::atomic<bool> resetPending;
+    // microseconds, of the start indication until its first sample is staged
+    std::atomic<int64_t> startTime;
+    std::atomic<int64_t> firstSample;
+    std::atomic<int64_t> maxFirstSample;
+    // control side, under the mixer mutex
+    bool open;
+    // timestamped channels only; marked by the writer, the rest is render side
+    std::unique_ptr<PlayoutScheduler> scheduler;
+    // told of arrivals by the writer, the rest is render side
+    AudioJitterBuffer jitter;
+
+    // render side
+    AudioResampler resampler;
+    std::vector<int16_t> input;
+    std::vector<int16_t> resampled;
+    std::vector<int16_t> staged;
+    DriftCorrector drift;
+    // the queue ran dry, the next block read fades in
+    bool recovering;
+    size_t stagedFrames;
+    size_t stagedPosition;
+    int32_t gain;
+    int32_t targetGain;
+};
+
+class AudioMixer::Input: public IAudioOutput
+{
+public:
+    Input(AudioMixer::Pointer mixer, Source& source)
+        : mixer_(std::move(mixer))
+        , source_(source)
+    {
+    }
+
+    bool open() override
+    {
+        return mixer_->openInput(source_);
+    }
+
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override
+    {
+        // pairs with the release in mixSource(): once clear, the render side is done with the last session
+        if(source_.resetPending.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        // zero: the message came without a timestamp
+        if(source_.scheduler != nullptr && timestamp != 0)
+        {
+            source_.scheduler->mark(timestamp, source_.buffer.getWritePosition());
+        }
+        source_.jitter.onArrival(std::chrono::microseconds(buffer.size / source_.bytesPerFrame * 1000000
+                                                           / source_.sampleRate),
+                                 AudioJitterBuffer::Clock::now());
+        source_.buffer.write(buffer.cdata, buffer.size);
+    }
+
+    void start() override
+    {
+        if(!source_.playing.exchange(true))
+        {
+            source_.startTime = microseconds(std::chrono::steady_clock::now());
+        }
+    }
+
+    void stop() override
+    {
+        mixer_->closeInput(source_);
+    }
+
+    void suspend() override
+    {
+        // what is queued still plays out
+        source_.playing = false;
+    }
+
+    uint32_t getSampleSize() const override
+    {
+        return cSampleSize;
+    }
+
+    uint32_t getChannelCount() const override
+    {
+        return source_.channelCount;
+    }
+
+    uint32_t getSampleRate() const override
+    {
+        return source_.sampleRate;
+    }
+
+private:
+    AudioMixer::Pointer mixer_;
+    Source& source_;
+};
+
+AudioMixer::AudioMixer(uint32_t duckingLevel, std::chrono::milliseconds latencyBound)
+    : latencyBound_(latencyBound)
+    , duckingGain_(cUnityGain)
+    , focusDucking_(false)
+    , renderedFrames_(0)
+    , outputLatency_(0)
+    , mediaClock_(std::make_shared<MediaClock>())
+    , openInputs_(0)
+    , deviceOpen_(false)
+    , warm_(false)
+{
+    for(auto& source : activeSources_)
+    {
+        source = nullptr;
+    }
+    this->setDuckingLevel(duckingLevel);
+}
+
+AudioMixer::~AudioMixer()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    if(deviceOpen_)
+    {
+        device_->stop();
+    }
+}
+
+void AudioMixer::setDevice(IAudioOutput::Pointer device)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    device_ = std::move(device);
+}
+
+bool AudioMixer::warmUp()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    warm_ = true;
+    if(!deviceOpen_ && openInputs_ == 0)
+    {
+        this->resetSources();
+        this->openDevice();
+    }
+    return deviceOpen_;
+}
+
+IAudioOutput::Pointer AudioMixer::createInput(Channel channel, uint32_t channelCount, uint32_t sampleRate)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(channelCount < 1 || channelCount > cChannelCount || sampleRate < cMinSampleRate || sampleRate > cMaxSampleRate)
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] cannot mix " << channelCount << " channel(s) at " << sampleRate << " Hz";
+        return nullptr;
+    }
+
+    auto& source = sources_[static_cast<size_t>(channel)];
+    if(source == nullptr)
+    {
+        const size_t latencyBound = sampleRate * latencyBound_.count() / 1000 * channelCount * sizeof(int16_t);
+        source = std::make_unique<Source>(channel, channelCount, sampleRate, latencyBound,
+                                          std::min(cMaxJitterTarget, latencyBound_ / 2),
+                                          channel == Channel::MEDIA ? mediaClock_ : nullptr);
+        activeSources_[static_cast<size_t>(channel)].store(source.get(), std::memory_order_release);
+    }
+    else if(source->channelCount != channelCount || source->sampleRate != sampleRate)
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] " << channelName(channel) << " is already mixed in another format";
+        return nullptr;
+    }
+
+    return std::make_shared<Input>(this->shared_from_this(), *source);
+}
+
+void AudioMixer::setFocusDucking(bool value)
+{
+    focusDucking_ = value;
+}
+
+void AudioMixer::setDuckingLevel(uint32_t duckingLevel)
+{
+    duckingGain_ = static_cast<int32_t>(std::min<uint32_t>(duckingLevel, 100) * cUnityGain / 100);
+}
+
+size_t AudioMixer::render(void* buffer, size_t frames)
+{
+    auto output = static_cast<int16_t*>(buffer);
+    std::fill(output, output + frames * cChannelCount, 0);
+    const auto playout = std::chrono::steady_clock::now()
+                         + std::chrono::microseconds(outputLatency_.load(std::memory_order_relaxed));
+
+    const auto guidance = activeSources_[static_cast<size_t>(Channel::GUIDANCE)].load(std::memory_order_acquire);
+    const bool ducked = focusDucking_.load(std::memory_order_relaxed)
+                        || (guidance != nullptr && (guidance->playing.load(std::memory_order_relaxed)
+                                                    || guidance->stagedPosition < guidance->stagedFrames
+                                                    || !guidance->buffer.empty()));
+
+    for(const auto& active : activeSources_)
+    {
+        const auto source = active.load(std::memory_order_acquire);
+        if(source != nullptr)
+        {
+            source->targetGain = source->channel == Channel::MEDIA && ducked
+                                 ? duckingGain_.load(std::memory_order_relaxed) : cUnityGain;
+            this->mixSource(*source, output, frames, playout);
+        }
+    }
+
+    renderedFrames_.fetch_add(frames, std::memory_order_relaxed);
+    return frames;
+}
+
+void AudioMixer::setOutputLatency(std::chrono::microseconds latency)
+{
+    outputLatency_ = latency.count();
+    OPENAUTO_LOG(info) << "[AudioMixer] output latency: " << latency.count() / 1000.0 << " ms";
+}
+
+AudioMixer::Statistics AudioMixer::getStatistics() const
+{
+    Statistics statistics;
+    statistics.renderedFrames = renderedFrames_.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < activeSources_.size(); ++i)
+    {
+        const auto source = activeSources_[i].load(std::memory_order_acquire);
+        if(source != nullptr)
+        {
+            statistics.underrunFrames[i] = source->underrunFrames.load(std::memory_order_relaxed);
+            statistics.buffers[i] = source->buffer.getStatistics();
+            statistics.jitter[i] = source->jitter.getStatistics();
+            if(source->scheduler != nullptr)
+            {
+                statistics.media = source->scheduler->getStatistics();
+            }
+            statistics.firstSample[i] = std::chrono::microseconds(source->firstSample.load(std::memory_order_relaxed));
+            statistics.maxFirstSample[i] = std::chrono::microseconds(
+                source->maxFirstSample.load(std::memory_order_relaxed));
+        }
+    }
+    return statistics;
+}
+
+MediaClock::Pointer AudioMixer::getMediaClock() const
+{
+    return mediaClock_;
+}
+
+void AudioMixer::mix(int16_t* dst, const int16_t* src, size_t count, int32_t gain)
+{
+    size_t i = 0;
+#if defined(OA_MIXER_NEON)
+    if(gain == cUnityGain)
+    {
+        for(; i + 8 <= count; i += 8)
+        {
+            vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+        }
+    }
+    else
+    {
+        const int16x4_t factor = vdup_n_s16(static_cast<int16_t>(gain));
+        for(; i + 8 <= count; i += 8)
+        {
+            const int16x8_t samples = vld1q_s16(src + i);
+            const int16x8_t scaled = vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(samples), factor), 15),
+                                                  vshrn_n_s32(vmull_s16(vget_high_s16(samples), factor), 15));
+            vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), scaled));
+        }
+    }
+#elif defined(OA_MIXER_SSE2)
+    if(gain == cUnityGain)
+    {
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i mixed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(mixed, samples));
+        }
+    }
+    else
+    {
+        const __m128i factor = _mm_set1_epi16(static_cast<int16_t>(gain));
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            // full 32 bit products from their low and high halves
+            const __m128i low = _mm_mullo_epi16(samples, factor);
+            const __m128i high = _mm_mulhi_epi16(samples, factor);
+            const __m128i scaled = _mm_packs_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(low, high), 15),
+                                                   _mm_srai_epi32(_mm_unpackhi_epi16(low, high), 15));
+            const __m128i mixed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(mixed, scaled));
+        }
+    }
+#endif
+    mixScalar(dst + i, src + i, count - i, gain);
+}
+
+void AudioMixer::mixScalar(int16_t* dst, const int16_t* src, size_t count, int32_t gain)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        const int32_t sample = gain == cUnityGain ? src[i] : (src[i] * gain) >> 15;
+        dst[i] = static_cast<int16_t>(std::clamp<int32_t>(dst[i] + sample, INT16_MIN, INT16_MAX));
+    }
+}
+
+bool AudioMixer::openInput(Source& source)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(!source.open)
+    {
+        if(openInputs_ == 0 && !deviceOpen_)
+        {
+            this->resetSources();
+            this->openDevice();
+        }
+        else if(source.resetPending.load(std::memory_order_acquire))
+        {
+            OPENAUTO_LOG(info) << "[AudioMixer] " << channelName(source.channel)
+                               << " reopened while its last session fades out, writes are dropped until the fade"
+                               << " out ends";
+        }
+
+        source.open = true;
+        ++openInputs_;
+        OPENAUTO_LOG(info) << "[AudioMixer] " << channelName(source.channel) << " opened, " << source.channelCount
+                           << " channel(s) at " << source.sampleRate << " Hz";
+    }
+
+    return device_ == nullptr || deviceOpen_;
+}
+
+void AudioMixer::closeInput(Source& source)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    source.playing = false;
+    if(!source.open)
+    {
+        return;
+    }
+
+    source.open = false;
+    const auto statistics = source.buffer.getStatistics();
+    OPENAUTO_LOG(info) << "[AudioMixer] " << channelName(source.channel) << " closed, buffer peak: "
+                       << statistics.peakFill << " bytes, dropped: " << statistics.droppedBytes
+                       << ", underruns: " << source.underrunFrames.load() * 1000 / cSampleRate << " ms";
+    const auto jitter = source.jitter.getStatistics();
+    OPENAUTO_LOG(info) << "[AudioMixer] " << channelName(source.channel) << " jitter: " << jitter.jitter.count() / 1000.0
+                       << " ms, target: " << jitter.target.count() / 1000.0 << " ms, gaps: " << jitter.underruns
+                       << ", concealed: " << jitter.concealedFrames * 1000 / cSampleRate << " ms, first sample after: "
+                       << source.maxFirstSample.load() / 1000.0 << " ms at most";
+    if(source.scheduler != nullptr)
+    {
+        const auto playout = source.scheduler->getStatistics();
+        OPENAUTO_LOG(info) << "[AudioMixer] " << channelName(source.channel) << " queue: " << playout.queued.count() / 1000.0
+                           << " ms, held at: " << playout.target.count() / 1000.0 << " ms, skew: " << playout.skew
+                           << " ppm, clock resyncs: " << mediaClock_->getResyncCount();
+        mediaClock_->invalidate();
+    }
+
+    if(deviceOpen_)
+    {
+        source.resetPending.store(true, std::memory_order_release);
+    }
+
+    if(--openInputs_ == 0 && device_ != nullptr && !warm_)
+    {
+        if(deviceOpen_)
+        {
+            device_->stop();
+        }
+        deviceOpen_ = false;
+    }
+}
+
+void AudioMixer::openDevice()
+{
+    if(device_ == nullptr)
+    {
+        return;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    deviceOpen_ = device_->open();
+    if(deviceOpen_)
+    {
+        device_->start();
+        OPENAUTO_LOG(info) << "[AudioMixer] device output running after "
+                           << std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now() - begin).count() / 1000.0 << " ms";
+    }
+    else
+    {
+        OPENAUTO_LOG(error) << "[AudioMixer] device output could not be opened.";
+    }
+}
+
+void AudioMixer::resetSources()
+{
+    // nothing pulls yet, whatever a previous session left behind goes
+    for(const auto& source : sources_)
+    {
+        if(source != nullptr)
+        {
+            source->buffer.clear();
+            source->reset();
+            source->resetPending = false;
+        }
+    }
+}
+
+void AudioMixer::mixSource(Source& source, int16_t* output, size_t frames, std::chrono::steady_clock::time_point playout)
+{
+    if(source.resetPending.load(std::memory_order_acquire))
+    {
+        if(source.gain == 0 || (source.stagedPosition == source.stagedFrames && source.buffer.empty()))
+        {
+            // faded out: the next session starts from silence
+            source.buffer.clear();
+            source.reset();
+            source.gain = 0;
+            source.resetPending.store(false, std::memory_order_release);
+            return;
+        }
+        source.targetGain = 0;
+    }
+
+    size_t mixed = 0;
+    while(mixed < frames)
+    {
+        if(source.stagedPosition == source.stagedFrames
+           && !this->stage(source, playout + std::chrono::microseconds(mixed * 1000000 / cSampleRate)))
+        {
+            break;
+        }
+
+        const auto count = std::min(frames - mixed, source.stagedFrames - source.stagedPosition);
+        mix(output + mixed * cChannelCount, source.staged.data() + source.stagedPosition * cChannelCount,
+            count * cChannelCount, source.gain);
+        mixed += count;
+        source.stagedPosition += count;
+    }
+
+    if(mixed < frames && source.playing.load(std::memory_order_relaxed))
+    {
+        source.underrunFrames.fetch_add(frames - mixed, std::memory_order_relaxed);
+    }
+}
+
+bool AudioMixer::stage(Source& source, std::chrono::steady_clock::time_point playout)
+{
+    const bool playing = source.playing.load(std::memory_order_relaxed);
+    const auto queued = std::chrono::microseconds(source.buffer.size() / source.bytesPerFrame * 1000000
+                                                  / source.sampleRate);
+    size_t count = 0;
+    if(source.jitter.canRead(queued, !playing))
+    {
+        count = source.buffer.read(source.input.data(), source.input.size() * sizeof(int16_t)) / source.bytesPerFrame;
+        if(count == 0 && source.jitter.onEmpty(playing))
+        {
+            source.recovering = true;
+        }
+    }
+
+    source.stagedPosition = 0;
+    if(count == 0)
+    {
+        // a gap is bridged by what played last, fading out
+        source.stagedFrames = source.jitter.conceal(source.staged.data(), cBlockFrames);
+        return source.stagedFrames > 0;
+    }
+
+    if(source.recovering)
+    {
+        source.gain = 0;
+        source.recovering = false;
+    }
+    if(source.gain < source.targetGain)
+    {
+        source.gain = std::min(source.gain + cGainStep, source.targetGain);
+    }
+    else if(source.gain > source.targetGain)
+    {
+        source.gain = std::max(source.gain - cGainStep, source.targetGain);
+    }
+
+    if(source.scheduler == nullptr)
+    {
+        // may be nothing yet when decimating, the next call reads on
+        source.stagedFrames = source.resampler.process(source.input.data(), count, source.staged.data());
+    }
+    else
+    {
+        // the block just read is heard once what the filters hold has played
+        const auto position = source.buffer.getReadPosition() - count * source.bytesPerFrame;
+        source.scheduler->setTarget(source.jitter.getTarget());
+        const auto skew = source.scheduler->onPlay(position, playout + source.resampler.getLatency(),
+                                                   source.buffer.size());
+        source.drift.setSkew(skew);
+
+        const auto resampled = source.resampler.process(source.input.data(), count, source.resampled.data());
+        source.stagedFrames = source.drift.process(source.resampled.data(), resampled, source.staged.data());
+    }
+
+    source.jitter.remember(source.staged.data(), source.stagedFrames);
+
+    if(const auto started = source.startTime.load(std::memory_order_relaxed))
+    {
+        if(source.startTime.exchange(0, std::memory_order_relaxed) != 0)
+        {
+            const auto firstSample = microseconds(playout + source.resampler.getLatency()) - started;
+            source.firstSample.store(firstSample, std::memory_order_relaxed);
+            if(firstSample > source.maxFirstSample.load(std::memory_order_relaxed))
+            {
+                source.maxFirstSample.store(firstSample, std::memory_order_relaxed);
+            }
+        }
+    }
+    return true;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,318 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <f1x/openauto/autoapp/Projection/AudioResampler.hpp>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define OA_RESAMPLER_NEON 1
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#  define OA_RESAMPLER_SSE2 1
+#endif
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// input frames converted at a time, bounds the buffers allocated up front
+constexpr size_t cChunkFrames = 256;
+// passband edge relative to the Nyquist frequency of the lower rate
+constexpr double cCutoff = 0.9;
+// Kaiser window, about 80 dB stopband attenuation
+constexpr double cKaiserBeta = 8.0;
+
+double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for(int k = 1; k < 50; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if(term < sum * 1e-12)
+        {
+            break;
+        }
+    }
+    return sum;
+}
+
+int16_t saturate(int32_t value)
+{
+    return static_cast<int16_t>(std::clamp<int32_t>(value, INT16_MIN, INT16_MAX));
+}
+
+}
+
+AudioResampler::AudioResampler(uint32_t inputRate, uint32_t inputChannels, uint32_t outputRate, uint32_t outputChannels,
+                               Kernel kernel, size_t tapsPerPhase)
+    : inputRate_(inputRate)
+    , inputChannels_(std::clamp<uint32_t>(inputChannels, 1, 2))
+    , outputRate_(outputRate)
+    , outputChannels_(std::clamp<uint32_t>(outputChannels, 1, 2))
+    , up_(1)
+    , down_(1)
+    , taps_(0)
+    , dot_(kernel == Kernel::SCALAR ? &AudioResampler::dotScalar : &AudioResampler::dot)
+    , filterChannels_(inputChannels_ == 2 && outputChannels_ == 2 ? 2 : 1)
+    , time_(0)
+{
+    if(inputRate_ > 0 && outputRate_ > 0 && inputRate_ != outputRate_)
+    {
+        const auto divisor = std::gcd(inputRate_, outputRate_);
+        up_ = outputRate_ / divisor;
+        down_ = inputRate_ / divisor;
+
+        // decimation narrows the passband relative to the filter rate, the filter grows with it
+        const size_t scale = (down_ + up_ - 1) / up_;
+        taps_ = (std::max<size_t>(tapsPerPhase, 8) * scale + 7) / 8 * 8;
+        this->design();
+        history_.assign(filterChannels_, std::vector<int16_t>(taps_ - 1 + cChunkFrames, 0));
+    }
+}
+
+size_t AudioResampler::process(const int16_t* input, size_t inputFrames, int16_t* output)
+{
+    if(taps_ == 0)
+    {
+        return this->convertChannels(input, inputFrames, output);
+    }
+
+    size_t produced = 0;
+    while(inputFrames > 0)
+    {
+        const auto count = std::min(inputFrames, cChunkFrames);
+        const auto offset = taps_ - 1;
+
+        for(size_t frame = 0; frame < count; ++frame)
+        {
+            const auto source = input + frame * inputChannels_;
+            if(filterChannels_ == 2)
+            {
+                history_[0][offset + frame] = source[0];
+                history_[1][offset + frame] = source[1];
+            }
+            else
+            {
+                history_[0][offset + frame] = inputChannels_ == 2
+                                              ? static_cast<int16_t>((source[0] + source[1]) >> 1) : source[0];
+            }
+        }
+
+        // the output at time_ uses the input frame at or before it and the taps_ - 1 ones before that
+        for(auto index = time_ / up_; index < count; index = time_ / up_)
+        {
+            const auto phase = static_cast<size_t>(time_ % up_);
+            const auto coefficients = coefficients_.data() + phase * taps_;
+            auto target = output + produced * outputChannels_;
+
+            for(size_t channel = 0; channel < filterChannels_; ++channel)
+            {
+                const auto sum = dot_(history_[channel].data() + index, coefficients, taps_);
+                target[channel] = saturate((sum + (1 << 14)) >> 15);
+            }
+            if(filterChannels_ < outputChannels_)
+            {
+                target[1] = target[0];
+            }
+
+            ++produced;
+            time_ += down_;
+        }
+
+        time_ -= count * up_;
+        for(auto& history : history_)
+        {
+            std::memmove(history.data(), history.data() + count, offset * sizeof(int16_t));
+        }
+
+        input += count * inputChannels_;
+        inputFrames -= count;
+    }
+
+    return produced;
+}
+
+size_t AudioResampler::getMaxOutputFrames(size_t inputFrames) const
+{
+    return (inputFrames * up_ + down_ - 1) / down_;
+}
+
+void AudioResampler::reset()
+{
+    for(auto& history : history_)
+    {
+        std::fill(history.begin(), history.end(), 0);
+    }
+    time_ = 0;
+}
+
+std::chrono::microseconds AudioResampler::getLatency() const
+{
+    if(taps_ == 0)
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    // linear phase: half the prototype length, which runs at up_ times the input rate
+    const auto length = static_cast<uint64_t>(taps_) * up_;
+    return std::chrono::microseconds((length - 1) * 1000000 / (2ULL * up_ * inputRate_));
+}
+
+uint32_t AudioResampler::getInputRate() const
+{
+    return inputRate_;
+}
+
+uint32_t AudioResampler::getOutputRate() const
+{
+    return outputRate_;
+}
+
+int32_t AudioResampler::dot(const int16_t* samples, const int16_t* coefficients, size_t count)
+{
+#if defined(OA_RESAMPLER_NEON)
+    int32x4_t sum = vdupq_n_s32(0);
+    for(size_t i = 0; i < count; i += 8)
+    {
+        const int16x8_t x = vld1q_s16(samples + i);
+        const int16x8_t h = vld1q_s16(coefficients + i);
+        sum = vmlal_s16(sum, vget_low_s16(x), vget_low_s16(h));
+        sum = vmlal_s16(sum, vget_high_s16(x), vget_high_s16(h));
+    }
+    const int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+    return vget_lane_s32(vpadd_s32(half, half), 0);
+#elif defined(OA_RESAMPLER_SSE2)
+    __m128i sum = _mm_setzero_si128();
+    for(size_t i = 0; i < count; i += 8)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(x, h));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#else
+    return dotScalar(samples, coefficients, count);
+#endif
+}
+
+int32_t AudioResampler::dotScalar(const int16_t* samples, const int16_t* coefficients, size_t count)
+{
+    // wraps like the vector lanes do; the filter design keeps real sums far from that
+    uint32_t sum = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        sum += static_cast<uint32_t>(static_cast<int32_t>(samples[i]) * coefficients[i]);
+    }
+    return static_cast<int32_t>(sum);
+}
+
+const char* AudioResampler::getNativeKernelName()
+{
+#if defined(OA_RESAMPLER_NEON)
+    return "neon";
+#elif defined(OA_RESAMPLER_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void AudioResampler::design()
+{
+    // windowed sinc at up_ times the input rate, gain up_ to make up for the inserted zeros
+    const auto length = taps_ * up_;
+    const double cutoff = cCutoff * 0.5 * std::min(inputRate_, outputRate_) / (static_cast<double>(inputRate_) * up_);
+    const double center = (length - 1) / 2.0;
+    const double window = besselI0(cKaiserBeta);
+
+    std::vector<double> prototype(length);
+    for(size_t n = 0; n < length; ++n)
+    {
+        const double x = n - center;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(2.0 * M_PI * cutoff * x) / (2.0 * M_PI * cutoff * x);
+        const double ratio = x / center;
+        const double kaiser = besselI0(cKaiserBeta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / window;
+        prototype[n] = 2.0 * cutoff * up_ * sinc * kaiser;
+    }
+
+    coefficients_.assign(up_ * taps_, 0);
+    for(size_t phase = 0; phase < up_; ++phase)
+    {
+        auto coefficients = coefficients_.data() + phase * taps_;
+        int32_t sum = 0;
+        size_t peak = 0;
+        for(size_t tap = 0; tap < taps_; ++tap)
+        {
+            const auto value = std::lround(prototype[phase + tap * up_] * 32768.0);
+            coefficients[taps_ - 1 - tap] = static_cast<int16_t>(std::clamp<long>(value, INT16_MIN, INT16_MAX));
+            sum += coefficients[taps_ - 1 - tap];
+            if(std::abs(coefficients[taps_ - 1 - tap]) > std::abs(coefficients[peak]))
+            {
+                peak = taps_ - 1 - tap;
+            }
+        }
+
+        // every phase passes DC at exactly unity, so a constant stays that constant
+        coefficients[peak] = saturate(coefficients[peak] + 32768 - sum);
+    }
+}
+
+size_t AudioResampler::convertChannels(const int16_t* input, size_t inputFrames, int16_t* output) const
+{
+    if(inputChannels_ == outputChannels_)
+    {
+        std::memcpy(output, input, inputFrames * inputChannels_ * sizeof(int16_t));
+    }
+    else if(inputChannels_ == 1)
+    {
+        for(size_t frame = 0; frame < inputFrames; ++frame)
+        {
+            output[frame * 2] = input[frame];
+            output[frame * 2 + 1] = input[frame];
+        }
+    }
+    else
+    {
+        for(size_t frame = 0; frame < inputFrames; ++frame)
+        {
+            output[frame] = static_cast<int16_t>((input[frame * 2] + input[frame * 2 + 1]) >> 1);
+        }
+    }
+    return inputFrames;
+}
+
+}
+}
+}
+}
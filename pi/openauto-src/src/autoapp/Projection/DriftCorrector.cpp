@@ -0,0 +1,95 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Projection/DriftCorrector.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+DriftCorrector::DriftCorrector(uint32_t channelCount)
+    : channelCount_(std::clamp<uint32_t>(channelCount, 1, 2))
+{
+    this->setSkew(0);
+    this->reset();
+}
+
+void DriftCorrector::setSkew(int32_t skew)
+{
+    skew_ = std::clamp(skew, -cMaxSkew, cMaxSkew);
+    step_ = (uint64_t(1) << 32) + static_cast<uint64_t>((int64_t(1) << 32) * skew_ / 1000000);
+}
+
+int32_t DriftCorrector::getSkew() const
+{
+    return skew_;
+}
+
+size_t DriftCorrector::process(const int16_t* input, size_t inputFrames, int16_t* output)
+{
+    if(inputFrames == 0)
+    {
+        return 0;
+    }
+
+    // frame 0 is the last one of the previous call, frame n is input frame n - 1
+    const uint64_t end = static_cast<uint64_t>(inputFrames) << 32;
+    size_t produced = 0;
+    while(position_ < end)
+    {
+        const auto index = static_cast<size_t>(position_ >> 32);
+        const auto fraction = static_cast<int32_t>((position_ >> 17) & 0x7FFF);
+        for(uint32_t channel = 0; channel < channelCount_; ++channel)
+        {
+            const int32_t a = index == 0 ? history_[channel] : input[(index - 1) * channelCount_ + channel];
+            const int32_t b = input[index * channelCount_ + channel];
+            output[produced * channelCount_ + channel] = static_cast<int16_t>(a + (((b - a) * fraction) >> 15));
+        }
+        ++produced;
+        position_ += step_;
+    }
+
+    position_ -= end;
+    for(uint32_t channel = 0; channel < channelCount_; ++channel)
+    {
+        history_[channel] = input[(inputFrames - 1) * channelCount_ + channel];
+    }
+    return produced;
+}
+
+size_t DriftCorrector::getMaxOutputFrames(size_t inputFrames)
+{
+    return inputFrames + inputFrames * cMaxSkew / 1000000 + 2;
+}
+
+void DriftCorrector::reset()
+{
+    position_ = 0;
+    history_.fill(0);
+}
+
+}
+}
+}
+}
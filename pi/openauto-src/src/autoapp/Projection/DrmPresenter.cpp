@@ -0,0 +1,915 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_V4L2
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <drm_fourcc.h>
+#include <f1x/openauto/autoapp/Projection/DrmPresenter.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// distance of the overlay from the top left corner of the display
+constexpr uint32_t cOverlayMargin = 16;
+// failed commits in a row, about half a second of video, before giving up
+constexpr uint32_t cMaxCommitFailures = 30;
+
+uint32_t drmFormatFor(uint32_t v4l2Format)
+{
+    switch(v4l2Format)
+    {
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV12M:
+        return DRM_FORMAT_NV12;
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YUV420M:
+        return DRM_FORMAT_YUV420;
+    case V4L2_PIX_FMT_XBGR32:
+        return DRM_FORMAT_XRGB8888;
+    default:
+        return 0;
+    }
+}
+
+bool readPropertyValue(int fd, uint32_t objectId, uint32_t objectType, const char* name, uint64_t& value)
+{
+    drmModeObjectProperties* properties = drmModeObjectGetProperties(fd, objectId, objectType);
+    if(properties == nullptr)
+    {
+        return false;
+    }
+
+    bool found = false;
+    for(uint32_t i = 0; i < properties->count_props && !found; ++i)
+    {
+        drmModePropertyRes* property = drmModeGetProperty(fd, properties->props[i]);
+        if(property != nullptr && strcmp(property->name, name) == 0)
+        {
+            value = properties->prop_values[i];
+            found = true;
+        }
+        drmModeFreeProperty(property);
+    }
+
+    drmModeFreeObjectProperties(properties);
+    return found;
+}
+
+// pixel clock (kHz) over the pixels of a frame including blanking
+FramePacer::Clock::duration refreshPeriod(const drmModeModeInfo& mode, FramePacer::Clock::duration fallback)
+{
+    if(mode.clock == 0 || mode.htotal == 0 || mode.vtotal == 0)
+    {
+        return fallback;
+    }
+
+    return std::chrono::nanoseconds(static_cast<int64_t>(mode.htotal) * mode.vtotal * 1000000 / mode.clock);
+}
+
+}
+
+DrmPresenter::DrmPresenter(int32_t layerIndex, std::string devicePath)
+    : layerIndex_(layerIndex)
+    , devicePath_(std::move(devicePath))
+    , fd_(-1)
+    , ownsFd_(true)
+    , crtcId_(0)
+    , crtcIndex_(0)
+    , displayWidth_(0)
+    , displayHeight_(0)
+    , refreshPeriod_(std::chrono::microseconds(16667))
+    , planeId_(0)
+    , planeFormat_(0)
+    , zPosition_(0)
+    , scannedOutFramebuffer_(0)
+    , presentedFrames_(0)
+    , overlayGeneration_(0)
+    , overlayPlaneId_(0)
+    , overlayBack_(0)
+    , overlayVisible_(false)
+    , overlayDisabled_(false)
+    , commitFailures_(0)
+    , failed_(false)
+{
+}
+
+DrmPresenter::DrmPresenter(int32_t layerIndex, int sharedFd)
+    : DrmPresenter(layerIndex)
+{
+    fd_ = sharedFd;
+    ownsFd_ = false;
+}
+
+DrmPresenter::~DrmPresenter()
+{
+    this->clear();
+    this->destroyOverlayBuffers();
+
+    if(ownsFd_ && fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+std::string DrmPresenter::findDevice()
+{
+    for(int card = 0; card < 16; ++card)
+    {
+        const auto path = "/dev/dri/card" + std::to_string(card);
+        const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if(fd < 0)
+        {
+            continue;
+        }
+
+        bool usable = false;
+        if(drmModeRes* resources = drmModeGetResources(fd))
+        {
+            for(int i = 0; i < resources->count_connectors && !usable; ++i)
+            {
+                drmModeConnector* connector = drmModeGetConnector(fd, resources->connectors[i]);
+                usable = connector != nullptr && connector->connection == DRM_MODE_CONNECTED && connector->count_modes > 0;
+                drmModeFreeConnector(connector);
+            }
+            drmModeFreeResources(resources);
+        }
+
+        ::close(fd);
+
+        if(usable)
+        {
+            return path;
+        }
+    }
+
+    return std::string();
+}
+
+bool DrmPresenter::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(fd_ < 0)
+    {
+        const auto path = devicePath_.empty() ? findDevice() : devicePath_;
+        fd_ = path.empty() ? -1 : ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+
+        if(fd_ < 0)
+        {
+            OPENAUTO_LOG(error) << "[DrmPresenter] no usable DRM device found.";
+            return false;
+        }
+
+        OPENAUTO_LOG(info) << "[DrmPresenter] using " << path;
+    }
+
+    // another KMS client (Qt eglfs_kms, a compositor) holds master, every commit would fail with EACCES
+    if(!drmIsMaster(fd_))
+    {
+        OPENAUTO_LOG(error) << "[DrmPresenter] not DRM master, another client drives the display.";
+        return false;
+    }
+
+    if(drmSetClientCap(fd_, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0 || drmSetClientCap(fd_, DRM_CLIENT_CAP_ATOMIC, 1) != 0)
+    {
+        OPENAUTO_LOG(error) << "[DrmPresenter] driver does not support atomic modesetting.";
+        return false;
+    }
+
+    return this->findCrtc();
+}
+
+bool DrmPresenter::findCrtc()
+{
+    drmModeRes* resources = drmModeGetResources(fd_);
+    if(resources == nullptr)
+    {
+        OPENAUTO_LOG(error) << "[DrmPresenter] unable to read DRM resources: " << std::strerror(errno);
+        return false;
+    }
+
+    drmModeConnector* connector = nullptr;
+    for(int i = 0; i < resources->count_connectors && connector == nullptr; ++i)
+    {
+        connector = drmModeGetConnector(fd_, resources->connectors[i]);
+        if(connector != nullptr && (connector->connection != DRM_MODE_CONNECTED || connector->count_modes == 0))
+        {
+            drmModeFreeConnector(connector);
+            connector = nullptr;
+        }
+    }
+
+    if(connector == nullptr)
+    {
+        OPENAUTO_LOG(error) << "[DrmPresenter] no connected display.";
+        drmModeFreeResources(resources);
+        return false;
+    }
+
+    // prefer the CRTC the UI already drives
+    if(drmModeEncoder* encoder = connector->encoder_id != 0 ? drmModeGetEncoder(fd_, connector->encoder_id) : nullptr)
+    {
+        if(drmModeCrtc* crtc = encoder->crtc_id != 0 ? drmModeGetCrtc(fd_, encoder->crtc_id) : nullptr)
+        {
+            if(crtc->mode_valid)
+            {
+                crtcId_ = crtc->crtc_id;
+                displayWidth_ = crtc->mode.hdisplay;
+                displayHeight_ = crtc->mode.vdisplay;
+                refreshPeriod_ = refreshPeriod(crtc->mode, refreshPeriod_);
+            }
+            drmModeFreeCrtc(crtc);
+        }
+        drmModeFreeEncoder(encoder);
+    }
+
+    // nothing lit the display up (headless, vkms): set the preferred mode ourselves
+    if(crtcId_ == 0 && connector->count_encoders > 0)
+    {
+        if(drmModeEncoder* encoder = drmModeGetEncoder(fd_, connector->encoders[0]))
+        {
+            for(int i = 0; i < resources->count_crtcs && crtcId_ == 0; ++i)
+            {
+                if(encoder->possible_crtcs & (1u << i))
+                {
+                    crtcId_ = resources->crtcs[i];
+                }
+            }
+            drmModeFreeEncoder(encoder);
+        }
+
+        uint32_t modeBlob = 0;
+        drmModeAtomicReq* request = drmModeAtomicAlloc();
+        const bool modeSet = crtcId_ != 0
+            && drmModeCreatePropertyBlob(fd_, &connector->modes[0], sizeof(connector->modes[0]), &modeBlob) == 0
+            && drmModeAtomicAddProperty(request, crtcId_, this->propertyId(crtcId_, DRM_MODE_OBJECT_CRTC, "MODE_ID"), modeBlob) >= 0
+            && drmModeAtomicAddProperty(request, crtcId_, this->propertyId(crtcId_, DRM_MODE_OBJECT_CRTC, "ACTIVE"), 1) >= 0
+            && drmModeAtomicAddProperty(request, connector->connector_id,
+                                        this->propertyId(connector->connector_id, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID"), crtcId_) >= 0
+            && drmModeAtomicCommit(fd_, request, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr) == 0;
+        drmModeAtomicFree(request);
+
+        if(!modeSet)
+        {
+            OPENAUTO_LOG(error) << "[DrmPresenter] unable to set a display mode: " << std::strerror(errno);
+            crtcId_ = 0;
+        }
+        else
+        {
+            displayWidth_ = connector->modes[0].hdisplay;
+            displayHeight_ = connector->modes[0].vdisplay;
+            refreshPeriod_ = refreshPeriod(connector->modes[0], refreshPeriod_);
+        }
+    }
+
+    for(int i = 0; i < resources->count_crtcs; ++i)
+    {
+        if(resources->crtcs[i] == crtcId_)
+        {
+            crtcIndex_ = static_cast<uint32_t>(i);
+        }
+    }
+
+    drmModeFreeConnector(connector);
+    drmModeFreeResources(resources);
+
+    if(crtcId_ == 0)
+    {
+        return false;
+    }
+
+    OPENAUTO_LOG(info) << "[DrmPresenter] crtc " << crtcId_ << ", " << displayWidth_ << "x" << displayHeight_
+                       << ", refresh: " << std::chrono::duration_cast<std::chrono::microseconds>(refreshPeriod_).count() << " us";
+    return true;
+}
+
+bool DrmPresenter::findPlane(uint32_t drmFormat)
+{
+    planeId_ = this->findFreePlane(drmFormat, overlayPlaneId_);
+    if(planeId_ == 0)
+    {
+        OPENAUTO_LOG(error) << "[DrmPresenter] no free overlay plane for format " << drmFormat;
+        return false;
+    }
+
+    this->readPlaneProperties(planeId_, properties_);
+    planeFormat_ = drmFormat;
+
+    return this->setupZPosition();
+}
+
+uint32_t DrmPresenter::findFreePlane(uint32_t drmFormat, uint32_t excludedPlaneId) const
+{
+    drmModePlaneRes* planes = drmModeGetPlaneResources(fd_);
+    if(planes == nullptr)
+    {
+        return 0;
+    }
+
+    uint32_t planeId = 0;
+    for(uint32_t i = 0; i < planes->count_planes && planeId == 0; ++i)
+    {
+        drmModePlane* plane = drmModeGetPlane(fd_, planes->planes[i]);
+        if(plane == nullptr)
+        {
+            continue;
+        }
+
+        uint64_t type = 0;
+        const bool candidate = plane->plane_id != excludedPlaneId
+            && (plane->possible_crtcs & (1u << crtcIndex_)) && plane->crtc_id == 0
+            && readPropertyValue(fd_, plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", type) && type == DRM_PLANE_TYPE_OVERLAY
+            && std::find(plane->formats, plane->formats + plane->count_formats, drmFormat) != plane->formats + plane->count_formats;
+
+        if(candidate)
+        {
+            planeId = plane->plane_id;
+        }
+
+        drmModeFreePlane(plane);
+    }
+
+    drmModeFreePlaneResources(planes);
+    return planeId;
+}
+
+void DrmPresenter::readPlaneProperties(uint32_t planeId, PlaneProperties& properties) const
+{
+    properties.fbId = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "FB_ID");
+    properties.crtcId = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "CRTC_ID");
+    properties.srcX = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "SRC_X");
+    properties.srcY = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "SRC_Y");
+    properties.srcW = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "SRC_W");
+    properties.srcH = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "SRC_H");
+    properties.crtcX = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "CRTC_X");
+    properties.crtcY = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "CRTC_Y");
+    properties.crtcW = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "CRTC_W");
+    properties.crtcH = this->propertyId(planeId, DRM_MODE_OBJECT_PLANE, "CRTC_H");
+}
+
+bool DrmPresenter::setupZPosition()
+{
+    properties_.zpos = 0;
+    zPosition_ = 0;
+
+    const auto zposId = this->propertyId(planeId_, DRM_MODE_OBJECT_PLANE, "zpos");
+    drmModePropertyRes* zpos = zposId != 0 ? drmModeGetProperty(fd_, zposId) : nullptr;
+    if(zpos == nullptr)
+    {
+        OPENAUTO_LOG(info) << "[DrmPresenter] plane " << planeId_ << " has no zpos, overlay stacks above the UI.";
+        return true;
+    }
+
+    // the UI lives on the CRTC's primary plane; the layer index is relative to it
+    uint64_t primaryZ = 0;
+    if(drmModePlaneRes* planes = drmModeGetPlaneResources(fd_))
+    {
+        for(uint32_t i = 0; i < planes->count_planes; ++i)
+        {
+            drmModePlane* plane = drmModeGetPlane(fd_, planes->planes[i]);
+            uint64_t type = 0;
+            if(plane != nullptr && (plane->possible_crtcs & (1u << crtcIndex_))
+               && readPropertyValue(fd_, plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", type) && type == DRM_PLANE_TYPE_PRIMARY)
+            {
+                readPropertyValue(fd_, plane->plane_id, DRM_MODE_OBJECT_PLANE, "zpos", primaryZ);
+            }
+            drmModeFreePlane(plane);
+        }
+        drmModeFreePlaneResources(planes);
+    }
+
+    readPropertyValue(fd_, planeId_, DRM_MODE_OBJECT_PLANE, "zpos", zPosition_);
+
+    if(zpos->flags & DRM_MODE_PROP_IMMUTABLE)
+    {
+        OPENAUTO_LOG(info) << "[DrmPresenter] plane " << planeId_ << " has fixed zpos " << zPosition_
+                           << " (ui: " << primaryZ << "), layer index " << layerIndex_ << " ignored.";
+    }
+    else
+    {
+        const int64_t requested = layerIndex_ > 0 ? static_cast<int64_t>(primaryZ) + layerIndex_
+                                                  : static_cast<int64_t>(primaryZ) + layerIndex_ - 1;
+        const int64_t minimum = (zpos->flags & DRM_MODE_PROP_RANGE) && zpos->count_values >= 2 ? static_cast<int64_t>(zpos->values[0]) : 0;
+        const int64_t maximum = (zpos->flags & DRM_MODE_PROP_RANGE) && zpos->count_values >= 2 ? static_cast<int64_t>(zpos->values[1]) : requested;
+
+        zPosition_ = static_cast<uint64_t>(std::clamp(requested, minimum, std::max(minimum, maximum)));
+        properties_.zpos = zposId;
+
+        OPENAUTO_LOG(info) << "[DrmPresenter] plane " << planeId_ << " zpos " << zPosition_
+                           << " (ui: " << primaryZ << ", layer index: " << layerIndex_ << ")";
+    }
+
+    drmModeFreeProperty(zpos);
+    return true;
+}
+
+uint32_t DrmPresenter::propertyId(uint32_t objectId, uint32_t objectType, const char* name) const
+{
+    drmModeObjectProperties* properties = drmModeObjectGetProperties(fd_, objectId, objectType);
+    if(properties == nullptr)
+    {
+        return 0;
+    }
+
+    uint32_t id = 0;
+    for(uint32_t i = 0; i < properties->count_props && id == 0; ++i)
+    {
+        drmModePropertyRes* property = drmModeGetProperty(fd_, properties->props[i]);
+        if(property != nullptr && strcmp(property->name, name) == 0)
+        {
+            id = property->prop_id;
+        }
+        drmModeFreeProperty(property);
+    }
+
+    drmModeFreeObjectProperties(properties);
+    return id;
+}
+
+uint32_t DrmPresenter::importFrame(const V4L2DecodedFrame& frame)
+{
+    const auto key = std::make_pair(frame.generation, frame.index);
+    const auto cached = framebuffers_.find(key);
+    if(cached != framebuffers_.end())
+    {
+        return cached->second;
+    }
+
+    uint32_t handles[4] = {};
+    uint32_t pitches[4] = {};
+    uint32_t offsets[4] = {};
+
+    for(uint32_t plane = 0; plane < frame.planeCount && plane < 4; ++plane)
+    {
+        if(drmPrimeFDToHandle(fd_, frame.dmabufFd[plane], &handles[plane]) != 0)
+        {
+            OPENAUTO_LOG(error) << "[DrmPresenter] dmabuf import failed: " << std::strerror(errno);
+            return 0;
+        }
+        pitches[plane] = frame.bytesPerLine[plane];
+        offsets[plane] = frame.planeOffset[plane];
+    }
+
+    // contiguous formats carry the chroma planes in the same buffer as luma
+    if(frame.planeCount == 1 && planeFormat_ == DRM_FORMAT_NV12)
+    {
+        handles[1] = handles[0];
+        pitches[1] = pitches[0];
+        offsets[1] = offsets[0] + pitches[0] * frame.height;
+    }
+    else if(frame.planeCount == 1 && planeFormat_ == DRM_FORMAT_YUV420)
+    {
+        handles[1] = handles[2] = handles[0];
+        pitches[1] = pitches[2] = pitches[0] / 2;
+        offsets[1] = offsets[0] + pitches[0] * frame.height;
+        offsets[2] = offsets[1] + pitches[1] * (frame.height / 2);
+    }
+
+    uint32_t framebuffer = 0;
+    if(drmModeAddFB2(fd_, frame.width, frame.height, planeFormat_, handles, pitches, offsets, &framebuffer, 0) != 0)
+    {
+        OPENAUTO_LOG(error) << "[DrmPresenter] unable to create framebuffer: " << std::strerror(errno);
+        framebuffer = 0;
+    }
+
+    // the framebuffer keeps its own reference to the buffer objects
+    for(uint32_t plane = 0; plane < frame.planeCount && plane < 4; ++plane)
+    {
+        drm_gem_close close{};
+        close.handle = handles[plane];
+        drmIoctl(fd_, DRM_IOCTL_GEM_CLOSE, &close);
+    }
+
+    if(framebuffer != 0)
+    {
+        framebuffers_[key] = framebuffer;
+    }
+
+    return framebuffer;
+}
+
+void DrmPresenter::setFailureHandler(FailureHandler handler)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    failureHandler_ = std::move(handler);
+}
+
+bool DrmPresenter::hasFailed() const
+{
+    return failed_;
+}
+
+bool DrmPresenter::present(const V4L2DecodedFrame& frame, std::optional<V4L2DecodedFrame>& released)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    const auto drmFormat = drmFormatFor(frame.pixelFormat);
+    if(failed_ || fd_ < 0 || crtcId_ == 0 || drmFormat == 0)
+    {
+        return false;
+    }
+
+    if((planeId_ == 0 || planeFormat_ != drmFormat) && !this->findPlane(drmFormat))
+    {
+        return false;
+    }
+
+    const auto framebuffer = this->importFrame(frame);
+    if(framebuffer == 0)
+    {
+        return false;
+    }
+
+    const auto visibleWidth = frame.visibleWidth != 0 ? frame.visibleWidth : frame.width;
+    const auto visibleHeight = frame.visibleHeight != 0 ? frame.visibleHeight : frame.height;
+
+    // the margins are cut off and the content scaled by the plane, a rect that
+    // does not fit the frame (e.g. while the size changes) is not applied
+    QRect source(0, 0, static_cast<int>(visibleWidth), static_cast<int>(visibleHeight));
+    if(contentRect_.width() > 0 && contentRect_.height() > 0
+       && static_cast<uint32_t>(contentRect_.x() + contentRect_.width()) <= visibleWidth
+       && static_cast<uint32_t>(contentRect_.y() + contentRect_.height()) <= visibleHeight)
+    {
+        source = contentRect_;
+    }
+    const auto target = VideoGeometry::displayRect(source.width(), source.height(), displayWidth_, displayHeight_);
+
+    drmModeAtomicReq* request = drmModeAtomicAlloc();
+    drmModeAtomicAddProperty(request, planeId_, properties_.fbId, framebuffer);
+    drmModeAtomicAddProperty(request, planeId_, properties_.crtcId, crtcId_);
+    drmModeAtomicAddProperty(request, planeId_, properties_.srcX, static_cast<uint64_t>(source.x()) << 16);
+    drmModeAtomicAddProperty(request, planeId_, properties_.srcY, static_cast<uint64_t>(source.y()) << 16);
+    drmModeAtomicAddProperty(request, planeId_, properties_.srcW, static_cast<uint64_t>(source.width()) << 16);
+    drmModeAtomicAddProperty(request, planeId_, properties_.srcH, static_cast<uint64_t>(source.height()) << 16);
+    drmModeAtomicAddProperty(request, planeId_, properties_.crtcX, target.x());
+    drmModeAtomicAddProperty(request, planeId_, properties_.crtcY, target.y());
+    drmModeAtomicAddProperty(request, planeId_, properties_.crtcW, target.width());
+    drmModeAtomicAddProperty(request, planeId_, properties_.crtcH, target.height());
+    if(properties_.zpos != 0)
+    {
+        drmModeAtomicAddProperty(request, planeId_, properties_.zpos, zPosition_);
+    }
+
+    const auto videoCursor = drmModeAtomicGetCursor(request);
+    const bool withOverlay = this->addOverlay(request);
+
+    // a blocking commit returns once the new framebuffer is latched on vblank
+    auto result = drmModeAtomicCommit(fd_, request, 0, nullptr);
+    if(result != 0 && withOverlay)
+    {
+        // never let the overlay cost the picture
+        OPENAUTO_LOG(warning) << "[DrmPresenter] commit with overlay plane " << overlayPlaneId_ << " failed: "
+                              << std::strerror(errno) << ", overlay disabled.";
+        overlayDisabled_ = true;
+        overlayVisible_ = false;
+        drmModeAtomicSetCursor(request, videoCursor);
+        result = drmModeAtomicCommit(fd_, request, 0, nullptr);
+    }
+    else if(result == 0 && withOverlay)
+    {
+        overlayBack_ ^= 1;
+    }
+    drmModeAtomicFree(request);
+
+    if(result != 0)
+    {
+        // the first of a run is logged, the rest would only repeat it every frame
+        if(++commitFailures_ == 1)
+        {
+            OPENAUTO_LOG(error) << "[DrmPresenter] atomic commit failed: " << std::strerror(errno);
+        }
+        if(commitFailures_ >= cMaxCommitFailures)
+        {
+            OPENAUTO_LOG(error) << "[DrmPresenter] " << commitFailures_ << " commits failed in a row, giving up.";
+            failed_ = true;
+            if(failureHandler_)
+            {
+                failureHandler_();
+            }
+        }
+        return false;
+    }
+    commitFailures_ = 0;
+
+    released = scannedOut_;
+    const bool reallocated = scannedOut_.has_value() && scannedOut_->generation != frame.generation;
+
+    scannedOut_ = frame;
+    scannedOutFramebuffer_ = framebuffer;
+    lastFlip_ = FramePacer::Clock::now();
+    ++presentedFrames_;
+
+    // framebuffers of a previous capture queue can go once none of them is on screen
+    if(reallocated)
+    {
+        this->removeFramebuffers(true);
+    }
+    return true;
+}
+
+void DrmPresenter::removeFramebuffers(bool keepScannedOut)
+{
+    for(auto it = framebuffers_.begin(); it != framebuffers_.end();)
+    {
+        const bool current = keepScannedOut && scannedOut_.has_value() && it->first.first == scannedOut_->generation;
+        if(current)
+        {
+            ++it;
+        }
+        else
+        {
+            drmModeRmFB(fd_, it->second);
+            it = framebuffers_.erase(it);
+        }
+    }
+}
+
+std::optional<V4L2DecodedFrame> DrmPresenter::clear()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(fd_ < 0 || planeId_ == 0)
+    {
+        return std::nullopt;
+    }
+
+    drmModeAtomicReq* request = drmModeAtomicAlloc();
+    drmModeAtomicAddProperty(request, planeId_, properties_.fbId, 0);
+    drmModeAtomicAddProperty(request, planeId_, properties_.crtcId, 0);
+    if(overlayVisible_)
+    {
+        drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.fbId, 0);
+        drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.crtcId, 0);
+        overlayVisible_ = false;
+    }
+    drmModeAtomicCommit(fd_, request, 0, nullptr);
+    drmModeAtomicFree(request);
+
+    // the overlay comes back with the next frame
+    overlayGeneration_ = 0;
+
+    std::optional<V4L2DecodedFrame> released;
+    released.swap(scannedOut_);
+    scannedOutFramebuffer_ = 0;
+    this->removeFramebuffers(false);
+
+    OPENAUTO_LOG(info) << "[DrmPresenter] presented frames: " << presentedFrames_;
+    return released;
+}
+
+FramePacer::VBlankClock DrmPresenter::getVBlankClock() const
+{
+    FramePacer::VBlankClock clock;
+    clock.period = refreshPeriod_;
+    clock.last = lastFlip_;
+
+    // a relative wait for 0 vblanks returns the last one right away; its
+    // timestamp is CLOCK_MONOTONIC, the clock steady_clock reads
+    drmVBlank vblank{};
+    vblank.request.type = static_cast<drmVBlankSeqType>(
+        DRM_VBLANK_RELATIVE | ((crtcIndex_ << DRM_VBLANK_HIGH_CRTC_SHIFT) & DRM_VBLANK_HIGH_CRTC_MASK));
+    vblank.request.sequence = 0;
+    if(fd_ >= 0 && drmWaitVBlank(fd_, &vblank) == 0)
+    {
+        clock.last = FramePacer::Clock::time_point(std::chrono::seconds(vblank.reply.tval_sec)
+                                                   + std::chrono::microseconds(vblank.reply.tval_usec));
+    }
+
+    return clock;
+}
+
+void DrmPresenter::setOverlay(VideoOverlay::Pointer overlay)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    overlay_ = std::move(overlay);
+    overlayGeneration_ = 0;
+}
+
+bool DrmPresenter::addOverlay(drmModeAtomicReq* request)
+{
+    if(overlay_ == nullptr || overlayDisabled_ || !overlay_->fetch(overlayGeneration_, overlayImage_))
+    {
+        return false;
+    }
+
+    if(overlayImage_.width == 0 || overlayImage_.height == 0 || overlayImage_.pixels.size() < overlayImage_.width * overlayImage_.height)
+    {
+        if(!overlayVisible_)
+        {
+            return false;
+        }
+
+        drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.fbId, 0);
+        drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.crtcId, 0);
+        overlayVisible_ = false;
+        return true;
+    }
+
+    if(overlayPlaneId_ == 0)
+    {
+        overlayPlaneId_ = this->findFreePlane(DRM_FORMAT_ARGB8888, planeId_);
+        if(overlayPlaneId_ == 0)
+        {
+            OPENAUTO_LOG(warning) << "[DrmPresenter] no second overlay plane with ARGB8888, overlay not shown.";
+            overlayDisabled_ = true;
+            return false;
+        }
+
+        this->readPlaneProperties(overlayPlaneId_, overlayProperties_);
+        const auto zposId = this->propertyId(overlayPlaneId_, DRM_MODE_OBJECT_PLANE, "zpos");
+        drmModePropertyRes* zpos = zposId != 0 ? drmModeGetProperty(fd_, zposId) : nullptr;
+        overlayProperties_.zpos = zpos != nullptr && !(zpos->flags & DRM_MODE_PROP_IMMUTABLE) ? zposId : 0;
+        drmModeFreeProperty(zpos);
+
+        OPENAUTO_LOG(info) << "[DrmPresenter] overlay plane " << overlayPlaneId_;
+    }
+
+    // whatever does not fit next to the margin is cut off
+    const auto width = std::min(overlayImage_.width, displayWidth_ > cOverlayMargin ? displayWidth_ - cOverlayMargin : 0);
+    const auto height = std::min(overlayImage_.height, displayHeight_ > cOverlayMargin ? displayHeight_ - cOverlayMargin : 0);
+    if(width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    if((overlayBuffers_[0].width != width || overlayBuffers_[0].height != height) && !this->createOverlayBuffers(width, height))
+    {
+        overlayDisabled_ = true;
+        return false;
+    }
+
+    auto& buffer = overlayBuffers_[overlayBack_];
+    for(uint32_t row = 0; row < height; ++row)
+    {
+        std::memcpy(static_cast<uint8_t*>(buffer.map) + row * buffer.pitch,
+                    overlayImage_.pixels.data() + row * overlayImage_.width, width * sizeof(uint32_t));
+    }
+
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.fbId, buffer.framebuffer);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.crtcId, crtcId_);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.srcX, 0);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.srcY, 0);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.srcW, static_cast<uint64_t>(width) << 16);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.srcH, static_cast<uint64_t>(height) << 16);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.crtcX, cOverlayMargin);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.crtcY, cOverlayMargin);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.crtcW, width);
+    drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.crtcH, height);
+    if(overlayProperties_.zpos != 0)
+    {
+        drmModeAtomicAddProperty(request, overlayPlaneId_, overlayProperties_.zpos, zPosition_ + 1);
+    }
+
+    overlayVisible_ = true;
+    return true;
+}
+
+bool DrmPresenter::createOverlayBuffers(uint32_t width, uint32_t height)
+{
+    this->destroyOverlayBuffers();
+
+    for(auto& buffer: overlayBuffers_)
+    {
+        drm_mode_create_dumb create{};
+        create.width = width;
+        create.height = height;
+        create.bpp = 32;
+        if(drmIoctl(fd_, DRM_IOCTL_MODE_CREATE_DUMB, &create) != 0)
+        {
+            OPENAUTO_LOG(error) << "[DrmPresenter] unable to allocate overlay buffer: " << std::strerror(errno);
+            this->destroyOverlayBuffers();
+            return false;
+        }
+
+        buffer.handle = create.handle;
+        buffer.pitch = create.pitch;
+        buffer.size = create.size;
+
+        const uint32_t handles[4] = {create.handle};
+        const uint32_t pitches[4] = {create.pitch};
+        const uint32_t offsets[4] = {};
+        drm_mode_map_dumb map{};
+        map.handle = create.handle;
+
+        if(drmModeAddFB2(fd_, width, height, DRM_FORMAT_ARGB8888, handles, pitches, offsets, &buffer.framebuffer, 0) != 0
+           || drmIoctl(fd_, DRM_IOCTL_MODE_MAP_DUMB, &map) != 0)
+        {
+            OPENAUTO_LOG(error) << "[DrmPresenter] unable to set up overlay buffer: " << std::strerror(errno);
+            this->destroyOverlayBuffers();
+            return false;
+        }
+
+        buffer.map = mmap(nullptr, buffer.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, map.offset);
+        if(buffer.map == MAP_FAILED)
+        {
+            buffer.map = nullptr;
+            OPENAUTO_LOG(error) << "[DrmPresenter] unable to map overlay buffer: " << std::strerror(errno);
+            this->destroyOverlayBuffers();
+            return false;
+        }
+
+        buffer.width = width;
+        buffer.height = height;
+    }
+
+    return true;
+}
+
+void DrmPresenter::destroyOverlayBuffers()
+{
+    for(auto& buffer: overlayBuffers_)
+    {
+        if(buffer.map != nullptr)
+        {
+            munmap(buffer.map, buffer.size);
+        }
+        if(buffer.framebuffer != 0)
+        {
+            drmModeRmFB(fd_, buffer.framebuffer);
+        }
+        if(buffer.handle != 0)
+        {
+            drm_mode_destroy_dumb destroy{};
+            destroy.handle = buffer.handle;
+            drmIoctl(fd_, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+        }
+
+        buffer = OverlayBuffer();
+    }
+
+    overlayBack_ = 0;
+}
+
+void DrmPresenter::setContentRect(const QRect& contentRect)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    contentRect_ = contentRect;
+    OPENAUTO_LOG(info) << "[DrmPresenter] content: " << contentRect.width() << "x" << contentRect.height()
+                       << " at " << contentRect.x() << "," << contentRect.y();
+}
+
+QRect DrmPresenter::getDisplayGeometry() const
+{
+    return QRect(0, 0, static_cast<int>(displayWidth_), static_cast<int>(displayHeight_));
+}
+
+uint64_t DrmPresenter::getPresentedFrameCount() const
+{
+    return presentedFrames_;
+}
+
+uint32_t DrmPresenter::getPlaneId() const
+{
+    return planeId_;
+}
+
+uint32_t DrmPresenter::getOverlayPlaneId() const
+{
+    return overlayPlaneId_;
+}
+
+uint64_t DrmPresenter::getZPosition() const
+{
+    return zPosition_;
+}
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,225 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_FFMPEG
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <f1x/openauto/autoapp/Projection/FFmpegDecoder.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+extern "C"
+{
+#include <libavutil/error.h>
+}
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// roughly every 10 seconds at 30 fps
+constexpr uint64_t cReportInterval = 300;
+
+std::string errorString(int error)
+{
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(error, buffer, sizeof(buffer));
+    return buffer;
+}
+
+}
+
+FFmpegDecoder::FFmpegDecoder()
+    : context_(nullptr)
+    , packet_(nullptr)
+    , frame_(nullptr)
+{
+}
+
+FFmpegDecoder::~FFmpegDecoder()
+{
+    this->close();
+}
+
+bool FFmpegDecoder::open(AVCodecID codecId, int threadCount, bool frameThreading)
+{
+    this->close();
+
+    const AVCodec* codec = avcodec_find_decoder(codecId);
+    if(codec == nullptr)
+    {
+        OPENAUTO_LOG(error) << "[FFmpegDecoder] no decoder for codec id " << codecId;
+        return false;
+    }
+
+    context_ = avcodec_alloc_context3(codec);
+    packet_ = av_packet_alloc();
+    frame_ = av_frame_alloc();
+    if(context_ == nullptr || packet_ == nullptr || frame_ == nullptr)
+    {
+        this->close();
+        return false;
+    }
+
+    if(threadCount <= 0)
+    {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    context_->thread_count = threadCount;
+    context_->thread_type = frameThreading ? FF_THREAD_FRAME : FF_THREAD_SLICE;
+    context_->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    context_->flags2 |= AV_CODEC_FLAG2_FAST;
+
+    const auto result = avcodec_open2(context_, codec, nullptr);
+    if(result < 0)
+    {
+        OPENAUTO_LOG(error) << "[FFmpegDecoder] avcodec_open2 failed: " << errorString(result);
+        this->close();
+        return false;
+    }
+
+    statistics_ = Statistics();
+    window_ = Statistics();
+
+    OPENAUTO_LOG(info) << "[FFmpegDecoder] " << codec->name << " opened, threads: " << context_->thread_count
+                       << (frameThreading ? " (frame)" : " (slice)");
+    return true;
+}
+
+bool FFmpegDecoder::decode(uint64_t timestamp, const uint8_t* data, size_t size, const FrameHandler& handler)
+{
+    if(context_ == nullptr)
+    {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    // the packet only borrows the buffer, libavcodec copies what it has to keep
+    packet_->data = const_cast<uint8_t*>(data);
+    packet_->size = static_cast<int>(size);
+    packet_->pts = static_cast<int64_t>(timestamp);
+
+    auto result = avcodec_send_packet(context_, packet_);
+    if(result == AVERROR(EAGAIN))
+    {
+        // finished frames have to be taken out before the decoder accepts the packet
+        this->receiveFrames(begin, handler);
+        result = avcodec_send_packet(context_, packet_);
+    }
+    av_packet_unref(packet_);
+
+    if(result < 0)
+    {
+        ++statistics_.errors;
+        OPENAUTO_LOG(debug) << "[FFmpegDecoder] avcodec_send_packet failed: " << errorString(result);
+        return false;
+    }
+
+    this->receiveFrames(begin, handler);
+    return true;
+}
+
+void FFmpegDecoder::receiveFrames(std::chrono::steady_clock::time_point begin, const FrameHandler& handler)
+{
+    for(;;)
+    {
+        const auto result = avcodec_receive_frame(context_, frame_);
+        if(result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+        {
+            break;
+        }
+        else if(result < 0)
+        {
+            ++statistics_.errors;
+            OPENAUTO_LOG(debug) << "[FFmpegDecoder] avcodec_receive_frame failed: " << errorString(result);
+            break;
+        }
+
+        // submission to picture, whatever the handler does with it is not included
+        const auto elapsed = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+
+        for(auto* statistics : {&statistics_, &window_})
+        {
+            ++statistics->frames;
+            statistics->totalMicroseconds += elapsed;
+            statistics->maxMicroseconds = std::max(statistics->maxMicroseconds, elapsed);
+        }
+
+        if(handler)
+        {
+            handler(frame_);
+        }
+        av_frame_unref(frame_);
+
+        if(window_.frames >= cReportInterval)
+        {
+            this->report();
+        }
+    }
+}
+
+void FFmpegDecoder::report()
+{
+    OPENAUTO_LOG(info) << "[FFmpegDecoder] decode time avg: " << (window_.totalMicroseconds / window_.frames) / 1000.0
+                       << " ms, max: " << window_.maxMicroseconds / 1000.0
+                       << " ms, frames: " << statistics_.frames << ", errors: " << statistics_.errors;
+    window_ = Statistics();
+}
+
+void FFmpegDecoder::close()
+{
+    if(context_ != nullptr && statistics_.frames > 0)
+    {
+        OPENAUTO_LOG(info) << "[FFmpegDecoder] decoded frames: " << statistics_.frames
+                           << ", avg decode time: " << (statistics_.totalMicroseconds / statistics_.frames) / 1000.0 << " ms"
+                           << ", max: " << statistics_.maxMicroseconds / 1000.0 << " ms";
+    }
+
+    av_frame_free(&frame_);
+    av_packet_free(&packet_);
+    avcodec_free_context(&context_);
+}
+
+bool FFmpegDecoder::isOpen() const
+{
+    return context_ != nullptr;
+}
+
+FFmpegDecoder::Statistics FFmpegDecoder::getStatistics() const
+{
+    return statistics_;
+}
+
+}
+}
+}
+}
+
+#endif
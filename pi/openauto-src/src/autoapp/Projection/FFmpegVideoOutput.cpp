@@ -0,0 +1,480 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_FFMPEG
+
+#include <QApplication>
+#include <QPainter>
+#include <QScreen>
+#include <f1x/openauto/autoapp/Projection/FFmpegVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+extern "C"
+{
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// a shorter session says little about the sustained throughput
+constexpr uint64_t cMinimumMeasuredFrames = 300;
+
+AVCodecID codecId(aap_protobuf::service::media::shared::message::MediaCodecType codec)
+{
+    return codec == aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265 ? AV_CODEC_ID_HEVC : AV_CODEC_ID_H264;
+}
+
+bool isH264(const VideoMode& mode)
+{
+    return codecId(mode.codec) == AV_CODEC_ID_H264;
+}
+
+// plane pointers of the part of frame starting at x, y (chroma aligned)
+void cropPlanes(const AVFrame* frame, int x, int y, const uint8_t* planes[4])
+{
+    const auto* descriptor = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    for(int plane = 0; plane < 4; ++plane)
+    {
+        planes[plane] = frame->data[plane];
+        if(descriptor == nullptr || planes[plane] == nullptr)
+        {
+            continue;
+        }
+
+        // bytes per pixel of the plane, from the first component stored in it
+        int step = 0;
+        for(int component = 0; component < descriptor->nb_components && step == 0; ++component)
+        {
+            if(descriptor->comp[component].plane == plane)
+            {
+                step = descriptor->comp[component].step;
+            }
+        }
+
+        const bool chroma = (plane == 1 || plane == 2) && (descriptor->flags & AV_PIX_FMT_FLAG_RGB) == 0;
+        const int planeX = chroma ? x >> descriptor->log2_chroma_w : x;
+        const int planeY = chroma ? y >> descriptor->log2_chroma_h : y;
+        planes[plane] += planeY * frame->linesize[plane] + planeX * step;
+    }
+}
+
+}
+
+class FFmpegVideoOutput::FrameWidget: public QWidget
+{
+public:
+    FrameWidget()
+    {
+        this->setAttribute(Qt::WA_OpaquePaintEvent, true);
+        this->setAttribute(Qt::WA_NoSystemBackground, true);
+    }
+
+    void setFrame(QImage frame)
+    {
+        frame_ = std::move(frame);
+        this->update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent*) override
+    {
+        QPainter painter(this);
+        if(frame_.isNull())
+        {
+            painter.fillRect(this->rect(), Qt::black);
+            return;
+        }
+
+        // converted to the size it has on screen unless the widget was resized since
+        const auto target = VideoGeometry::displayRect(frame_.width(), frame_.height(), this->width(), this->height());
+        if(target != this->rect())
+        {
+            painter.fillRect(this->rect(), Qt::black);
+        }
+        painter.drawImage(target, frame_);
+    }
+
+private:
+    QImage frame_;
+};
+
+FFmpegVideoOutput::FFmpegVideoOutput(configuration::IConfiguration::Pointer configuration)
+    : VideoOutput(std::move(configuration))
+    , framePacing_(configuration_->getVideoFramePacing())
+    , refreshPeriod_(std::chrono::microseconds(16667))
+    , scaler_(nullptr)
+    , framePending_(false)
+    , hidden_(false)
+{
+    this->moveToThread(QApplication::instance()->thread());
+    connect(this, &FFmpegVideoOutput::startPlayback, this, &FFmpegVideoOutput::onStartPlayback, Qt::QueuedConnection);
+    connect(this, &FFmpegVideoOutput::stopPlayback, this, &FFmpegVideoOutput::onStopPlayback, Qt::QueuedConnection);
+    connect(this, &FFmpegVideoOutput::frameReady, this, &FFmpegVideoOutput::onFrameReady, Qt::QueuedConnection);
+    QMetaObject::invokeMethod(this, "createVideoOutput", Qt::BlockingQueuedConnection);
+}
+
+FFmpegVideoOutput::~FFmpegVideoOutput()
+{
+    sws_freeContext(scaler_);
+}
+
+void FFmpegVideoOutput::createVideoOutput()
+{
+    OPENAUTO_LOG(info) << "[FFmpegVideoOutput] createVideoOutput()";
+    videoWidget_ = std::make_unique<FrameWidget>();
+    presentTimer_ = std::make_unique<QTimer>();
+    presentTimer_->setSingleShot(true);
+    presentTimer_->setTimerType(Qt::PreciseTimer);
+    connect(presentTimer_.get(), &QTimer::timeout, this, &FFmpegVideoOutput::onPresentTimeout);
+}
+
+bool FFmpegVideoOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    presentationPolicy_.reset();
+    framePacer_.reset();
+    framePacer_.setMediaClock(mediaClock_);
+    hidden_ = false;
+    const auto mode = this->getVideoMode();
+    if(!decoder_.open(codecId(mode.codec)))
+    {
+        return false;
+    }
+
+    if(isH264(mode) && parameterSets_.isComplete())
+    {
+        OPENAUTO_LOG(info) << "[FFmpegVideoOutput] priming decoder with cached SPS/PPS: "
+                           << H264Parser::describe(parameterSets_.getSequenceInfo());
+        const auto& annexB = parameterSets_.getAnnexB();
+        decoder_.decode(0, annexB.data(), annexB.size(), FFmpegDecoder::FrameHandler());
+    }
+
+    return true;
+}
+
+bool FFmpegVideoOutput::init()
+{
+    emit startPlayback();
+    return true;
+}
+
+void FFmpegVideoOutput::stop()
+{
+    emit stopPlayback();
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    OPENAUTO_LOG(info) << "[FFmpegVideoOutput] presentation: " << presentationPolicy_.describe();
+    if(framePacing_)
+    {
+        OPENAUTO_LOG(info) << "[FFmpegVideoOutput] pacing: " << framePacer_.describe();
+    }
+    this->storeThroughput();
+    decoder_.close();
+}
+
+VideoCapabilities FFmpegVideoOutput::getCapabilities()
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VideoCapabilities::resolutionSize(configuration_->getVideoResolution(), width, height);
+    const uint64_t configuredPixelRate = static_cast<uint64_t>(width) * height
+                                         * VideoCapabilities::framesPerSecond(configuration_->getVideoFPS());
+
+    VideoCapabilities capabilities;
+    if(avcodec_find_decoder(AV_CODEC_ID_H264) != nullptr)
+    {
+        DecoderCapability decoder;
+        decoder.maxWidth = 3840;
+        decoder.maxHeight = 2160;
+        decoder.maxPixelRate = configuredPixelRate;
+        capabilities.add(decoder);
+    }
+
+    if(avcodec_find_decoder(AV_CODEC_ID_HEVC) != nullptr)
+    {
+        // H.265 costs roughly twice the time per pixel in software
+        DecoderCapability decoder;
+        decoder.codec = aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265;
+        decoder.maxWidth = 3840;
+        decoder.maxHeight = 2160;
+        decoder.maxPixelRate = configuredPixelRate / 2;
+        capabilities.add(decoder);
+    }
+
+    capabilities.loadMeasurements();
+    return capabilities;
+}
+
+void FFmpegVideoOutput::setVideoMode(const VideoMode& mode)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    const auto previous = this->getVideoMode();
+    VideoOutput::setVideoMode(mode);
+
+    if(decoder_.isOpen() && codecId(mode.codec) != codecId(previous.codec))
+    {
+        decoder_.close();
+        decoder_.open(codecId(mode.codec));
+    }
+}
+
+void FFmpegVideoOutput::storeThroughput()
+{
+    const auto statistics = decoder_.getStatistics();
+    if(statistics.frames < cMinimumMeasuredFrames || statistics.totalMicroseconds == 0)
+    {
+        return;
+    }
+
+    const auto mode = this->getVideoMode();
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VideoCapabilities::resolutionSize(mode.resolution, width, height);
+    VideoCapabilities::storeMeasurement(mode.codec, statistics.frames * width * height * 1000000 / statistics.totalMicroseconds);
+}
+
+bool FFmpegVideoOutput::suspend()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        if(!decoder_.isOpen())
+        {
+            return false;
+        }
+
+        hidden_ = true;
+    }
+
+    emit stopPlayback();
+    OPENAUTO_LOG(info) << "[FFmpegVideoOutput] suspended, decoder kept alive.";
+    return true;
+}
+
+void FFmpegVideoOutput::resume()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        if(!decoder_.isOpen())
+        {
+            return;
+        }
+
+        presentationPolicy_.reset();
+        if(isH264(this->getVideoMode()) && parameterSets_.isComplete())
+        {
+            OPENAUTO_LOG(info) << "[FFmpegVideoOutput] replaying cached SPS/PPS: "
+                               << H264Parser::describe(parameterSets_.getSequenceInfo());
+            const auto& annexB = parameterSets_.getAnnexB();
+            decoder_.decode(0, annexB.data(), annexB.size(), FFmpegDecoder::FrameHandler());
+        }
+
+        this->startResumeTimer();
+        hidden_ = false;
+    }
+
+    emit startPlayback();
+    OPENAUTO_LOG(info) << "[FFmpegVideoOutput] resumed.";
+}
+
+void FFmpegVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    const auto info = isH264(this->getVideoMode()) ? PresentationPolicy::inspect(buffer.cdata, buffer.size, &parameterSets_)
+                                                   : H264Parser::inspectH265(buffer.cdata, buffer.size);
+    if(info.sequenceChanged)
+    {
+        OPENAUTO_LOG(info) << "[FFmpegVideoOutput] stream: " << H264Parser::describe(parameterSets_.getSequenceInfo());
+    }
+
+    if(presentationPolicy_.onFrame(timestamp, info) == PresentationDecision::DROP)
+    {
+        this->onFrameDropped();
+        return;
+    }
+
+    decoder_.decode(timestamp, buffer.cdata, buffer.size, [this](const AVFrame* frame) { this->convertFrame(frame); });
+}
+
+void FFmpegVideoOutput::convertFrame(const AVFrame* frame)
+{
+    if(hidden_)
+    {
+        return;
+    }
+
+    // the margins are not converted at all, the content goes straight to its size on screen
+    const auto mode = this->getVideoMode();
+    uint32_t codecWidth = 0;
+    uint32_t codecHeight = 0;
+    VideoCapabilities::resolutionSize(mode.resolution, codecWidth, codecHeight);
+    QRect source(0, 0, frame->width, frame->height);
+    if(static_cast<uint32_t>(frame->width) == codecWidth && static_cast<uint32_t>(frame->height) == codecHeight)
+    {
+        source = VideoGeometry::contentRect(codecWidth, codecHeight, this->getVideoMargins(mode));
+    }
+
+    const QSize size = outputSize_.isEmpty()
+                       ? source.size()
+                       : VideoGeometry::displayRect(source.width(), source.height(), outputSize_.width(), outputSize_.height()).size();
+
+    scaler_ = sws_getCachedContext(scaler_, source.width(), source.height(), static_cast<AVPixelFormat>(frame->format),
+                                   size.width(), size.height(), AV_PIX_FMT_RGB32, SWS_FAST_BILINEAR,
+                                   nullptr, nullptr, nullptr);
+    if(scaler_ == nullptr)
+    {
+        OPENAUTO_LOG(error) << "[FFmpegVideoOutput] unsupported frame format: " << frame->format;
+        return;
+    }
+
+    // AV_PIX_FMT_RGB32 is native endian 0xAARRGGBB, the layout of QImage::Format_RGB32
+    QImage image(size, QImage::Format_RGB32);
+    uint8_t* destination[] = {image.bits()};
+    const int destinationStride[] = {image.bytesPerLine()};
+    const uint8_t* planes[4];
+    cropPlanes(frame, source.x(), source.y(), planes);
+    sws_scale(scaler_, planes, frame->linesize, 0, source.height(), destination, destinationStride);
+
+    auto due = FramePacer::Clock::now();
+    if(framePacing_)
+    {
+        // Qt draws on the refresh after the update, so the frame is handed over one refresh early
+        FramePacer::VBlankClock vblank;
+        vblank.period = refreshPeriod_;
+        due = framePacer_.schedule(static_cast<uint64_t>(frame->pts), due, vblank) - vblank.period;
+    }
+
+    {
+        std::lock_guard<decltype(frameMutex_)> lock(frameMutex_);
+        pendingFrame_ = std::move(image);
+        pendingDue_ = due;
+    }
+
+    // one queued notification at a time, a frame that was not shown yet is simply replaced
+    if(!framePending_.exchange(true))
+    {
+        emit frameReady();
+    }
+}
+
+FFmpegDecoder::Statistics FFmpegVideoOutput::getDecodeStatistics()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return decoder_.getStatistics();
+}
+
+void FFmpegVideoOutput::onStartPlayback()
+{
+    videoWidget_->setFocus();
+    videoWidget_->setWindowFlags(Qt::Window | Qt::FramelessWindowHint);
+    videoWidget_->raise();
+    videoWidget_->showFullScreen();
+    videoWidget_->activateWindow();
+
+    // the fullscreen resize may not have happened yet, the screen size is what it will be
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    outputSize_ = QGuiApplication::primaryScreen()->size();
+    const auto refreshRate = QGuiApplication::primaryScreen()->refreshRate();
+    if(refreshRate > 1.0)
+    {
+        refreshPeriod_ = std::chrono::duration_cast<FramePacer::Clock::duration>(std::chrono::duration<double>(1.0 / refreshRate));
+    }
+    OPENAUTO_LOG(info) << "[FFmpegVideoOutput] output size: " << outputSize_.width() << "x" << outputSize_.height();
+}
+
+void FFmpegVideoOutput::onStopPlayback()
+{
+    videoWidget_->hide();
+    videoWidget_->clearFocus();
+    videoWidget_->setFrame(QImage());
+    presentTimer_->stop();
+    scheduledFrame_ = QImage();
+
+    std::lock_guard<decltype(frameMutex_)> lock(frameMutex_);
+    pendingFrame_ = QImage();
+}
+
+void FFmpegVideoOutput::onFrameReady()
+{
+    QImage frame;
+    FramePacer::Clock::time_point due;
+    {
+        std::lock_guard<decltype(frameMutex_)> lock(frameMutex_);
+        frame = std::move(pendingFrame_);
+        due = pendingDue_;
+        framePending_ = false;
+    }
+
+    if(frame.isNull())
+    {
+        return;
+    }
+
+    // the next picture is ready, the one still waiting is due by now
+    if(!scheduledFrame_.isNull())
+    {
+        presentTimer_->stop();
+        this->showFrame(std::move(scheduledFrame_));
+        scheduledFrame_ = QImage();
+    }
+
+    const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - FramePacer::Clock::now());
+    if(wait.count() > 0)
+    {
+        scheduledFrame_ = std::move(frame);
+        presentTimer_->start(static_cast<int>(wait.count()));
+    }
+    else
+    {
+        this->showFrame(std::move(frame));
+    }
+}
+
+void FFmpegVideoOutput::onPresentTimeout()
+{
+    if(!scheduledFrame_.isNull())
+    {
+        this->showFrame(std::move(scheduledFrame_));
+        scheduledFrame_ = QImage();
+    }
+}
+
+void FFmpegVideoOutput::showFrame(QImage frame)
+{
+    videoWidget_->setFrame(std::move(frame));
+    this->onPictureShown();
+}
+
+}
+}
+}
+}
+
+#endif
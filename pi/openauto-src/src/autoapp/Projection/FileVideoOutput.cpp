@@ -0,0 +1,98 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <f1x/openauto/autoapp/Projection/FileVideoOutput.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+const std::string FileVideoOutput::cIndexSuffix = ".index";
+
+FileVideoOutput::FileVideoOutput(std::string path,
+                                 aap_protobuf::service::media::sink::message::VideoCodecResolutionType resolution,
+                                 aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate,
+                                 size_t screenDPI)
+    : NullVideoOutput(resolution, frameRate, screenDPI)
+    , path_(std::move(path))
+    , offset_(0)
+{
+}
+
+bool FileVideoOutput::open()
+{
+    std::lock_guard<decltype(fileMutex_)> lock(fileMutex_);
+
+    stream_.close();
+    index_.close();
+    stream_.open(path_, std::ios::binary | std::ios::trunc);
+    index_.open(path_ + cIndexSuffix, std::ios::trunc);
+    offset_ = 0;
+
+    if(!stream_.is_open() || !index_.is_open())
+    {
+        OPENAUTO_LOG(error) << "[FileVideoOutput] cannot write " << path_;
+        stream_.close();
+        index_.close();
+        return false;
+    }
+
+    OPENAUTO_LOG(info) << "[FileVideoOutput] writing to " << path_;
+    return NullVideoOutput::open();
+}
+
+void FileVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    {
+        std::lock_guard<decltype(fileMutex_)> lock(fileMutex_);
+        if(stream_.is_open())
+        {
+            stream_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+            index_ << timestamp << " " << offset_ << " " << buffer.size << "\n";
+            offset_ += buffer.size;
+        }
+    }
+
+    NullVideoOutput::write(timestamp, buffer);
+}
+
+void FileVideoOutput::stop()
+{
+    {
+        std::lock_guard<decltype(fileMutex_)> lock(fileMutex_);
+        if(stream_.is_open())
+        {
+            OPENAUTO_LOG(info) << "[FileVideoOutput] wrote " << offset_ << " bytes to " << path_;
+        }
+        stream_.close();
+        index_.close();
+    }
+
+    NullVideoOutput::stop();
+}
+
+}
+}
+}
+}
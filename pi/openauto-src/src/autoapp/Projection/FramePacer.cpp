@@ -0,0 +1,191 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <f1x/openauto/autoapp/Projection/FramePacer.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// timestamps that jump further than this belong to a restarted stream
+constexpr uint64_t cResyncGap = 1000000;
+
+int64_t microseconds(FramePacer::Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+// first grid point at or after time
+FramePacer::Clock::time_point alignUp(FramePacer::Clock::time_point time, FramePacer::Clock::time_point origin,
+                                      FramePacer::Clock::duration period)
+{
+    const auto elapsed = (time - origin).count();
+    auto steps = elapsed / period.count();
+    if(steps * period.count() < elapsed)
+    {
+        ++steps;
+    }
+    return origin + steps * period;
+}
+
+}
+
+constexpr std::chrono::milliseconds FramePacer::cMaxSyncOffset;
+
+FramePacer::FramePacer(std::chrono::milliseconds maxDelay)
+    : maxDelay_(std::chrono::duration_cast<std::chrono::microseconds>(maxDelay).count())
+{
+    this->reset();
+}
+
+FramePacer::Clock::time_point FramePacer::schedule(uint64_t timestamp, Clock::time_point now, const VBlankClock& vblank)
+{
+    if(offsetCount_ > 0 && (timestamp < lastTimestamp_ || timestamp - lastTimestamp_ > cResyncGap))
+    {
+        const auto statistics = statistics_;
+        this->reset();
+        statistics_ = statistics;
+        ++statistics_.resyncs;
+    }
+    const auto elapsed = offsetCount_ > 0 ? timestamp - lastTimestamp_ : 0;
+    lastTimestamp_ = timestamp;
+    ++statistics_.frames;
+
+    const auto offset = microseconds(now) - static_cast<int64_t>(timestamp);
+    this->addOffset(offset);
+
+    // peak hold with a decay of 1/64 per frame (a few seconds at 30 fps)
+    const auto delay = offset - baseOffset_;
+    margin_ = std::max(delay, margin_ - margin_ / 64);
+    if(margin_ > maxDelay_)
+    {
+        margin_ = maxDelay_;
+        if(delay > maxDelay_)
+        {
+            ++statistics_.late;
+        }
+    }
+
+    if(vblank.period <= Clock::duration::zero())
+    {
+        return now;
+    }
+
+    if(anchor_ == Clock::time_point())
+    {
+        anchor_ = now;
+    }
+
+    const auto origin = vblank.last != Clock::time_point() ? vblank.last : anchor_;
+    auto target = Clock::time_point(std::chrono::microseconds(static_cast<int64_t>(timestamp) + baseOffset_ + margin_));
+
+    // a video timeline unrelated to the one of the audio maps far off, or into the past
+    Clock::time_point audible;
+    if(mediaClock_ != nullptr && mediaClock_->map(timestamp, now, audible)
+       && audible > target - cMaxSyncOffset && audible < target + cMaxSyncOffset
+       && audible < now + cMaxSyncOffset)
+    {
+        target = audible;
+        ++statistics_.synced;
+    }
+    auto due = alignUp(target, origin, vblank.period);
+
+    if(lastDue_ != Clock::time_point())
+    {
+        // keep the cadence of the previous frames while the target stays within a
+        // refresh of it, so small margin changes do not make single frames jump
+        const auto period = std::chrono::duration_cast<std::chrono::microseconds>(vblank.period).count();
+        const auto steps = std::max<int64_t>(1, (static_cast<int64_t>(elapsed) + period / 2) / period);
+        const auto expected = lastDue_ + steps * vblank.period;
+
+        if(expected > target - vblank.period / 2 && expected < target + vblank.period * 3 / 2)
+        {
+            due = expected;
+        }
+        else if(due <= lastDue_ && lastDue_ <= now + std::chrono::microseconds(maxDelay_))
+        {
+            // two frames for one refresh: show the second one a refresh later,
+            // unless the stream outruns the display
+            due = lastDue_ + vblank.period;
+        }
+    }
+
+    due = std::max(due, alignUp(now + Clock::duration(1), origin, vblank.period));
+    lastDue_ = due;
+    return due;
+}
+
+void FramePacer::addOffset(int64_t offset)
+{
+    offsets_[offsetNext_] = offset;
+    offsetNext_ = (offsetNext_ + 1) % cWindow;
+    offsetCount_ = std::min(offsetCount_ + 1, cWindow);
+
+    // 128 compares per frame, cheaper than keeping a monotonic queue up to date
+    baseOffset_ = *std::min_element(offsets_.begin(), offsets_.begin() + offsetCount_);
+}
+
+void FramePacer::reset()
+{
+    offsetCount_ = 0;
+    offsetNext_ = 0;
+    baseOffset_ = 0;
+    margin_ = 0;
+    lastTimestamp_ = 0;
+    anchor_ = Clock::time_point();
+    lastDue_ = Clock::time_point();
+    statistics_ = Statistics();
+}
+
+void FramePacer::setMediaClock(MediaClock::Pointer clock)
+{
+    mediaClock_ = std::move(clock);
+}
+
+std::chrono::microseconds FramePacer::getMargin() const
+{
+    return std::chrono::microseconds(margin_);
+}
+
+FramePacer::Statistics FramePacer::getStatistics() const
+{
+    return statistics_;
+}
+
+std::string FramePacer::describe() const
+{
+    std::ostringstream stream;
+    stream << "frames: " << statistics_.frames << ", late: " << statistics_.late << ", resyncs: " << statistics_.resyncs
+           << ", audio synced: " << statistics_.synced << ", margin: " << margin_ / 1000.0 << " ms";
+    return stream.str();
+}
+
+}
+}
+}
+}
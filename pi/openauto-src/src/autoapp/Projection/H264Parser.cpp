@@ -0,0 +1,480 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <f1x/openauto/autoapp/Projection/H264Parser.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+constexpr uint8_t cStartCode[] = {0, 0, 0, 1};
+
+// Reads RBSP bits straight from the NAL payload, skipping emulation prevention bytes.
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, size_t size)
+        : data_(data)
+        , size_(size)
+        , offset_(0)
+        , bit_(0)
+        , zeros_(0)
+        , failed_(false)
+    {
+    }
+
+    uint32_t readBit()
+    {
+        if(bit_ == 0)
+        {
+            if(offset_ >= size_)
+            {
+                failed_ = true;
+                return 0;
+            }
+
+            if(zeros_ >= 2 && data_[offset_] == 0x03)
+            {
+                zeros_ = 0;
+                if(++offset_ >= size_)
+                {
+                    failed_ = true;
+                    return 0;
+                }
+            }
+
+            zeros_ = data_[offset_] == 0 ? zeros_ + 1 : 0;
+        }
+
+        const uint32_t value = (data_[offset_] >> (7 - bit_)) & 0x01;
+        if(++bit_ == 8)
+        {
+            bit_ = 0;
+            ++offset_;
+        }
+
+        return value;
+    }
+
+    uint32_t readBits(unsigned count)
+    {
+        uint32_t value = 0;
+        while(count-- > 0)
+        {
+            value = (value << 1) | this->readBit();
+        }
+        return value;
+    }
+
+    uint32_t readUnsignedExpGolomb()
+    {
+        unsigned leadingZeros = 0;
+        while(this->readBit() == 0)
+        {
+            if(failed_ || ++leadingZeros > 31)
+            {
+                failed_ = true;
+                return 0;
+            }
+        }
+
+        return leadingZeros == 0 ? 0 : (1u << leadingZeros) - 1 + this->readBits(leadingZeros);
+    }
+
+    int32_t readSignedExpGolomb()
+    {
+        const auto value = this->readUnsignedExpGolomb();
+        return value & 0x01 ? static_cast<int32_t>((value + 1) / 2) : -static_cast<int32_t>(value / 2);
+    }
+
+    bool failed() const
+    {
+        return failed_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+    unsigned bit_;
+    unsigned zeros_;
+    bool failed_;
+};
+
+void skipScalingList(BitReader& reader, unsigned size)
+{
+    int32_t lastScale = 8;
+    int32_t nextScale = 8;
+    for(unsigned i = 0; i < size && nextScale != 0; ++i)
+    {
+        nextScale = (lastScale + reader.readSignedExpGolomb() + 256) % 256;
+        lastScale = nextScale == 0 ? lastScale : nextScale;
+    }
+}
+
+bool hasChromaFormat(uint8_t profileIdc)
+{
+    switch(profileIdc)
+    {
+    case 100: case 110: case 122: case 244: case 44: case 83:
+    case 86: case 118: case 128: case 138: case 139: case 134: case 135:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+size_t H264Parser::findStartCode(const uint8_t* data, size_t size, size_t offset)
+{
+    while(offset + 3 <= size)
+    {
+        const auto* zero = static_cast<const uint8_t*>(std::memchr(data + offset, 0, size - offset - 2));
+        if(zero == nullptr)
+        {
+            break;
+        }
+
+        offset = static_cast<size_t>(zero - data);
+        if(zero[1] == 0 && zero[2] == 1)
+        {
+            return offset + 3;
+        }
+
+        ++offset;
+    }
+
+    return size;
+}
+
+H264AccessUnitInfo H264Parser::inspect(const uint8_t* data, size_t size, H264ParameterSets* parameterSets)
+{
+    H264AccessUnitInfo info;
+
+    forEachNalUnit(data, size, [&](const H264NalUnit& nal) {
+        switch(nal.type)
+        {
+        case H264NalType::SLICE:
+        case H264NalType::SLICE_PARTITION_A:
+        case H264NalType::SLICE_IDR:
+        {
+            // every slice of a picture has the same type and nal_ref_idc, the first one is enough
+            info.hasSlice = true;
+            info.isIdr = nal.type == H264NalType::SLICE_IDR;
+            info.isReference = nal.refIdc != 0;
+
+            uint32_t firstMbInSlice = 0;
+            if(parseFirstMbInSlice(nal, firstMbInSlice) && firstMbInSlice == 0)
+            {
+                info.isPictureStart = true;
+            }
+            return false;
+        }
+
+        case H264NalType::SPS:
+        case H264NalType::PPS:
+            info.hasParameterSets = true;
+            if(parameterSets != nullptr && parameterSets->update(nal))
+            {
+                info.sequenceChanged = true;
+            }
+            return true;
+
+        case H264NalType::ACCESS_UNIT_DELIMITER:
+            info.isPictureStart = true;
+            return true;
+
+        default:
+            return true;
+        }
+    });
+
+    return info;
+}
+
+H264AccessUnitInfo H264Parser::inspectH265(const uint8_t* data, size_t size)
+{
+    H264AccessUnitInfo info;
+
+    forEachNalUnit(data, size, [&](const H264NalUnit& nal) {
+        if(nal.size < 3)
+        {
+            return true;
+        }
+
+        const uint8_t type = (nal.data[0] >> 1) & 0x3F;
+        if(type < 32)
+        {
+            // IRAP pictures are 16..23; among 0..14 the even types are sub-layer non-reference pictures
+            info.hasSlice = true;
+            info.isIdr = type >= 16 && type <= 23;
+            info.isReference = type > 14 || type % 2 != 0;
+            info.isPictureStart = (nal.data[2] & 0x80) != 0;
+            return false;
+        }
+
+        switch(type)
+        {
+        case 32:
+        case 33:
+        case 34:
+            // VPS, SPS, PPS
+            info.hasParameterSets = true;
+            return true;
+
+        case 35:
+            // access unit delimiter
+            info.isPictureStart = true;
+            return true;
+
+        default:
+            return true;
+        }
+    });
+
+    return info;
+}
+
+bool H264Parser::parseSequenceParameterSet(const H264NalUnit& nal, H264SequenceInfo& info)
+{
+    if(nal.type != H264NalType::SPS || nal.size < 4)
+    {
+        return false;
+    }
+
+    BitReader reader(nal.data + 1, nal.size - 1);
+    H264SequenceInfo sequence;
+    sequence.profileIdc = static_cast<uint8_t>(reader.readBits(8));
+    sequence.constraintFlags = static_cast<uint8_t>(reader.readBits(8));
+    sequence.levelIdc = static_cast<uint8_t>(reader.readBits(8));
+    sequence.id = reader.readUnsignedExpGolomb();
+
+    bool separateColourPlane = false;
+    if(hasChromaFormat(sequence.profileIdc))
+    {
+        sequence.chromaFormatIdc = reader.readUnsignedExpGolomb();
+        if(sequence.chromaFormatIdc == 3)
+        {
+            separateColourPlane = reader.readBit() != 0;
+        }
+
+        reader.readUnsignedExpGolomb();     // bit_depth_luma_minus8
+        reader.readUnsignedExpGolomb();     // bit_depth_chroma_minus8
+        reader.readBit();                   // qpprime_y_zero_transform_bypass_flag
+
+        if(reader.readBit() != 0)           // seq_scaling_matrix_present_flag
+        {
+            const unsigned lists = sequence.chromaFormatIdc == 3 ? 12 : 8;
+            for(unsigned i = 0; i < lists; ++i)
+            {
+                if(reader.readBit() != 0)
+                {
+                    skipScalingList(reader, i < 6 ? 16 : 64);
+                }
+            }
+        }
+    }
+
+    reader.readUnsignedExpGolomb();         // log2_max_frame_num_minus4
+    const auto pictureOrderCountType = reader.readUnsignedExpGolomb();
+    if(pictureOrderCountType == 0)
+    {
+        reader.readUnsignedExpGolomb();     // log2_max_pic_order_cnt_lsb_minus4
+    }
+    else if(pictureOrderCountType == 1)
+    {
+        reader.readBit();                   // delta_pic_order_always_zero_flag
+        reader.readSignedExpGolomb();       // offset_for_non_ref_pic
+        reader.readSignedExpGolomb();       // offset_for_top_to_bottom_field
+        const auto cycle = reader.readUnsignedExpGolomb();
+        for(uint32_t i = 0; i < cycle && !reader.failed(); ++i)
+        {
+            reader.readSignedExpGolomb();
+        }
+    }
+
+    sequence.maxReferenceFrames = reader.readUnsignedExpGolomb();
+    reader.readBit();                       // gaps_in_frame_num_value_allowed_flag
+    const auto widthInMbs = reader.readUnsignedExpGolomb() + 1;
+    const auto heightInMapUnits = reader.readUnsignedExpGolomb() + 1;
+    sequence.frameMbsOnly = reader.readBit() != 0;
+    if(!sequence.frameMbsOnly)
+    {
+        reader.readBit();                   // mb_adaptive_frame_field_flag
+    }
+    reader.readBit();                       // direct_8x8_inference_flag
+
+    uint32_t cropLeft = 0, cropRight = 0, cropTop = 0, cropBottom = 0;
+    if(reader.readBit() != 0)
+    {
+        cropLeft = reader.readUnsignedExpGolomb();
+        cropRight = reader.readUnsignedExpGolomb();
+        cropTop = reader.readUnsignedExpGolomb();
+        cropBottom = reader.readUnsignedExpGolomb();
+    }
+
+    if(reader.failed())
+    {
+        return false;
+    }
+
+    // crop offsets are in chroma samples, and in field pairs for interlaced streams
+    const bool hasChroma = sequence.chromaFormatIdc != 0 && !separateColourPlane;
+    const uint32_t cropUnitX = hasChroma && sequence.chromaFormatIdc < 3 ? 2 : 1;
+    const uint32_t cropUnitY = (hasChroma && sequence.chromaFormatIdc == 1 ? 2 : 1) * (sequence.frameMbsOnly ? 1 : 2);
+    const uint32_t codedWidth = widthInMbs * 16;
+    const uint32_t codedHeight = heightInMapUnits * 16 * (sequence.frameMbsOnly ? 1 : 2);
+    const uint32_t cropWidth = (cropLeft + cropRight) * cropUnitX;
+    const uint32_t cropHeight = (cropTop + cropBottom) * cropUnitY;
+    if(cropWidth >= codedWidth || cropHeight >= codedHeight)
+    {
+        return false;
+    }
+
+    sequence.width = codedWidth - cropWidth;
+    sequence.height = codedHeight - cropHeight;
+    info = sequence;
+    return true;
+}
+
+bool H264Parser::parseFirstMbInSlice(const H264NalUnit& nal, uint32_t& firstMbInSlice)
+{
+    if(nal.size < 2)
+    {
+        return false;
+    }
+
+    BitReader reader(nal.data + 1, nal.size - 1);
+    firstMbInSlice = reader.readUnsignedExpGolomb();
+    return !reader.failed();
+}
+
+const char* H264Parser::profileName(uint8_t profileIdc)
+{
+    switch(profileIdc)
+    {
+    case 66: return "baseline";
+    case 77: return "main";
+    case 88: return "extended";
+    case 100: return "high";
+    case 110: return "high 10";
+    case 122: return "high 4:2:2";
+    case 244: return "high 4:4:4";
+    default: return "unknown";
+    }
+}
+
+std::string H264Parser::describe(const H264SequenceInfo& info)
+{
+    std::ostringstream stream;
+    stream << info.width << "x" << info.height << ", " << profileName(info.profileIdc) << " profile, level "
+           << info.levelIdc / 10 << "." << info.levelIdc % 10;
+    return stream.str();
+}
+
+bool H264ParameterSets::update(const H264NalUnit& nal)
+{
+    if(nal.type == H264NalType::PPS)
+    {
+        if(store(pps_, nal))
+        {
+            this->rebuild();
+        }
+        return false;
+    }
+
+    if(nal.type != H264NalType::SPS || !store(sps_, nal))
+    {
+        return false;
+    }
+
+    this->rebuild();
+    H264SequenceInfo sequenceInfo;
+    if(!H264Parser::parseSequenceParameterSet(nal, sequenceInfo))
+    {
+        // keep the bytes for the decoder, it may understand more than this parser
+        sequenceInfo_ = H264SequenceInfo();
+    }
+    else
+    {
+        sequenceInfo_ = sequenceInfo;
+    }
+
+    return true;
+}
+
+bool H264ParameterSets::store(aasdk::common::Data& target, const H264NalUnit& nal)
+{
+    if(target.size() == nal.size + sizeof(cStartCode)
+       && std::memcmp(target.data() + sizeof(cStartCode), nal.data, nal.size) == 0)
+    {
+        return false;
+    }
+
+    target.assign(std::begin(cStartCode), std::end(cStartCode));
+    target.insert(target.end(), nal.data, nal.data + nal.size);
+    return true;
+}
+
+void H264ParameterSets::clear()
+{
+    sps_.clear();
+    pps_.clear();
+    annexB_.clear();
+    sequenceInfo_ = H264SequenceInfo();
+}
+
+bool H264ParameterSets::isComplete() const
+{
+    return !sps_.empty() && !pps_.empty();
+}
+
+const H264SequenceInfo& H264ParameterSets::getSequenceInfo() const
+{
+    return sequenceInfo_;
+}
+
+const aasdk::common::Data& H264ParameterSets::getAnnexB() const
+{
+    return annexB_;
+}
+
+void H264ParameterSets::rebuild()
+{
+    annexB_.clear();
+    if(this->isComplete())
+    {
+        annexB_.insert(annexB_.end(), sps_.begin(), sps_.end());
+        annexB_.insert(annexB_.end(), pps_.begin(), pps_.end());
+    }
+}
+
+}
+}
+}
+}
@@ -16,9 +16,11 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <f1x/openauto/Common/Log.hpp>
 #include <f1x/openauto/autoapp/Projection/IInputDeviceEventHandler.hpp>
 #include <f1x/openauto/autoapp/Projection/InputDevice.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
 
 namespace f1x
 {
@@ -213,8 +215,13 @@ bool InputDevice::handleTouchEvent(QEvent* event)
     QMouseEvent* mouse = static_cast<QMouseEvent*>(event);
     if(event->type() == QEvent::MouseButtonRelease || mouse->buttons().testFlag(Qt::LeftButton))
     {
-        const uint32_t x = (static_cast<float>(mouse->pos().x()) / touchscreenGeometry_.width()) * displayGeometry_.width();
-        const uint32_t y = (static_cast<float>(mouse->pos().y()) / touchscreenGeometry_.height()) * displayGeometry_.height();
+        // the video content is shown in this part of the screen, touches on the bars next to it land on its edge
+        const auto area = VideoGeometry::displayRect(displayGeometry_.width(), displayGeometry_.height(),
+                                                     touchscreenGeometry_.width(), touchscreenGeometry_.height());
+        const auto areaX = std::clamp(mouse->pos().x() - area.x(), 0, std::max(area.width() - 1, 0));
+        const auto areaY = std::clamp(mouse->pos().y() - area.y(), 0, std::max(area.height() - 1, 0));
+        const uint32_t x = displayGeometry_.x() + (static_cast<float>(areaX) / area.width()) * displayGeometry_.width();
+        const uint32_t y = displayGeometry_.y() + (static_cast<float>(areaY) / area.height()) * displayGeometry_.height();
         eventHandler_->onTouchEvent({type, x, y, 0});
     }
 
@@ -231,6 +238,15 @@ QRect InputDevice::getTouchscreenGeometry() const
     return touchscreenGeometry_;
 }
 
+void InputDevice::setVideoGeometry(const QRect& videoGeometry)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    OPENAUTO_LOG(info) << "[InputDevice] video geometry: " << videoGeometry.width() << "x" << videoGeometry.height()
+                       << " at " << videoGeometry.x() << "," << videoGeometry.y();
+    displayGeometry_ = videoGeometry;
+}
+
 IInputDevice::ButtonCodes InputDevice::getSupportedButtonCodes() const
 {
     return configuration_->getButtonCodes();
@@ -0,0 +1,106 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// further off than any callback jitter: the timeline restarted
+constexpr int64_t cResyncThreshold = 100000;
+// 1/64 of every error, about 60 ms of audio blocks to settle
+constexpr int64_t cSmoothing = 64;
+
+int64_t microseconds(MediaClock::Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+}
+
+constexpr std::chrono::milliseconds MediaClock::cMaxAge;
+
+MediaClock::MediaClock()
+    : offset_(0)
+    , lastPlayout_(0)
+    , resyncs_(0)
+{
+}
+
+void MediaClock::update(uint64_t timestamp, Clock::time_point playout)
+{
+    const auto measured = microseconds(playout) - static_cast<int64_t>(timestamp);
+    auto offset = offset_.load(std::memory_order_relaxed);
+    const auto lastPlayout = lastPlayout_.load(std::memory_order_relaxed);
+
+    if(lastPlayout == 0 || std::llabs(measured - offset) > cResyncThreshold)
+    {
+        offset = measured;
+        if(lastPlayout != 0)
+        {
+            resyncs_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        offset += (measured - offset) / cSmoothing;
+    }
+
+    offset_.store(offset, std::memory_order_relaxed);
+    // a reader that sees the new time sees the offset that goes with it
+    lastPlayout_.store(std::max<int64_t>(microseconds(playout), 1), std::memory_order_release);
+}
+
+void MediaClock::invalidate()
+{
+    lastPlayout_.store(0, std::memory_order_release);
+}
+
+bool MediaClock::map(uint64_t timestamp, Clock::time_point now, Clock::time_point& playout) const
+{
+    const auto lastPlayout = lastPlayout_.load(std::memory_order_acquire);
+    if(lastPlayout == 0 || microseconds(now) - lastPlayout > std::chrono::microseconds(cMaxAge).count())
+    {
+        return false;
+    }
+
+    playout = Clock::time_point(std::chrono::microseconds(static_cast<int64_t>(timestamp)
+                                                          + offset_.load(std::memory_order_relaxed)));
+    return true;
+}
+
+uint64_t MediaClock::getResyncCount() const
+{
+    return resyncs_.load(std::memory_order_relaxed);
+}
+
+}
+}
+}
+}
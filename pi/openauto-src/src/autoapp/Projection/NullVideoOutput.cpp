@@ -0,0 +1,178 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <f1x/openauto/autoapp/Projection/NullVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+NullVideoOutput::NullVideoOutput(aap_protobuf::service::media::sink::message::VideoCodecResolutionType resolution,
+                                 aap_protobuf::service::media::sink::message::VideoFrameRateType frameRate,
+                                 size_t screenDPI)
+    : resolution_(resolution)
+    , frameRate_(frameRate)
+    , screenDPI_(screenDPI)
+{
+    videoMode_.resolution = resolution_;
+    videoMode_.frameRate = frameRate_;
+}
+
+bool NullVideoOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    statistics_ = Statistics();
+    return true;
+}
+
+bool NullVideoOutput::init()
+{
+    return true;
+}
+
+void NullVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    const auto now = Clock::now();
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        if(statistics_.frames == 0)
+        {
+            statistics_.firstTimestamp = timestamp;
+            statistics_.firstWrite = now;
+        }
+        else if(now - statistics_.lastWrite > statistics_.maxInterval)
+        {
+            statistics_.maxInterval = now - statistics_.lastWrite;
+        }
+
+        ++statistics_.frames;
+        statistics_.bytes += buffer.size;
+        statistics_.lastTimestamp = timestamp;
+        statistics_.lastWrite = now;
+    }
+
+    // as far as the statistics go the frame was on screen
+    diagnostics::VideoStatistics::onFrameShown();
+}
+
+void NullVideoOutput::stop()
+{
+    OPENAUTO_LOG(info) << "[NullVideoOutput] " << describe(this->getStatistics());
+}
+
+bool NullVideoOutput::suspend()
+{
+    // nothing to take off a screen
+    return true;
+}
+
+void NullVideoOutput::resume()
+{
+}
+
+VideoCapabilities NullVideoOutput::getCapabilities()
+{
+    VideoCapabilities capabilities;
+    for(const auto codec: {aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265,
+                           aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H264_BP})
+    {
+        DecoderCapability decoder;
+        decoder.codec = codec;
+        VideoCapabilities::resolutionSize(resolution_, decoder.maxWidth, decoder.maxHeight);
+        capabilities.add(decoder);
+    }
+
+    return capabilities;
+}
+
+void NullVideoOutput::setVideoMode(const VideoMode& mode)
+{
+    OPENAUTO_LOG(info) << "[NullVideoOutput] video mode: " << VideoCapabilities::describe(mode);
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    videoMode_ = mode;
+}
+
+void NullVideoOutput::setMediaClock(MediaClock::Pointer)
+{
+}
+
+VideoMode NullVideoOutput::getVideoMode() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return videoMode_;
+}
+
+aap_protobuf::service::media::sink::message::VideoFrameRateType NullVideoOutput::getVideoFPS() const
+{
+    return frameRate_;
+}
+
+aap_protobuf::service::media::sink::message::VideoCodecResolutionType NullVideoOutput::getVideoResolution() const
+{
+    return resolution_;
+}
+
+size_t NullVideoOutput::getScreenDPI() const
+{
+    return screenDPI_;
+}
+
+QRect NullVideoOutput::getVideoMargins(const VideoMode&) const
+{
+    return QRect(0, 0, 0, 0);
+}
+
+QRect NullVideoOutput::getDisplayGeometry() const
+{
+    return QRect();
+}
+
+NullVideoOutput::Statistics NullVideoOutput::getStatistics() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return statistics_;
+}
+
+std::string NullVideoOutput::describe(const Statistics& statistics)
+{
+    std::ostringstream stream;
+    stream << "frames: " << statistics.frames << ", bytes: " << statistics.bytes;
+    if(statistics.frames > 1)
+    {
+        const auto streamSpan = statistics.lastTimestamp - statistics.firstTimestamp;
+        const auto writeSpan = std::chrono::duration_cast<std::chrono::microseconds>(statistics.lastWrite - statistics.firstWrite);
+        stream << ", stream " << streamSpan / 1000 << " ms in " << writeSpan.count() / 1000 << " ms"
+               << ", longest gap: " << std::chrono::duration_cast<std::chrono::microseconds>(statistics.maxInterval).count() / 1000.0 << " ms";
+    }
+
+    return stream.str();
+}
+
+}
+}
+}
+}
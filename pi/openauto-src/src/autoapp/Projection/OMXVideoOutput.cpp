@@ -27,6 +27,7 @@ extern "C"
 
 #include <aasdk/Common/Data.hpp>
 #include <f1x/openauto/autoapp/Projection/OMXVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
 #include <f1x/openauto/Common/Log.hpp>
 
 namespace f1x
@@ -61,6 +62,7 @@ bool OMXVideoOutput::open()
     std::lock_guard<decltype(mutex_)> lock(mutex_);
 
     OPENAUTO_LOG(debug) << "[OMXVideoOutput] open.";
+    presentationPolicy_.reset();
 
 #ifdef USE_OMX
     bcm_host_init();
@@ -109,10 +111,10 @@ bool OMXVideoOutput::init()
     OPENAUTO_LOG(debug) << "[OMXVideoOutput] init, state: " << isActive_;
     ilclient_change_component_state(components_[VideoComponent::DECODER], OMX_StateExecuting);
     
-    return this->setupDisplayRegion();
+    return this->setupDisplayRegion(true);
 }
 
-bool OMXVideoOutput::setupDisplayRegion()
+bool OMXVideoOutput::setupDisplayRegion(bool visible)
 {
     OMX_CONFIG_DISPLAYREGIONTYPE displayRegion;
     displayRegion.nSize = sizeof(OMX_CONFIG_DISPLAYREGIONTYPE);
@@ -120,8 +122,21 @@ bool OMXVideoOutput::setupDisplayRegion()
     displayRegion.nPortIndex = 90;
     displayRegion.layer = static_cast<OMX_S32>(configuration_->getOMXLayerIndex());
     displayRegion.fullscreen = OMX_TRUE;
-    displayRegion.noaspect = OMX_TRUE;
-    displayRegion.set = static_cast<OMX_DISPLAYSETTYPE >(OMX_DISPLAY_SET_FULLSCREEN | OMX_DISPLAY_SET_NOASPECT | OMX_DISPLAY_SET_LAYER);    
+    // the renderer cuts the margins off and keeps the aspect ratio of the rest,
+    // black bars only show up when the margins do not fit the display
+    const auto mode = this->getVideoMode();
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VideoCapabilities::resolutionSize(mode.resolution, width, height);
+    const auto content = VideoGeometry::contentRect(width, height, this->getVideoMargins(mode));
+    displayRegion.src_rect.x_offset = content.x();
+    displayRegion.src_rect.y_offset = content.y();
+    displayRegion.src_rect.width = content.width();
+    displayRegion.src_rect.height = content.height();
+    displayRegion.noaspect = OMX_FALSE;
+    // a hidden renderer keeps its layer and tunnels, it is just fully transparent
+    displayRegion.alpha = visible ? 255 : 0;
+    displayRegion.set = static_cast<OMX_DISPLAYSETTYPE >(OMX_DISPLAY_SET_FULLSCREEN | OMX_DISPLAY_SET_SRC_RECT | OMX_DISPLAY_SET_NOASPECT | OMX_DISPLAY_SET_LAYER | OMX_DISPLAY_SET_ALPHA);
 
     return OMX_SetConfig(ilclient_get_handle(components_[VideoComponent::RENDERER]), OMX_IndexConfigDisplayRegion, &displayRegion) == OMX_ErrorNone;
 }
@@ -130,9 +145,33 @@ void OMXVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuf
 {
     std::lock_guard<decltype(mutex_)> lock(mutex_);
 
+    const auto info = PresentationPolicy::inspect(buffer.cdata, buffer.size, &parameterSets_);
+    if(info.sequenceChanged)
+    {
+        OPENAUTO_LOG(info) << "[OMXVideoOutput] stream: " << H264Parser::describe(parameterSets_.getSequenceInfo());
+    }
+
+    // ilclient_get_input_buffer blocks until the decoder has room, a frame that waited too long is skipped here
+    if(presentationPolicy_.onFrame(timestamp, info) == PresentationDecision::DROP)
+    {
+        this->onFrameDropped();
+        return;
+    }
+
+    this->submit(timestamp, buffer.cdata, buffer.size, timestamp == 0 ? OMX_BUFFERFLAG_STARTTIME : 0);
+
+    // there is no render callback in this graph, a submitted picture is as close as it gets
+    if(info.hasSlice)
+    {
+        this->onPictureShown();
+    }
+}
+
+void OMXVideoOutput::submit(uint64_t timestamp, const uint8_t* data, size_t size, OMX_U32 flags)
+{
     size_t writeSize = 0;
 
-    while(isActive_ && writeSize < buffer.size)
+    while(isActive_ && writeSize < size)
     {
         OMX_BUFFERHEADERTYPE* buf = ilclient_get_input_buffer(components_[VideoComponent::DECODER], 130, 1);
 
@@ -142,18 +181,14 @@ void OMXVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuf
         }
         else
         {
-            aasdk::common::DataConstBuffer currentBuffer(buffer.cdata, buffer.size, writeSize);
+            aasdk::common::DataConstBuffer currentBuffer(data, size, writeSize);
             buf->nFilledLen = std::min<size_t>(buf->nAllocLen, currentBuffer.size);
             memcpy(buf->pBuffer, &currentBuffer.cdata[0], buf->nFilledLen);
             buf->nTimeStamp = omx_ticks_from_s64(timestamp / 1000000);
-            buf->nOffset = 0;           
-            
+            buf->nOffset = 0;
+            buf->nFlags = flags;
+
             writeSize += buf->nFilledLen;
-            
-            if(timestamp == 0)
-            {
-              buf->nFlags = OMX_BUFFERFLAG_STARTTIME;
-            }
 
             if(!portSettingsChanged_ && ilclient_remove_event(components_[VideoComponent::DECODER], OMX_EventPortSettingsChanged, 131, 0, 0, 1) == 0)
             {
@@ -181,6 +216,55 @@ void OMXVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuf
     }
 }
 
+bool OMXVideoOutput::suspend()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(!isActive_ || !this->setupDisplayRegion(false))
+    {
+        return false;
+    }
+
+    OPENAUTO_LOG(info) << "[OMXVideoOutput] suspended, decoder kept alive.";
+    return true;
+}
+
+void OMXVideoOutput::resume()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(!isActive_)
+    {
+        return;
+    }
+
+    this->startResumeTimer();
+    presentationPolicy_.reset();
+
+    if(parameterSets_.isComplete())
+    {
+        OPENAUTO_LOG(info) << "[OMXVideoOutput] replaying cached SPS/PPS: " << H264Parser::describe(parameterSets_.getSequenceInfo());
+        const auto& annexB = parameterSets_.getAnnexB();
+        this->submit(0, annexB.data(), annexB.size(), OMX_BUFFERFLAG_CODECCONFIG | OMX_BUFFERFLAG_TIME_UNKNOWN);
+    }
+
+    this->setupDisplayRegion(true);
+    OPENAUTO_LOG(info) << "[OMXVideoOutput] resumed.";
+}
+
+VideoCapabilities OMXVideoOutput::getCapabilities()
+{
+    // VideoCore IV decodes H.264 up to level 4.1, i.e. 1080p at 30 frames per second
+    DecoderCapability decoder;
+    decoder.maxWidth = 1920;
+    decoder.maxHeight = 1080;
+    decoder.maxPixelRate = 1920 * 1080 * 30;
+
+    VideoCapabilities capabilities;
+    capabilities.add(decoder);
+    return capabilities;
+}
+
 void OMXVideoOutput::stop()
 {
     OPENAUTO_LOG(debug) << "[OMXVideoOutput] stop.";
@@ -190,6 +274,7 @@ void OMXVideoOutput::stop()
     if(isActive_)
     {
         isActive_ = false;
+        OPENAUTO_LOG(info) << "[OMXVideoOutput] presentation: " << presentationPolicy_.describe();
 
         ilclient_disable_tunnel(&tunnels_[0]);
         ilclient_disable_tunnel(&tunnels_[1]);
@@ -0,0 +1,312 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_PIPEWIRE
+
+#include <cerrno>
+#include <cstring>
+#include <pipewire/pipewire.h>
+#include <spa/param/audio/format-utils.h>
+#include <f1x/openauto/autoapp/Projection/PipeWireAudioOutput.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+struct PipeWireAudioOutput::Events
+{
+    static void onStateChanged(void* data, pw_stream_state, pw_stream_state state, const char* error)
+    {
+        auto self = static_cast<PipeWireAudioOutput*>(data);
+        self->streaming_ = state == PW_STREAM_STATE_STREAMING;
+
+        if(state == PW_STREAM_STATE_ERROR)
+        {
+            OPENAUTO_LOG(error) << "[PipeWireAudioOutput] " << self->role_ << " stream failed: "
+                                << (error != nullptr ? error : "unknown error");
+        }
+        else
+        {
+            OPENAUTO_LOG(debug) << "[PipeWireAudioOutput] " << self->role_ << " stream "
+                                << pw_stream_state_as_string(state);
+        }
+    }
+
+    static void onProcess(void* data)
+    {
+        static_cast<PipeWireAudioOutput*>(data)->process();
+    }
+
+    static const pw_stream_events& get()
+    {
+        static const pw_stream_events events = []() {
+            pw_stream_events events{};
+            events.version = PW_VERSION_STREAM_EVENTS;
+            events.state_changed = &Events::onStateChanged;
+            events.process = &Events::onProcess;
+            return events;
+        }();
+        return events;
+    }
+};
+
+PipeWireAudioOutput::PipeWireAudioOutput(std::string role, uint32_t channelCount, uint32_t sampleSize,
+                                         uint32_t sampleRate, uint32_t quantum,
+                                         std::chrono::milliseconds latencyBound)
+    : role_(std::move(role))
+    , channelCount_(channelCount)
+    , sampleSize_(sampleSize)
+    , sampleRate_(sampleRate)
+    , bytesPerFrame_((sampleSize / 8) * channelCount)
+    , quantum_(quantum)
+    , audioBuffer_(sampleRate * latencyBound.count() / 1000 * bytesPerFrame_, bytesPerFrame_)
+    , threadLoop_(nullptr)
+    , stream_(nullptr)
+    , processedFrames_(0)
+    , lastQuantum_(0)
+    , fillMonitor_("pipewire-data", bytesPerFrame_)
+    , streaming_(false)
+{
+}
+
+PipeWireAudioOutput::~PipeWireAudioOutput()
+{
+    this->stop();
+}
+
+bool PipeWireAudioOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(stream_ != nullptr)
+    {
+        return true;
+    }
+
+    if(sampleSize_ != 16 || channelCount_ == 0 || channelCount_ > 2)
+    {
+        OPENAUTO_LOG(error) << "[PipeWireAudioOutput] unsupported format: " << sampleSize_ << " bit, "
+                            << channelCount_ << " channels";
+        return false;
+    }
+
+    static std::once_flag initialized;
+    std::call_once(initialized, []() { pw_init(nullptr, nullptr); });
+
+    const auto name = "openauto-" + role_;
+    threadLoop_ = pw_thread_loop_new(name.c_str(), nullptr);
+    if(threadLoop_ == nullptr || pw_thread_loop_start(threadLoop_) < 0)
+    {
+        OPENAUTO_LOG(error) << "[PipeWireAudioOutput] cannot start the PipeWire loop";
+        if(threadLoop_ != nullptr)
+        {
+            pw_thread_loop_destroy(threadLoop_);
+            threadLoop_ = nullptr;
+        }
+        return false;
+    }
+
+    const auto latency = std::to_string(quantum_) + "/" + std::to_string(sampleRate_);
+    auto properties = pw_properties_new(PW_KEY_MEDIA_TYPE, "Audio",
+                                        PW_KEY_MEDIA_CATEGORY, "Playback",
+                                        PW_KEY_MEDIA_ROLE, role_.c_str(),
+                                        PW_KEY_MEDIA_NAME, name.c_str(),
+                                        PW_KEY_NODE_NAME, name.c_str(),
+                                        PW_KEY_NODE_LATENCY, latency.c_str(),
+                                        PW_KEY_APP_NAME, "openauto",
+                                        nullptr);
+
+    spa_audio_info_raw format{};
+    format.format = SPA_AUDIO_FORMAT_S16_LE;
+    format.rate = sampleRate_;
+    format.channels = channelCount_;
+    if(channelCount_ == 1)
+    {
+        format.position[0] = SPA_AUDIO_CHANNEL_MONO;
+    }
+    else
+    {
+        format.position[0] = SPA_AUDIO_CHANNEL_FL;
+        format.position[1] = SPA_AUDIO_CHANNEL_FR;
+    }
+
+    uint8_t podBuffer[1024];
+    spa_pod_builder builder{};
+    spa_pod_builder_init(&builder, podBuffer, sizeof(podBuffer));
+    const spa_pod* parameters[1] = {spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &format)};
+
+    // created inactive, start() lets the graph pull from it
+    const auto flags = static_cast<pw_stream_flags>(PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_INACTIVE |
+                                                    PW_STREAM_FLAG_MAP_BUFFERS | PW_STREAM_FLAG_RT_PROCESS);
+
+    pw_thread_loop_lock(threadLoop_);
+    // takes ownership of properties, also on failure
+    stream_ = pw_stream_new_simple(pw_thread_loop_get_loop(threadLoop_), name.c_str(), properties,
+                                   &Events::get(), this);
+    const auto result = stream_ != nullptr
+                        ? pw_stream_connect(stream_, PW_DIRECTION_OUTPUT, PW_ID_ANY, flags, parameters, 1)
+                        : -errno;
+    if(result < 0 && stream_ != nullptr)
+    {
+        pw_stream_destroy(stream_);
+        stream_ = nullptr;
+    }
+    pw_thread_loop_unlock(threadLoop_);
+
+    if(stream_ == nullptr)
+    {
+        OPENAUTO_LOG(error) << "[PipeWireAudioOutput] cannot connect the " << role_ << " stream: "
+                            << std::strerror(-result);
+        pw_thread_loop_stop(threadLoop_);
+        pw_thread_loop_destroy(threadLoop_);
+        threadLoop_ = nullptr;
+        return false;
+    }
+
+    OPENAUTO_LOG(info) << "[PipeWireAudioOutput] " << name << ": " << sampleRate_ << " Hz, " << channelCount_
+                       << " channels, latency: " << latency;
+    // the stream is inactive, so this side may act as the consumer
+    audioBuffer_.clear();
+    fillMonitor_.restart();
+    return true;
+}
+
+void PipeWireAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    audioBuffer_.write(buffer.cdata, buffer.size);
+}
+
+void PipeWireAudioOutput::start()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(stream_ != nullptr)
+    {
+        pw_thread_loop_lock(threadLoop_);
+        pw_stream_set_active(stream_, true);
+        pw_thread_loop_unlock(threadLoop_);
+    }
+}
+
+void PipeWireAudioOutput::stop()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(stream_ == nullptr)
+    {
+        return;
+    }
+
+    pw_thread_loop_lock(threadLoop_);
+    pw_stream_destroy(stream_);
+    stream_ = nullptr;
+    pw_thread_loop_unlock(threadLoop_);
+
+    pw_thread_loop_stop(threadLoop_);
+    pw_thread_loop_destroy(threadLoop_);
+    threadLoop_ = nullptr;
+    streaming_ = false;
+
+    const auto statistics = audioBuffer_.getStatistics();
+    OPENAUTO_LOG(info) << "[PipeWireAudioOutput] " << role_ << " processed: " << processedFrames_.load()
+                       << " frames, quantum: " << lastQuantum_.load() << ", buffer peak: " << statistics.peakFill
+                       << " bytes, dropped: " << statistics.droppedBytes
+                       << ", underruns: " << fillMonitor_.getUnderruns() << " ("
+                       << fillMonitor_.getSilentFrames() * 1000 / sampleRate_ << " ms of silence)";
+}
+
+void PipeWireAudioOutput::suspend()
+{
+    //not needed
+}
+
+uint32_t PipeWireAudioOutput::getSampleSize() const
+{
+    return sampleSize_;
+}
+
+uint32_t PipeWireAudioOutput::getChannelCount() const
+{
+    return channelCount_;
+}
+
+uint32_t PipeWireAudioOutput::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+PipeWireAudioOutput::Statistics PipeWireAudioOutput::getStatistics() const
+{
+    Statistics statistics;
+    statistics.processedFrames = processedFrames_;
+    statistics.underruns = fillMonitor_.getUnderruns();
+    statistics.silentFrames = fillMonitor_.getSilentFrames();
+    statistics.quantum = lastQuantum_;
+    statistics.streaming = streaming_;
+    return statistics;
+}
+
+void PipeWireAudioOutput::process()
+{
+    fillMonitor_.enter();
+
+    auto buffer = pw_stream_dequeue_buffer(stream_);
+    if(buffer == nullptr)
+    {
+        return;
+    }
+
+    auto& data = buffer->buffer->datas[0];
+    if(data.data == nullptr)
+    {
+        pw_stream_queue_buffer(stream_, buffer);
+        return;
+    }
+
+    size_t frames = data.maxsize / bytesPerFrame_;
+    // 0 from daemons that do not tell
+    if(buffer->requested > 0 && buffer->requested < frames)
+    {
+        frames = buffer->requested;
+    }
+
+    const size_t size = frames * bytesPerFrame_;
+    auto target = static_cast<uint8_t*>(data.data);
+    fillMonitor_.fill(target, audioBuffer_.read(target, size), size);
+
+    data.chunk->offset = 0;
+    data.chunk->stride = static_cast<int32_t>(bytesPerFrame_);
+    data.chunk->size = static_cast<uint32_t>(size);
+    pw_stream_queue_buffer(stream_, buffer);
+
+    processedFrames_.fetch_add(frames, std::memory_order_relaxed);
+    lastQuantum_.store(static_cast<uint32_t>(frames), std::memory_order_relaxed);
+}
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,149 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Projection/DriftCorrector.hpp>
+#include <f1x/openauto/autoapp/Projection/PlayoutScheduler.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// a message is 20 to 60 ms of audio, this covers a few seconds of them
+constexpr size_t cMarkCapacity = 256;
+// reads before the queue length is taken as the target, about two seconds of 1 ms blocks
+constexpr uint64_t cSettleReads = 2000;
+// queue smoothing per read, spans the bursts the phone sends in
+constexpr double cQueueSmoothing = 1.0 / 1024;
+// 5 ms off the target asks for 100 ppm; the integral takes over within half a minute
+constexpr double cProportionalGain = 0.02;
+constexpr double cIntegralGain = cProportionalGain / 30000;
+
+}
+
+PlayoutScheduler::PlayoutScheduler(uint32_t sampleRate, uint32_t bytesPerFrame, MediaClock::Pointer clock)
+    : sampleRate_(sampleRate)
+    , bytesPerFrame_(bytesPerFrame)
+    , clock_(std::move(clock))
+    , marks_(cMarkCapacity)
+{
+    this->reset();
+}
+
+void PlayoutScheduler::mark(uint64_t timestamp, uint64_t position)
+{
+    Mark mark;
+    mark.timestamp = timestamp;
+    mark.position = position;
+    // a lost mark only means the timestamps are extrapolated further
+    marks_.push(std::move(mark));
+}
+
+int32_t PlayoutScheduler::onPlay(uint64_t position, Clock::time_point playout, size_t queuedBytes)
+{
+    // the last mark at or before position tells its timestamp
+    while(hasNext_ || marks_.pop(next_))
+    {
+        hasNext_ = true;
+        if(next_.position > position)
+        {
+            break;
+        }
+        current_ = next_;
+        hasCurrent_ = true;
+        hasNext_ = false;
+    }
+
+    if(hasCurrent_ && clock_ != nullptr)
+    {
+        const auto frames = (position - current_.position) / bytesPerFrame_;
+        clock_->update(current_.timestamp + frames * 1000000 / sampleRate_, playout);
+    }
+
+    const double queued = static_cast<double>(queuedBytes / bytesPerFrame_) * 1000000.0 / sampleRate_;
+    queued_ = plays_ == 0 ? queued : queued_ + (queued - queued_) * cQueueSmoothing;
+    queuedStatistic_.store(static_cast<int64_t>(queued_), std::memory_order_relaxed);
+
+    if(++plays_ < cSettleReads)
+    {
+        return 0;
+    }
+    if(plays_ == cSettleReads || requestedTarget_ > 0)
+    {
+        target_ = requestedTarget_ > 0 ? requestedTarget_ : queued_;
+        targetStatistic_.store(static_cast<int64_t>(target_), std::memory_order_relaxed);
+    }
+
+    const auto error = queued_ - target_;
+    integral_ = std::clamp(integral_ + error * cIntegralGain, -double(DriftCorrector::cMaxSkew),
+                           double(DriftCorrector::cMaxSkew));
+    const auto skew = static_cast<int32_t>(std::clamp(error * cProportionalGain + integral_,
+                                                      -double(DriftCorrector::cMaxSkew),
+                                                      double(DriftCorrector::cMaxSkew)));
+    skew_.store(skew, std::memory_order_relaxed);
+    return skew;
+}
+
+void PlayoutScheduler::setTarget(std::chrono::microseconds target)
+{
+    requestedTarget_ = static_cast<double>(target.count());
+}
+
+void PlayoutScheduler::reset()
+{
+    Mark mark;
+    while(marks_.pop(mark));
+
+    hasCurrent_ = false;
+    hasNext_ = false;
+    plays_ = 0;
+    queued_ = 0;
+    target_ = 0;
+    requestedTarget_ = 0;
+    integral_ = 0;
+    skew_ = 0;
+    queuedStatistic_ = 0;
+    targetStatistic_ = 0;
+
+    if(clock_ != nullptr)
+    {
+        clock_->invalidate();
+    }
+}
+
+PlayoutScheduler::Statistics PlayoutScheduler::getStatistics() const
+{
+    Statistics statistics;
+    statistics.skew = skew_.load(std::memory_order_relaxed);
+    statistics.queued = std::chrono::microseconds(queuedStatistic_.load(std::memory_order_relaxed));
+    statistics.target = std::chrono::microseconds(targetStatistic_.load(std::memory_order_relaxed));
+    return statistics;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,193 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <f1x/openauto/autoapp/Projection/PresentationPolicy.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+// a timestamp jump larger than this is a new stream (or a phone that restarted its clock)
+constexpr std::chrono::microseconds cMaxTimestampGap = std::chrono::seconds(10);
+// the target may follow the stream 1 ms per second later, covers clock drift between phone and head unit
+constexpr int64_t cDriftAllowanceDivider = 1000;
+
+}
+
+PresentationPolicy::PresentationPolicy(std::chrono::milliseconds lateThreshold,
+                                       std::chrono::milliseconds resyncThreshold,
+                                       std::chrono::milliseconds maxIdrWait)
+    : lateThreshold_(lateThreshold)
+    , resyncThreshold_(resyncThreshold)
+    , maxIdrWait_(maxIdrWait)
+{
+    this->reset();
+}
+
+void PresentationPolicy::reset()
+{
+    anchored_ = false;
+    anchorTimestamp_ = 0;
+    anchorTime_ = Clock::time_point();
+    lastTimestamp_ = 0;
+    waitingForIdr_ = false;
+    waitingSince_ = Clock::time_point();
+    statistics_ = Statistics();
+}
+
+void PresentationPolicy::skipToIdr(Clock::time_point now)
+{
+    if(!waitingForIdr_)
+    {
+        waitingForIdr_ = true;
+        waitingSince_ = now;
+    }
+}
+
+void PresentationPolicy::anchor(uint64_t timestamp, Clock::time_point now)
+{
+    anchored_ = true;
+    anchorTimestamp_ = timestamp;
+    anchorTime_ = now;
+}
+
+PresentationDecision PresentationPolicy::onFrame(uint64_t timestamp, const FrameInfo& info, Clock::time_point now)
+{
+    ++statistics_.frames;
+
+    // codec configuration and SEI-only messages are cheap and needed by whatever comes next
+    if(!info.hasSlice)
+    {
+        return PresentationDecision::DECODE;
+    }
+
+    if(!anchored_ || timestamp < lastTimestamp_ || std::chrono::microseconds(timestamp - lastTimestamp_) > cMaxTimestampGap)
+    {
+        this->anchor(timestamp, now);
+    }
+
+    const auto elapsed = static_cast<int64_t>(timestamp - lastTimestamp_);
+    lastTimestamp_ = timestamp;
+
+    const auto target = anchorTime_ + std::chrono::microseconds(timestamp - anchorTimestamp_);
+    auto lateness = std::chrono::duration_cast<std::chrono::microseconds>(now - target);
+
+    if(lateness.count() < 0)
+    {
+        // earlier than any frame so far: the previous anchor already included some delay
+        this->anchor(timestamp, now);
+        lateness = std::chrono::microseconds(0);
+    }
+    else if(elapsed > 0)
+    {
+        const auto drift = std::min<int64_t>(lateness.count(), elapsed / cDriftAllowanceDivider);
+        anchorTime_ += std::chrono::microseconds(drift);
+    }
+
+    statistics_.maxLatenessMicroseconds = std::max<int64_t>(statistics_.maxLatenessMicroseconds, lateness.count());
+
+    if(waitingForIdr_)
+    {
+        if(info.isIdr)
+        {
+            // the latency the stream settled at is the new normal, or every frame after it would be late again
+            waitingForIdr_ = false;
+            this->anchor(timestamp, now);
+            ++statistics_.resyncs;
+            return PresentationDecision::RESYNC;
+        }
+
+        if(now - waitingSince_ > maxIdrWait_)
+        {
+            // the phone only sends IDRs on its own schedule; a corrupted picture beats a frozen one
+            OPENAUTO_LOG(warning) << "[PresentationPolicy] no IDR within " << maxIdrWait_.count() / 1000
+                                  << " ms, decoding from a non-IDR frame.";
+            waitingForIdr_ = false;
+            this->anchor(timestamp, now);
+            return PresentationDecision::DECODE;
+        }
+
+        ++statistics_.dropped;
+        return PresentationDecision::DROP;
+    }
+
+    if(lateness <= lateThreshold_)
+    {
+        return PresentationDecision::DECODE;
+    }
+
+    ++statistics_.late;
+
+    if(info.isIdr)
+    {
+        this->anchor(timestamp, now);
+        ++statistics_.resyncs;
+        return PresentationDecision::RESYNC;
+    }
+
+    if(lateness > resyncThreshold_)
+    {
+        OPENAUTO_LOG(debug) << "[PresentationPolicy] " << lateness.count() / 1000 << " ms behind, skipping to the next IDR.";
+        waitingForIdr_ = true;
+        waitingSince_ = now;
+        ++statistics_.dropped;
+        return PresentationDecision::DROP;
+    }
+
+    if(!info.isReference)
+    {
+        ++statistics_.dropped;
+        return PresentationDecision::DROP;
+    }
+
+    return PresentationDecision::DECODE;
+}
+
+PresentationPolicy::Statistics PresentationPolicy::getStatistics() const
+{
+    return statistics_;
+}
+
+std::string PresentationPolicy::describe() const
+{
+    std::ostringstream stream;
+    stream << "frames: " << statistics_.frames << ", late: " << statistics_.late << ", dropped: " << statistics_.dropped
+           << ", resyncs: " << statistics_.resyncs << ", max lateness: " << statistics_.maxLatenessMicroseconds / 1000.0 << " ms";
+    return stream.str();
+}
+
+PresentationPolicy::FrameInfo PresentationPolicy::inspect(const uint8_t* data, size_t size, H264ParameterSets* parameterSets)
+{
+    return H264Parser::inspect(data, size, parameterSets);
+}
+
+}
+}
+}
+}
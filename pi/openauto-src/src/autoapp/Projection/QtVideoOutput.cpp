@@ -29,8 +29,17 @@ namespace autoapp
 namespace projection
 {
 
+namespace
+{
+
+// a few seconds of a high bitrate stream; beyond that the player is stuck anyway
+constexpr size_t cVideoLatencyBound = 4 * 1024 * 1024;
+
+}
+
 QtVideoOutput::QtVideoOutput(configuration::IConfiguration::Pointer configuration)
     : VideoOutput(std::move(configuration))
+    , videoBuffer_(cVideoLatencyBound)
 {
     this->moveToThread(QApplication::instance()->thread());
     connect(this, &QtVideoOutput::startPlayback, this, &QtVideoOutput::onStartPlayback, Qt::QueuedConnection);
@@ -59,6 +68,9 @@ bool QtVideoOutput::init()
 
 void QtVideoOutput::stop()
 {
+    const auto statistics = videoBuffer_.getStatistics();
+    OPENAUTO_LOG(info) << "[QtVideoOutput] buffer peak: " << statistics.peakFill << " bytes, dropped: "
+                       << statistics.droppedBytes << ", refused: " << statistics.refusedBytes;
     emit stopPlayback();
 }
 
@@ -67,6 +79,11 @@ void QtVideoOutput::write(uint64_t, const aasdk::common::DataConstBuffer& buffer
     videoBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
 }
 
+QRect QtVideoOutput::getVideoMargins(const VideoMode&) const
+{
+    return QRect();
+}
+
 void QtVideoOutput::onStartPlayback()
 {
     videoWidget_->setAttribute(Qt::WA_OpaquePaintEvent, true);
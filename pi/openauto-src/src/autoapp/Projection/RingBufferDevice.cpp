@@ -0,0 +1,116 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <f1x/openauto/autoapp/Projection/RingBufferDevice.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+RingBufferDevice::RingBufferDevice(size_t latencyBound, size_t alignment)
+    : ring_(latencyBound, alignment)
+    , readyReadPending_(false)
+{
+}
+
+bool RingBufferDevice::isSequential() const
+{
+    return true;
+}
+
+bool RingBufferDevice::open(OpenMode mode)
+{
+    // QIODevice's read buffer would put an allocating copy on the reader's thread
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+qint64 RingBufferDevice::readData(char *data, qint64 maxlen)
+{
+    // re-arm before looking, a write landing after this is announced again
+    readyReadPending_.store(false);
+    return static_cast<qint64>(ring_.read(data, static_cast<size_t>(maxlen)));
+}
+
+qint64 RingBufferDevice::writeData(const char *data, qint64 len)
+{
+    ring_.write(data, static_cast<size_t>(len));
+    if(!readyReadPending_.exchange(true))
+    {
+        emit readyRead();
+    }
+
+    // what did not fit is counted as refused, the writer does not retry
+    return len;
+}
+
+qint64 RingBufferDevice::size() const
+{
+    return this->bytesAvailable();
+}
+
+qint64 RingBufferDevice::pos() const
+{
+    return 0;
+}
+
+bool RingBufferDevice::seek(qint64)
+{
+    return false;
+}
+
+bool RingBufferDevice::atEnd() const
+{
+    // the stream only ends when the device is closed
+    return false;
+}
+
+bool RingBufferDevice::reset()
+{
+    ring_.clear();
+    return true;
+}
+
+qint64 RingBufferDevice::bytesAvailable() const
+{
+    return QIODevice::bytesAvailable() + static_cast<qint64>(ring_.size());
+}
+
+bool RingBufferDevice::canReadLine() const
+{
+    return false;
+}
+
+void RingBufferDevice::setLatencyBound(size_t latencyBound)
+{
+    ring_.setLatencyBound(latencyBound);
+}
+
+RingBufferDevice::Statistics RingBufferDevice::getStatistics() const
+{
+    return ring_.getStatistics();
+}
+
+}
+}
+}
+}
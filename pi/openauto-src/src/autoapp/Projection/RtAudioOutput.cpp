@@ -16,6 +16,7 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <f1x/openauto/autoapp/Projection/RtAudioOutput.hpp>
 #include <f1x/openauto/Common/Log.hpp>
 
@@ -32,16 +33,27 @@ namespace autoapp
 namespace projection
 {
 
-RtAudioOutput::RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+RtAudioOutput::RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate,
+                             std::chrono::milliseconds latencyBound)
     : channelCount_(channelCount)
     , sampleSize_(sampleSize)
     , sampleRate_(sampleRate)
+    , bytesPerFrame_((sampleSize / 8) * channelCount)
+    , audioBuffer_(sampleRate * latencyBound.count() / 1000 * bytesPerFrame_, bytesPerFrame_)
+    , renderer_(nullptr)
+    , fillMonitor_("rtaudio-" + std::to_string(sampleRate / 1000) + "k", bytesPerFrame_)
 {
     std::vector<RtAudio::Api> apis;
     RtAudio::getCompiledApi(apis);
     dac_ = std::find(apis.begin(), apis.end(), RtAudio::LINUX_PULSE) == apis.end() ? std::make_unique<RtAudio>() : std::make_unique<RtAudio>(RtAudio::LINUX_PULSE);
 }
 
+RtAudioOutput::RtAudioOutput(IAudioRenderer& renderer, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+    : RtAudioOutput(channelCount, sampleSize, sampleRate, std::chrono::milliseconds(0))
+{
+    renderer_ = &renderer;
+}
+
 bool RtAudioOutput::open()
 {
     std::lock_guard<decltype(mutex_)> lock(mutex_);
@@ -89,12 +101,21 @@ bool RtAudioOutput::open()
 #endif
 
     OPENAUTO_LOG(info) << "[RtAudioOutput] Sample Rate: " << sampleRate_;
-    return audioBuffer_.open(QIODevice::ReadWrite);
+    if(renderer_ != nullptr)
+    {
+        // what the backend queues below us plus the buffer the callback fills
+        const auto latencyFrames = static_cast<uint64_t>(std::max<long>(dac_->getStreamLatency(), 0)) + bufferFrames;
+        renderer_->setOutputLatency(std::chrono::microseconds(latencyFrames * 1000000 / sampleRate_));
+    }
+    // the stream is not running yet, so this side may act as the consumer
+    audioBuffer_.clear();
+    fillMonitor_.restart();
+    return true;
 }
 
 void RtAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+    audioBuffer_.write(buffer.cdata, buffer.size);
 }
 
 void RtAudioOutput::start()
@@ -133,6 +154,12 @@ void RtAudioOutput::stop()
     {
         dac_->closeStream();
     }
+
+    const auto statistics = audioBuffer_.getStatistics();
+    OPENAUTO_LOG(info) << "[RtAudioOutput] buffer peak: " << statistics.peakFill << " bytes, dropped: "
+                       << statistics.droppedBytes << ", refused: " << statistics.refusedBytes
+                       << ", underruns: " << fillMonitor_.getUnderruns() << " (" << fillMonitor_.getSilentFrames() * 1000 / sampleRate_
+                       << " ms of silence)";
 }
 
 void RtAudioOutput::suspend()
@@ -183,10 +210,14 @@ int RtAudioOutput::audioBufferReadHandler(void* outputBuffer, void* inputBuffer,
                                           double streamTime, RtAudioStreamStatus status, void* userData)
 {
     RtAudioOutput* self = static_cast<RtAudioOutput*>(userData);
-    std::lock_guard<decltype(self->mutex_)> lock(self->mutex_);
+    self->fillMonitor_.enter();
+
+    const size_t bufferSize = nBufferFrames * self->bytesPerFrame_;
+    const auto count = self->renderer_ != nullptr
+                       ? self->renderer_->render(outputBuffer, nBufferFrames) * self->bytesPerFrame_
+                       : self->audioBuffer_.read(outputBuffer, bufferSize);
+    self->fillMonitor_.fill(outputBuffer, count, bufferSize);
 
-    const auto bufferSize = nBufferFrames * (self->sampleSize_ / 8) * self->channelCount_;
-    self->audioBuffer_.read(reinterpret_cast<char*>(outputBuffer), bufferSize);
     return 0;
 }
 
@@ -0,0 +1,1124 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_V4L2
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <f1x/openauto/autoapp/Projection/V4L2VideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/ThreadCpuMonitor.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+constexpr uint32_t cOutputBufferCount = 6;
+constexpr uint32_t cOutputBufferSize = 1024 * 1024;
+constexpr uint32_t cExtraCaptureBuffers = 2;
+constexpr auto cOutputBufferTimeout = std::chrono::milliseconds(100);
+// how long after a vblank a paced commit is issued, it then lands on the next one
+constexpr auto cCommitLead = std::chrono::milliseconds(1);
+
+int xioctl(int fd, unsigned long request, void* argument)
+{
+    int result;
+    do
+    {
+        result = ioctl(fd, request, argument);
+    } while(result == -1 && errno == EINTR);
+
+    return result;
+}
+
+std::string fourcc(uint32_t format)
+{
+    return std::string{static_cast<char>(format & 0xFF), static_cast<char>((format >> 8) & 0xFF),
+                       static_cast<char>((format >> 16) & 0xFF), static_cast<char>((format >> 24) & 0xFF)};
+}
+
+bool supportsCodedFormat(int fd, uint32_t type, uint32_t codedFormat)
+{
+    v4l2_fmtdesc description{};
+    description.type = type;
+
+    for(description.index = 0; xioctl(fd, VIDIOC_ENUM_FMT, &description) == 0; ++description.index)
+    {
+        if(description.pixelformat == codedFormat)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool isDecoder(const std::string& path, uint32_t codedFormat)
+{
+    const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    v4l2_capability capability{};
+    bool found = false;
+
+    if(xioctl(fd, VIDIOC_QUERYCAP, &capability) == 0)
+    {
+        const auto caps = (capability.capabilities & V4L2_CAP_DEVICE_CAPS) ? capability.device_caps : capability.capabilities;
+
+        if(caps & V4L2_CAP_VIDEO_M2M_MPLANE)
+        {
+            found = supportsCodedFormat(fd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, codedFormat);
+        }
+        else if(caps & V4L2_CAP_VIDEO_M2M)
+        {
+            found = supportsCodedFormat(fd, V4L2_BUF_TYPE_VIDEO_OUTPUT, codedFormat);
+        }
+    }
+
+    ::close(fd);
+    return found;
+}
+
+// largest coded size the decoder at path accepts, 1080p when it does not say
+void maxFrameSize(const std::string& path, uint32_t codedFormat, uint32_t& width, uint32_t& height)
+{
+    width = 0;
+    height = 0;
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if(fd >= 0)
+    {
+        v4l2_frmsizeenum frameSize{};
+        frameSize.pixel_format = codedFormat;
+
+        for(frameSize.index = 0; xioctl(fd, VIDIOC_ENUM_FRAMESIZES, &frameSize) == 0; ++frameSize.index)
+        {
+            if(frameSize.type == V4L2_FRMSIZE_TYPE_DISCRETE)
+            {
+                width = std::max(width, frameSize.discrete.width);
+                height = std::max(height, frameSize.discrete.height);
+            }
+            else
+            {
+                width = frameSize.stepwise.max_width;
+                height = frameSize.stepwise.max_height;
+                break;
+            }
+        }
+
+        ::close(fd);
+    }
+
+    if(width == 0 || height == 0)
+    {
+        width = 1920;
+        height = 1080;
+    }
+}
+
+}
+
+V4L2VideoOutput::V4L2VideoOutput(configuration::IConfiguration::Pointer configuration, std::string devicePath, uint32_t codedFormat)
+    : VideoOutput(std::move(configuration))
+    , devicePath_(std::move(devicePath))
+    , codedFormat_(codedFormat)
+    , fd_(-1)
+    , wakeupFd_(-1)
+    , multiPlanar_(false)
+    , outputType_(V4L2_BUF_TYPE_VIDEO_OUTPUT)
+    , captureType_(V4L2_BUF_TYPE_VIDEO_CAPTURE)
+    , captureFormat_{}
+    , visibleRect_{}
+    , captureGeneration_(0)
+    , captureStreaming_(false)
+    , isActive_(false)
+    , decodedFrames_(0)
+    , framePacing_(configuration_->getVideoFramePacing())
+    , primePending_(false)
+    , hidden_(false)
+    , clearPending_(false)
+{
+}
+
+V4L2VideoOutput::~V4L2VideoOutput()
+{
+    this->stop();
+}
+
+std::string V4L2VideoOutput::findDecoder(uint32_t codedFormat)
+{
+    for(int node = 0; node < 64; ++node)
+    {
+        const auto path = "/dev/video" + std::to_string(node);
+        if(isDecoder(path, codedFormat))
+        {
+            return path;
+        }
+    }
+
+    return std::string();
+}
+
+VideoCapabilities V4L2VideoOutput::getCapabilities()
+{
+    VideoCapabilities capabilities;
+    const std::pair<aap_protobuf::service::media::shared::message::MediaCodecType, uint32_t> codecs[] = {
+        {aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H264_BP, V4L2_PIX_FMT_H264},
+        {aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265, V4L2_PIX_FMT_HEVC}
+    };
+
+    for(const auto& codec: codecs)
+    {
+        // a configured device is used for every codec
+        const auto path = devicePath_.empty() ? findDecoder(codec.second) : devicePath_;
+        if(path.empty() || !isDecoder(path, codec.second))
+        {
+            continue;
+        }
+
+        // hardware decoders run in real time up to their size limit
+        DecoderCapability decoder;
+        decoder.codec = codec.first;
+        maxFrameSize(path, codec.second, decoder.maxWidth, decoder.maxHeight);
+        capabilities.add(decoder);
+
+        OPENAUTO_LOG(info) << "[V4L2VideoOutput] " << fourcc(codec.second) << " decoder: " << path << ", up to "
+                           << decoder.maxWidth << "x" << decoder.maxHeight;
+    }
+
+    return capabilities;
+}
+
+void V4L2VideoOutput::setVideoMode(const VideoMode& mode)
+{
+    const auto previous = this->getVideoMode();
+    VideoOutput::setVideoMode(mode);
+
+    const uint32_t codedFormat = mode.codec == aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265
+                                 ? V4L2_PIX_FMT_HEVC : V4L2_PIX_FMT_H264;
+    bool reopen = false;
+    DrmPresenter::Pointer presenter;
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        reopen = isActive_ && (codedFormat != codedFormat_ || mode.resolution != previous.resolution);
+        codedFormat_ = codedFormat;
+        presenter = presenter_;
+    }
+    this->applyContentRect(presenter, mode);
+
+    // the channel is opened before the phone picks its config, nothing was decoded yet
+    if(reopen)
+    {
+        OPENAUTO_LOG(info) << "[V4L2VideoOutput] reopening for " << VideoCapabilities::describe(mode);
+        this->stop();
+        this->open();
+    }
+}
+
+void V4L2VideoOutput::setFrameHandler(FrameHandler handler)
+{
+    // read without locking by the event thread, so it can only be changed while stopped
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    if(!isActive_)
+    {
+        frameHandler_ = std::move(handler);
+    }
+}
+
+void V4L2VideoOutput::setPresenter(DrmPresenter::Pointer presenter)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    if(!isActive_)
+    {
+        presenter_ = std::move(presenter);
+        this->applyContentRect(presenter_, this->getVideoMode());
+    }
+}
+
+QRect V4L2VideoOutput::getDisplayGeometry() const
+{
+    // the presenter is only replaced while stopped, before the service asks
+    return presenter_ != nullptr ? presenter_->getDisplayGeometry() : VideoOutput::getDisplayGeometry();
+}
+
+void V4L2VideoOutput::applyContentRect(const DrmPresenter::Pointer& presenter, const VideoMode& mode) const
+{
+    if(presenter == nullptr)
+    {
+        return;
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VideoCapabilities::resolutionSize(mode.resolution, width, height);
+    presenter->setContentRect(VideoGeometry::contentRect(width, height, this->getVideoMargins(mode)));
+}
+
+uint64_t V4L2VideoOutput::getDecodedFrameCount() const
+{
+    return decodedFrames_.load(std::memory_order_relaxed);
+}
+
+bool V4L2VideoOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(isActive_)
+    {
+        return true;
+    }
+
+    presentationPolicy_.reset();
+    framePacer_.reset();
+    framePacer_.setMediaClock(mediaClock_);
+    primePending_ = true;
+    hidden_ = false;
+    const auto path = devicePath_.empty() ? findDecoder(codedFormat_) : devicePath_;
+    if(path.empty())
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] no memory-to-memory decoder for " << fourcc(codedFormat_) << " found.";
+        return false;
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if(fd_ < 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] failed to open " << path << ": " << std::strerror(errno);
+        return false;
+    }
+
+    v4l2_capability capability{};
+    if(xioctl(fd_, VIDIOC_QUERYCAP, &capability) != 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] querycap failed: " << std::strerror(errno);
+        this->releaseOutput();
+        return false;
+    }
+
+    const auto caps = (capability.capabilities & V4L2_CAP_DEVICE_CAPS) ? capability.device_caps : capability.capabilities;
+    multiPlanar_ = (caps & V4L2_CAP_VIDEO_M2M_MPLANE) != 0;
+    outputType_ = multiPlanar_ ? V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE : V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    captureType_ = multiPlanar_ ? V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE : V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    OPENAUTO_LOG(info) << "[V4L2VideoOutput] using " << path << " (" << reinterpret_cast<const char*>(capability.card) << ", "
+                       << (multiPlanar_ ? "multi-planar" : "single-planar") << ")";
+
+    if(!this->configureOutput())
+    {
+        this->releaseOutput();
+        return false;
+    }
+
+    v4l2_event_subscription subscription{};
+    subscription.type = V4L2_EVENT_SOURCE_CHANGE;
+    if(xioctl(fd_, VIDIOC_SUBSCRIBE_EVENT, &subscription) != 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] decoder does not report source changes: " << std::strerror(errno);
+        this->releaseOutput();
+        return false;
+    }
+
+    subscription.type = V4L2_EVENT_EOS;
+    xioctl(fd_, VIDIOC_SUBSCRIBE_EVENT, &subscription);
+
+    wakeupFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    isActive_ = true;
+    decodedFrames_ = 0;
+    eventThread_ = std::thread(&V4L2VideoOutput::eventLoop, this);
+    return true;
+}
+
+bool V4L2VideoOutput::init()
+{
+    OPENAUTO_LOG(debug) << "[V4L2VideoOutput] init, state: " << isActive_;
+    return isActive_;
+}
+
+bool V4L2VideoOutput::configureOutput()
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VideoCapabilities::resolutionSize(this->getVideoMode().resolution, width, height);
+
+    v4l2_format format{};
+    format.type = outputType_;
+    if(multiPlanar_)
+    {
+        format.fmt.pix_mp.pixelformat = codedFormat_;
+        format.fmt.pix_mp.width = width;
+        format.fmt.pix_mp.height = height;
+        format.fmt.pix_mp.num_planes = 1;
+        format.fmt.pix_mp.plane_fmt[0].sizeimage = cOutputBufferSize;
+    }
+    else
+    {
+        format.fmt.pix.pixelformat = codedFormat_;
+        format.fmt.pix.width = width;
+        format.fmt.pix.height = height;
+        format.fmt.pix.sizeimage = cOutputBufferSize;
+    }
+
+    if(xioctl(fd_, VIDIOC_S_FMT, &format) != 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] unable to set coded format " << fourcc(codedFormat_) << ": " << std::strerror(errno);
+        return false;
+    }
+
+    v4l2_requestbuffers request{};
+    request.count = cOutputBufferCount;
+    request.type = outputType_;
+    request.memory = V4L2_MEMORY_MMAP;
+    if(xioctl(fd_, VIDIOC_REQBUFS, &request) != 0 || request.count == 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] unable to allocate output buffers: " << std::strerror(errno);
+        return false;
+    }
+
+    outputBuffers_.resize(request.count);
+    freeOutputBuffers_.clear();
+
+    for(uint32_t index = 0; index < request.count; ++index)
+    {
+        v4l2_buffer buffer{};
+        v4l2_plane planes[VIDEO_MAX_PLANES]{};
+        this->prepareBuffer(buffer, planes, outputType_, index);
+
+        if(xioctl(fd_, VIDIOC_QUERYBUF, &buffer) != 0)
+        {
+            OPENAUTO_LOG(error) << "[V4L2VideoOutput] querybuf failed: " << std::strerror(errno);
+            return false;
+        }
+
+        auto& mapped = outputBuffers_[index];
+        mapped.planeCount = 1;
+        mapped.dmabufFd[0] = -1;
+        mapped.length[0] = multiPlanar_ ? planes[0].length : buffer.length;
+        const auto offset = multiPlanar_ ? planes[0].m.mem_offset : buffer.m.offset;
+        mapped.address[0] = mmap(nullptr, mapped.length[0], PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+
+        if(mapped.address[0] == MAP_FAILED)
+        {
+            mapped.address[0] = nullptr;
+            OPENAUTO_LOG(error) << "[V4L2VideoOutput] mmap of output buffer failed: " << std::strerror(errno);
+            return false;
+        }
+
+        freeOutputBuffers_.push_back(index);
+    }
+
+    auto type = static_cast<int>(outputType_);
+    if(xioctl(fd_, VIDIOC_STREAMON, &type) != 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] streamon (output) failed: " << std::strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool V4L2VideoOutput::setupCapture()
+{
+    this->releaseCapture();
+
+    captureFormat_ = v4l2_format{};
+    captureFormat_.type = captureType_;
+    if(xioctl(fd_, VIDIOC_G_FMT, &captureFormat_) != 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] unable to read capture format: " << std::strerror(errno);
+        return false;
+    }
+
+    v4l2_control minimumBuffers{};
+    minimumBuffers.id = V4L2_CID_MIN_BUFFERS_FOR_CAPTURE;
+    const uint32_t count = (xioctl(fd_, VIDIOC_G_CTRL, &minimumBuffers) == 0 ? minimumBuffers.value : 4) + cExtraCaptureBuffers;
+
+    v4l2_requestbuffers request{};
+    request.count = count;
+    request.type = captureType_;
+    request.memory = V4L2_MEMORY_MMAP;
+    if(xioctl(fd_, VIDIOC_REQBUFS, &request) != 0 || request.count == 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] unable to allocate capture buffers: " << std::strerror(errno);
+        return false;
+    }
+
+    captureBuffers_.resize(request.count);
+    ++captureGeneration_;
+
+    // the coded size is usually padded (1920x1088), the compose rectangle is what should be shown
+    v4l2_selection selection{};
+    selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    selection.target = V4L2_SEL_TGT_COMPOSE;
+    if(xioctl(fd_, VIDIOC_G_SELECTION, &selection) == 0)
+    {
+        visibleRect_ = selection.r;
+    }
+    else
+    {
+        visibleRect_ = v4l2_rect{0, 0, multiPlanar_ ? captureFormat_.fmt.pix_mp.width : captureFormat_.fmt.pix.width,
+                                 multiPlanar_ ? captureFormat_.fmt.pix_mp.height : captureFormat_.fmt.pix.height};
+    }
+
+    for(uint32_t index = 0; index < request.count; ++index)
+    {
+        v4l2_buffer buffer{};
+        v4l2_plane planes[VIDEO_MAX_PLANES]{};
+        this->prepareBuffer(buffer, planes, captureType_, index);
+
+        if(xioctl(fd_, VIDIOC_QUERYBUF, &buffer) != 0)
+        {
+            OPENAUTO_LOG(error) << "[V4L2VideoOutput] querybuf (capture) failed: " << std::strerror(errno);
+            return false;
+        }
+
+        auto& exported = captureBuffers_[index];
+        exported.planeCount = multiPlanar_ ? buffer.length : 1;
+
+        for(uint32_t plane = 0; plane < exported.planeCount; ++plane)
+        {
+            v4l2_exportbuffer exportBuffer{};
+            exportBuffer.type = captureType_;
+            exportBuffer.index = index;
+            exportBuffer.plane = plane;
+            exportBuffer.flags = O_RDONLY | O_CLOEXEC;
+
+            exported.address[plane] = nullptr;
+            exported.length[plane] = multiPlanar_ ? planes[plane].length : buffer.length;
+            exported.dmabufFd[plane] = xioctl(fd_, VIDIOC_EXPBUF, &exportBuffer) == 0 ? exportBuffer.fd : -1;
+
+            if(exported.dmabufFd[plane] < 0)
+            {
+                OPENAUTO_LOG(error) << "[V4L2VideoOutput] unable to export capture buffer as dmabuf: " << std::strerror(errno);
+                return false;
+            }
+        }
+
+        if(!this->queueCaptureBuffer(index))
+        {
+            return false;
+        }
+    }
+
+    auto type = static_cast<int>(captureType_);
+    if(xioctl(fd_, VIDIOC_STREAMON, &type) != 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] streamon (capture) failed: " << std::strerror(errno);
+        return false;
+    }
+
+    captureStreaming_ = true;
+
+    if(multiPlanar_)
+    {
+        OPENAUTO_LOG(info) << "[V4L2VideoOutput] capture " << captureFormat_.fmt.pix_mp.width << "x" << captureFormat_.fmt.pix_mp.height
+                           << " " << fourcc(captureFormat_.fmt.pix_mp.pixelformat) << ", buffers: " << request.count;
+    }
+    else
+    {
+        OPENAUTO_LOG(info) << "[V4L2VideoOutput] capture " << captureFormat_.fmt.pix.width << "x" << captureFormat_.fmt.pix.height
+                           << " " << fourcc(captureFormat_.fmt.pix.pixelformat) << ", buffers: " << request.count;
+    }
+
+    return true;
+}
+
+void V4L2VideoOutput::releaseCapture()
+{
+    if(captureStreaming_)
+    {
+        auto type = static_cast<int>(captureType_);
+        xioctl(fd_, VIDIOC_STREAMOFF, &type);
+        captureStreaming_ = false;
+    }
+
+    for(auto& exported : captureBuffers_)
+    {
+        for(uint32_t plane = 0; plane < exported.planeCount; ++plane)
+        {
+            if(exported.dmabufFd[plane] >= 0)
+            {
+                ::close(exported.dmabufFd[plane]);
+            }
+        }
+    }
+
+    if(!captureBuffers_.empty())
+    {
+        captureBuffers_.clear();
+
+        v4l2_requestbuffers request{};
+        request.count = 0;
+        request.type = captureType_;
+        request.memory = V4L2_MEMORY_MMAP;
+        xioctl(fd_, VIDIOC_REQBUFS, &request);
+    }
+}
+
+void V4L2VideoOutput::releaseOutput()
+{
+    if(fd_ < 0)
+    {
+        return;
+    }
+
+    auto type = static_cast<int>(outputType_);
+    xioctl(fd_, VIDIOC_STREAMOFF, &type);
+
+    for(auto& mapped : outputBuffers_)
+    {
+        if(mapped.address[0] != nullptr)
+        {
+            munmap(mapped.address[0], mapped.length[0]);
+        }
+    }
+
+    if(!outputBuffers_.empty())
+    {
+        outputBuffers_.clear();
+        freeOutputBuffers_.clear();
+
+        v4l2_requestbuffers request{};
+        request.count = 0;
+        request.type = outputType_;
+        request.memory = V4L2_MEMORY_MMAP;
+        xioctl(fd_, VIDIOC_REQBUFS, &request);
+    }
+
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void V4L2VideoOutput::prepareBuffer(v4l2_buffer& buffer, v4l2_plane* planes, uint32_t type, uint32_t index) const
+{
+    buffer.type = type;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    buffer.index = index;
+
+    if(multiPlanar_)
+    {
+        buffer.m.planes = planes;
+        buffer.length = VIDEO_MAX_PLANES;
+    }
+}
+
+bool V4L2VideoOutput::queueCaptureBuffer(uint32_t index)
+{
+    v4l2_buffer buffer{};
+    v4l2_plane planes[VIDEO_MAX_PLANES]{};
+    this->prepareBuffer(buffer, planes, captureType_, index);
+
+    if(xioctl(fd_, VIDIOC_QBUF, &buffer) != 0)
+    {
+        OPENAUTO_LOG(error) << "[V4L2VideoOutput] qbuf (capture) failed: " << std::strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+void V4L2VideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    std::unique_lock<decltype(mutex_)> lock(mutex_);
+
+    const bool isH264 = codedFormat_ == V4L2_PIX_FMT_H264;
+    const auto info = isH264 ? PresentationPolicy::inspect(buffer.cdata, buffer.size, &parameterSets_)
+                             : H264Parser::inspectH265(buffer.cdata, buffer.size);
+    if(info.sequenceChanged)
+    {
+        OPENAUTO_LOG(info) << "[V4L2VideoOutput] stream: " << H264Parser::describe(parameterSets_.getSequenceInfo());
+    }
+
+    if(presentationPolicy_.onFrame(timestamp, info) == PresentationDecision::DROP)
+    {
+        this->onFrameDropped();
+        return;
+    }
+
+    bool queued = true;
+    if(primePending_)
+    {
+        primePending_ = false;
+        if(isH264 && !info.hasParameterSets && parameterSets_.isComplete())
+        {
+            OPENAUTO_LOG(info) << "[V4L2VideoOutput] priming decoder with cached SPS/PPS: "
+                               << H264Parser::describe(parameterSets_.getSequenceInfo());
+            const auto& annexB = parameterSets_.getAnnexB();
+            queued = this->queueBitstream(timestamp, annexB.data(), annexB.size(), lock);
+        }
+    }
+
+    if(!queued || !this->queueBitstream(timestamp, buffer.cdata, buffer.size, lock))
+    {
+        // the frames behind this one may refer to it, none of them is shown until the next IDR
+        presentationPolicy_.skipToIdr();
+        this->onFrameDropped();
+    }
+}
+
+bool V4L2VideoOutput::queueBitstream(uint64_t timestamp, const uint8_t* data, size_t size, std::unique_lock<std::mutex>& lock)
+{
+    if(outputBuffers_.empty())
+    {
+        return false;
+    }
+
+    // part of an access unit decodes to garbage, so it goes in whole or not at all
+    const auto bufferSize = outputBuffers_.front().length[0];
+    const auto needed = (size + bufferSize - 1) / bufferSize;
+    if(needed > outputBuffers_.size())
+    {
+        OPENAUTO_LOG(warning) << "[V4L2VideoOutput] access unit of " << size
+                              << " bytes does not fit the output buffers, dropping it.";
+        return false;
+    }
+
+    if(!outputAvailable_.wait_for(lock, cOutputBufferTimeout,
+                                  [this, needed]() { return freeOutputBuffers_.size() >= needed || !isActive_; }))
+    {
+        OPENAUTO_LOG(warning) << "[V4L2VideoOutput] decoder did not return output buffers in time, dropping "
+                              << size << " bytes.";
+        return false;
+    }
+
+    size_t writeSize = 0;
+    while(writeSize < size)
+    {
+        if(!isActive_)
+        {
+            return false;
+        }
+
+        const auto index = freeOutputBuffers_.back();
+        freeOutputBuffers_.pop_back();
+
+        auto& mapped = outputBuffers_[index];
+        const auto chunk = std::min<size_t>(mapped.length[0], size - writeSize);
+        memcpy(mapped.address[0], data + writeSize, chunk);
+
+        v4l2_buffer outputBuffer{};
+        v4l2_plane planes[VIDEO_MAX_PLANES]{};
+        this->prepareBuffer(outputBuffer, planes, outputType_, index);
+        outputBuffer.timestamp.tv_sec = timestamp / 1000000;
+        outputBuffer.timestamp.tv_usec = timestamp % 1000000;
+
+        if(multiPlanar_)
+        {
+            outputBuffer.length = 1;
+            planes[0].bytesused = chunk;
+        }
+        else
+        {
+            outputBuffer.bytesused = chunk;
+        }
+
+        if(xioctl(fd_, VIDIOC_QBUF, &outputBuffer) != 0)
+        {
+            OPENAUTO_LOG(error) << "[V4L2VideoOutput] qbuf (output) failed: " << std::strerror(errno);
+            freeOutputBuffers_.push_back(index);
+            return false;
+        }
+
+        writeSize += chunk;
+    }
+
+    return true;
+}
+
+void V4L2VideoOutput::stop()
+{
+    OPENAUTO_LOG(debug) << "[V4L2VideoOutput] stop.";
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        isActive_ = false;
+    }
+
+    outputAvailable_.notify_all();
+    this->wakeup();
+
+    if(eventThread_.joinable())
+    {
+        eventThread_.join();
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(fd_ >= 0)
+    {
+        OPENAUTO_LOG(info) << "[V4L2VideoOutput] decoded frames: " << decodedFrames_.load()
+                           << ", presentation: " << presentationPolicy_.describe();
+        if(framePacing_)
+        {
+            OPENAUTO_LOG(info) << "[V4L2VideoOutput] pacing: " << framePacer_.describe();
+        }
+
+        pendingFrame_.reset();
+
+        // take the last frame off the screen before its buffer goes away
+        if(presenter_ != nullptr)
+        {
+            presenter_->clear();
+        }
+
+        this->releaseCapture();
+        this->releaseOutput();
+    }
+
+    if(wakeupFd_ >= 0)
+    {
+        ::close(wakeupFd_);
+        wakeupFd_ = -1;
+    }
+}
+
+bool V4L2VideoOutput::suspend()
+{
+    if(!isActive_)
+    {
+        return false;
+    }
+
+    // first, so a frame the event thread is about to present is taken off again by the clear
+    hidden_ = true;
+    // the presenter and the capture queue belong to the event thread
+    clearPending_ = true;
+    this->wakeup();
+
+    OPENAUTO_LOG(info) << "[V4L2VideoOutput] suspended, decoder kept alive.";
+    return true;
+}
+
+void V4L2VideoOutput::resume()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+        if(!isActive_)
+        {
+            return;
+        }
+
+        // the next access unit is preceded by the cached SPS/PPS unless it carries its own
+        presentationPolicy_.reset();
+        primePending_ = true;
+    }
+
+    this->startResumeTimer();
+    hidden_ = false;
+    OPENAUTO_LOG(info) << "[V4L2VideoOutput] resumed.";
+}
+
+void V4L2VideoOutput::eventLoop()
+{
+    diagnostics::setCurrentThreadName("v4l2-decoder");
+
+    pollfd descriptors[2];
+    descriptors[0].fd = fd_;
+    descriptors[0].events = POLLIN | POLLOUT | POLLPRI;
+    descriptors[1].fd = wakeupFd_;
+    descriptors[1].events = POLLIN;
+
+    while(isActive_)
+    {
+        descriptors[0].events = pendingFrame_.has_value() ? POLLOUT | POLLPRI : POLLIN | POLLOUT | POLLPRI;
+        descriptors[0].revents = 0;
+        descriptors[1].revents = 0;
+
+        timespec timeout{};
+        if(pendingFrame_.has_value())
+        {
+            const auto remaining = std::max<int64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(commitTime_ - FramePacer::Clock::now()).count(), 0);
+            timeout.tv_sec = remaining / 1000000000;
+            timeout.tv_nsec = remaining % 1000000000;
+        }
+
+        if(ppoll(descriptors, 2, pendingFrame_.has_value() ? &timeout : nullptr, nullptr) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+
+            OPENAUTO_LOG(error) << "[V4L2VideoOutput] poll failed: " << std::strerror(errno);
+            break;
+        }
+
+        if(descriptors[1].revents != 0)
+        {
+            uint64_t count = 0;
+            ::read(wakeupFd_, &count, sizeof(count));
+            if(!isActive_)
+            {
+                break;
+            }
+            if(clearPending_.exchange(false))
+            {
+                this->clearScreen();
+            }
+        }
+
+        const auto events = descriptors[0].revents;
+
+        if(events & POLLPRI)
+        {
+            this->handleEvents();
+        }
+
+        if(events & POLLIN)
+        {
+            this->dequeueCapture();
+        }
+
+        if(events & POLLOUT)
+        {
+            this->dequeueOutput();
+        }
+
+        if(pendingFrame_.has_value() && FramePacer::Clock::now() >= commitTime_)
+        {
+            const auto frame = *pendingFrame_;
+            pendingFrame_.reset();
+            this->presentFrame(frame);
+            // whatever was decoded in the meantime
+            this->dequeueCapture();
+        }
+
+        // m2m devices report POLLERR while neither queue has work (e.g. before
+        // the first access unit); back off instead of spinning
+        if((events & POLLERR) && !(events & (POLLIN | POLLOUT | POLLPRI)) && !pendingFrame_.has_value())
+        {
+            poll(&descriptors[1], 1, 5);
+        }
+    }
+}
+
+void V4L2VideoOutput::wakeup()
+{
+    if(wakeupFd_ >= 0)
+    {
+        const uint64_t wakeup = 1;
+        ::write(wakeupFd_, &wakeup, sizeof(wakeup));
+    }
+}
+
+void V4L2VideoOutput::clearScreen()
+{
+    if(pendingFrame_.has_value())
+    {
+        this->queueCaptureBuffer(pendingFrame_->index);
+        pendingFrame_.reset();
+    }
+
+    if(presenter_ != nullptr)
+    {
+        // the buffer that was on screen goes back to the decoder, it would be one capture buffer short otherwise
+        const auto released = presenter_->clear();
+        if(released.has_value() && released->generation == captureGeneration_)
+        {
+            this->queueCaptureBuffer(released->index);
+        }
+    }
+}
+
+void V4L2VideoOutput::handleEvents()
+{
+    v4l2_event event{};
+
+    while(xioctl(fd_, VIDIOC_DQEVENT, &event) == 0)
+    {
+        if(event.type == V4L2_EVENT_SOURCE_CHANGE && (event.u.src_change.changes & V4L2_EVENT_SRC_CH_RESOLUTION))
+        {
+            OPENAUTO_LOG(info) << "[V4L2VideoOutput] source change, reconfiguring capture queue.";
+            // its buffer is about to go away
+            pendingFrame_.reset();
+
+            if(!this->setupCapture())
+            {
+                this->releaseCapture();
+            }
+        }
+        else if(event.type == V4L2_EVENT_EOS)
+        {
+            OPENAUTO_LOG(debug) << "[V4L2VideoOutput] end of stream.";
+        }
+    }
+}
+
+void V4L2VideoOutput::dequeueCapture()
+{
+    if(!captureStreaming_ || pendingFrame_.has_value())
+    {
+        return;
+    }
+
+    for(;;)
+    {
+        v4l2_buffer buffer{};
+        v4l2_plane planes[VIDEO_MAX_PLANES]{};
+        this->prepareBuffer(buffer, planes, captureType_, 0);
+
+        if(xioctl(fd_, VIDIOC_DQBUF, &buffer) != 0)
+        {
+            // EAGAIN: nothing decoded yet, EPIPE: last buffer before a resolution change was already returned
+            return;
+        }
+
+        const auto bytesUsed = multiPlanar_ ? planes[0].bytesused : buffer.bytesused;
+        if((buffer.flags & V4L2_BUF_FLAG_LAST) && bytesUsed == 0)
+        {
+            continue;
+        }
+
+        if(buffer.flags & V4L2_BUF_FLAG_ERROR)
+        {
+            OPENAUTO_LOG(debug) << "[V4L2VideoOutput] corrupted frame, index: " << buffer.index;
+            this->queueCaptureBuffer(buffer.index);
+            continue;
+        }
+
+        V4L2DecodedFrame frame{};
+        this->fillFrame(buffer, planes, frame);
+        decodedFrames_.fetch_add(1, std::memory_order_relaxed);
+
+        if(frameHandler_)
+        {
+            frameHandler_(frame);
+        }
+
+        if(!hidden_ && presenter_ != nullptr && framePacing_)
+        {
+            // the blocking commit is issued right after the vblank before the due one and latches on it
+            const auto vblank = presenter_->getVBlankClock();
+            const auto now = FramePacer::Clock::now();
+            const auto commitTime = framePacer_.schedule(frame.timestamp, now, vblank) - vblank.period + cCommitLead;
+            if(commitTime > now)
+            {
+                pendingFrame_ = frame;
+                commitTime_ = commitTime;
+                return;
+            }
+        }
+
+        this->presentFrame(frame);
+    }
+}
+
+void V4L2VideoOutput::presentFrame(const V4L2DecodedFrame& frame)
+{
+    std::optional<V4L2DecodedFrame> released;
+    if(!hidden_ && presenter_ != nullptr && presenter_->present(frame, released))
+    {
+        this->onPictureShown();
+
+        // the new frame stays on screen, the one it replaced goes back to the decoder
+        if(released.has_value() && released->generation == captureGeneration_)
+        {
+            this->queueCaptureBuffer(released->index);
+        }
+    }
+    else
+    {
+        this->queueCaptureBuffer(frame.index);
+    }
+}
+
+void V4L2VideoOutput::fillFrame(const v4l2_buffer& buffer, const v4l2_plane* planes, V4L2DecodedFrame& frame) const
+{
+    const auto& exported = captureBuffers_[buffer.index];
+    frame.index = buffer.index;
+    frame.generation = captureGeneration_;
+    frame.planeCount = exported.planeCount;
+    frame.visibleWidth = visibleRect_.width;
+    frame.visibleHeight = visibleRect_.height;
+    frame.timestamp = static_cast<uint64_t>(buffer.timestamp.tv_sec) * 1000000 + buffer.timestamp.tv_usec;
+
+    if(multiPlanar_)
+    {
+        frame.width = captureFormat_.fmt.pix_mp.width;
+        frame.height = captureFormat_.fmt.pix_mp.height;
+        frame.pixelFormat = captureFormat_.fmt.pix_mp.pixelformat;
+        for(uint32_t plane = 0; plane < exported.planeCount; ++plane)
+        {
+            frame.dmabufFd[plane] = exported.dmabufFd[plane];
+            frame.bytesPerLine[plane] = captureFormat_.fmt.pix_mp.plane_fmt[plane].bytesperline;
+            frame.planeOffset[plane] = planes[plane].data_offset;
+        }
+    }
+    else
+    {
+        frame.width = captureFormat_.fmt.pix.width;
+        frame.height = captureFormat_.fmt.pix.height;
+        frame.pixelFormat = captureFormat_.fmt.pix.pixelformat;
+        frame.dmabufFd[0] = exported.dmabufFd[0];
+        frame.bytesPerLine[0] = captureFormat_.fmt.pix.bytesperline;
+        frame.planeOffset[0] = 0;
+    }
+}
+
+void V4L2VideoOutput::dequeueOutput()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    bool released = false;
+
+    for(;;)
+    {
+        v4l2_buffer buffer{};
+        v4l2_plane planes[VIDEO_MAX_PLANES]{};
+        this->prepareBuffer(buffer, planes, outputType_, 0);
+
+        if(xioctl(fd_, VIDIOC_DQBUF, &buffer) != 0)
+        {
+            break;
+        }
+
+        freeOutputBuffers_.push_back(buffer.index);
+        released = true;
+    }
+
+    if(released)
+    {
+        outputAvailable_.notify_one();
+    }
+}
+
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,336 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoCapabilities.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+using aap_protobuf::service::media::shared::message::MediaCodecType;
+using aap_protobuf::service::media::sink::message::VideoCodecResolutionType;
+using aap_protobuf::service::media::sink::message::VideoFrameRateType;
+
+// a decoder is only trusted with 80% of what it managed before, frame sizes vary
+constexpr uint64_t cHeadroomPercent = 80;
+
+const VideoCodecResolutionType cLandscapeResolutions[] = {
+    aap_protobuf::service::media::sink::message::VIDEO_3840x2160,
+    aap_protobuf::service::media::sink::message::VIDEO_2560x1440,
+    aap_protobuf::service::media::sink::message::VIDEO_1920x1080,
+    aap_protobuf::service::media::sink::message::VIDEO_1280x720,
+    aap_protobuf::service::media::sink::message::VIDEO_800x480
+};
+
+const VideoCodecResolutionType cPortraitResolutions[] = {
+    aap_protobuf::service::media::sink::message::VIDEO_2160x3840,
+    aap_protobuf::service::media::sink::message::VIDEO_1440x2560,
+    aap_protobuf::service::media::sink::message::VIDEO_1080x1920,
+    aap_protobuf::service::media::sink::message::VIDEO_720x1280
+};
+
+const MediaCodecType cCodecPreference[] = {
+    aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265,
+    aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H264_BP
+};
+
+std::string measurementKey(MediaCodecType codec)
+{
+    return MediaCodecType_Name(codec) + ".PixelRate";
+}
+
+}
+
+const std::string VideoCapabilities::cMeasurementFileName = "openauto_video.ini";
+
+void VideoCapabilities::add(const DecoderCapability& capability)
+{
+    decoders_.push_back(capability);
+}
+
+bool VideoCapabilities::hasCodec(MediaCodecType codec) const
+{
+    return std::any_of(decoders_.begin(), decoders_.end(), [codec](const auto& decoder) { return decoder.codec == codec; });
+}
+
+const std::vector<DecoderCapability>& VideoCapabilities::getDecoders() const
+{
+    return decoders_;
+}
+
+void VideoCapabilities::setMeasuredPixelRate(MediaCodecType codec, uint64_t pixelRate)
+{
+    measuredPixelRates_[codec] = pixelRate;
+}
+
+uint64_t VideoCapabilities::getMeasuredPixelRate(MediaCodecType codec) const
+{
+    const auto it = measuredPixelRates_.find(codec);
+    return it != measuredPixelRates_.end() ? it->second : 0;
+}
+
+void VideoCapabilities::setPixelRateLimit(uint64_t pixelRate)
+{
+    pixelRateLimit_ = pixelRate;
+}
+
+void VideoCapabilities::setDisplaySize(uint32_t width, uint32_t height)
+{
+    displayWidth_ = width;
+    displayHeight_ = height;
+}
+
+bool VideoCapabilities::supports(const VideoMode& mode) const
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    resolutionSize(mode.resolution, width, height);
+    const uint64_t pixelRate = static_cast<uint64_t>(width) * height * framesPerSecond(mode.frameRate);
+    if(pixelRateLimit_ > 0 && pixelRate > pixelRateLimit_)
+    {
+        return false;
+    }
+
+    const uint64_t measured = this->getMeasuredPixelRate(mode.codec);
+
+    for(const auto& decoder: decoders_)
+    {
+        if(decoder.codec != mode.codec)
+        {
+            continue;
+        }
+
+        // size limits are given for the decoder's native orientation, a portrait stream fits the same way turned
+        const auto longSide = std::max(width, height);
+        const auto shortSide = std::min(width, height);
+        if(longSide > std::max(decoder.maxWidth, decoder.maxHeight) || shortSide > std::min(decoder.maxWidth, decoder.maxHeight))
+        {
+            continue;
+        }
+
+        const uint64_t limit = measured > 0 ? measured * cHeadroomPercent / 100 : decoder.maxPixelRate;
+        if(limit == 0 || pixelRate <= limit)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<VideoMode> VideoCapabilities::selectModes(VideoCodecResolutionType maxResolution, VideoFrameRateType frameRate) const
+{
+    uint32_t maxWidth = 0;
+    uint32_t maxHeight = 0;
+    resolutionSize(maxResolution, maxWidth, maxHeight);
+
+    std::vector<VideoFrameRateType> frameRates{frameRate};
+    if(frameRate == aap_protobuf::service::media::sink::message::VIDEO_FPS_60)
+    {
+        frameRates.push_back(aap_protobuf::service::media::sink::message::VIDEO_FPS_30);
+    }
+
+    std::vector<VideoCodecResolutionType> resolutions;
+    if(maxHeight > maxWidth)
+    {
+        resolutions.assign(std::begin(cPortraitResolutions), std::end(cPortraitResolutions));
+    }
+    else
+    {
+        resolutions.assign(std::begin(cLandscapeResolutions), std::end(cLandscapeResolutions));
+    }
+
+    if(displayWidth_ > 0 && displayHeight_ > 0)
+    {
+        // a frame holds a picture of the display's aspect ratio as big as the display
+        // exactly when it is at least that big itself
+        const auto covering = std::find_if(resolutions.rbegin(), resolutions.rend(), [this](const auto resolution) {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            resolutionSize(resolution, width, height);
+            return width >= displayWidth_ && height >= displayHeight_;
+        });
+        if(covering != resolutions.rend())
+        {
+            resolutions.erase(resolutions.begin(), std::prev(covering.base()));
+        }
+    }
+
+    std::vector<VideoMode> modes;
+    for(const auto codec: cCodecPreference)
+    {
+        for(const auto resolution: resolutions)
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            resolutionSize(resolution, width, height);
+            if(width > maxWidth || height > maxHeight)
+            {
+                continue;
+            }
+
+            // one entry per size, at the highest frame rate that is sustainable
+            for(const auto rate: frameRates)
+            {
+                VideoMode mode;
+                mode.codec = codec;
+                mode.resolution = resolution;
+                mode.frameRate = rate;
+                if(this->supports(mode))
+                {
+                    modes.push_back(mode);
+                    break;
+                }
+            }
+        }
+    }
+
+    if(modes.empty())
+    {
+        VideoMode mode;
+        mode.resolution = maxResolution;
+        mode.frameRate = frameRate;
+        modes.push_back(mode);
+    }
+
+    return modes;
+}
+
+void VideoCapabilities::loadMeasurements()
+{
+    boost::property_tree::ptree iniConfig;
+
+    try
+    {
+        boost::property_tree::ini_parser::read_ini(cMeasurementFileName, iniConfig);
+    }
+    catch(const boost::property_tree::ini_parser_error&)
+    {
+        return;
+    }
+
+    for(const auto codec: cCodecPreference)
+    {
+        const auto pixelRate = iniConfig.get<uint64_t>(measurementKey(codec), 0);
+        if(pixelRate > 0)
+        {
+            this->setMeasuredPixelRate(codec, pixelRate);
+        }
+    }
+}
+
+void VideoCapabilities::storeMeasurement(MediaCodecType codec, uint64_t pixelRate)
+{
+    boost::property_tree::ptree iniConfig;
+
+    try
+    {
+        boost::property_tree::ini_parser::read_ini(cMeasurementFileName, iniConfig);
+    }
+    catch(const boost::property_tree::ini_parser_error&)
+    {
+        // first measurement
+    }
+
+    // one session is a noisy sample, older ones keep most of their weight
+    const auto previous = iniConfig.get<uint64_t>(measurementKey(codec), 0);
+    const auto value = previous > 0 ? (previous * 3 + pixelRate) / 4 : pixelRate;
+    iniConfig.put<uint64_t>(measurementKey(codec), value);
+
+    try
+    {
+        boost::property_tree::ini_parser::write_ini(cMeasurementFileName, iniConfig);
+        OPENAUTO_LOG(info) << "[VideoCapabilities] " << MediaCodecType_Name(codec) << " decode throughput: "
+                           << pixelRate / 1000000 << " Mpixel/s, stored " << value / 1000000 << " Mpixel/s";
+    }
+    catch(const boost::property_tree::ini_parser_error& e)
+    {
+        OPENAUTO_LOG(warning) << "[VideoCapabilities] failed to write " << cMeasurementFileName << ": " << e.what();
+    }
+}
+
+void VideoCapabilities::resolutionSize(VideoCodecResolutionType resolution, uint32_t& width, uint32_t& height)
+{
+    switch(resolution)
+    {
+    case aap_protobuf::service::media::sink::message::VIDEO_1280x720:
+        width = 1280; height = 720;
+        break;
+    case aap_protobuf::service::media::sink::message::VIDEO_1920x1080:
+        width = 1920; height = 1080;
+        break;
+    case aap_protobuf::service::media::sink::message::VIDEO_2560x1440:
+        width = 2560; height = 1440;
+        break;
+    case aap_protobuf::service::media::sink::message::VIDEO_3840x2160:
+        width = 3840; height = 2160;
+        break;
+    case aap_protobuf::service::media::sink::message::VIDEO_720x1280:
+        width = 720; height = 1280;
+        break;
+    case aap_protobuf::service::media::sink::message::VIDEO_1080x1920:
+        width = 1080; height = 1920;
+        break;
+    case aap_protobuf::service::media::sink::message::VIDEO_1440x2560:
+        width = 1440; height = 2560;
+        break;
+    case aap_protobuf::service::media::sink::message::VIDEO_2160x3840:
+        width = 2160; height = 3840;
+        break;
+    default:
+        width = 800; height = 480;
+        break;
+    }
+}
+
+uint32_t VideoCapabilities::framesPerSecond(VideoFrameRateType frameRate)
+{
+    return frameRate == aap_protobuf::service::media::sink::message::VIDEO_FPS_60 ? 60 : 30;
+}
+
+std::string VideoCapabilities::describe(const VideoMode& mode)
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    resolutionSize(mode.resolution, width, height);
+
+    std::ostringstream stream;
+    stream << (mode.codec == aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265 ? "H.265 " : "H.264 ")
+           << width << "x" << height << "@" << framesPerSecond(mode.frameRate);
+    return stream.str();
+}
+
+}
+}
+}
+}
@@ -0,0 +1,164 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <f1x/openauto/autoapp/Projection/VideoDecodeThread.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/ThreadCpuMonitor.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+VideoDecodeThread::VideoDecodeThread(IVideoOutput::Pointer videoOutput, size_t depth)
+    : videoOutput_(std::move(videoOutput))
+    , queue_(depth)
+    , running_(false)
+    , sleeping_(false)
+    , spaceWanted_(false)
+    , writtenFrames_(0)
+{
+}
+
+VideoDecodeThread::~VideoDecodeThread()
+{
+    this->stop();
+}
+
+void VideoDecodeThread::start()
+{
+    if(running_.exchange(true))
+    {
+        return;
+    }
+
+    writtenFrames_ = 0;
+    thread_ = std::thread(&VideoDecodeThread::run, this);
+    OPENAUTO_LOG(info) << "[VideoDecodeThread] started, queue depth: " << queue_.capacity();
+}
+
+void VideoDecodeThread::stop()
+{
+    if(!running_.exchange(false))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        wakeup_.notify_one();
+    }
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    // whatever is still queued belongs to a stream that is going away
+    QueuedVideoFrame frame;
+    while(queue_.pop(frame));
+    spaceWanted_ = false;
+
+    OPENAUTO_LOG(info) << "[VideoDecodeThread] stopped, written frames: " << writtenFrames_.load();
+}
+
+bool VideoDecodeThread::push(QueuedVideoFrame&& frame)
+{
+    if(!queue_.push(std::move(frame)))
+    {
+        // announce first and try again, the decode thread may have emptied the queue in between
+        spaceWanted_ = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(!queue_.push(std::move(frame)))
+        {
+            return false;
+        }
+    }
+
+    // pairs with the fence in run(): either the decode thread sees the frame or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleeping_)
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        wakeup_.notify_one();
+    }
+
+    return true;
+}
+
+void VideoDecodeThread::setSpaceHandler(SpaceHandler handler)
+{
+    spaceHandler_ = std::move(handler);
+}
+
+size_t VideoDecodeThread::getDepth() const
+{
+    return queue_.capacity();
+}
+
+size_t VideoDecodeThread::getQueuedFrameCount() const
+{
+    return queue_.size();
+}
+
+uint64_t VideoDecodeThread::getWrittenFrameCount() const
+{
+    return writtenFrames_;
+}
+
+void VideoDecodeThread::run()
+{
+    diagnostics::setCurrentThreadName("video-decoder");
+    QueuedVideoFrame frame;
+
+    while(running_)
+    {
+        if(!queue_.pop(frame))
+        {
+            std::unique_lock<decltype(mutex_)> lock(mutex_);
+            sleeping_ = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wakeup_.wait(lock, [this]() { return !queue_.empty() || !running_; });
+            sleeping_ = false;
+            continue;
+        }
+
+        if(spaceWanted_.exchange(false) && spaceHandler_)
+        {
+            spaceHandler_();
+        }
+
+        videoOutput_->write(frame.timestamp, frame.buffer);
+        ++writtenFrames_;
+        diagnostics::VideoStatistics::onFrameDecoded(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - frame.received));
+
+        // give the message back to its pool as early as possible
+        frame = QueuedVideoFrame();
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,110 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+namespace
+{
+
+uint32_t roundToMultipleOf4(uint64_t value)
+{
+    return static_cast<uint32_t>((value + 2) / 4 * 4);
+}
+
+}
+
+QRect VideoGeometry::fitMargins(uint32_t codecWidth, uint32_t codecHeight, uint32_t displayWidth, uint32_t displayHeight)
+{
+    if(codecWidth == 0 || codecHeight == 0 || displayWidth == 0 || displayHeight == 0)
+    {
+        return QRect();
+    }
+
+    const auto codecAspect = static_cast<uint64_t>(codecWidth) * displayHeight;
+    const auto displayAspect = static_cast<uint64_t>(displayWidth) * codecHeight;
+    if(codecAspect > displayAspect)
+    {
+        // frame wider than the display: full height, margins left and right
+        const auto contentWidth = (static_cast<uint64_t>(codecHeight) * displayWidth + displayHeight / 2) / displayHeight;
+        return QRect(0, 0, roundToMultipleOf4(codecWidth - contentWidth), 0);
+    }
+
+    const auto contentHeight = (static_cast<uint64_t>(codecWidth) * displayHeight + displayWidth / 2) / displayWidth;
+    return QRect(0, 0, 0, roundToMultipleOf4(codecHeight - contentHeight));
+}
+
+QRect VideoGeometry::scaleMargins(const QRect& margins, uint32_t fromWidth, uint32_t fromHeight, uint32_t toWidth, uint32_t toHeight)
+{
+    if(fromWidth == 0 || fromHeight == 0)
+    {
+        return QRect();
+    }
+
+    return QRect(0, 0, static_cast<int>(static_cast<uint64_t>(margins.width()) * toWidth / fromWidth),
+                 static_cast<int>(static_cast<uint64_t>(margins.height()) * toHeight / fromHeight));
+}
+
+QRect VideoGeometry::contentRect(uint32_t codecWidth, uint32_t codecHeight, const QRect& margins)
+{
+    // margins that leave nothing are not honoured
+    const auto marginWidth = static_cast<uint32_t>(margins.width()) < codecWidth ? static_cast<uint32_t>(margins.width()) : 0;
+    const auto marginHeight = static_cast<uint32_t>(margins.height()) < codecHeight ? static_cast<uint32_t>(margins.height()) : 0;
+
+    return QRect(static_cast<int>(marginWidth / 2), static_cast<int>(marginHeight / 2),
+                 static_cast<int>(codecWidth - marginWidth), static_cast<int>(codecHeight - marginHeight));
+}
+
+QRect VideoGeometry::displayRect(uint32_t contentWidth, uint32_t contentHeight, uint32_t displayWidth, uint32_t displayHeight)
+{
+    if(contentWidth == 0 || contentHeight == 0)
+    {
+        return QRect(0, 0, static_cast<int>(displayWidth), static_cast<int>(displayHeight));
+    }
+
+    // scaled to the full width, then to the full height if that is too tall
+    auto width = static_cast<uint64_t>(displayWidth);
+    auto height = (static_cast<uint64_t>(displayWidth) * contentHeight + contentWidth / 2) / contentWidth;
+    if(height > displayHeight)
+    {
+        height = displayHeight;
+        width = std::min<uint64_t>((static_cast<uint64_t>(displayHeight) * contentWidth + contentHeight / 2) / contentHeight, displayWidth);
+    }
+
+    if(displayWidth - width <= 1 && displayHeight - height <= 1)
+    {
+        return QRect(0, 0, static_cast<int>(displayWidth), static_cast<int>(displayHeight));
+    }
+
+    return QRect(static_cast<int>((displayWidth - width) / 2), static_cast<int>((displayHeight - height) / 2),
+                 static_cast<int>(width), static_cast<int>(height));
+}
+
+}
+}
+}
+}
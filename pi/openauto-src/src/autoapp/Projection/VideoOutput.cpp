@@ -16,8 +16,12 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <QGuiApplication>
+#include <QScreen>
 #include <f1x/openauto/Common/Log.hpp>
 #include <f1x/openauto/autoapp/Projection/VideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
 
 namespace f1x {
   namespace openauto {
@@ -25,8 +29,63 @@ namespace f1x {
       namespace projection {
 
         VideoOutput::VideoOutput(configuration::IConfiguration::Pointer configuration)
-            : configuration_(std::move(configuration)) {
+            : configuration_(std::move(configuration)), resumeStart_(0) {
+          videoMode_.resolution = configuration_->getVideoResolution();
+          videoMode_.frameRate = configuration_->getVideoFPS();
 
+          const auto *screen = QGuiApplication::primaryScreen();
+          if (screen != nullptr) {
+            displayGeometry_ = QRect(0, 0, screen->size().width(), screen->size().height());
+          }
+        }
+
+        bool VideoOutput::suspend() {
+          return false;
+        }
+
+        void VideoOutput::resume() {
+        }
+
+        VideoCapabilities VideoOutput::getCapabilities() {
+          DecoderCapability decoder;
+          VideoCapabilities::resolutionSize(configuration_->getVideoResolution(), decoder.maxWidth, decoder.maxHeight);
+
+          VideoCapabilities capabilities;
+          capabilities.add(decoder);
+          return capabilities;
+        }
+
+        void VideoOutput::setVideoMode(const VideoMode &mode) {
+          OPENAUTO_LOG(info) << "[VideoOutput] video mode: " << VideoCapabilities::describe(mode);
+          videoMode_ = mode;
+        }
+
+        void VideoOutput::setMediaClock(MediaClock::Pointer clock) {
+          mediaClock_ = std::move(clock);
+        }
+
+        VideoMode VideoOutput::getVideoMode() const {
+          return videoMode_;
+        }
+
+        void VideoOutput::startResumeTimer() {
+          resumeStart_ = std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        void VideoOutput::onPictureShown() {
+          diagnostics::VideoStatistics::onFrameShown();
+
+          const auto start = resumeStart_.exchange(0);
+          if (start != 0) {
+            const auto elapsed = std::chrono::steady_clock::now()
+                                 - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(start));
+            OPENAUTO_LOG(info) << "[VideoOutput] resume to first frame: "
+                               << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms";
+          }
+        }
+
+        void VideoOutput::onFrameDropped() {
+          diagnostics::VideoStatistics::onFrameDropped();
         }
 
         aap_protobuf::service::media::sink::message::VideoFrameRateType VideoOutput::getVideoFPS() const {
@@ -41,8 +100,26 @@ namespace f1x {
           return configuration_->getScreenDPI();
         }
 
-        QRect VideoOutput::getVideoMargins() const {
-          return configuration_->getVideoMargins();
+        QRect VideoOutput::getVideoMargins(const VideoMode &mode) const {
+          uint32_t width = 0;
+          uint32_t height = 0;
+          VideoCapabilities::resolutionSize(mode.resolution, width, height);
+
+          const auto &configuredMargins = configuration_->getVideoMargins();
+          if (configuredMargins.width() > 0 || configuredMargins.height() > 0) {
+            // given for the configured resolution, the ceiling of all modes
+            uint32_t configuredWidth = 0;
+            uint32_t configuredHeight = 0;
+            VideoCapabilities::resolutionSize(configuration_->getVideoResolution(), configuredWidth, configuredHeight);
+            return VideoGeometry::scaleMargins(configuredMargins, configuredWidth, configuredHeight, width, height);
+          }
+
+          const auto display = this->getDisplayGeometry();
+          return VideoGeometry::fitMargins(width, height, display.width(), display.height());
+        }
+
+        QRect VideoOutput::getDisplayGeometry() const {
+          return displayGeometry_;
         }
 
       }
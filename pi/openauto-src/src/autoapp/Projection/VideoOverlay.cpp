@@ -0,0 +1,62 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <f1x/openauto/autoapp/Projection/VideoOverlay.hpp>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace projection
+{
+
+VideoOverlay::VideoOverlay()
+    : generation_(1)
+{
+}
+
+void VideoOverlay::update(Image image)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    image_ = std::move(image);
+    ++generation_;
+}
+
+bool VideoOverlay::fetch(uint64_t& generation, Image& image) const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    if(generation == generation_)
+    {
+        return false;
+    }
+
+    generation = generation_;
+    image.width = image_.width;
+    image.height = image_.height;
+    // assign keeps the capacity of the caller's buffer
+    image.pixels.assign(image_.pixels.begin(), image_.pixels.end());
+    return true;
+}
+
+}
+}
+}
+}
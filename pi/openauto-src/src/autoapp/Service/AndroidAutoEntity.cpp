@@ -31,18 +31,23 @@ namespace f1x {
                                              aasdk::messenger::IMessenger::Pointer messenger,
                                              configuration::IConfiguration::Pointer configuration,
                                              ServiceList serviceList,
-                                             IPinger::Pointer pinger)
+                                             IPinger::Pointer pinger,
+                                             RoundTripEstimator::Pointer roundTripEstimator)
             : strand_(ioService), cryptor_(std::move(cryptor)), transport_(std::move(transport)),
               messenger_(std::move(messenger)), controlServiceChannel_(
                 std::make_shared<aasdk::channel::control::ControlServiceChannel>(strand_, messenger_)),
               configuration_(std::move(configuration)), serviceList_(std::move(serviceList)),
-              pinger_(std::move(pinger)), eventHandler_(nullptr) {
+              pinger_(std::move(pinger)), roundTripEstimator_(std::move(roundTripEstimator)), eventHandler_(nullptr) {
         }
 
         AndroidAutoEntity::~AndroidAutoEntity() {
           OPENAUTO_LOG(debug) << "[AndroidAutoEntity] destroy.";
         }
 
+        void AndroidAutoEntity::setAudioFocusHandler(AudioFocusHandler handler) {
+          audioFocusHandler_ = std::move(handler);
+        }
+
         void AndroidAutoEntity::start(IAndroidAutoEntityEventHandler &eventHandler) {
           strand_.dispatch([this, self = this->shared_from_this(), eventHandler = &eventHandler]() {
             OPENAUTO_LOG(info) << "[AndroidAutoEntity] start()";
@@ -237,6 +242,10 @@ namespace f1x {
               ? aap_protobuf::service::control::message::AudioFocusStateType::AUDIO_FOCUS_STATE_LOSS
               : aap_protobuf::service::control::message::AudioFocusStateType::AUDIO_FOCUS_STATE_GAIN;
 
+          if (audioFocusHandler_) {
+            audioFocusHandler_(request.audio_focus_type());
+          }
+
           OPENAUTO_LOG(debug) << "[AndroidAutoEntity] AudioFocusStateType determined: "
                              << AudioFocusStateType_Name(audioFocusStateType);
 
@@ -311,6 +320,7 @@ namespace f1x {
           OPENAUTO_LOG(info) << "[AndroidAutoEntity] onPingResponse()";
           OPENAUTO_LOG(debug) << "[AndroidAutoEntity] Timestamp: " << response.timestamp();
           pinger_->pong();
+          roundTripEstimator_->onPingResponse(response.timestamp());
           controlServiceChannel_->receive(this->shared_from_this());
         }
 
@@ -61,11 +61,16 @@ namespace f1x {
                                                                        std::make_shared<aasdk::messenger::MessageOutStream>(
                                                                            ioService_, transport, cryptor)));
 
-          auto serviceList = serviceFactory_.create(messenger);
+          auto roundTripEstimator(std::make_shared<RoundTripEstimator>());
+          auto serviceList = serviceFactory_.create(messenger, roundTripEstimator);
           auto pinger(std::make_shared<Pinger>(ioService_, 10000));
-          return std::make_shared<AndroidAutoEntity>(ioService_, std::move(cryptor), std::move(transport),
-                                                     std::move(messenger), configuration_, std::move(serviceList),
-                                                     std::move(pinger));
+          auto entity = std::make_shared<AndroidAutoEntity>(ioService_, std::move(cryptor), std::move(transport),
+                                                            std::move(messenger), configuration_, std::move(serviceList),
+                                                            std::move(pinger), std::move(roundTripEstimator));
+          entity->setAudioFocusHandler([&serviceFactory = serviceFactory_](auto type) {
+            serviceFactory.onAudioFocusRequest(type);
+          });
+          return entity;
         }
 
       }
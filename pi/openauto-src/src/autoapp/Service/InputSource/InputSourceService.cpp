@@ -29,7 +29,7 @@ namespace f1x {
                                                  projection::IInputDevice::Pointer inputDevice)
               : strand_(ioService),
                 channel_(std::make_shared<aasdk::channel::inputsource::InputSourceService>(strand_, std::move(messenger))),
-                inputDevice_(std::move(inputDevice)) {
+                inputDevice_(std::move(inputDevice)), inputDeviceStarted_(false), paused_(false) {
 
           }
 
@@ -43,6 +43,7 @@ namespace f1x {
           void InputSourceService::stop() {
             strand_.dispatch([this, self = this->shared_from_this()]() {
               OPENAUTO_LOG(info) << "[InputSourceService] stop()";
+              inputDeviceStarted_ = false;
               inputDevice_->stop();
             });
           }
@@ -50,12 +51,21 @@ namespace f1x {
           void InputSourceService::pause() {
             strand_.dispatch([this, self = this->shared_from_this()]() {
               OPENAUTO_LOG(info) << "[InputSourceService] pause()";
+              // touches on the home screen are not meant for the phone
+              paused_ = true;
+              if (inputDeviceStarted_) {
+                inputDevice_->stop();
+              }
             });
           }
 
           void InputSourceService::resume() {
             strand_.dispatch([this, self = this->shared_from_this()]() {
               OPENAUTO_LOG(info) << "[InputSourceService] resume()";
+              if (paused_ && inputDeviceStarted_) {
+                inputDevice_->start(*this);
+              }
+              paused_ = false;
             });
           }
 
@@ -119,7 +129,10 @@ namespace f1x {
             response.set_status(status);
 
             if (status == aap_protobuf::shared::MessageStatus::STATUS_SUCCESS) {
-              inputDevice_->start(*this);
+              inputDeviceStarted_ = true;
+              if (!paused_) {
+                inputDevice_->start(*this);
+              }
             }
 
             OPENAUTO_LOG(debug) << "[InputSourceService] Sending KeyBindingResponse with Status: " << status;
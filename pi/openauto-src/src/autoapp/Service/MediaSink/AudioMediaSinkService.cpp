@@ -27,8 +27,11 @@ namespace f1x {
 
           AudioMediaSinkService::AudioMediaSinkService(boost::asio::io_service &ioService,
                                                        aasdk::channel::mediasink::audio::IAudioMediaSinkService::Pointer channel,
-                                                       projection::IAudioOutput::Pointer audioOutput)
-              : strand_(ioService), channel_(std::move(channel)), audioOutput_(std::move(audioOutput)), session_(-1) {
+                                                       projection::IAudioOutput::Pointer audioOutput,
+                                                       MediaFlowController::Pointer flowController)
+              : strand_(ioService), channel_(std::move(channel)), audioOutput_(std::move(audioOutput)), session_(-1),
+                flowController_(flowController != nullptr ? std::move(flowController)
+                                                          : std::make_shared<MediaFlowController>(1, false)) {
 
           }
 
@@ -164,7 +167,7 @@ namespace f1x {
             aap_protobuf::service::media::shared::message::Config response;
             auto status = aap_protobuf::service::media::shared::message::Config::STATUS_READY;
             response.set_status(status);
-            response.set_max_unacked(1);
+            response.set_max_unacked(flowController_->getMaxUnacked());
             response.add_configuration_indices(0);
 
             auto promise = aasdk::channel::SendPromise::defer(strand_);
@@ -180,6 +183,7 @@ namespace f1x {
             OPENAUTO_LOG(info) << "[AudioMediaSinkService] onMediaChannelStartIndication()";
             OPENAUTO_LOG(info) << "[AudioMediaSinkService] Channel Id: " << aasdk::messenger::channelIdToString(channel_->getId()) << ", session: " << indication.session_id();
             session_ = indication.session_id();
+            flowController_->reset();
             audioOutput_->start();
             channel_->receive(this->shared_from_this());
           }
@@ -199,16 +203,20 @@ namespace f1x {
             OPENAUTO_LOG(debug) << "[AudioMediaSinkService] onMediaWithTimestampIndication()";
             OPENAUTO_LOG(debug) << "[AudioMediaSinkService] Channel Id: " << aasdk::messenger::channelIdToString(channel_->getId()) << ", session: " << session_;
 
+            flowController_->onReceived();
             audioOutput_->write(timestamp, buffer);
 
-            aap_protobuf::service::media::source::message::Ack indication;
-            indication.set_session_id(session_);
-            indication.set_ack(1);
+            const auto count = flowController_->onConsumed();
+            if (count > 0) {
+              aap_protobuf::service::media::source::message::Ack indication;
+              indication.set_session_id(session_);
+              indication.set_ack(count);
 
-            auto promise = aasdk::channel::SendPromise::defer(strand_);
-            promise->then([]() {}, std::bind(&AudioMediaSinkService::onChannelError, this->shared_from_this(),
-                                             std::placeholders::_1));
-            channel_->sendMediaAckIndication(indication, std::move(promise));
+              auto promise = aasdk::channel::SendPromise::defer(strand_);
+              promise->then([]() {}, std::bind(&AudioMediaSinkService::onChannelError, this->shared_from_this(),
+                                               std::placeholders::_1));
+              channel_->sendMediaAckIndication(indication, std::move(promise));
+            }
             channel_->receive(this->shared_from_this());
           }
 
@@ -26,11 +26,12 @@ namespace f1x::openauto::autoapp::service::mediasink {
 
   GuidanceAudioService::GuidanceAudioService(boost::asio::io_service &ioService,
                                              aasdk::messenger::IMessenger::Pointer messenger,
-                                             projection::IAudioOutput::Pointer audioOutput)
+                                             projection::IAudioOutput::Pointer audioOutput,
+                                             MediaFlowController::Pointer flowController)
       : AudioMediaSinkService(
       ioService,
       std::make_shared<GuidanceAudioChannel>(strand_, std::move(messenger)),
-      std::move(audioOutput)) {
+      std::move(audioOutput), std::move(flowController)) {
 
   }
 }
@@ -22,12 +22,13 @@
 namespace f1x::openauto::autoapp::service::mediasink {
   MediaAudioService::MediaAudioService(boost::asio::io_service &ioService,
                                        aasdk::messenger::IMessenger::Pointer messenger,
-                                       projection::IAudioOutput::Pointer audioOutput)
+                                       projection::IAudioOutput::Pointer audioOutput,
+                                       MediaFlowController::Pointer flowController)
       : AudioMediaSinkService(ioService,
                               std::make_shared<aasdk::channel::mediasink::audio::channel::MediaAudioChannel>(strand_,
                                                                                                              std::move(
                                                                                                                  messenger)),
-                              std::move(audioOutput)) {
+                              std::move(audioOutput), std::move(flowController)) {
 
   }
 }
@@ -0,0 +1,119 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Service/MediaSink/MediaFlowController.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x::openauto::autoapp::service::mediasink {
+
+  // gaps longer than this are pauses in the stream, not the frame rate
+  static constexpr auto cMaximumArrivalGap = std::chrono::seconds(1);
+
+  MediaFlowController::MediaFlowController(uint32_t maxUnacked, bool adaptive,
+                                           RoundTripEstimator::Pointer roundTripEstimator)
+      : maxUnacked_(std::max<uint32_t>(maxUnacked, 1)), adaptive_(adaptive),
+        roundTripEstimator_(std::move(roundTripEstimator)), window_(maxUnacked_), roundFrames_(0), consumed_(0),
+        acked_(0), arrivalInterval_(0) {
+
+  }
+
+  uint32_t MediaFlowController::getMaxUnacked() const {
+    return maxUnacked_;
+  }
+
+  uint32_t MediaFlowController::getWindow() const {
+    return window_;
+  }
+
+  std::chrono::microseconds MediaFlowController::getRoundTrip() const {
+    return roundTripEstimator_ != nullptr ? roundTripEstimator_->get() : std::chrono::microseconds(0);
+  }
+
+  void MediaFlowController::reset() {
+    window_ = maxUnacked_;
+    roundFrames_ = 0;
+    consumed_ = 0;
+    acked_ = 0;
+    lastArrival_ = Clock::time_point();
+    arrivalInterval_ = std::chrono::microseconds(0);
+  }
+
+  void MediaFlowController::onReceived(Clock::time_point now) {
+    if (lastArrival_ != Clock::time_point() && now - lastArrival_ < cMaximumArrivalGap) {
+      const auto sample = std::chrono::duration_cast<std::chrono::microseconds>(now - lastArrival_);
+      arrivalInterval_ = arrivalInterval_.count() == 0 ? sample : arrivalInterval_ + (sample - arrivalInterval_) / 16;
+    }
+
+    lastArrival_ = now;
+  }
+
+  uint32_t MediaFlowController::onConsumed(size_t backlog) {
+    ++consumed_;
+
+    if (adaptive_ && ++roundFrames_ >= window_) {
+      roundFrames_ = 0;
+      this->adapt(backlog);
+    }
+
+    // The phone sends while fewer than maxUnacked frames are unacked. Keeping
+    // (maxUnacked - window) consumed frames unacked limits what it can send
+    // ahead of the output to window frames.
+    const uint64_t held = maxUnacked_ - window_;
+    if (consumed_ < acked_ + held) {
+      return 0;
+    }
+
+    // Batches of half a window still leave the phone credit for the other half,
+    // so it never waits on an ack that is being held back here.
+    const auto ackable = consumed_ - held - acked_;
+    if (ackable < (window_ + 1) / 2) {
+      return 0;
+    }
+
+    acked_ += ackable;
+    return static_cast<uint32_t>(ackable);
+  }
+
+  void MediaFlowController::adapt(size_t backlog) {
+    // one frame being decoded, one arriving, plus whatever is on the wire during a round trip
+    uint32_t target = 2;
+    const auto roundTrip = this->getRoundTrip();
+    if (arrivalInterval_.count() > 0) {
+      target += static_cast<uint32_t>((roundTrip.count() + arrivalInterval_.count() - 1) / arrivalInterval_.count());
+    }
+    target = std::min(target, maxUnacked_);
+
+    const auto previous = window_;
+    if (backlog > window_ / 2) {
+      // the decoder does not keep up, more credit would only add latency
+      window_ = std::max<uint32_t>(window_ - 1, 1);
+    } else if (window_ < target) {
+      ++window_;
+    } else if (window_ > target) {
+      --window_;
+    }
+
+    if (window_ != previous) {
+      OPENAUTO_LOG(debug) << "[MediaFlowController] window: " << previous << " -> " << window_
+                          << ", backlog: " << backlog << ", rtt: " << roundTrip.count()
+                          << " us, frame interval: " << arrivalInterval_.count() << " us";
+    }
+  }
+
+}
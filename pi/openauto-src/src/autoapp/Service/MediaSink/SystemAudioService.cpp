@@ -23,12 +23,13 @@
 namespace f1x::openauto::autoapp::service::mediasink {
   SystemAudioService::SystemAudioService(boost::asio::io_service &ioService,
                                          aasdk::messenger::IMessenger::Pointer messenger,
-                                         projection::IAudioOutput::Pointer audioOutput)
+                                         projection::IAudioOutput::Pointer audioOutput,
+                                         MediaFlowController::Pointer flowController)
       : AudioMediaSinkService(ioService,
                               std::make_shared<aasdk::channel::mediasink::audio::channel::SystemAudioChannel>(strand_,
                                                                                                               std::move(
                                                                                                                   messenger)),
-                              std::move(audioOutput)) {
+                              std::move(audioOutput), std::move(flowController)) {
 
   }
 
@@ -26,11 +26,12 @@ namespace f1x {
         namespace mediasink {
           TelephonyAudioService::TelephonyAudioService(boost::asio::io_service &ioService,
                                                      aasdk::messenger::IMessenger::Pointer messenger,
-                                                     projection::IAudioOutput::Pointer audioOutput)
+                                                     projection::IAudioOutput::Pointer audioOutput,
+                                                     MediaFlowController::Pointer flowController)
               : AudioMediaSinkService(ioService, std::make_shared<aasdk::channel::mediasink::audio::channel::TelephonyAudioChannel>(strand_,
                                                                                                           std::move(
                                                                                                               messenger)),
-                                 std::move(audioOutput)) {
+                                 std::move(audioOutput), std::move(flowController)) {
 
           }
         }
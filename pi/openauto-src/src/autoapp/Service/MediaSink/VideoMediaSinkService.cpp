@@ -18,6 +18,8 @@
 
 #include <fstream>
 #include <f1x/openauto/autoapp/Service/MediaSink/VideoMediaSinkService.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/AllocationTracker.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
 
 namespace f1x {
   namespace openauto {
@@ -26,9 +28,19 @@ namespace f1x {
         namespace mediasink {
           VideoMediaSinkService::VideoMediaSinkService(boost::asio::io_service &ioService,
                                                        aasdk::channel::mediasink::video::IVideoMediaSinkService::Pointer channel,
-                                                       projection::IVideoOutput::Pointer videoOutput)
-              : strand_(ioService), channel_(std::move(channel)), videoOutput_(std::move(videoOutput)), session_(-1) {
-
+                                                       projection::IVideoOutput::Pointer videoOutput,
+                                                       size_t decodeQueueDepth,
+                                                       MediaFlowController::Pointer flowController,
+                                                       bool persistentDecoder)
+              : strand_(ioService), channel_(std::move(channel)), videoOutput_(std::move(videoOutput)), session_(-1),
+                flowController_(flowController != nullptr ? std::move(flowController)
+                                                          : std::make_shared<MediaFlowController>(1, false)),
+                persistentDecoder_(persistentDecoder), suspended_(false), outputStopped_(false),
+                videoFocus_(aap_protobuf::service::media::video::message::VideoFocusMode::VIDEO_FOCUS_NATIVE),
+                frameInterval_(1000000 / 30) {
+            if (decodeQueueDepth > 0) {
+              decodeThread_ = std::make_shared<projection::VideoDecodeThread>(videoOutput_, decodeQueueDepth);
+            }
           }
 
           void VideoMediaSinkService::start() {
@@ -45,6 +57,13 @@ namespace f1x {
               OPENAUTO_LOG(info) << "[VideoMediaSinkService] stop()";
               OPENAUTO_LOG(info) << "[VideoMediaSinkService] Channel "
                                  << aasdk::messenger::channelIdToString(channel_->getId());
+              if (decodeThread_ != nullptr) {
+                decodeThread_->stop();
+                overflow_.clear();
+              }
+              suspended_ = false;
+              outputStopped_ = false;
+              receiveTimes_.clear();
               videoOutput_->stop();
             });
           }
@@ -54,6 +73,24 @@ namespace f1x {
               OPENAUTO_LOG(info) << "[VideoMediaSinkService] pause()";
               OPENAUTO_LOG(info) << "[VideoMediaSinkService] Channel "
                                  << aasdk::messenger::channelIdToString(channel_->getId());
+
+              if (!persistentDecoder_ || suspended_) {
+                return;
+              }
+
+              suspended_ = true;
+              outputStopped_ = !videoOutput_->suspend();
+              if (outputStopped_) {
+                // the session is kept anyway, only the output is rebuilt on resume
+                OPENAUTO_LOG(warning) << "[VideoMediaSinkService] video output cannot be suspended, stopping it.";
+                videoOutput_->stop();
+              }
+
+              // the phone stops streaming until it gets the focus back
+              if (videoFocus_ != aap_protobuf::service::media::video::message::VideoFocusMode::VIDEO_FOCUS_NATIVE) {
+                this->sendVideoFocusNotification(
+                    aap_protobuf::service::media::video::message::VideoFocusMode::VIDEO_FOCUS_NATIVE, true);
+              }
             });
           }
 
@@ -63,6 +100,21 @@ namespace f1x {
               OPENAUTO_LOG(info) << "[VideoMediaSinkService] Channel "
                                  << aasdk::messenger::channelIdToString(channel_->getId());
 
+              if (!suspended_) {
+                return;
+              }
+
+              suspended_ = false;
+              if (outputStopped_) {
+                outputStopped_ = false;
+                videoOutput_->open();
+                videoOutput_->init();
+              } else {
+                videoOutput_->resume();
+              }
+              // regaining the projected focus makes the phone restart the stream with a keyframe
+              this->sendVideoFocusNotification(
+                  aap_protobuf::service::media::video::message::VideoFocusMode::VIDEO_FOCUS_PROJECTED, true);
             });
           }
 
@@ -82,20 +134,39 @@ namespace f1x {
             videoChannel->set_available_while_in_call(true);
 
 
-            auto *videoConfig1 = videoChannel->add_video_configs();
-            videoConfig1->set_codec_resolution(videoOutput_->getVideoResolution());
-            videoConfig1->set_frame_rate(videoOutput_->getVideoFPS());
+            // the configured resolution is the ceiling, density is scaled along with smaller sizes
+            uint32_t configuredWidth = 0;
+            uint32_t configuredHeight = 0;
+            projection::VideoCapabilities::resolutionSize(videoOutput_->getVideoResolution(), configuredWidth,
+                                                          configuredHeight);
+            const auto display = videoOutput_->getDisplayGeometry();
 
-            const auto &videoMargins = videoOutput_->getVideoMargins();
-            videoConfig1->set_height_margin(videoMargins.height());
-            videoConfig1->set_width_margin(videoMargins.width());
-            videoConfig1->set_density(videoOutput_->getScreenDPI());
-
-            OPENAUTO_LOG(info) << "[VideoMediaSinkService] getVideoResolution " << VideoCodecResolutionType_Name(videoOutput_->getVideoResolution());
-            OPENAUTO_LOG(info) << "[VideoMediaSinkService] getVideoFPS " << VideoFrameRateType_Name(videoOutput_->getVideoFPS());
-            OPENAUTO_LOG(info) << "[VideoMediaSinkService] width " << videoMargins.width();
-            OPENAUTO_LOG(info) << "[VideoMediaSinkService] height " << videoMargins.height();
-            OPENAUTO_LOG(info) << "[VideoMediaSinkService] getScreenDPI " << videoOutput_->getScreenDPI();
+            auto capabilities = videoOutput_->getCapabilities();
+            if (qualityController_ != nullptr) {
+              capabilities.setPixelRateLimit(qualityController_->getPixelRateLimit());
+            }
+            capabilities.setDisplaySize(display.width(), display.height());
+
+            videoModes_ = capabilities.selectModes(videoOutput_->getVideoResolution(), videoOutput_->getVideoFPS());
+            for (const auto &mode : videoModes_) {
+              uint32_t width = 0;
+              uint32_t height = 0;
+              projection::VideoCapabilities::resolutionSize(mode.resolution, width, height);
+              const auto videoMargins = videoOutput_->getVideoMargins(mode);
+
+              auto *videoConfig = videoChannel->add_video_configs();
+              videoConfig->set_codec_resolution(mode.resolution);
+              videoConfig->set_frame_rate(mode.frameRate);
+              videoConfig->set_video_codec_type(mode.codec);
+              videoConfig->set_width_margin(videoMargins.width());
+              videoConfig->set_height_margin(videoMargins.height());
+              videoConfig->set_density(videoOutput_->getScreenDPI() * width / configuredWidth);
+
+              OPENAUTO_LOG(info) << "[VideoMediaSinkService] video config " << videoChannel->video_configs_size() - 1
+                                 << ": " << projection::VideoCapabilities::describe(mode)
+                                 << ", margins " << videoConfig->width_margin() << "x" << videoConfig->height_margin()
+                                 << ", density " << videoConfig->density();
+            }
           }
 
           void
@@ -106,7 +177,35 @@ namespace f1x {
                                << MediaCodecType_Name(request.type());
 
 
-            auto status = videoOutput_->init()
+            // the first config of the codec the phone settled on is the best one it can have;
+            // videoModes_.size() when none was offered
+            size_t index = videoModes_.size();
+            for (size_t i = 0; i < videoModes_.size(); ++i) {
+              if (videoModes_[i].codec == request.type()) {
+                index = i;
+                break;
+              }
+            }
+
+            if (index == videoModes_.size()) {
+              // another codec's config would only decode garbage, the phone is told to wait instead
+              OPENAUTO_LOG(error) << "[VideoMediaSinkService] no video config was offered for "
+                                  << MediaCodecType_Name(request.type()) << ", not ready";
+            } else {
+              OPENAUTO_LOG(info) << "[VideoMediaSinkService] using video config " << index << ": "
+                                 << projection::VideoCapabilities::describe(videoModes_[index]);
+              videoOutput_->setVideoMode(videoModes_[index]);
+              frameInterval_ = std::chrono::microseconds(
+                  1000000 / projection::VideoCapabilities::framesPerSecond(videoModes_[index].frameRate));
+              if (qualityController_ != nullptr) {
+                qualityController_->onModeSelected(videoModes_[index]);
+              }
+              if (videoModeHandler_) {
+                videoModeHandler_(videoModes_[index]);
+              }
+            }
+
+            auto status = index < videoModes_.size() && videoOutput_->init()
                           ? aap_protobuf::service::media::shared::message::Config::STATUS_READY
                           : aap_protobuf::service::media::shared::message::Config::STATUS_WAIT;
 
@@ -114,8 +213,10 @@ namespace f1x {
 
             aap_protobuf::service::media::shared::message::Config response;
             response.set_status(status);
-            response.set_max_unacked(1);
-            response.add_configuration_indices(0);
+            response.set_max_unacked(flowController_->getMaxUnacked());
+            if (index < videoModes_.size()) {
+              response.add_configuration_indices(index);
+            }
 
             auto promise = aasdk::channel::SendPromise::defer(strand_);
             promise->then(std::bind(&VideoMediaSinkService::sendVideoFocusIndication, this->shared_from_this()),
@@ -135,6 +236,16 @@ namespace f1x {
                                                                ? aap_protobuf::shared::MessageStatus::STATUS_SUCCESS
                                                                : aap_protobuf::shared::MessageStatus::STATUS_INTERNAL_ERROR;
 
+            if (decodeThread_ != nullptr) {
+              std::weak_ptr<VideoMediaSinkService> weakSelf = this->shared_from_this();
+              decodeThread_->setSpaceHandler([this, weakSelf]() {
+                if (auto self = weakSelf.lock()) {
+                  strand_.dispatch([this, self]() { this->onDecodeQueueSpace(); });
+                }
+              });
+              decodeThread_->start();
+            }
+
             OPENAUTO_LOG(info) << "[VideoMediaSinkService] Status determined: "
                                << aap_protobuf::shared::MessageStatus_Name(status);
 
@@ -156,6 +267,8 @@ namespace f1x {
                                << indication.session_id();
 
             session_ = indication.session_id();
+            flowController_->reset();
+            receiveTimes_.clear();
             channel_->receive(this->shared_from_this());
           }
 
@@ -170,26 +283,98 @@ namespace f1x {
 
           void VideoMediaSinkService::onMediaWithTimestampIndication(aasdk::messenger::Timestamp::ValueType timestamp,
                                                                      const aasdk::common::DataConstBuffer &buffer) {
+            this->onMediaWithTimestampMessage(timestamp, buffer, nullptr);
+          }
+
+          void VideoMediaSinkService::onMediaWithTimestampMessage(aasdk::messenger::Timestamp::ValueType timestamp,
+                                                                  const aasdk::common::DataConstBuffer &buffer,
+                                                                  aasdk::messenger::Message::Pointer message) {
             OPENAUTO_LOG(debug) << "[VideoMediaSinkService] onMediaWithTimestampIndication()";
             OPENAUTO_LOG(debug) << "[VideoMediaSinkService] Channel Id: "
                                << aasdk::messenger::channelIdToString(channel_->getId()) << ", session: " << session_;
 
-            videoOutput_->write(timestamp, buffer);
+            OPENAUTO_ALLOCATION_FRAME();
+            const auto now = MediaFlowController::Clock::now();
+            flowController_->onReceived(now);
+            if (qualityController_ != nullptr) {
+              receiveTimes_.push_back(now);
+            }
+            diagnostics::VideoStatistics::onFrameReceived(buffer.size);
+
+            if (decodeThread_ == nullptr) {
+              videoOutput_->write(timestamp, buffer);
+              diagnostics::VideoStatistics::onFrameDecoded(std::chrono::duration_cast<std::chrono::microseconds>(
+                  MediaFlowController::Clock::now() - now));
+              this->sendMediaAckIndication();
+            } else {
+              projection::QueuedVideoFrame frame{timestamp, buffer, std::move(message), now};
+              if (frame.owner == nullptr) {
+                // nobody keeps the payload alive past this call
+                auto copy = std::make_shared<aasdk::common::Data>(buffer.cdata, buffer.cdata + buffer.size);
+                frame.buffer = aasdk::common::DataConstBuffer(*copy);
+                frame.owner = std::move(copy);
+              }
+
+              // acked when queued, not when decoded; a full queue holds the ack back instead of the strand
+              if (overflow_.empty() && decodeThread_->push(std::move(frame))) {
+                this->sendMediaAckIndication();
+              } else {
+                overflow_.push_back(std::move(frame));
+              }
+            }
+
+            channel_->receive(this->shared_from_this());
+          }
+
+          void VideoMediaSinkService::onDecodeQueueSpace() {
+            while (!overflow_.empty() && decodeThread_->push(std::move(overflow_.front()))) {
+              overflow_.pop_front();
+              this->sendMediaAckIndication();
+            }
+          }
+
+          void VideoMediaSinkService::sendMediaAckIndication() {
+            const auto backlog = decodeThread_ != nullptr ? decodeThread_->getQueuedFrameCount() + overflow_.size() : 0;
+            if (qualityController_ != nullptr) {
+              this->sampleQuality(backlog);
+            }
+
+            const auto count = flowController_->onConsumed(backlog);
+            if (count == 0) {
+              return;
+            }
 
             aap_protobuf::service::media::source::message::Ack indication;
             indication.set_session_id(session_);
-            indication.set_ack(1);
+            indication.set_ack(count);
 
             auto promise = aasdk::channel::SendPromise::defer(strand_);
             promise->then([]() {}, std::bind(&VideoMediaSinkService::onChannelError, this->shared_from_this(),
                                              std::placeholders::_1));
             channel_->sendMediaAckIndication(indication, std::move(promise));
-            channel_->receive(this->shared_from_this());
+          }
+
+          void VideoMediaSinkService::sampleQuality(size_t backlog) {
+            VideoQualityController::Sample sample;
+            sample.decodeLag = frameInterval_ * backlog;
+            // frames are consumed in the order they arrived, the oldest one is the frame just consumed
+            if (!receiveTimes_.empty()) {
+              sample.ackLatency = std::chrono::duration_cast<std::chrono::microseconds>(
+                  MediaFlowController::Clock::now() - receiveTimes_.front());
+              receiveTimes_.pop_front();
+            }
+            sample.roundTrip = flowController_->getRoundTrip();
+            qualityController_->onSample(sample);
           }
 
           void VideoMediaSinkService::onMediaIndication(const aasdk::common::DataConstBuffer &buffer) {
+            this->onMediaMessage(buffer, nullptr);
+          }
+
+          void VideoMediaSinkService::onMediaMessage(const aasdk::common::DataConstBuffer &buffer,
+                                                     aasdk::messenger::Message::Pointer message) {
             OPENAUTO_LOG(debug) << "[VideoMediaSinkService] onMediaIndication()";
-            this->onMediaWithTimestampIndication(0, buffer);
+            this->onMediaWithTimestampMessage(0, buffer, std::move(message));
           }
 
           void VideoMediaSinkService::onChannelError(const aasdk::error::Error &e) {
@@ -217,19 +402,41 @@ namespace f1x {
               } catch (...) {
                 OPENAUTO_LOG(error) << "[VideoMediaSinkService] Error in creating /tmp/entityexit";
               }
+
+              // the session outlives the home screen, so the phone is told to stop streaming
+              if (persistentDecoder_) {
+                this->sendVideoFocusNotification(request.mode(), false);
+                channel_->receive(this->shared_from_this());
+                return;
+              }
             }
 
             this->sendVideoFocusIndication();
             channel_->receive(this->shared_from_this());
           }
 
+          void VideoMediaSinkService::setVideoModeHandler(VideoModeHandler handler) {
+            videoModeHandler_ = std::move(handler);
+          }
+
+          void VideoMediaSinkService::setQualityController(VideoQualityController::Pointer qualityController) {
+            qualityController_ = std::move(qualityController);
+          }
+
           void VideoMediaSinkService::sendVideoFocusIndication() {
-            OPENAUTO_LOG(info) << "[VideoMediaSinkService] sendVideoFocusIndication()";
+            this->sendVideoFocusNotification(
+                aap_protobuf::service::media::video::message::VideoFocusMode::VIDEO_FOCUS_PROJECTED, false);
+          }
+
+          void VideoMediaSinkService::sendVideoFocusNotification(
+              aap_protobuf::service::media::video::message::VideoFocusMode focus, bool unsolicited) {
+            OPENAUTO_LOG(info) << "[VideoMediaSinkService] sendVideoFocusIndication(), focus: " << VideoFocusMode_Name(focus)
+                               << ", unsolicited: " << unsolicited;
 
+            videoFocus_ = focus;
             aap_protobuf::service::media::video::message::VideoFocusNotification videoFocusIndication;
-            videoFocusIndication.set_focus(
-                aap_protobuf::service::media::video::message::VideoFocusMode::VIDEO_FOCUS_PROJECTED);
-            videoFocusIndication.set_unsolicited(false);
+            videoFocusIndication.set_focus(focus);
+            videoFocusIndication.set_unsolicited(unsolicited);
 
             auto promise = aasdk::channel::SendPromise::defer(strand_);
             promise->then([]() { }, std::bind(&VideoMediaSinkService::onChannelError, this->shared_from_this(),
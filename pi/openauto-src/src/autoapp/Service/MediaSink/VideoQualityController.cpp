@@ -0,0 +1,144 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <sstream>
+#include <f1x/openauto/autoapp/Service/MediaSink/VideoQualityController.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x::openauto::autoapp::service::mediasink {
+
+  // any of these, smoothed, held for the sustain period is pressure
+  static constexpr auto cHighDecodeLag = std::chrono::milliseconds(100);
+  static constexpr auto cHighAckLatency = std::chrono::milliseconds(150);
+  static constexpr auto cHighRoundTrip = std::chrono::milliseconds(200);
+  // 800x480@30, nothing is offered below it
+  static constexpr uint64_t cMinimumPixelRate = 800 * 480 * 30;
+
+  static std::chrono::microseconds smooth(std::chrono::microseconds smoothed, std::chrono::microseconds sample) {
+    return smoothed + (sample - smoothed) / 8;
+  }
+
+  VideoQualityController::VideoQualityController(std::chrono::seconds sustainPeriod, std::chrono::seconds recoveryPeriod)
+      : sustainPeriod_(sustainPeriod), recoveryPeriod_(recoveryPeriod), modePixelRate_(0), limit_(0), decided_(false) {
+
+  }
+
+  void VideoQualityController::onModeSelected(const projection::VideoMode &mode) {
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    projection::VideoCapabilities::resolutionSize(mode.resolution, width, height);
+
+    mode_ = mode;
+    modePixelRate_ = static_cast<uint64_t>(width) * height * projection::VideoCapabilities::framesPerSecond(mode.frameRate);
+    decided_ = false;
+    smoothed_ = Sample();
+    pressureSince_ = Clock::time_point();
+    healthySince_ = Clock::time_point();
+  }
+
+  void VideoQualityController::onSample(const Sample &sample, Clock::time_point now) {
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if (modePixelRate_ == 0 || decided_) {
+      return;
+    }
+
+    smoothed_.decodeLag = smooth(smoothed_.decodeLag, sample.decodeLag);
+    smoothed_.ackLatency = smooth(smoothed_.ackLatency, sample.ackLatency);
+    smoothed_.roundTrip = smooth(smoothed_.roundTrip, sample.roundTrip);
+
+    const bool pressure = smoothed_.decodeLag > cHighDecodeLag || smoothed_.ackLatency > cHighAckLatency ||
+                          smoothed_.roundTrip > cHighRoundTrip;
+    // half of the limits, so a stream that just got below them does not count as recovered
+    const bool healthy = smoothed_.decodeLag * 2 < cHighDecodeLag && smoothed_.ackLatency * 2 < cHighAckLatency &&
+                         smoothed_.roundTrip * 2 < cHighRoundTrip;
+
+    if (pressure) {
+      healthySince_ = Clock::time_point();
+      if (pressureSince_ == Clock::time_point()) {
+        pressureSince_ = now;
+      } else if (now - pressureSince_ >= sustainPeriod_ && modePixelRate_ > cMinimumPixelRate) {
+        previousLimits_.push_back(limit_);
+        this->decide(Action::DOWNGRADE, modePixelRate_ - 1, now);
+      }
+      return;
+    }
+
+    pressureSince_ = Clock::time_point();
+    if (!healthy) {
+      healthySince_ = Clock::time_point();
+    } else if (healthySince_ == Clock::time_point()) {
+      healthySince_ = now;
+    } else if (now - healthySince_ >= recoveryPeriod_ && !previousLimits_.empty()) {
+      const auto limit = previousLimits_.back();
+      previousLimits_.pop_back();
+      this->decide(Action::UPGRADE, limit, now);
+    }
+  }
+
+  uint64_t VideoQualityController::getPixelRateLimit() const {
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return limit_;
+  }
+
+  std::vector<VideoQualityController::Decision> VideoQualityController::getDecisions() const {
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return std::vector<Decision>(decisions_.begin(), decisions_.end());
+  }
+
+  void VideoQualityController::decide(Action action, uint64_t limit, Clock::time_point now) {
+    Decision decision;
+    decision.time = now;
+    decision.action = action;
+    decision.previousLimit = limit_;
+    decision.limit = limit;
+    decision.mode = mode_;
+    decision.smoothed = smoothed_;
+
+    limit_ = limit;
+    decided_ = true;
+
+    decisions_.push_back(decision);
+    if (decisions_.size() > cMaxDecisions) {
+      decisions_.pop_front();
+    }
+
+    diagnostics::VideoStatistics::onQualityDecision(action == Action::DOWNGRADE, limit);
+    OPENAUTO_LOG(info) << "[VideoQualityController] " << describe(decision) << ", applies from the next session";
+  }
+
+  std::string VideoQualityController::describe(const Decision &decision) {
+    const auto limitName = [](uint64_t limit) {
+      return limit == 0 ? std::string("unlimited") : std::to_string(limit / 1000000) + " Mpixel/s";
+    };
+
+    std::ostringstream stream;
+    stream << (decision.action == Action::DOWNGRADE ? "downgrade" : "upgrade")
+           << " while streaming " << projection::VideoCapabilities::describe(decision.mode)
+           << ", limit: " << limitName(decision.previousLimit) << " -> " << limitName(decision.limit)
+           << ", decode lag: " << decision.smoothed.decodeLag.count() / 1000
+           << " ms, ack latency: " << decision.smoothed.ackLatency.count() / 1000
+           << " ms, rtt: " << decision.smoothed.roundTrip.count() / 1000 << " ms";
+    return stream.str();
+  }
+
+}
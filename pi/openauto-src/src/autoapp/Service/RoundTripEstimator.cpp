@@ -0,0 +1,55 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/openauto/autoapp/Service/RoundTripEstimator.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
+#include <f1x/openauto/Common/Log.hpp>
+
+namespace f1x::openauto::autoapp::service {
+
+  // anything longer is a stale or foreign timestamp, the pinger gives up after a few seconds anyway
+  static constexpr int64_t cMaximumSample = 10 * 1000 * 1000;
+
+  RoundTripEstimator::RoundTripEstimator()
+      : smoothed_(0) {
+
+  }
+
+  void RoundTripEstimator::onPingResponse(int64_t requestTimestamp, Clock::time_point now) {
+    const auto sample = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count()
+                        - requestTimestamp;
+    if (sample < 0 || sample > cMaximumSample) {
+      OPENAUTO_LOG(debug) << "[RoundTripEstimator] ignoring sample: " << sample << " us";
+      return;
+    }
+
+    // same gain as the TCP retransmission timer (RFC 6298)
+    const auto smoothed = smoothed_.load(std::memory_order_relaxed);
+    const auto updated = smoothed == 0 ? sample : smoothed + (sample - smoothed) / 8;
+    smoothed_.store(std::max<int64_t>(updated, 1), std::memory_order_relaxed);
+    diagnostics::VideoStatistics::setRoundTrip(std::chrono::microseconds(updated));
+
+    OPENAUTO_LOG(debug) << "[RoundTripEstimator] sample: " << sample << " us, smoothed: " << updated << " us";
+  }
+
+  std::chrono::microseconds RoundTripEstimator::get() const {
+    return std::chrono::microseconds(smoothed_.load(std::memory_order_relaxed));
+  }
+
+}
@@ -18,6 +18,9 @@
 
 #include <QApplication>
 #include <QScreen>
+#if defined(USE_V4L2)
+#include <qpa/qplatformnativeinterface.h>
+#endif
 
 #include <aasdk/Channel/MediaSink/Audio/Channel/MediaAudioChannel.hpp>
 #include <aasdk/Channel/MediaSink/Audio/Channel/SystemAudioChannel.hpp>
@@ -40,7 +43,14 @@
 #include <f1x/openauto/autoapp/Service/WifiProjection/WifiProjectionService.hpp>
 #include <f1x/openauto/autoapp/Projection/QtVideoOutput.hpp>
 #include <f1x/openauto/autoapp/Projection/OMXVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/V4L2VideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/FFmpegVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/NullVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/FileVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
 #include <f1x/openauto/autoapp/Projection/RtAudioOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/AlsaAudioOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/PipeWireAudioOutput.hpp>
 #include <f1x/openauto/autoapp/Projection/QtAudioOutput.hpp>
 #include <f1x/openauto/autoapp/Projection/QtAudioInput.hpp>
 #include <f1x/openauto/autoapp/Projection/InputDevice.hpp>
@@ -51,19 +61,57 @@ namespace f1x::openauto::autoapp::service {
 
   ServiceFactory::ServiceFactory(boost::asio::io_service &ioService,
                                  configuration::IConfiguration::Pointer configuration)
-      : ioService_(ioService), configuration_(std::move(configuration)) {
+      : ioService_(ioService), configuration_(std::move(configuration)), drmPresenterFailed_(false) {
+    if (configuration_->getVideoAdaptiveQuality()) {
+      videoQualityController_ = std::make_shared<mediasink::VideoQualityController>();
+    }
+
+    // the Qt backend pushes into its own buffers, there is nothing for a mixer to feed; PipeWire
+    // mixes and ducks the channels itself, going by the role of each stream
+    const auto backendType = configuration_->getAudioOutputBackendType();
+    if (configuration_->getAudioSoftwareMixer() &&
+        (backendType == configuration::AudioOutputBackendType::RTAUDIO ||
+         backendType == configuration::AudioOutputBackendType::ALSA)) {
+      OPENAUTO_LOG(info) << "[ServiceFactory] Software audio mixer, ducking level: "
+                         << configuration_->getAudioDuckingLevel() << "%";
+      audioMixer_ = std::make_shared<projection::AudioMixer>(configuration_->getAudioDuckingLevel());
+      audioMixer_->setDevice(this->createDeviceAudioOutput(projection::AudioMixer::Channel::MEDIA,
+                                                           projection::AudioMixer::cChannelCount,
+                                                           projection::AudioMixer::cSampleRate, audioMixer_.get()));
+    }
+  }
+
+  void ServiceFactory::setVideoOverlay(projection::VideoOverlay::Pointer overlay) {
+    videoOverlay_ = std::move(overlay);
+  }
 
+  void ServiceFactory::onAudioFocusRequest(aap_protobuf::service::control::message::AudioFocusRequestType type) {
+    if (audioMixer_ != nullptr) {
+      // the phone keeps playing media under a transient sound only when it may be ducked
+      audioMixer_->setFocusDucking(
+          type == aap_protobuf::service::control::message::AudioFocusRequestType::AUDIO_FOCUS_GAIN_TRANSIENT_MAY_DUCK);
+    }
   }
 
-  ServiceList ServiceFactory::create(aasdk::messenger::IMessenger::Pointer messenger) {
+  ServiceList ServiceFactory::create(aasdk::messenger::IMessenger::Pointer messenger,
+                                     RoundTripEstimator::Pointer roundTripEstimator) {
     OPENAUTO_LOG(info) << "[ServiceFactory] create()";
     ServiceList serviceList;
 
-    this->createMediaSinkServices(serviceList, messenger);
+    if (audioMixer_ != nullptr) {
+      // the mixer outlives the session; a transient focus the last phone never gave back must not duck this one
+      audioMixer_->setFocusDucking(false);
+      // channels open onto a device that already plays, so the first prompt is not clipped by its start
+      audioMixer_->warmUp();
+    }
+
+    // shared with the video service, touches follow the video config the phone is using
+    auto inputDevice = this->createInputDevice();
+    this->createMediaSinkServices(serviceList, messenger, std::move(roundTripEstimator), inputDevice);
     
     this->createMediaSourceServices(serviceList, messenger);
     serviceList.emplace_back(this->createSensorService(messenger));
-    serviceList.emplace_back(this->createInputService(messenger));
+    serviceList.emplace_back(this->createInputService(messenger, std::move(inputDevice)));
     if (configuration_->getWirelessProjectionEnabled())
     {
         // TODO: What is WiFi Projection Service?
@@ -94,59 +142,49 @@ namespace f1x::openauto::autoapp::service {
     return std::make_shared<bluetooth::BluetoothService>(ioService_, messenger, std::move(bluetoothDevice));
   }
 
-  IService::Pointer ServiceFactory::createInputService(aasdk::messenger::IMessenger::Pointer messenger) {
-    OPENAUTO_LOG(info) << "[ServiceFactory] createInputService()";
-    QRect videoGeometry;
-    switch (configuration_->getVideoResolution()) {
-      case aap_protobuf::service::media::sink::message::VideoCodecResolutionType::VIDEO_1280x720:
-        OPENAUTO_LOG(info) << "[ServiceFactory] Resolution 1280x720";
-        videoGeometry = QRect(0, 0, 1280, 720);
-        break;
-      case aap_protobuf::service::media::sink::message::VideoCodecResolutionType::VIDEO_1920x1080:
-        OPENAUTO_LOG(info) << "[ServiceFactory] Resolution 1920x1080";
-        videoGeometry = QRect(0, 0, 1920, 1080);
-        break;
-      default:
-        OPENAUTO_LOG(info) << "[ServiceFactory] Resolution 800x480";
-        videoGeometry = QRect(0, 0, 800, 480);
-        break;
-    }
+  projection::IInputDevice::Pointer ServiceFactory::createInputDevice() {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    projection::VideoCapabilities::resolutionSize(configuration_->getVideoResolution(), width, height);
+    OPENAUTO_LOG(info) << "[ServiceFactory] Resolution " << width << "x" << height;
+    QRect videoGeometry(0, 0, width, height);
 
     QScreen *screen = QGuiApplication::primaryScreen();
     QRect screenGeometry = screen == nullptr ? QRect(0, 0, 1, 1) : screen->geometry();
-    projection::IInputDevice::Pointer inputDevice(
-        std::make_shared<projection::InputDevice>(*QApplication::instance(), configuration_,
-                                                  std::move(screenGeometry), std::move(videoGeometry)));
+    return std::make_shared<projection::InputDevice>(*QApplication::instance(), configuration_,
+                                                     std::move(screenGeometry), std::move(videoGeometry));
+  }
 
+  IService::Pointer ServiceFactory::createInputService(aasdk::messenger::IMessenger::Pointer messenger,
+                                                       projection::IInputDevice::Pointer inputDevice) {
+    OPENAUTO_LOG(info) << "[ServiceFactory] createInputService()";
     return std::make_shared<inputsource::InputSourceService>(ioService_, messenger, std::move(inputDevice));
   }
 
   void ServiceFactory::createMediaSinkServices(ServiceList &serviceList,
-                                               aasdk::messenger::IMessenger::Pointer messenger) {
+                                               aasdk::messenger::IMessenger::Pointer messenger,
+                                               RoundTripEstimator::Pointer roundTripEstimator,
+                                               projection::IInputDevice::Pointer inputDevice) {
     OPENAUTO_LOG(info) << "[ServiceFactory] createMediaSinkServices()";
     if (configuration_->musicAudioChannelEnabled()) {
       OPENAUTO_LOG(info) << "[ServiceFactory] Media Audio Channel enabled";
-      auto mediaAudioOutput =
-          configuration_->getAudioOutputBackendType() == configuration::AudioOutputBackendType::RTAUDIO ?
-          std::make_shared<projection::RtAudioOutput>(2, 16, 48000) :
-          projection::IAudioOutput::Pointer(new projection::QtAudioOutput(2, 16, 48000),
-                                            std::bind(&QObject::deleteLater, std::placeholders::_1));
+      auto mediaAudioOutput = this->createAudioOutput(projection::AudioMixer::Channel::MEDIA, 2, 48000);
 
       serviceList.emplace_back(
-          std::make_shared<mediasink::MediaAudioService>(ioService_, messenger, std::move(mediaAudioOutput)));
+          std::make_shared<mediasink::MediaAudioService>(ioService_, messenger, std::move(mediaAudioOutput),
+                                                         std::make_shared<mediasink::MediaFlowController>(
+                                                             configuration_->getAudioMaxUnacked(), false)));
     }
 
     if (configuration_->guidanceAudioChannelEnabled()) {
       OPENAUTO_LOG(info) << "[ServiceFactory] Guidance Audio Channel enabled";
-      auto guidanceAudioOutput =
-          configuration_->getAudioOutputBackendType() == configuration::AudioOutputBackendType::RTAUDIO ?
-          std::make_shared<projection::RtAudioOutput>(1, 16, 16000) :
-          projection::IAudioOutput::Pointer(new projection::QtAudioOutput(1, 16, 16000),
-                                            std::bind(&QObject::deleteLater, std::placeholders::_1));
+      auto guidanceAudioOutput = this->createAudioOutput(projection::AudioMixer::Channel::GUIDANCE, 1, 16000);
 
       serviceList.emplace_back(
           std::make_shared<mediasink::GuidanceAudioService>(ioService_, messenger,
-                                                            std::move(guidanceAudioOutput)));
+                                                            std::move(guidanceAudioOutput),
+                                                            std::make_shared<mediasink::MediaFlowController>(
+                                                                configuration_->getAudioMaxUnacked(), false)));
     }
 
     /* TODO: This also causes a problem - suspect not actually enabled yet in AA, or removed due to preference of Bluetooth.
@@ -168,25 +206,144 @@ namespace f1x::openauto::autoapp::service {
      */
 
     OPENAUTO_LOG(info) << "[ServiceFactory] System Audio Channel enabled";
-    auto systemAudioOutput =
-        configuration_->getAudioOutputBackendType() == configuration::AudioOutputBackendType::RTAUDIO ?
-        std::make_shared<projection::RtAudioOutput>(1, 16, 16000) :
-        projection::IAudioOutput::Pointer(new projection::QtAudioOutput(1, 16, 16000),
-                                          std::bind(&QObject::deleteLater, std::placeholders::_1));
+    auto systemAudioOutput = this->createAudioOutput(projection::AudioMixer::Channel::SYSTEM, 1, 16000);
 
     serviceList.emplace_back(
-        std::make_shared<mediasink::SystemAudioService>(ioService_, messenger, std::move(systemAudioOutput)));
+        std::make_shared<mediasink::SystemAudioService>(ioService_, messenger, std::move(systemAudioOutput),
+                                                       std::make_shared<mediasink::MediaFlowController>(
+                                                           configuration_->getAudioMaxUnacked(), false)));
+
+    auto videoOutput = this->createVideoOutput();
+    if (audioMixer_ != nullptr) {
+      // pictures of a video app follow the sound of it
+      videoOutput->setMediaClock(audioMixer_->getMediaClock());
+    }
+    OPENAUTO_LOG(info) << "[ServiceFactory] Video Channel enabled";
+    auto videoService(
+        std::make_shared<mediasink::VideoService>(ioService_, messenger, videoOutput,
+                                                  configuration_->getVideoDecodeQueueDepth(),
+                                                  std::make_shared<mediasink::MediaFlowController>(
+                                                      configuration_->getVideoMaxUnacked(),
+                                                      configuration_->getVideoAdaptiveFlowControl(),
+                                                      std::move(roundTripEstimator)),
+                                                  configuration_->getVideoPersistentDecoder()));
+    videoService->setQualityController(videoQualityController_);
+    videoService->setVideoModeHandler([inputDevice, videoOutput](const projection::VideoMode &mode) {
+      uint32_t width = 0;
+      uint32_t height = 0;
+      projection::VideoCapabilities::resolutionSize(mode.resolution, width, height);
+      // touches map onto the part of the frame the phone draws into, not onto the margins
+      inputDevice->setVideoGeometry(
+          projection::VideoGeometry::contentRect(width, height, videoOutput->getVideoMargins(mode)));
+    });
+    serviceList.emplace_back(std::move(videoService));
+  }
+
+  projection::IAudioOutput::Pointer ServiceFactory::createAudioOutput(projection::AudioMixer::Channel channel,
+                                                                      uint32_t channelCount, uint32_t sampleRate) {
+    if (audioMixer_ != nullptr) {
+      auto input = audioMixer_->createInput(channel, channelCount, sampleRate);
+      if (input != nullptr) {
+        return input;
+      }
+    }
 
-#ifdef USE_OMX
-    auto videoOutput(std::make_shared<projection::OMXVideoOutput>(configuration_));
+    return this->createDeviceAudioOutput(channel, channelCount, sampleRate, nullptr);
+  }
+
+  projection::IAudioOutput::Pointer ServiceFactory::createDeviceAudioOutput(projection::AudioMixer::Channel channel,
+                                                                            uint32_t channelCount, uint32_t sampleRate,
+                                                                            projection::IAudioRenderer *renderer) {
+    switch (configuration_->getAudioOutputBackendType()) {
+      case configuration::AudioOutputBackendType::PIPEWIRE:
+#if defined(USE_PIPEWIRE)
+        // media.role values the session manager has ducking rules for
+        return std::make_shared<projection::PipeWireAudioOutput>(
+            channel == projection::AudioMixer::Channel::MEDIA ? "Music" :
+            channel == projection::AudioMixer::Channel::GUIDANCE ? "Navigation" : "Notification",
+            channelCount, 16, sampleRate, configuration_->getAudioPipeWireQuantum());
+#else
+        OPENAUTO_LOG(warning) << "[ServiceFactory] Built without PipeWire support, using RtAudio.";
+        return std::make_shared<projection::RtAudioOutput>(channelCount, 16, sampleRate);
+#endif
+      case configuration::AudioOutputBackendType::ALSA:
+#if defined(USE_ALSA)
+        if (renderer != nullptr) {
+          return std::make_shared<projection::AlsaAudioOutput>(*renderer, configuration_->getAudioAlsaDevice(),
+                                                               channelCount, 16, sampleRate,
+                                                               configuration_->getAudioAlsaPeriodSize(),
+                                                               configuration_->getAudioAlsaBufferSize());
+        }
+        return std::make_shared<projection::AlsaAudioOutput>(configuration_->getAudioAlsaDevice(),
+                                                             channelCount, 16, sampleRate,
+                                                             configuration_->getAudioAlsaPeriodSize(),
+                                                             configuration_->getAudioAlsaBufferSize());
 #else
-    projection::IVideoOutput::Pointer videoOutput(new projection::QtVideoOutput(configuration_),
-                                                  std::bind(&QObject::deleteLater, std::placeholders::_1));
+        OPENAUTO_LOG(warning) << "[ServiceFactory] Built without ALSA support, using RtAudio.";
+        [[fallthrough]];
 #endif
+      case configuration::AudioOutputBackendType::RTAUDIO:
+        if (renderer != nullptr) {
+          return std::make_shared<projection::RtAudioOutput>(*renderer, channelCount, 16, sampleRate);
+        }
+        return std::make_shared<projection::RtAudioOutput>(channelCount, 16, sampleRate);
+      default:
+        return projection::IAudioOutput::Pointer(new projection::QtAudioOutput(channelCount, 16, sampleRate),
+                                                 std::bind(&QObject::deleteLater, std::placeholders::_1));
+    }
+  }
 
-    OPENAUTO_LOG(info) << "[ServiceFactory] Video Channel enabled";
-    serviceList.emplace_back(
-        std::make_shared<mediasink::VideoService>(ioService_, messenger, std::move(videoOutput)));
+  projection::IVideoOutput::Pointer ServiceFactory::createVideoOutput() {
+    switch (configuration_->getVideoOutputBackendType()) {
+      case configuration::VideoOutputBackendType::NONE:
+        OPENAUTO_LOG(info) << "[ServiceFactory] Video output: none";
+        return std::make_shared<projection::NullVideoOutput>(configuration_->getVideoResolution(),
+                                                             configuration_->getVideoFPS(),
+                                                             configuration_->getScreenDPI());
+      case configuration::VideoOutputBackendType::FILE:
+        OPENAUTO_LOG(info) << "[ServiceFactory] Video output: " << configuration_->getVideoOutputFile();
+        return std::make_shared<projection::FileVideoOutput>(configuration_->getVideoOutputFile(),
+                                                             configuration_->getVideoResolution(),
+                                                             configuration_->getVideoFPS(),
+                                                             configuration_->getScreenDPI());
+      default:
+        break;
+    }
+
+#if defined(USE_V4L2)
+    if (!drmPresenterFailed_) {
+      // on eglfs_kms Qt holds DRM master, the presenter has to commit through its descriptor;
+      // otherwise it opens a node of its own, which is master only without another KMS client
+      auto nativeInterface = QGuiApplication::platformNativeInterface();
+      const auto qtFd = nativeInterface != nullptr
+                        ? static_cast<int>(reinterpret_cast<intptr_t>(nativeInterface->nativeResourceForIntegration("dri_fd")))
+                        : 0;
+      auto presenter = qtFd > 0
+                       ? std::make_shared<projection::DrmPresenter>(configuration_->getOMXLayerIndex(), qtFd)
+                       : std::make_shared<projection::DrmPresenter>(configuration_->getOMXLayerIndex());
+      if (presenter->open()) {
+        presenter->setOverlay(videoOverlay_);
+        presenter->setFailureHandler([this]() { drmPresenterFailed_ = true; });
+        auto videoOutput(std::make_shared<projection::V4L2VideoOutput>(configuration_));
+        videoOutput->setPresenter(std::move(presenter));
+        return videoOutput;
+      }
+      drmPresenterFailed_ = true;
+    }
+
+    // decoding without a way to show the frames is pointless, Qt decodes and draws on its own
+    OPENAUTO_LOG(warning) << "[ServiceFactory] DRM presenter unavailable, falling back to the Qt video output.";
+    return projection::IVideoOutput::Pointer(new projection::QtVideoOutput(configuration_),
+                                             std::bind(&QObject::deleteLater, std::placeholders::_1));
+#elif defined(USE_OMX)
+    return std::make_shared<projection::OMXVideoOutput>(configuration_);
+#elif defined(USE_FFMPEG)
+    return projection::IVideoOutput::Pointer(new projection::FFmpegVideoOutput(configuration_),
+                                             std::bind(&QObject::deleteLater, std::placeholders::_1));
+#else
+    return projection::IVideoOutput::Pointer(new projection::QtVideoOutput(configuration_),
+                                             std::bind(&QObject::deleteLater, std::placeholders::_1));
+#endif
   }
 
   void ServiceFactory::createMediaSourceServices(f1x::openauto::autoapp::service::ServiceList &serviceList,
@@ -357,9 +357,15 @@ comboBoxBluetooth->addItem(QCoreApplication::translate("SettingsWindow", "none",
     //configuration_->setTelephonyAudioChannelEnabled(ui_->checkBoxVoiceAudioChannel->isChecked());
     // TODO: Add CheckBox In
     configuration_->setTelephonyAudioChannelEnabled(true);
-    configuration_->setAudioOutputBackendType(
-        ui_->radioButtonRtAudio->isChecked() ? configuration::AudioOutputBackendType::RTAUDIO
-                                             : configuration::AudioOutputBackendType::QT);
+    if (ui_->radioButtonAlsaAudio->isChecked()) {
+        configuration_->setAudioOutputBackendType(configuration::AudioOutputBackendType::ALSA);
+    } else if (ui_->radioButtonPipeWireAudio->isChecked()) {
+        configuration_->setAudioOutputBackendType(configuration::AudioOutputBackendType::PIPEWIRE);
+    } else {
+        configuration_->setAudioOutputBackendType(
+            ui_->radioButtonRtAudio->isChecked() ? configuration::AudioOutputBackendType::RTAUDIO
+                                                 : configuration::AudioOutputBackendType::QT);
+    }
 
     configuration_->save();
 
@@ -637,6 +643,8 @@ comboBoxBluetooth->addItem(QCoreApplication::translate("SettingsWindow", "none",
     const auto &audioOutputBackendType = configuration_->getAudioOutputBackendType();
     ui_->radioButtonRtAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::RTAUDIO);
     ui_->radioButtonQtAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::QT);
+    ui_->radioButtonAlsaAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::ALSA);
+    ui_->radioButtonPipeWireAudio->setChecked(audioOutputBackendType == configuration::AudioOutputBackendType::PIPEWIRE);
 
     ui_->checkBoxHardwareSave->setChecked(false);
     QStorageInfo storage("/media/USBDRIVES/CSSTORAGE");
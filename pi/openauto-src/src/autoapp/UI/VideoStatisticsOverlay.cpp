@@ -0,0 +1,164 @@
+#include <f1x/openauto/autoapp/UI/VideoStatisticsOverlay.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/ThreadCpuMonitor.hpp>
+#include <QFile>
+#include <QFontDatabase>
+#include <QPainter>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+namespace f1x
+{
+namespace openauto
+{
+namespace autoapp
+{
+namespace ui
+{
+
+namespace
+{
+
+const QString cEnableFile = QStringLiteral("/tmp/videostatistics");
+constexpr int cMargin = 16;
+constexpr int cPadding = 8;
+
+}
+
+VideoStatisticsOverlay::VideoStatisticsOverlay(configuration::IConfiguration::Pointer configuration,
+                                               projection::VideoOverlay::Pointer overlay, QWidget *parent)
+    : QWidget(parent, Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool | Qt::WindowTransparentForInput)
+    , configuration_(std::move(configuration))
+    , overlay_(std::move(overlay))
+    , active_(false)
+    , previousCpuTicks_(0)
+{
+    this->setAttribute(Qt::WA_TranslucentBackground);
+    this->setAttribute(Qt::WA_ShowWithoutActivating);
+    this->move(cMargin, cMargin);
+
+    connect(&timer_, &QTimer::timeout, this, &VideoStatisticsOverlay::refresh);
+    timer_.start(1000);
+}
+
+bool VideoStatisticsOverlay::isRequested() const
+{
+    return configuration_->getVideoStatisticsOverlay() || QFile::exists(cEnableFile);
+}
+
+double VideoStatisticsOverlay::sampleCpuLoad()
+{
+    uint64_t ticks = 0;
+    for(const auto& sample: diagnostics::ThreadCpuMonitor::sample())
+    {
+        ticks += sample.cpuTicks;
+    }
+
+    static const double ticksPerSecond = static_cast<double>(sysconf(_SC_CLK_TCK));
+    const double seconds = timer_.interval() / 1000.0;
+    const double percent = previousCpuTicks_ != 0 && ticks >= previousCpuTicks_
+        ? (ticks - previousCpuTicks_) / ticksPerSecond / seconds * 100.0 : 0.0;
+    previousCpuTicks_ = ticks;
+    return percent;
+}
+
+void VideoStatisticsOverlay::refresh()
+{
+    if(!this->isRequested())
+    {
+        if(active_)
+        {
+            active_ = false;
+            previousCpuTicks_ = 0;
+            this->hide();
+            if(overlay_ != nullptr)
+            {
+                overlay_->update(projection::VideoOverlay::Image());
+            }
+        }
+        return;
+    }
+
+    const auto current = diagnostics::VideoStatistics::sample();
+    const auto cpuLoad = this->sampleCpuLoad();
+    if(!active_)
+    {
+        // the first second has nothing to compare with
+        active_ = true;
+        previous_ = current;
+        return;
+    }
+
+    this->render(diagnostics::VideoStatistics::rates(previous_, current), cpuLoad);
+    previous_ = current;
+
+    this->resize(image_.size());
+    this->show();
+    this->raise();
+    this->update();
+
+    if(overlay_ != nullptr)
+    {
+        projection::VideoOverlay::Image image;
+        image.width = static_cast<uint32_t>(image_.width());
+        image.height = static_cast<uint32_t>(image_.height());
+        image.pixels.resize(image.width * image.height);
+        for(uint32_t row = 0; row < image.height; ++row)
+        {
+            std::memcpy(image.pixels.data() + row * image.width, image_.constScanLine(row), image.width * sizeof(uint32_t));
+        }
+        overlay_->update(std::move(image));
+    }
+}
+
+void VideoStatisticsOverlay::render(const diagnostics::VideoStatistics::Rates& rates, double cpuLoad)
+{
+    QStringList lines{
+        QString("rx    %1 fps  %2 kbit/s").arg(rates.receivedFps, 5, 'f', 1).arg(rates.bitrateKbps, 0, 'f', 0),
+        QString("dec   %1 fps").arg(rates.decodedFps, 5, 'f', 1),
+        QString("shown %1 fps  %2 dropped").arg(rates.shownFps, 5, 'f', 1).arg(rates.droppedFrames),
+        QString("decode %1 ms  max %2 ms").arg(rates.decodeLatencyMs, 0, 'f', 1).arg(rates.maxDecodeLatencyMs, 0, 'f', 1),
+        QString("rtt   %1 ms").arg(rates.roundTripMs, 0, 'f', 1),
+        QString("cpu   %1 %").arg(cpuLoad, 0, 'f', 0)
+    };
+    if(rates.qualityDecisions > 0)
+    {
+        const QString limit = rates.pixelRateLimitMpx > 0 ? QString("%1 Mpx/s").arg(rates.pixelRateLimitMpx, 0, 'f', 1) : QString("unlimited");
+        lines << QString("quality %1 after %2 #%3").arg(limit)
+                     .arg(rates.lastQualityDowngrade ? "downgrade" : "upgrade").arg(rates.qualityDecisions);
+    }
+
+    QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    font.setPixelSize(14);
+    const QFontMetrics metrics(font);
+
+    int width = 0;
+    for(const auto& line: lines)
+    {
+        width = std::max(width, metrics.boundingRect(line).width());
+    }
+
+    // premultiplied ARGB32 is the layout the DRM overlay plane scans out
+    image_ = QImage(width + 2 * cPadding, lines.size() * metrics.height() + 2 * cPadding, QImage::Format_ARGB32_Premultiplied);
+    image_.fill(QColor(0, 0, 0, 160));
+
+    QPainter painter(&image_);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    for(int i = 0; i < lines.size(); ++i)
+    {
+        painter.drawText(cPadding, cPadding + i * metrics.height() + metrics.ascent(), lines[i]);
+    }
+}
+
+void VideoStatisticsOverlay::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(0, 0, image_);
+}
+
+}
+}
+}
+}
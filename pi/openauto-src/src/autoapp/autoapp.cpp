@@ -38,6 +38,8 @@
 #include <f1x/openauto/autoapp/UI/ConnectDialog.hpp>
 #include <f1x/openauto/autoapp/UI/WarningDialog.hpp>
 #include <f1x/openauto/autoapp/UI/UpdateDialog.hpp>
+#include <f1x/openauto/autoapp/UI/VideoStatisticsOverlay.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/ThreadCpuMonitor.hpp>
 #include <f1x/openauto/Common/Log.hpp>
 
 namespace autoapp = f1x::openauto::autoapp;
@@ -45,7 +47,8 @@ using ThreadPool = std::vector<std::thread>;
 
 void startUSBWorkers(boost::asio::io_service& ioService, libusb_context* usbContext, ThreadPool& threadPool)
 {
-    auto usbWorker = [&ioService, usbContext]() {
+    auto usbWorker = [&ioService, usbContext](size_t index) {
+        autoapp::diagnostics::setCurrentThreadName("usb-worker-" + std::to_string(index));
         timeval libusbEventTimeout{180, 0};
 
         while(!ioService.stopped())
@@ -54,22 +57,23 @@ void startUSBWorkers(boost::asio::io_service& ioService, libusb_context* usbCont
         }
     };
 
-    threadPool.emplace_back(usbWorker);
-    threadPool.emplace_back(usbWorker);
-    threadPool.emplace_back(usbWorker);
-    threadPool.emplace_back(usbWorker);
+    threadPool.emplace_back(usbWorker, 0);
+    threadPool.emplace_back(usbWorker, 1);
+    threadPool.emplace_back(usbWorker, 2);
+    threadPool.emplace_back(usbWorker, 3);
 }
 
 void startIOServiceWorkers(boost::asio::io_service& ioService, ThreadPool& threadPool)
 {
-    auto ioServiceWorker = [&ioService]() {
+    auto ioServiceWorker = [&ioService](size_t index) {
+        autoapp::diagnostics::setCurrentThreadName("asio-worker-" + std::to_string(index));
         ioService.run();
     };
 
-    threadPool.emplace_back(ioServiceWorker);
-    threadPool.emplace_back(ioServiceWorker);
-    threadPool.emplace_back(ioServiceWorker);
-    threadPool.emplace_back(ioServiceWorker);
+    threadPool.emplace_back(ioServiceWorker, 0);
+    threadPool.emplace_back(ioServiceWorker, 1);
+    threadPool.emplace_back(ioServiceWorker, 2);
+    threadPool.emplace_back(ioServiceWorker, 3);
 }
 
 void configureLogging() {
@@ -132,6 +136,9 @@ int main(int argc, char* argv[])
 
     auto configuration = std::make_shared<autoapp::configuration::Configuration>();
 
+    auto threadCpuMonitor = std::make_shared<autoapp::diagnostics::ThreadCpuMonitor>(ioService, std::chrono::seconds(configuration->getThreadCpuStatsInterval()));
+    threadCpuMonitor->start();
+
     autoapp::ui::MainWindow mainWindow(configuration);
     //mainWindow.setWindowFlags(Qt::WindowStaysOnTopHint);
 
@@ -236,7 +243,11 @@ int main(int argc, char* argv[])
     aasdk::usb::USBWrapper usbWrapper(usbContext);
     aasdk::usb::AccessoryModeQueryFactory queryFactory(usbWrapper, ioService);
     aasdk::usb::AccessoryModeQueryChainFactory queryChainFactory(usbWrapper, ioService, queryFactory);
+    auto videoOverlay = std::make_shared<autoapp::projection::VideoOverlay>();
+    autoapp::ui::VideoStatisticsOverlay videoStatisticsOverlay(configuration, videoOverlay);
+
     autoapp::service::ServiceFactory serviceFactory(ioService, configuration);
+    serviceFactory.setVideoOverlay(videoOverlay);
     autoapp::service::AndroidAutoEntityFactory androidAutoEntityFactory(ioService, configuration, serviceFactory);
 
     auto usbHub(std::make_shared<aasdk::usb::USBHub>(usbWrapper, ioService, queryChainFactory));
@@ -258,9 +269,13 @@ int main(int argc, char* argv[])
         }
     });
 
-    QObject::connect(&mainWindow, &autoapp::ui::MainWindow::TriggerAppStop, [&app]() {
+    QObject::connect(&mainWindow, &autoapp::ui::MainWindow::TriggerAppStop, [&app, configuration]() {
         try {
-            if (std::ifstream("/tmp/android_device")) {
+            if (configuration->getVideoPersistentDecoder()) {
+                // keep the session and the decoder, TriggerAppStart resumes it
+                OPENAUTO_LOG(debug) << "[AutoApp] TriggerAppStop: Pause android auto.";
+                app->pause();
+            } else if (std::ifstream("/tmp/android_device")) {
                 OPENAUTO_LOG(debug) << "[AutoApp] TriggerAppStop: Manual stop usb android auto.";
                 app->disableAutostartEntity = true;
                 system("/usr/local/bin/autoapp_helper usbreset");
@@ -302,6 +317,7 @@ int main(int argc, char* argv[])
     app->waitForUSBDevice();
 
     auto result = qApplication.exec();
+    threadCpuMonitor->stop();
 
     std::for_each(threadPool.begin(), threadPool.end(), std::bind(&std::thread::join, std::placeholders::_1));
 
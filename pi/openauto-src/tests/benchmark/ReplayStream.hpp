@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include <aasdk/Common/Data.hpp>
+
+namespace f1x::openauto::benchmark {
+
+// One access unit as the phone would send it in a single MEDIA_MESSAGE_DATA.
+struct ReplayFrame {
+    uint64_t timestamp;
+    aasdk::common::Data data;
+};
+
+inline size_t findStartCode(const aasdk::common::Data& stream, size_t offset) {
+    for (size_t i = offset; i + 3 <= stream.size(); ++i) {
+        if (stream[i] == 0 && stream[i + 1] == 0 && stream[i + 2] == 1) {
+            return (i > offset && stream[i - 1] == 0) ? i - 1 : i;
+        }
+    }
+    return stream.size();
+}
+
+inline size_t startCodeLength(const aasdk::common::Data& stream, size_t offset) {
+    return stream[offset + 2] == 1 ? 3 : 4;
+}
+
+// Splits a raw Annex-B stream into access units. Parameter sets and SEI are kept
+// together with the slice that follows them, the same way Android Auto frames them.
+inline std::vector<ReplayFrame> splitAnnexB(const aasdk::common::Data& stream, uint32_t fps) {
+    std::vector<ReplayFrame> frames;
+    aasdk::common::Data pending;
+    uint64_t timestamp = 0;
+    const uint64_t frameDuration = 1000000 / (fps == 0 ? 30 : fps);
+
+    size_t begin = findStartCode(stream, 0);
+    while (begin < stream.size()) {
+        const size_t end = findStartCode(stream, begin + startCodeLength(stream, begin));
+        const uint8_t nalType = stream[begin + startCodeLength(stream, begin)] & 0x1F;
+
+        pending.insert(pending.end(), stream.begin() + begin, stream.begin() + end);
+
+        if (nalType >= 1 && nalType <= 5) {
+            frames.push_back({timestamp, std::move(pending)});
+            pending.clear();
+            timestamp += frameDuration;
+        }
+
+        begin = end;
+    }
+
+    return frames;
+}
+
+// Deterministic stand-in for a recorded session: SPS/PPS + IDR every gop frames and
+// P slices in between. Payload bytes never contain zero so no start code emulation.
+inline std::vector<ReplayFrame> synthesizeStream(size_t frameCount, uint32_t fps, size_t gop = 60) {
+    std::mt19937 generator(0x0A0A);
+    std::uniform_int_distribution<int> byte(1, 255);
+    aasdk::common::Data stream;
+
+    auto appendNal = [&](uint8_t header, size_t size) {
+        static const uint8_t startCode[] = {0, 0, 0, 1};
+        stream.insert(stream.end(), std::begin(startCode), std::end(startCode));
+        stream.push_back(header);
+        for (size_t i = 0; i < size; ++i) {
+            stream.push_back(static_cast<uint8_t>(byte(generator)));
+        }
+    };
+
+    for (size_t i = 0; i < frameCount; ++i) {
+        if (i % gop == 0) {
+            appendNal(0x67, 12);
+            appendNal(0x68, 4);
+            appendNal(0x65, 48 * 1024);
+        } else {
+            appendNal(0x41, 6 * 1024 + (i % 7) * 512);
+        }
+    }
+
+    return splitAnnexB(stream, fps);
+}
+
+// Media messages as listed in an index written by FileVideoOutput ("<timestamp> <offset> <size>" lines).
+inline std::vector<ReplayFrame> splitIndexed(const aasdk::common::Data& stream, std::istream& index) {
+    std::vector<ReplayFrame> frames;
+    uint64_t timestamp = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    while (index >> timestamp >> offset >> size) {
+        if (offset + size > stream.size()) {
+            break;
+        }
+        frames.push_back({timestamp, aasdk::common::Data(stream.begin() + offset, stream.begin() + offset + size)});
+    }
+
+    return frames;
+}
+
+inline std::vector<ReplayFrame> loadStream(const std::string& path, uint32_t fps) {
+    std::ifstream file(path, std::ios::binary);
+    aasdk::common::Data stream((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::ifstream index(path + ".index");
+    if (index.is_open()) {
+        return splitIndexed(stream, index);
+    }
+
+    return splitAnnexB(stream, fps);
+}
+
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <f1x/openauto/autoapp/Projection/FFmpegDecoder.hpp>
+#include "ReplayStream.hpp"
+
+/*
+ * Decodes a recorded Android Auto H.264 session (raw Annex-B, e.g. dumped from
+ * VideoMediaSinkService) with the libavcodec decoder used by FFmpegVideoOutput.
+ *
+ *   video_decode_benchmark --stream file.h264 [--threads N] [--frame-threads] [--fps N]
+ *
+ * Reports per-frame decode time and how many messages went in before the first
+ * picture came out, which is the latency the threading mode adds.
+ */
+
+namespace autoapp = f1x::openauto::autoapp;
+namespace benchmark = f1x::openauto::benchmark;
+
+namespace {
+
+const char* argument(int argc, char* argv[], const char* name) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return nullptr;
+}
+
+bool flag(int argc, char* argv[], const char* name) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const char* streamPath = argument(argc, argv, "--stream");
+    const char* threadsArg = argument(argc, argv, "--threads");
+    const char* fpsArg = argument(argc, argv, "--fps");
+    const bool frameThreading = flag(argc, argv, "--frame-threads");
+
+    // synthesized streams are not decodable, this needs a real recording
+    if (streamPath == nullptr) {
+        std::cerr << "usage: video_decode_benchmark --stream file.h264 [--threads N] [--frame-threads] [--fps N]" << std::endl;
+        return 2;
+    }
+
+    const int threads = threadsArg != nullptr ? std::atoi(threadsArg) : 0;
+    const uint32_t fps = fpsArg != nullptr ? static_cast<uint32_t>(std::strtoul(fpsArg, nullptr, 10)) : 30;
+    const auto frames = benchmark::loadStream(streamPath, fps);
+    if (frames.empty()) {
+        std::cerr << "no access units in " << streamPath << std::endl;
+        return 2;
+    }
+
+    autoapp::projection::FFmpegDecoder decoder;
+    if (!decoder.open(AV_CODEC_ID_H264, threads, frameThreading)) {
+        return 2;
+    }
+
+    std::vector<double> decodeTimes;
+    decodeTimes.reserve(frames.size());
+    size_t pictures = 0;
+    size_t firstPictureAfter = 0;
+    size_t messages = 0;
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto& frame : frames) {
+        ++messages;
+        const auto decodeBegin = std::chrono::steady_clock::now();
+        decoder.decode(frame.timestamp, frame.data.data(), frame.data.size(), [&](const AVFrame*) {
+            decodeTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeBegin).count());
+            if (pictures++ == 0) {
+                firstPictureAfter = messages;
+            }
+        });
+    }
+    const auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    const auto statistics = decoder.getStatistics();
+    decoder.close();
+
+    if (decodeTimes.empty()) {
+        std::cerr << "nothing decoded, errors: " << statistics.errors << std::endl;
+        return 1;
+    }
+
+    std::sort(decodeTimes.begin(), decodeTimes.end());
+    const auto percentile = [&](double p) {
+        return decodeTimes[std::min(decodeTimes.size() - 1, static_cast<size_t>(p * decodeTimes.size()))];
+    };
+
+    std::cout << "messages: " << frames.size() << ", pictures: " << pictures << ", errors: " << statistics.errors << std::endl;
+    std::cout << "threads: " << (threads > 0 ? std::to_string(threads) : std::string("auto"))
+              << (frameThreading ? " (frame)" : " (slice)")
+              << ", first picture after " << firstPictureAfter << " message(s)" << std::endl;
+    std::cout << "decode ms p50: " << percentile(0.5) << ", p99: " << percentile(0.99)
+              << ", max: " << decodeTimes.back() << std::endl;
+    std::cout << "throughput: " << pictures / wall << " fps (stream: " << fps << " fps)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <boost/asio.hpp>
+#include <aasdk/Channel/MediaSink/Video/IVideoMediaSinkService.hpp>
+#include <f1x/openauto/autoapp/Projection/FileVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/NullVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Service/MediaSink/VideoMediaSinkService.hpp>
+#include <f1x/openauto/autoapp/Diagnostics/AllocationTracker.hpp>
+#include "ReplayStream.hpp"
+
+/*
+ * Replays a recorded (or synthesized) H.264 session through VideoMediaSinkService
+ * without a phone, USB or display attached.
+ *
+ *   video_replay_benchmark [--stream file.h264] [--frames N] [--warmup N] [--queue-depth N] [--alloc-budget N]
+ *                          [--dump out.h264]
+ *
+ * A stream recorded with Video.OutputBackendType = 2 (FileVideoOutput) is played
+ * back with the framing and timestamps of its .index file; other streams are
+ * split into access units at 30 fps. --dump writes what reaches the output the
+ * same way, otherwise frames end in a NullVideoOutput.
+ *
+ * --queue-depth N hands frames to the decode thread like autoapp does with
+ * Video.DecodeQueueDepth; the default 0 writes to the output on the strand.
+ *
+ * With --alloc-budget the process exits non-zero when the steady-state number of
+ * heap allocations per frame goes over the budget (requires -DALLOC_TRACKING=ON).
+ */
+
+namespace autoapp = f1x::openauto::autoapp;
+namespace benchmark = f1x::openauto::benchmark;
+
+namespace {
+
+class ReplayVideoChannel : public aasdk::channel::mediasink::video::IVideoMediaSinkService {
+public:
+    aasdk::messenger::ChannelId getId() const override {
+        return aasdk::messenger::ChannelId::MEDIA_SINK_VIDEO;
+    }
+
+    void send(aasdk::messenger::Message::Pointer, aasdk::channel::SendPromise::Pointer promise) override {
+        promise->resolve();
+    }
+
+    void receive(aasdk::channel::mediasink::video::IVideoMediaSinkServiceEventHandler::Pointer) override {
+    }
+
+    void sendChannelOpenResponse(const aap_protobuf::service::control::message::ChannelOpenResponse&,
+                                 aasdk::channel::SendPromise::Pointer promise) override {
+        promise->resolve();
+    }
+
+    void sendChannelSetupResponse(const aap_protobuf::service::media::shared::message::Config&,
+                                  aasdk::channel::SendPromise::Pointer promise) override {
+        promise->resolve();
+    }
+
+    void sendMediaAckIndication(const aap_protobuf::service::media::source::message::Ack& indication,
+                                aasdk::channel::SendPromise::Pointer promise) override {
+        acks += indication.ack();
+        ++ackMessages;
+        promise->resolve();
+    }
+
+    void sendVideoFocusIndication(const aap_protobuf::service::media::video::message::VideoFocusNotification&,
+                                  aasdk::channel::SendPromise::Pointer promise) override {
+        promise->resolve();
+    }
+
+    uint64_t acks = 0;
+    uint64_t ackMessages = 0;
+};
+
+const char* argument(int argc, char* argv[], const char* name) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return nullptr;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const char* streamPath = argument(argc, argv, "--stream");
+    const char* framesArg = argument(argc, argv, "--frames");
+    const char* warmupArg = argument(argc, argv, "--warmup");
+    const char* budgetArg = argument(argc, argv, "--alloc-budget");
+    const char* queueDepthArg = argument(argc, argv, "--queue-depth");
+    const char* maxUnackedArg = argument(argc, argv, "--max-unacked");
+    const char* dumpPath = argument(argc, argv, "--dump");
+
+    const size_t frameLimit = framesArg != nullptr ? std::strtoul(framesArg, nullptr, 10) : 1800;
+    const size_t warmup = warmupArg != nullptr ? std::strtoul(warmupArg, nullptr, 10) : 120;
+    const size_t queueDepth = queueDepthArg != nullptr ? std::strtoul(queueDepthArg, nullptr, 10) : 0;
+    const uint32_t maxUnacked = maxUnackedArg != nullptr ? std::strtoul(maxUnackedArg, nullptr, 10) : 1;
+
+    auto frames = streamPath != nullptr ? benchmark::loadStream(streamPath, 30) : benchmark::synthesizeStream(frameLimit, 30);
+    if (frames.size() <= warmup) {
+        std::cerr << "stream too short: " << frames.size() << " frames, warmup " << warmup << std::endl;
+        return 2;
+    }
+
+    boost::asio::io_service ioService;
+    // handlers posted from the decode thread arrive while nothing else is pending
+    boost::asio::io_service::work work(ioService);
+    auto channel = std::make_shared<ReplayVideoChannel>();
+    const auto resolution = aap_protobuf::service::media::sink::message::VIDEO_1280x720;
+    const auto frameRate = aap_protobuf::service::media::sink::message::VIDEO_FPS_30;
+    auto videoOutput = dumpPath != nullptr
+                       ? std::make_shared<autoapp::projection::FileVideoOutput>(dumpPath, resolution, frameRate, 140)
+                       : std::make_shared<autoapp::projection::NullVideoOutput>(resolution, frameRate, 140);
+    auto flowController = std::make_shared<autoapp::service::mediasink::MediaFlowController>(maxUnacked, true);
+    auto service = std::make_shared<autoapp::service::mediasink::VideoMediaSinkService>(ioService, channel, videoOutput,
+                                                                                        queueDepth, flowController);
+
+    aap_protobuf::service::control::message::ChannelOpenRequest openRequest;
+    openRequest.set_priority(0);
+    openRequest.set_service_id(static_cast<int32_t>(channel->getId()));
+    service->onChannelOpenRequest(openRequest);
+
+    aap_protobuf::service::media::shared::message::Setup setupRequest;
+    setupRequest.set_type(aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H264_BP);
+    service->onMediaChannelSetupRequest(setupRequest);
+
+    aap_protobuf::service::media::shared::message::Start startIndication;
+    startIndication.set_session_id(1);
+    startIndication.set_configuration_index(0);
+    service->onMediaChannelStartIndication(startIndication);
+    ioService.poll();
+
+    std::chrono::steady_clock::duration busy{};
+    size_t index = 0;
+    for (auto& frame : frames) {
+        if (index++ == warmup) {
+            autoapp::diagnostics::AllocationTracker::beginSteadyState();
+            busy = {};
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        service->onMediaWithTimestampIndication(frame.timestamp, aasdk::common::DataConstBuffer(frame.data));
+        ioService.poll();
+        busy += std::chrono::steady_clock::now() - begin;
+    }
+
+    // let the decode thread catch up and the held back acks go out
+    for (int wait = 0; wait < 1000 && videoOutput->getStatistics().frames < frames.size(); ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ioService.poll();
+    }
+    service->stop();
+    ioService.poll();
+
+    const auto measured = frames.size() - warmup;
+    const auto usPerFrame = std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count() / 1000.0 / measured;
+    const auto allocationsPerFrame = autoapp::diagnostics::AllocationTracker::getAllocationsPerFrame();
+
+    const auto statistics = videoOutput->getStatistics();
+    std::cout << "frames: " << statistics.frames << ", acks: " << channel->acks
+              << " in " << channel->ackMessages << " messages, bytes: " << statistics.bytes << std::endl;
+    std::cout << "steady state: " << usPerFrame << " us/frame";
+    if (autoapp::diagnostics::AllocationTracker::isEnabled()) {
+        std::cout << ", " << allocationsPerFrame << " allocations/frame";
+    }
+    std::cout << std::endl;
+
+    if (budgetArg != nullptr) {
+        if (!autoapp::diagnostics::AllocationTracker::isEnabled()) {
+            std::cerr << "--alloc-budget needs a build configured with -DALLOC_TRACKING=ON" << std::endl;
+            return 2;
+        }
+
+        const double budget = std::strtod(budgetArg, nullptr);
+        if (allocationsPerFrame > budget) {
+            std::cerr << "allocation budget exceeded: " << allocationsPerFrame << " > " << budget << std::endl;
+            autoapp::diagnostics::AllocationTracker::logReport(15);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <f1x/openauto/autoapp/Projection/DrmPresenter.hpp>
+
+#ifdef USE_V4L2
+
+namespace f1x::openauto::autoapp::projection {
+
+// Runs against vkms (modprobe vkms enable_overlay=1), which provides a virtual
+// connector, a primary plane with zpos and an XRGB8888 overlay plane. Frames are
+// dumb buffers exported as DMABUF, the same way the decoder hands them out.
+class DrmPresenterTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t cWidth = 640;
+    static constexpr uint32_t cHeight = 480;
+
+    void SetUp() override {
+        devicePath = findVkms();
+        if (devicePath.empty()) {
+            GTEST_SKIP() << "vkms with overlay planes is not loaded";
+        }
+
+        fd = ::open(devicePath.c_str(), O_RDWR | O_CLOEXEC);
+        ASSERT_GE(fd, 0);
+    }
+
+    void TearDown() override {
+        for (auto& buffer : buffers) {
+            ::close(buffer.dmabufFd[0]);
+        }
+        for (auto handle : handles) {
+            drm_mode_destroy_dumb destroy{};
+            destroy.handle = handle;
+            drmIoctl(fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    static std::string findVkms() {
+        for (int card = 0; card < 16; ++card) {
+            const auto path = "/dev/dri/card" + std::to_string(card);
+            const int cardFd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+            if (cardFd < 0) {
+                continue;
+            }
+
+            bool found = false;
+            drmVersion* version = drmGetVersion(cardFd);
+            if (version != nullptr && std::strcmp(version->name, "vkms") == 0) {
+                found = countOverlayPlanes(cardFd) > 0;
+            }
+            drmFreeVersion(version);
+            ::close(cardFd);
+
+            if (found) {
+                return path;
+            }
+        }
+
+        return {};
+    }
+
+    static int countOverlayPlanes(int cardFd) {
+        drmSetClientCap(cardFd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
+        drmModePlaneRes* planes = drmModeGetPlaneResources(cardFd);
+        int overlays = 0;
+
+        for (uint32_t i = 0; planes != nullptr && i < planes->count_planes; ++i) {
+            drmModeObjectProperties* properties = drmModeObjectGetProperties(cardFd, planes->planes[i], DRM_MODE_OBJECT_PLANE);
+            for (uint32_t j = 0; properties != nullptr && j < properties->count_props; ++j) {
+                drmModePropertyRes* property = drmModeGetProperty(cardFd, properties->props[j]);
+                if (property != nullptr && std::strcmp(property->name, "type") == 0 && properties->prop_values[j] == DRM_PLANE_TYPE_OVERLAY) {
+                    ++overlays;
+                }
+                drmModeFreeProperty(property);
+            }
+            drmModeFreeObjectProperties(properties);
+        }
+
+        drmModeFreePlaneResources(planes);
+        return overlays;
+    }
+
+    // A dumb XRGB8888 buffer dressed up as capture buffer `index` of `generation`.
+    V4L2DecodedFrame createFrame(uint32_t index, uint32_t generation) {
+        drm_mode_create_dumb create{};
+        create.width = cWidth;
+        create.height = cHeight;
+        create.bpp = 32;
+        EXPECT_EQ(drmIoctl(fd, DRM_IOCTL_MODE_CREATE_DUMB, &create), 0);
+        handles.push_back(create.handle);
+
+        V4L2DecodedFrame frame{};
+        frame.index = index;
+        frame.generation = generation;
+        frame.width = cWidth;
+        frame.height = cHeight;
+        frame.visibleWidth = cWidth;
+        frame.visibleHeight = cHeight;
+        frame.pixelFormat = V4L2_PIX_FMT_XBGR32;
+        frame.planeCount = 1;
+        frame.bytesPerLine[0] = create.pitch;
+        frame.planeOffset[0] = 0;
+        EXPECT_EQ(drmPrimeHandleToFD(fd, create.handle, DRM_CLOEXEC, &frame.dmabufFd[0]), 0);
+
+        buffers.push_back(frame);
+        return frame;
+    }
+
+    std::string devicePath;
+    int fd = -1;
+    std::vector<uint32_t> handles;
+    std::vector<V4L2DecodedFrame> buffers;
+};
+
+// TC-DRM-001 - A frame is handed back once the next one has flipped in
+TEST_F(DrmPresenterTest, ReleasesPreviousFrameAfterFlip) {
+    // the test descriptor opened the card first and is master, share it
+    DrmPresenter presenter(1, fd);
+    ASSERT_TRUE(presenter.open());
+
+    const auto first = createFrame(0, 1);
+    const auto second = createFrame(1, 1);
+    std::optional<V4L2DecodedFrame> released;
+
+    ASSERT_TRUE(presenter.present(first, released));
+    EXPECT_FALSE(released.has_value());
+    EXPECT_NE(presenter.getPlaneId(), 0u);
+
+    ASSERT_TRUE(presenter.present(second, released));
+    ASSERT_TRUE(released.has_value());
+    EXPECT_EQ(released->index, first.index);
+
+    ASSERT_TRUE(presenter.present(first, released));
+    ASSERT_TRUE(released.has_value());
+    EXPECT_EQ(released->index, second.index);
+
+    EXPECT_EQ(presenter.getPresentedFrameCount(), 3u);
+    presenter.clear();
+}
+
+// TC-DRM-002 - A frame of a new capture generation releases the old one
+TEST_F(DrmPresenterTest, NewGenerationReleasesOldFrame) {
+    DrmPresenter presenter(1, fd);
+    ASSERT_TRUE(presenter.open());
+
+    std::optional<V4L2DecodedFrame> released;
+    ASSERT_TRUE(presenter.present(createFrame(0, 1), released));
+    ASSERT_TRUE(presenter.present(createFrame(0, 2), released));
+
+    // the decoder drops frames of an older generation instead of requeueing them
+    ASSERT_TRUE(released.has_value());
+    EXPECT_EQ(released->generation, 1u);
+    presenter.clear();
+}
+
+// TC-DRM-003 - The layer index puts the video above or below the UI
+TEST_F(DrmPresenterTest, LayerIndexOrdersOverlayAgainstUi) {
+    std::optional<V4L2DecodedFrame> released;
+    const auto frame = createFrame(0, 1);
+
+    DrmPresenter above(2, fd);
+    ASSERT_TRUE(above.open());
+    ASSERT_TRUE(above.present(frame, released));
+    const auto aboveZ = above.getZPosition();
+    above.clear();
+
+    DrmPresenter below(0, fd);
+    ASSERT_TRUE(below.open());
+    ASSERT_TRUE(below.present(frame, released));
+    const auto belowZ = below.getZPosition();
+    below.clear();
+
+    // vkms overlays may have a fixed zpos, the order then comes from the driver
+    if (aboveZ != belowZ) {
+        EXPECT_GT(aboveZ, belowZ);
+    }
+}
+
+// TC-DRM-004 - Clear takes the plane off the screen
+TEST_F(DrmPresenterTest, ClearTakesPlaneOffScreen) {
+    DrmPresenter presenter(1, fd);
+    ASSERT_TRUE(presenter.open());
+
+    std::optional<V4L2DecodedFrame> released;
+    ASSERT_TRUE(presenter.present(createFrame(0, 1), released));
+    presenter.clear();
+
+    // after clear nothing is held, the next frame does not release anything
+    ASSERT_TRUE(presenter.present(createFrame(1, 1), released));
+    EXPECT_FALSE(released.has_value());
+    presenter.clear();
+}
+
+// TC-DRM-005 - The overlay goes on a second plane above the video, an empty image takes it off
+TEST_F(DrmPresenterTest, OverlayIsShownAboveVideo) {
+    DrmPresenter presenter(1, fd);
+    ASSERT_TRUE(presenter.open());
+
+    auto overlay = std::make_shared<VideoOverlay>();
+    VideoOverlay::Image image;
+    image.width = 64;
+    image.height = 32;
+    image.pixels.assign(image.width * image.height, 0x80000000);
+    overlay->update(image);
+    presenter.setOverlay(overlay);
+
+    std::optional<V4L2DecodedFrame> released;
+    ASSERT_TRUE(presenter.present(createFrame(0, 1), released));
+    if (presenter.getOverlayPlaneId() == 0) {
+        GTEST_SKIP() << "vkms has no second overlay plane";
+    }
+
+    drmModePlane* plane = drmModeGetPlane(fd, presenter.getOverlayPlaneId());
+    ASSERT_NE(plane, nullptr);
+    EXPECT_NE(plane->fb_id, 0u);
+    drmModeFreePlane(plane);
+
+    // an empty image takes it off again while the video keeps running
+    overlay->update(VideoOverlay::Image());
+    ASSERT_TRUE(presenter.present(createFrame(1, 1), released));
+    plane = drmModeGetPlane(fd, presenter.getOverlayPlaneId());
+    ASSERT_NE(plane, nullptr);
+    EXPECT_EQ(plane->fb_id, 0u);
+    drmModeFreePlane(plane);
+    presenter.clear();
+}
+
+// TC-DRM-006 - A node of its own is refused while another client holds DRM master
+TEST_F(DrmPresenterTest, RefusesWithoutMaster) {
+    // the test descriptor opened the card first and keeps master
+    DrmPresenter presenter(1, devicePath);
+    EXPECT_FALSE(presenter.open());
+    EXPECT_FALSE(presenter.hasFailed());
+}
+
+}
+
+#endif
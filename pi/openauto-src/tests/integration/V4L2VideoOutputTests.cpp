@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include <f1x/openauto/autoapp/Configuration/Configuration.hpp>
+#include <f1x/openauto/autoapp/Projection/V4L2VideoOutput.hpp>
+
+#ifdef USE_V4L2
+
+namespace f1x::openauto::autoapp::projection {
+
+// The decoder is exercised against vicodec (modprobe vicodec), which implements
+// the same stateful M2M interface as the Pi's H.264 decoder but for its own FWHT
+// codec. The compressed frames are produced by vicodec's encoder node.
+class V4L2VideoOutputTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t cWidth = 800;
+    static constexpr uint32_t cHeight = 480;
+
+    void SetUp() override {
+        decoderPath = V4L2VideoOutput::findDecoder(V4L2_PIX_FMT_FWHT);
+        encoderPath = findEncoder();
+
+        if (decoderPath.empty() || encoderPath.empty()) {
+            GTEST_SKIP() << "vicodec is not loaded";
+        }
+
+        configuration = std::make_shared<configuration::Configuration>();
+        configuration->setVideoResolution(aap_protobuf::service::media::sink::message::VIDEO_800x480);
+    }
+
+    static std::string findEncoder() {
+        for (int node = 0; node < 64; ++node) {
+            const auto path = "/dev/video" + std::to_string(node);
+            const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK);
+            if (fd < 0) {
+                continue;
+            }
+
+            v4l2_capability capability{};
+            v4l2_fmtdesc description{};
+            description.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            bool found = false;
+
+            if (ioctl(fd, VIDIOC_QUERYCAP, &capability) == 0 && (capability.device_caps & V4L2_CAP_VIDEO_M2M)) {
+                for (description.index = 0; ioctl(fd, VIDIOC_ENUM_FMT, &description) == 0; ++description.index) {
+                    found = found || description.pixelformat == V4L2_PIX_FMT_FWHT;
+                }
+            }
+
+            ::close(fd);
+            if (found) {
+                return path;
+            }
+        }
+
+        return {};
+    }
+
+    // Encodes frameCount moving gradient frames with the single-planar vicodec encoder.
+    std::vector<std::vector<uint8_t>> encodeFrames(size_t frameCount) {
+        std::vector<std::vector<uint8_t>> encoded;
+        const int fd = ::open(encoderPath.c_str(), O_RDWR);
+        if (fd < 0) {
+            return encoded;
+        }
+
+        v4l2_format format{};
+        format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        format.fmt.pix.width = cWidth;
+        format.fmt.pix.height = cHeight;
+        format.fmt.pix.pixelformat = V4L2_PIX_FMT_YUV420;
+        ioctl(fd, VIDIOC_S_FMT, &format);
+
+        format = v4l2_format{};
+        format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        format.fmt.pix.width = cWidth;
+        format.fmt.pix.height = cHeight;
+        format.fmt.pix.pixelformat = V4L2_PIX_FMT_FWHT;
+        ioctl(fd, VIDIOC_S_FMT, &format);
+
+        auto allocate = [fd](uint32_t type, std::vector<std::pair<void*, size_t>>& mappings) {
+            v4l2_requestbuffers request{};
+            request.count = 1;
+            request.type = type;
+            request.memory = V4L2_MEMORY_MMAP;
+            ioctl(fd, VIDIOC_REQBUFS, &request);
+
+            v4l2_buffer buffer{};
+            buffer.type = type;
+            buffer.memory = V4L2_MEMORY_MMAP;
+            buffer.index = 0;
+            ioctl(fd, VIDIOC_QUERYBUF, &buffer);
+            mappings.emplace_back(mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buffer.m.offset), buffer.length);
+        };
+
+        std::vector<std::pair<void*, size_t>> raw;
+        std::vector<std::pair<void*, size_t>> compressed;
+        allocate(V4L2_BUF_TYPE_VIDEO_OUTPUT, raw);
+        allocate(V4L2_BUF_TYPE_VIDEO_CAPTURE, compressed);
+
+        int type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        ioctl(fd, VIDIOC_STREAMON, &type);
+        type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        ioctl(fd, VIDIOC_STREAMON, &type);
+
+        const size_t frameSize = cWidth * cHeight * 3 / 2;
+        for (size_t frame = 0; frame < frameCount; ++frame) {
+            auto* pixels = static_cast<uint8_t*>(raw[0].first);
+            for (size_t i = 0; i < frameSize; ++i) {
+                pixels[i] = static_cast<uint8_t>((i % cWidth) + frame * 4);
+            }
+
+            v4l2_buffer buffer{};
+            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buffer.memory = V4L2_MEMORY_MMAP;
+            ioctl(fd, VIDIOC_QBUF, &buffer);
+
+            buffer = v4l2_buffer{};
+            buffer.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            buffer.memory = V4L2_MEMORY_MMAP;
+            buffer.bytesused = frameSize;
+            ioctl(fd, VIDIOC_QBUF, &buffer);
+
+            buffer = v4l2_buffer{};
+            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buffer.memory = V4L2_MEMORY_MMAP;
+            if (ioctl(fd, VIDIOC_DQBUF, &buffer) != 0) {
+                break;
+            }
+
+            const auto* data = static_cast<const uint8_t*>(compressed[0].first);
+            encoded.emplace_back(data, data + buffer.bytesused);
+
+            buffer = v4l2_buffer{};
+            buffer.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            buffer.memory = V4L2_MEMORY_MMAP;
+            ioctl(fd, VIDIOC_DQBUF, &buffer);
+        }
+
+        munmap(raw[0].first, raw[0].second);
+        munmap(compressed[0].first, compressed[0].second);
+        ::close(fd);
+        return encoded;
+    }
+
+    std::string decoderPath;
+    std::string encoderPath;
+    std::shared_ptr<configuration::Configuration> configuration;
+};
+
+// TC-V4L2-001 - Compressed frames come back decoded in exported capture buffers
+TEST_F(V4L2VideoOutputTest, DecodesIntoExportedCaptureBuffers) {
+    const auto encoded = encodeFrames(30);
+    ASSERT_EQ(encoded.size(), 30u);
+
+    V4L2VideoOutput videoOutput(configuration, decoderPath, V4L2_PIX_FMT_FWHT);
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int dmabufFd = -1;
+
+    videoOutput.setFrameHandler([&](const V4L2DecodedFrame& frame) {
+        width = frame.width;
+        height = frame.height;
+        dmabufFd = frame.dmabufFd[0];
+    });
+
+    ASSERT_TRUE(videoOutput.open());
+    ASSERT_TRUE(videoOutput.init());
+
+    uint64_t timestamp = 0;
+    for (const auto& frame : encoded) {
+        videoOutput.write(timestamp, aasdk::common::DataConstBuffer(frame));
+        timestamp += 33333;
+    }
+
+    for (int wait = 0; wait < 100 && videoOutput.getDecodedFrameCount() < encoded.size() - 2; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    videoOutput.stop();
+
+    EXPECT_GE(videoOutput.getDecodedFrameCount(), encoded.size() - 2);
+    EXPECT_EQ(width, cWidth);
+    EXPECT_EQ(height, cHeight);
+    EXPECT_GE(dmabufFd, 0);
+}
+
+// TC-V4L2-002 - Stopping before any data arrived releases the device
+TEST_F(V4L2VideoOutputTest, StopWithoutDataReleasesDevice) {
+    V4L2VideoOutput videoOutput(configuration, decoderPath, V4L2_PIX_FMT_FWHT);
+
+    ASSERT_TRUE(videoOutput.open());
+    videoOutput.stop();
+
+    // the device can be reopened right away, i.e. every buffer was released
+    ASSERT_TRUE(videoOutput.open());
+    videoOutput.stop();
+    EXPECT_EQ(videoOutput.getDecodedFrameCount(), 0u);
+}
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/AudioFillMonitor.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+// TC-AFILL-001 - A short read is padded with silence; only a gap in a running stream is an underrun
+TEST(AudioFillMonitorTest, CountsGapsNotIdle) {
+    AudioFillMonitor monitor("test-audio", 4);
+    std::vector<uint8_t> block(16, 0xff);
+
+    // nothing played yet
+    monitor.fill(block.data(), 0, block.size());
+    EXPECT_EQ(block, std::vector<uint8_t>(16, 0));
+    EXPECT_EQ(monitor.getUnderruns(), 0u);
+
+    block.assign(16, 0xff);
+    monitor.fill(block.data(), 8, block.size());
+    EXPECT_EQ(block[7], 0xff);
+    EXPECT_EQ(block[8], 0);
+    EXPECT_EQ(monitor.getUnderruns(), 1u);
+    EXPECT_EQ(monitor.getSilentFrames(), 2u);
+
+    // still starving, the stream has ended
+    monitor.fill(block.data(), 0, block.size());
+    EXPECT_EQ(monitor.getUnderruns(), 1u);
+
+    // running, then dry: a gap
+    monitor.fill(block.data(), 16, block.size());
+    monitor.fill(block.data(), 0, block.size());
+    EXPECT_EQ(monitor.getUnderruns(), 2u);
+    EXPECT_EQ(monitor.getSilentFrames(), 6u);
+
+    // started over, the first empty read is idle again
+    monitor.fill(block.data(), 16, block.size());
+    monitor.restart();
+    monitor.fill(block.data(), 0, block.size());
+    EXPECT_EQ(monitor.getUnderruns(), 2u);
+
+    monitor.resetCounters();
+    EXPECT_EQ(monitor.getUnderruns(), 0u);
+    EXPECT_EQ(monitor.getSilentFrames(), 0u);
+}
+
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/AudioJitterBuffer.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+class AudioJitterBufferTest : public ::testing::Test {
+protected:
+    static constexpr std::chrono::microseconds cMessage{20000};
+
+    // message `index` of a 20 ms stream, arriving `delay` after its nominal time
+    void arrive(uint64_t index, std::chrono::microseconds delay) {
+        buffer.onArrival(cMessage, start + cMessage * index + delay);
+    }
+
+    AudioJitterBuffer buffer{2, 48000, std::chrono::milliseconds(20), std::chrono::milliseconds(200)};
+    AudioJitterBuffer::Clock::time_point start = AudioJitterBuffer::Clock::now();
+};
+
+// TC-JIT-001 - Messages on time keep the target at its minimum
+TEST_F(AudioJitterBufferTest, SteadyArrivalsKeepMinimum) {
+    for (uint64_t i = 0; i < 500; ++i) {
+        arrive(i, std::chrono::microseconds(0));
+    }
+
+    EXPECT_EQ(buffer.getTarget(), std::chrono::milliseconds(20));
+    EXPECT_EQ(buffer.getStatistics().jitter.count(), 0);
+}
+
+// TC-JIT-002 - The target covers the latest message, and comes down again once the network calms
+TEST_F(AudioJitterBufferTest, TargetFollowsLateness) {
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> jitter(0, 60000);
+
+    uint64_t i = 0;
+    for (; i < 500; ++i) {
+        arrive(i, std::chrono::microseconds(jitter(random)));
+    }
+    EXPECT_GE(buffer.getTarget(), std::chrono::milliseconds(55));
+    EXPECT_LE(buffer.getTarget(), std::chrono::milliseconds(200));
+    EXPECT_GT(buffer.getStatistics().jitter, std::chrono::milliseconds(10));
+
+    // a minute of messages on time
+    for (; i < 3500; ++i) {
+        arrive(i, std::chrono::microseconds(30000));
+    }
+    EXPECT_LT(buffer.getTarget(), std::chrono::milliseconds(25));
+}
+
+// TC-JIT-003 - A burst ahead of time is not taken for lateness
+TEST_F(AudioJitterBufferTest, BurstIsNotLateness) {
+    for (uint64_t i = 0; i < 10; ++i) {
+        buffer.onArrival(cMessage, start + std::chrono::milliseconds(i));
+    }
+    for (uint64_t i = 10; i < 100; ++i) {
+        arrive(i, std::chrono::milliseconds(-190));
+    }
+
+    EXPECT_EQ(buffer.getTarget(), std::chrono::milliseconds(20));
+}
+
+// TC-JIT-004 - Playback waits for the target unless the writer has stopped
+TEST_F(AudioJitterBufferTest, PrimesToTarget) {
+    EXPECT_FALSE(buffer.canRead(std::chrono::milliseconds(10), false));
+    EXPECT_TRUE(buffer.canRead(std::chrono::milliseconds(10), true));
+
+    buffer.onEmpty(false);
+    EXPECT_FALSE(buffer.canRead(std::chrono::milliseconds(19), false));
+    EXPECT_TRUE(buffer.canRead(std::chrono::milliseconds(20), false));
+    EXPECT_TRUE(buffer.canRead(std::chrono::milliseconds(1), false));
+    EXPECT_EQ(buffer.getStatistics().latency, std::chrono::milliseconds(1));
+}
+
+// TC-JIT-005 - A gap while playing is counted once and bridged by a fade of what played last
+TEST_F(AudioJitterBufferTest, ConcealsUnderrun) {
+    ASSERT_TRUE(buffer.canRead(std::chrono::milliseconds(20), false));
+    buffer.remember(std::vector<int16_t>(960 * 2, 1000).data(), 960);
+
+    EXPECT_TRUE(buffer.onEmpty(true));
+    std::vector<int16_t> output(2000 * 2, -1);
+    size_t concealed = 0;
+    while (const auto count = buffer.conceal(output.data() + concealed * 2, 48)) {
+        EXPECT_FALSE(buffer.canRead(std::chrono::milliseconds(0), false));
+        concealed += count;
+    }
+
+    // 10 ms at 48 kHz, falling from full level to nothing
+    ASSERT_EQ(concealed, 480u);
+    EXPECT_EQ(output[0], 1000);
+    EXPECT_EQ(output[1], 1000);
+    for (size_t i = 1; i < concealed; ++i) {
+        ASSERT_LE(output[i * 2], output[(i - 1) * 2]);
+    }
+    EXPECT_LT(output[(concealed - 1) * 2], 10);
+
+    const auto statistics = buffer.getStatistics();
+    EXPECT_EQ(statistics.underruns, 1u);
+    EXPECT_EQ(statistics.concealedFrames, 480u);
+}
+
+// TC-JIT-006 - Data coming back ends the concealment, running out at the end of a stream is no gap
+TEST_F(AudioJitterBufferTest, RecoveryAndEndOfStream) {
+    ASSERT_TRUE(buffer.canRead(std::chrono::milliseconds(20), false));
+    buffer.remember(std::vector<int16_t>(480 * 2, 1000).data(), 480);
+
+    ASSERT_TRUE(buffer.onEmpty(true));
+    std::vector<int16_t> output(48 * 2);
+    EXPECT_EQ(buffer.conceal(output.data(), 48), 48u);
+    EXPECT_TRUE(buffer.canRead(std::chrono::milliseconds(20), false));
+    EXPECT_EQ(buffer.conceal(output.data(), 48), 0u);
+
+    EXPECT_FALSE(buffer.onEmpty(false));
+    EXPECT_EQ(buffer.conceal(output.data(), 48), 0u);
+    EXPECT_EQ(buffer.getStatistics().underruns, 1u);
+
+    // a new start that finds nothing queued is waiting, not a gap
+    EXPECT_FALSE(buffer.canRead(std::chrono::milliseconds(0), false));
+    EXPECT_FALSE(buffer.onEmpty(true));
+}
+
+}
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/AudioMixer.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+// stands in for the sound card, render() is pulled by the test
+class FakeDevice : public IAudioOutput {
+public:
+    bool open() override { ++opened; return true; }
+    void write(aasdk::messenger::Timestamp::ValueType, const aasdk::common::DataConstBuffer&) override {}
+    void start() override { ++started; }
+    void stop() override { ++stopped; }
+    void suspend() override {}
+    uint32_t getSampleSize() const override { return AudioMixer::cSampleSize; }
+    uint32_t getChannelCount() const override { return AudioMixer::cChannelCount; }
+    uint32_t getSampleRate() const override { return AudioMixer::cSampleRate; }
+
+    int opened = 0;
+    int started = 0;
+    int stopped = 0;
+};
+
+class AudioMixerTest : public ::testing::Test {
+protected:
+    static void write(const IAudioOutput::Pointer& input, const std::vector<int16_t>& samples) {
+        input->write(0, aasdk::common::DataConstBuffer(samples.data(), samples.size() * sizeof(int16_t)));
+    }
+
+    std::vector<int16_t> render(size_t frames) {
+        std::vector<int16_t> output(frames * AudioMixer::cChannelCount);
+        EXPECT_EQ(mixer->render(output.data(), frames), frames);
+        return output;
+    }
+
+    AudioMixer::Pointer mixer = std::make_shared<AudioMixer>(25);
+};
+
+// TC-AMIX-001 - The SIMD kernel matches the scalar one bit for bit, saturation included
+TEST_F(AudioMixerTest, MixKernelMatchesScalar) {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> sample(INT16_MIN, INT16_MAX);
+
+    for (const int32_t gain : {AudioMixer::cUnityGain, 0, 1, 8192, 16384, 32767}) {
+        // odd length, so the scalar tail runs as well
+        std::vector<int16_t> src(1027);
+        std::vector<int16_t> dst(src.size());
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = static_cast<int16_t>(sample(random));
+            dst[i] = static_cast<int16_t>(sample(random));
+        }
+
+        auto expected = dst;
+        AudioMixer::mixScalar(expected.data(), src.data(), src.size(), gain);
+        AudioMixer::mix(dst.data(), src.data(), src.size(), gain);
+        EXPECT_EQ(dst, expected) << "gain " << gain;
+    }
+
+    int16_t dst[2] = {30000, -30000};
+    const int16_t src[2] = {10000, -10000};
+    AudioMixer::mixScalar(dst, src, 2, AudioMixer::cUnityGain);
+    EXPECT_EQ(dst[0], INT16_MAX);
+    EXPECT_EQ(dst[1], INT16_MIN);
+}
+
+// TC-AMIX-002 - 16 kHz mono is resampled to 48 kHz stereo and summed with media
+TEST_F(AudioMixerTest, MixesChannelsOfDifferentFormats) {
+    auto media = mixer->createInput(AudioMixer::Channel::MEDIA, 2, 48000);
+    auto system = mixer->createInput(AudioMixer::Channel::SYSTEM, 1, 16000);
+    ASSERT_NE(media, nullptr);
+    ASSERT_NE(system, nullptr);
+    EXPECT_EQ(system->getSampleRate(), 16000u);
+    EXPECT_EQ(system->getChannelCount(), 1u);
+    EXPECT_TRUE(media->open());
+    EXPECT_TRUE(system->open());
+
+    write(media, std::vector<int16_t>(480 * 2, 100));
+    write(system, std::vector<int16_t>(160, 3000));
+
+    const auto output = render(480);
+    // the resampler passes a constant exactly once its filter is filled
+    for (size_t i = AudioResampler::cDefaultTapsPerPhase * 3 * 2; i < output.size(); ++i) {
+        ASSERT_EQ(output[i], 100 + 3000) << "sample " << i;
+    }
+
+    // drained: silence, counted against the channels that are playing only
+    media->start();
+    const auto silence = render(48);
+    EXPECT_EQ(silence, std::vector<int16_t>(96, 0));
+    EXPECT_EQ(mixer->getStatistics().underrunFrames[0], 48u);
+    EXPECT_EQ(mixer->getStatistics().underrunFrames[2], 0u);
+}
+
+// TC-AMIX-003 - Media ramps down to the ducking level while guidance plays and back up after
+TEST_F(AudioMixerTest, DucksMediaWhileGuidancePlays) {
+    auto media = mixer->createInput(AudioMixer::Channel::MEDIA, 2, 48000);
+    auto guidance = mixer->createInput(AudioMixer::Channel::GUIDANCE, 1, 16000);
+    media->open();
+    guidance->open();
+
+    const auto level = [&]() {
+        write(media, std::vector<int16_t>(48 * 2, 10000));
+        return render(48).back();
+    };
+
+    EXPECT_EQ(level(), 10000);
+
+    guidance->start();
+    int16_t ducked = 0;
+    for (int i = 0; i < 25; ++i) {
+        ducked = level();
+    }
+    EXPECT_EQ(ducked, 2500);
+
+    guidance->suspend();
+    int16_t restored = 0;
+    for (int i = 0; i < 25; ++i) {
+        restored = level();
+    }
+    EXPECT_EQ(restored, 10000);
+
+    // a focus request that may duck does the same without guidance
+    mixer->setFocusDucking(true);
+    for (int i = 0; i < 25; ++i) {
+        ducked = level();
+    }
+    EXPECT_EQ(ducked, 2500);
+}
+
+// TC-AMIX-004 - Formats the mixer cannot convert are refused
+TEST_F(AudioMixerTest, RefusesUnsupportedFormats) {
+    EXPECT_EQ(mixer->createInput(AudioMixer::Channel::MEDIA, 2, 0), nullptr);
+    EXPECT_EQ(mixer->createInput(AudioMixer::Channel::MEDIA, 6, 48000), nullptr);
+    EXPECT_NE(mixer->createInput(AudioMixer::Channel::MEDIA, 2, 44100), nullptr);
+    ASSERT_NE(mixer->createInput(AudioMixer::Channel::SYSTEM, 1, 16000), nullptr);
+    EXPECT_EQ(mixer->createInput(AudioMixer::Channel::SYSTEM, 2, 48000), nullptr);
+    // the next session gets the same channel again
+    EXPECT_NE(mixer->createInput(AudioMixer::Channel::SYSTEM, 1, 16000), nullptr);
+}
+
+// TC-AMIX-005 - A started channel waits for its jitter target, and a gap fades out and back in
+TEST_F(AudioMixerTest, BuffersAgainstJitter) {
+    auto media = mixer->createInput(AudioMixer::Channel::MEDIA, 2, 48000);
+    ASSERT_TRUE(media->open());
+    media->start();
+
+    write(media, std::vector<int16_t>(480 * 2, 10000));
+    EXPECT_EQ(render(48), std::vector<int16_t>(96, 0));
+    write(media, std::vector<int16_t>(480 * 2, 10000));
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_EQ(render(48).back(), 10000) << "block " << i;
+    }
+
+    // ran dry: the last 10 ms are repeated, fading out
+    const auto gap = render(960);
+    EXPECT_EQ(gap[0], 10000);
+    EXPECT_LT(gap[478 * 2], 100);
+    EXPECT_EQ(gap[480 * 2], 0);
+    EXPECT_EQ(gap.back(), 0);
+
+    // back once the target is queued, from silence
+    write(media, std::vector<int16_t>(1440 * 2, 10000));
+    const auto resumed = render(1440);
+    EXPECT_LT(resumed[0], 10000 / 10);
+    EXPECT_EQ(resumed.back(), 10000);
+
+    const auto statistics = mixer->getStatistics().jitter[0];
+    EXPECT_EQ(statistics.underruns, 1u);
+    EXPECT_EQ(statistics.concealedFrames, 480u);
+    EXPECT_GE(statistics.target, std::chrono::milliseconds(20));
+}
+
+// TC-AMIX-006 - A warmed up device keeps running across channels, which fade out and in instead
+TEST_F(AudioMixerTest, WarmDeviceOutlivesChannels) {
+    auto device = std::make_shared<FakeDevice>();
+    mixer->setDevice(device);
+    ASSERT_TRUE(mixer->warmUp());
+    EXPECT_EQ(device->opened, 1);
+    EXPECT_EQ(device->started, 1);
+    EXPECT_EQ(render(48), std::vector<int16_t>(96, 0));
+
+    auto media = mixer->createInput(AudioMixer::Channel::MEDIA, 2, 48000);
+    ASSERT_TRUE(media->open());
+    media->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    write(media, std::vector<int16_t>(1440 * 2, 10000));
+    EXPECT_EQ(render(480).back(), 10000);
+
+    const auto firstSample = mixer->getStatistics().firstSample[0];
+    EXPECT_GE(firstSample, std::chrono::milliseconds(5));
+    EXPECT_LT(firstSample, std::chrono::seconds(1));
+    EXPECT_EQ(mixer->getStatistics().maxFirstSample[0], firstSample);
+
+    // closing fades out over 20 ms and drops the rest; the device goes on
+    media->stop();
+    EXPECT_EQ(device->stopped, 0);
+    const auto fade = render(960);
+    EXPECT_LT(fade[940 * 2], 10000 / 10);
+    EXPECT_EQ(render(48), std::vector<int16_t>(96, 0));
+
+    // reopened, the next session fades in from silence
+    ASSERT_TRUE(media->open());
+    EXPECT_EQ(device->opened, 1);
+    write(media, std::vector<int16_t>(1440 * 2, 10000));
+    const auto resumed = render(1440);
+    EXPECT_LT(resumed[0], 10000 / 10);
+    EXPECT_EQ(resumed.back(), 10000);
+}
+
+// TC-AMIX-007 - Reopened during the fade out, open() returns at once and writes wait for the fade to finish
+TEST_F(AudioMixerTest, ReopenDuringFadeOut) {
+    auto device = std::make_shared<FakeDevice>();
+    mixer->setDevice(device);
+    ASSERT_TRUE(mixer->warmUp());
+
+    auto media = mixer->createInput(AudioMixer::Channel::MEDIA, 2, 48000);
+    ASSERT_TRUE(media->open());
+    media->start();
+    write(media, std::vector<int16_t>(1440 * 2, 10000));
+    EXPECT_EQ(render(480).back(), 10000);
+
+    media->stop();
+    const auto begin = std::chrono::steady_clock::now();
+    ASSERT_TRUE(media->open());
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(50));
+
+    // still fading out, this one goes nowhere
+    write(media, std::vector<int16_t>(1440 * 2, 20000));
+    render(960);
+    EXPECT_EQ(render(48), std::vector<int16_t>(96, 0));
+
+    media->start();
+    write(media, std::vector<int16_t>(1440 * 2, 10000));
+    const auto resumed = render(1440);
+    EXPECT_LT(resumed[0], 10000 / 10);
+    EXPECT_EQ(resumed.back(), 10000);
+}
+
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/AudioResampler.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+namespace {
+
+std::vector<int16_t> noise(size_t samples, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> sample(INT16_MIN, INT16_MAX);
+    std::vector<int16_t> result(samples);
+    for (auto& value : result) {
+        value = static_cast<int16_t>(sample(random));
+    }
+    return result;
+}
+
+// feeds input in chunks of random length, as a stream would arrive
+std::vector<int16_t> resample(AudioResampler& resampler, const std::vector<int16_t>& input, uint32_t inputChannels,
+                              uint32_t outputChannels, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<size_t> chunk(1, 700);
+    std::vector<int16_t> output;
+    std::vector<int16_t> buffer;
+    const auto frames = input.size() / inputChannels;
+    for (size_t position = 0; position < frames;) {
+        const auto count = std::min(chunk(random), frames - position);
+        buffer.resize(resampler.getMaxOutputFrames(count) * outputChannels);
+        const auto produced = resampler.process(input.data() + position * inputChannels, count, buffer.data());
+        EXPECT_LE(produced, resampler.getMaxOutputFrames(count));
+        output.insert(output.end(), buffer.begin(), buffer.begin() + produced * outputChannels);
+        position += count;
+    }
+    return output;
+}
+
+}
+
+// TC-ARES-001 - The native kernel is bit-exact with the scalar one, full scale noise included
+TEST(AudioResamplerTest, NativeKernelMatchesScalar) {
+    struct Conversion { uint32_t inputRate, inputChannels, outputRate, outputChannels; };
+    for (const auto& conversion : {Conversion{16000, 1, 48000, 2}, Conversion{16000, 1, 48000, 1},
+                                   Conversion{44100, 2, 48000, 2}, Conversion{48000, 2, 16000, 1},
+                                   Conversion{8000, 1, 48000, 2}}) {
+        const auto input = noise(conversion.inputRate / 2 * conversion.inputChannels, conversion.inputRate);
+        AudioResampler native(conversion.inputRate, conversion.inputChannels, conversion.outputRate,
+                              conversion.outputChannels, AudioResampler::Kernel::NATIVE);
+        AudioResampler scalar(conversion.inputRate, conversion.inputChannels, conversion.outputRate,
+                              conversion.outputChannels, AudioResampler::Kernel::SCALAR);
+
+        const auto expected = resample(scalar, input, conversion.inputChannels, conversion.outputChannels, 1);
+        const auto output = resample(native, input, conversion.inputChannels, conversion.outputChannels, 2);
+        EXPECT_EQ(output, expected) << conversion.inputRate << " -> " << conversion.outputRate << " ("
+                                    << AudioResampler::getNativeKernelName() << ")";
+        // half a second in, about half a second out
+        EXPECT_NEAR(static_cast<double>(output.size() / conversion.outputChannels), conversion.outputRate / 2.0, 1.0);
+    }
+
+    const auto samples = noise(64, 3);
+    const auto coefficients = noise(64, 4);
+    EXPECT_EQ(AudioResampler::dot(samples.data(), coefficients.data(), 64),
+              AudioResampler::dotScalar(samples.data(), coefficients.data(), 64));
+}
+
+// TC-ARES-002 - A constant comes out unchanged once the filter has filled
+TEST(AudioResamplerTest, PassesDcExactly) {
+    AudioResampler resampler(16000, 1, 48000, 2);
+    const std::vector<int16_t> input(1600, -12345);
+    std::vector<int16_t> output(resampler.getMaxOutputFrames(input.size()) * 2);
+    const auto produced = resampler.process(input.data(), input.size(), output.data());
+    ASSERT_EQ(produced, 4800u);
+
+    const auto settled = static_cast<size_t>(resampler.getLatency().count() * 48 / 1000) * 2 * 2 + 2;
+    for (size_t i = settled; i < produced * 2; ++i) {
+        ASSERT_EQ(output[i], -12345) << "sample " << i;
+    }
+}
+
+// TC-ARES-003 - A sine in the passband keeps its level and phase, delayed by the reported latency
+TEST(AudioResamplerTest, ConvertsSineWithReportedLatency) {
+    constexpr double frequency = 1000.0;
+    constexpr double amplitude = 16000.0;
+    AudioResampler resampler(16000, 1, 48000, 1);
+
+    std::vector<int16_t> input(16000);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<int16_t>(std::lround(amplitude * std::sin(2.0 * M_PI * frequency * i / 16000.0)));
+    }
+    std::vector<int16_t> output(resampler.getMaxOutputFrames(input.size()));
+    const auto produced = resampler.process(input.data(), input.size(), output.data());
+
+    // the filter is linear phase, half a prototype length; the query rounds down to microseconds
+    const double delay = (AudioResampler::cDefaultTapsPerPhase * 3 - 1) / 2.0;
+    EXPECT_EQ(resampler.getLatency().count(), static_cast<int64_t>(delay * 1000000 / 48000));
+
+    double error = 0.0;
+    double signal = 0.0;
+    for (size_t i = 4800; i < produced; ++i) {
+        const double expected = amplitude * std::sin(2.0 * M_PI * frequency * (i - delay) / 48000.0);
+        error += (output[i] - expected) * (output[i] - expected);
+        signal += expected * expected;
+    }
+    // better than 60 dB
+    EXPECT_GT(10.0 * std::log10(signal / error), 60.0);
+}
+
+// TC-ARES-004 - Equal rates only convert channels and add no delay
+TEST(AudioResamplerTest, EqualRatesConvertChannelsOnly) {
+    AudioResampler up(48000, 1, 48000, 2);
+    AudioResampler down(48000, 2, 48000, 1);
+    EXPECT_EQ(up.getLatency().count(), 0);
+
+    const std::vector<int16_t> mono = {1, -2, 300};
+    std::vector<int16_t> stereo(6);
+    ASSERT_EQ(up.process(mono.data(), 3, stereo.data()), 3u);
+    EXPECT_EQ(stereo, (std::vector<int16_t>{1, 1, -2, -2, 300, 300}));
+
+    std::vector<int16_t> folded(3);
+    const std::vector<int16_t> pairs = {100, 300, -100, -300, INT16_MAX, INT16_MAX};
+    ASSERT_EQ(down.process(pairs.data(), 3, folded.data()), 3u);
+    EXPECT_EQ(folded, (std::vector<int16_t>{200, -200, INT16_MAX}));
+}
+
+// TC-ARES-005 - reset() starts the stream over
+TEST(AudioResamplerTest, ResetRestartsStream) {
+    AudioResampler resampler(16000, 1, 48000, 2);
+    const auto input = noise(800, 5);
+    std::vector<int16_t> first(resampler.getMaxOutputFrames(input.size()) * 2);
+    std::vector<int16_t> second(first.size());
+
+    resampler.process(input.data(), 333, first.data());
+    resampler.reset();
+    const auto produced = resampler.process(input.data(), input.size(), first.data());
+
+    AudioResampler fresh(16000, 1, 48000, 2);
+    ASSERT_EQ(fresh.process(input.data(), input.size(), second.data()), produced);
+    EXPECT_EQ(first, second);
+}
+
+}
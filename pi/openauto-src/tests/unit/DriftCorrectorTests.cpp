@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/DriftCorrector.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+class DriftCorrectorTest : public ::testing::Test {
+protected:
+    // stereo ramp, one block of `frames` after the other
+    size_t run(int32_t skew, size_t blocks, size_t frames) {
+        corrector.setSkew(skew);
+        std::vector<int16_t> output(DriftCorrector::getMaxOutputFrames(frames) * 2);
+        size_t produced = 0;
+        for (size_t block = 0; block < blocks; ++block) {
+            std::vector<int16_t> input(frames * 2);
+            for (size_t i = 0; i < frames; ++i) {
+                input[i * 2] = static_cast<int16_t>((block * frames + i) % 20000);
+                input[i * 2 + 1] = static_cast<int16_t>(-input[i * 2]);
+            }
+            const auto count = corrector.process(input.data(), frames, output.data());
+            EXPECT_LE(count, DriftCorrector::getMaxOutputFrames(frames));
+            produced += count;
+        }
+        return produced;
+    }
+
+    DriftCorrector corrector{2};
+};
+
+// TC-DRIFT-001 - Without skew the input comes out unchanged, one frame late
+TEST_F(DriftCorrectorTest, ZeroSkewPassesThrough) {
+    const std::vector<int16_t> input = {100, -100, 200, -200, 300, -300, 400, -400};
+    std::vector<int16_t> output(DriftCorrector::getMaxOutputFrames(4) * 2);
+
+    ASSERT_EQ(corrector.process(input.data(), 4, output.data()), 4u);
+    EXPECT_EQ(output[0], 0);
+    EXPECT_EQ(output[1], 0);
+    for (size_t i = 2; i < 8; ++i) {
+        EXPECT_EQ(output[i], input[i - 2]) << "sample " << i;
+    }
+
+    ASSERT_EQ(corrector.process(input.data(), 4, output.data()), 4u);
+    EXPECT_EQ(output[0], 400);
+    EXPECT_EQ(output[1], -400);
+}
+
+// TC-DRIFT-002 - A positive skew drops frames, a negative one adds them, at the rate asked for
+TEST_F(DriftCorrectorTest, SkewChangesFrameCount) {
+    // one second of 48 kHz in 1 ms blocks
+    EXPECT_EQ(run(0, 1000, 48), 48000u);
+
+    corrector.reset();
+    const auto faster = run(500, 1000, 48);
+    EXPECT_GE(faster, 48000u - 25);
+    EXPECT_LE(faster, 48000u - 23);
+
+    corrector.reset();
+    const auto slower = run(-500, 1000, 48);
+    EXPECT_GE(slower, 48000u + 23);
+    EXPECT_LE(slower, 48000u + 25);
+}
+
+// TC-DRIFT-003 - The skew is limited to cMaxSkew
+TEST_F(DriftCorrectorTest, SkewIsClamped) {
+    corrector.setSkew(50000);
+    EXPECT_EQ(corrector.getSkew(), DriftCorrector::cMaxSkew);
+    corrector.setSkew(-50000);
+    EXPECT_EQ(corrector.getSkew(), -DriftCorrector::cMaxSkew);
+}
+
+// TC-DRIFT-004 - Interpolated samples stay between their neighbours
+TEST_F(DriftCorrectorTest, InterpolatesBetweenNeighbours) {
+    corrector.setSkew(-DriftCorrector::cMaxSkew);
+    std::vector<int16_t> input(4800 * 2);
+    for (size_t i = 0; i < 4800; ++i) {
+        input[i * 2] = static_cast<int16_t>(i * 4);
+        input[i * 2 + 1] = static_cast<int16_t>(i * 4);
+    }
+    std::vector<int16_t> output(DriftCorrector::getMaxOutputFrames(4800) * 2);
+    const auto produced = corrector.process(input.data(), 4800, output.data());
+
+    for (size_t i = 2; i < produced; ++i) {
+        ASSERT_GE(output[i * 2], output[(i - 1) * 2]) << "frame " << i;
+        ASSERT_LE(output[i * 2] - output[(i - 1) * 2], 4) << "frame " << i;
+        ASSERT_EQ(output[i * 2], output[i * 2 + 1]);
+    }
+}
+
+}
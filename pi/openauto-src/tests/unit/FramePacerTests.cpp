@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/FramePacer.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+class FramePacerTest : public ::testing::Test {
+protected:
+    static constexpr uint64_t cFrameDuration = 33333;
+
+    FramePacerTest() {
+        vblank.last = start;
+        vblank.period = std::chrono::microseconds(16667);
+    }
+
+    // frame `index` of a 30 fps stream arriving `delay` after its nominal time
+    FramePacer::Clock::time_point submit(uint64_t index, std::chrono::microseconds delay) {
+        const auto timestamp = 5000000 + index * cFrameDuration;
+        arrival = start + std::chrono::microseconds(index * cFrameDuration) + delay;
+        return pacer.schedule(timestamp, arrival, vblank);
+    }
+
+    bool onRefresh(FramePacer::Clock::time_point due) const {
+        return (due - vblank.last).count() % vblank.period.count() == 0;
+    }
+
+    FramePacer pacer{std::chrono::milliseconds(50)};
+    FramePacer::Clock::time_point start = FramePacer::Clock::now();
+    FramePacer::Clock::time_point arrival;
+    FramePacer::VBlankClock vblank;
+};
+
+// TC-PACE-001 - Jittery 30 fps arrivals come out every second refresh of a 60 Hz display
+TEST_F(FramePacerTest, JitterIsAbsorbed) {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> jitter(0, 20000);
+
+    std::vector<FramePacer::Clock::time_point> due;
+    for (uint64_t i = 0; i < 600; ++i) {
+        due.push_back(submit(i, std::chrono::microseconds(jitter(random))));
+        ASSERT_TRUE(onRefresh(due.back()));
+        ASSERT_GT(due.back(), arrival);
+    }
+
+    // skip the first second while the margin settles
+    size_t even = 0;
+    for (size_t i = 31; i < due.size(); ++i) {
+        even += due[i] - due[i - 1] == 2 * vblank.period ? 1 : 0;
+    }
+    EXPECT_GE(even, (due.size() - 31) * 98 / 100);
+}
+
+// TC-PACE-002 - The added latency stays within the delay limit plus one and a half refreshes
+TEST_F(FramePacerTest, LatencyIsBounded) {
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> jitter(0, 120000);
+
+    for (uint64_t i = 0; i < 300; ++i) {
+        const auto due = submit(i, std::chrono::microseconds(jitter(random)));
+        EXPECT_LE(due - arrival, std::chrono::milliseconds(50) + vblank.period * 3 / 2) << "frame " << i;
+    }
+
+    EXPECT_LE(pacer.getMargin(), std::chrono::milliseconds(50));
+    EXPECT_GT(pacer.getMargin(), std::chrono::milliseconds(30));
+    EXPECT_GT(pacer.getStatistics().late, 0u);
+}
+
+// TC-PACE-003 - Frames arriving on time are not held back
+TEST_F(FramePacerTest, SteadyStreamHasNoMargin) {
+    for (uint64_t i = 0; i < 100; ++i) {
+        const auto due = submit(i, std::chrono::microseconds(0));
+        EXPECT_LE(due - arrival, vblank.period * 3 / 2);
+    }
+
+    EXPECT_EQ(pacer.getMargin(), std::chrono::microseconds(0));
+}
+
+// TC-PACE-004 - A restarted stream clock starts the mapping over
+TEST_F(FramePacerTest, TimestampRestartResyncs) {
+    for (uint64_t i = 0; i < 10; ++i) {
+        submit(i, std::chrono::milliseconds(i == 5 ? 30 : 0));
+    }
+    EXPECT_GT(pacer.getMargin(), std::chrono::microseconds(0));
+
+    const auto now = arrival + std::chrono::seconds(2);
+    const auto due = pacer.schedule(0, now, vblank);
+    EXPECT_LE(due - now, vblank.period);
+    EXPECT_EQ(pacer.getMargin(), std::chrono::microseconds(0));
+    EXPECT_EQ(pacer.getStatistics().resyncs, 1u);
+}
+
+// TC-PACE-005 - Without a refresh phase the first frame anchors the grid
+TEST_F(FramePacerTest, UnknownPhaseUsesFirstFrame) {
+    vblank.last = FramePacer::Clock::time_point();
+
+    const auto first = submit(0, std::chrono::microseconds(3000));
+    EXPECT_EQ(first - arrival, vblank.period);
+
+    const auto second = submit(1, std::chrono::microseconds(3000));
+    EXPECT_EQ(second - first, 2 * vblank.period);
+}
+
+// TC-PACE-006 - With the audio playing, frames are due when their sound is heard
+TEST_F(FramePacerTest, FollowsMediaClock) {
+    auto clock = std::make_shared<MediaClock>();
+    pacer.setMediaClock(clock);
+
+    for (uint64_t i = 0; i < 30; ++i) {
+        // the sound of frame i is heard 40 ms after the frame arrives
+        const auto timestamp = 5000000 + i * cFrameDuration;
+        const auto heard = start + std::chrono::microseconds(i * cFrameDuration) + std::chrono::milliseconds(40);
+        clock->update(timestamp, heard);
+
+        const auto due = submit(i, std::chrono::microseconds(0));
+        EXPECT_TRUE(onRefresh(due));
+        EXPECT_GE(due, heard) << "frame " << i;
+        EXPECT_LT(due - heard, vblank.period) << "frame " << i;
+    }
+    EXPECT_EQ(pacer.getStatistics().synced, 30u);
+}
+
+// TC-PACE-007 - A clock on another timeline, or a stale one, is ignored
+TEST_F(FramePacerTest, IgnoresUnrelatedMediaClock) {
+    auto clock = std::make_shared<MediaClock>();
+    pacer.setMediaClock(clock);
+
+    clock->update(0, start);
+    for (uint64_t i = 0; i < 10; ++i) {
+        const auto due = submit(i, std::chrono::microseconds(0));
+        EXPECT_LE(due - arrival, vblank.period * 3 / 2);
+    }
+
+    clock->update(5000000 + 10 * cFrameDuration, start + std::chrono::microseconds(10 * cFrameDuration));
+    submit(20, std::chrono::microseconds(0));
+    EXPECT_EQ(pacer.getStatistics().synced, 0u);
+}
+
+}
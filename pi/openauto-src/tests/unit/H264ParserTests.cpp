@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/H264Parser.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+class H264ParserTest : public ::testing::Test {
+protected:
+    // Writes RBSP bits; nal() adds the header, stop bit and emulation prevention.
+    struct BitWriter {
+        void bit(uint32_t value) {
+            if (bits % 8 == 0) {
+                bytes.push_back(0);
+            }
+            if (value) {
+                bytes.back() |= 0x80 >> (bits % 8);
+            }
+            ++bits;
+        }
+
+        void field(uint32_t value, unsigned count) {
+            while (count-- > 0) {
+                bit((value >> count) & 0x01);
+            }
+        }
+
+        void ue(uint32_t value) {
+            const uint32_t coded = value + 1;
+            unsigned length = 0;
+            while ((coded >> length) > 1) {
+                ++length;
+            }
+            field(0, length);
+            field(coded, length + 1);
+        }
+
+        std::vector<uint8_t> nal(uint8_t header) {
+            bit(1);
+            std::vector<uint8_t> result = {header};
+            unsigned zeros = 0;
+            for (auto byte : bytes) {
+                if (zeros >= 2 && byte <= 3) {
+                    result.push_back(3);
+                    zeros = 0;
+                }
+                result.push_back(byte);
+                zeros = byte == 0 ? zeros + 1 : 0;
+            }
+            return result;
+        }
+
+        std::vector<uint8_t> bytes;
+        unsigned bits = 0;
+    };
+
+    static std::vector<uint8_t> baselineSps(uint32_t widthInMbs, uint32_t heightInMbs, uint8_t levelIdc) {
+        BitWriter writer;
+        writer.field(66, 8);
+        writer.field(0xC0, 8);
+        writer.field(levelIdc, 8);
+        writer.ue(0);                   // seq_parameter_set_id
+        writer.ue(0);                   // log2_max_frame_num_minus4
+        writer.ue(2);                   // pic_order_cnt_type
+        writer.ue(1);                   // max_num_ref_frames
+        writer.bit(0);
+        writer.ue(widthInMbs - 1);
+        writer.ue(heightInMbs - 1);
+        writer.bit(1);                  // frame_mbs_only_flag
+        writer.bit(1);                  // direct_8x8_inference_flag
+        writer.bit(0);                  // frame_cropping_flag
+        writer.bit(0);                  // vui_parameters_present_flag
+        return writer.nal(0x67);
+    }
+
+    static std::vector<uint8_t> annexB(std::initializer_list<std::vector<uint8_t>> units) {
+        std::vector<uint8_t> stream;
+        for (const auto& unit : units) {
+            stream.insert(stream.end(), {0, 0, 0, 1});
+            stream.insert(stream.end(), unit.begin(), unit.end());
+        }
+        return stream;
+    }
+
+    static H264NalUnit unit(const std::vector<uint8_t>& data) {
+        H264NalUnit nal;
+        nal.type = static_cast<H264NalType>(data[0] & 0x1F);
+        nal.refIdc = (data[0] >> 5) & 0x03;
+        nal.data = data.data();
+        nal.size = data.size();
+        return nal;
+    }
+
+    const std::vector<uint8_t> pps = {0x68, 0xCE, 0x3C, 0x80};
+    // first_mb_in_slice 0 (ue "1"), a few bytes of slice data
+    const std::vector<uint8_t> idrSlice = {0x65, 0x88, 0x84, 0x00, 0x21};
+    const std::vector<uint8_t> secondSlice = {0x65, 0x40, 0x84};
+    const std::vector<uint8_t> disposableSlice = {0x01, 0x9A, 0x02};
+};
+
+// TC-H264-001 - NAL units are split on three and four byte start codes
+TEST_F(H264ParserTest, SplitsNalUnits) {
+    const std::vector<uint8_t> stream = {0, 0, 0, 1, 0x67, 0x42, 0x00, 0x1F, 0, 0, 1, 0x68, 0xCE, 0, 0, 0, 1, 0x65, 0x88};
+
+    std::vector<std::pair<H264NalType, size_t>> units;
+    H264Parser::forEachNalUnit(stream.data(), stream.size(), [&](const H264NalUnit& nal) {
+        units.emplace_back(nal.type, nal.size);
+        return true;
+    });
+
+    ASSERT_EQ(units.size(), 3u);
+    EXPECT_EQ(units[0], std::make_pair(H264NalType::SPS, size_t(4)));
+    EXPECT_EQ(units[1], std::make_pair(H264NalType::PPS, size_t(2)));
+    EXPECT_EQ(units[2], std::make_pair(H264NalType::SLICE_IDR, size_t(2)));
+}
+
+// TC-H264-002 - Resolution, profile and level of a baseline SPS
+TEST_F(H264ParserTest, ParsesBaselineSps) {
+    const auto sps = baselineSps(50, 30, 31);
+
+    H264SequenceInfo info;
+    ASSERT_TRUE(H264Parser::parseSequenceParameterSet(unit(sps), info));
+    EXPECT_EQ(info.width, 800u);
+    EXPECT_EQ(info.height, 480u);
+    EXPECT_EQ(info.profileIdc, 66);
+    EXPECT_EQ(info.levelIdc, 31);
+    EXPECT_EQ(info.maxReferenceFrames, 1u);
+    EXPECT_EQ(H264Parser::describe(info), "800x480, baseline profile, level 3.1");
+}
+
+// TC-H264-003 - High profile SPS with chroma format and 1080p cropping
+TEST_F(H264ParserTest, ParsesHighProfileSpsWithCropping) {
+    BitWriter writer;
+    writer.field(100, 8);
+    writer.field(0, 8);
+    writer.field(40, 8);
+    writer.ue(0);                       // seq_parameter_set_id
+    writer.ue(1);                       // chroma_format_idc 4:2:0
+    writer.ue(0);                       // bit_depth_luma_minus8
+    writer.ue(0);                       // bit_depth_chroma_minus8
+    writer.bit(0);                      // qpprime_y_zero_transform_bypass_flag
+    writer.bit(1);                      // seq_scaling_matrix_present_flag
+    writer.bit(1);                      // first list present, ends right away
+    writer.ue(8 * 2);                   // delta_scale -8: next scale 0
+    for (int i = 1; i < 8; ++i) {
+        writer.bit(0);
+    }
+    writer.ue(0);                       // log2_max_frame_num_minus4
+    writer.ue(0);                       // pic_order_cnt_type
+    writer.ue(2);                       // log2_max_pic_order_cnt_lsb_minus4
+    writer.ue(4);                       // max_num_ref_frames
+    writer.bit(0);
+    writer.ue(119);
+    writer.ue(67);
+    writer.bit(1);
+    writer.bit(1);
+    writer.bit(1);                      // frame_cropping_flag
+    writer.ue(0);
+    writer.ue(0);
+    writer.ue(0);
+    writer.ue(4);                       // 8 luma rows at the bottom
+    writer.bit(0);
+    const auto sps = writer.nal(0x67);
+
+    H264SequenceInfo info;
+    ASSERT_TRUE(H264Parser::parseSequenceParameterSet(unit(sps), info));
+    EXPECT_EQ(info.width, 1920u);
+    EXPECT_EQ(info.height, 1080u);
+    EXPECT_EQ(info.profileIdc, 100);
+    EXPECT_EQ(info.maxReferenceFrames, 4u);
+}
+
+// TC-H264-004 - Emulation prevention bytes are skipped while reading
+TEST_F(H264ParserTest, SkipsEmulationPreventionBytes) {
+    // level 0 and the zero constraint byte put 00 00 in front of the exp-golomb fields
+    BitWriter writer;
+    writer.field(66, 8);
+    writer.field(0, 8);
+    writer.field(0, 8);
+    writer.field(0, 7);                 // leading zeros of a large seq_parameter_set_id...
+    writer.field(0xFF, 8);              // ...ue 254
+    writer.ue(0);
+    writer.ue(2);
+    writer.ue(1);
+    writer.bit(0);
+    writer.ue(79);
+    writer.ue(44);
+    writer.bit(1);
+    writer.bit(1);
+    writer.bit(0);
+    writer.bit(0);
+    const auto sps = writer.nal(0x67);
+    const std::vector<uint8_t> escape = {0, 0, 3};
+    ASSERT_NE(std::search(sps.begin(), sps.end(), escape.begin(), escape.end()), sps.end());
+
+    H264SequenceInfo info;
+    ASSERT_TRUE(H264Parser::parseSequenceParameterSet(unit(sps), info));
+    EXPECT_EQ(info.id, 254u);
+    EXPECT_EQ(info.width, 1280u);
+    EXPECT_EQ(info.height, 720u);
+}
+
+// TC-H264-005 - Access unit inspection stops at the first slice and reports picture starts
+TEST_F(H264ParserTest, InspectsAccessUnits) {
+    const auto sps = baselineSps(80, 45, 31);
+    const auto keyFrame = annexB({sps, pps, idrSlice, secondSlice});
+
+    auto info = H264Parser::inspect(keyFrame.data(), keyFrame.size());
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_TRUE(info.isIdr);
+    EXPECT_TRUE(info.isReference);
+    EXPECT_TRUE(info.isPictureStart);
+    EXPECT_TRUE(info.hasParameterSets);
+
+    const auto continuation = annexB({secondSlice});
+    info = H264Parser::inspect(continuation.data(), continuation.size());
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_FALSE(info.isPictureStart);
+
+    const auto disposable = annexB({{0x09, 0xF0}, disposableSlice});
+    info = H264Parser::inspect(disposable.data(), disposable.size());
+    EXPECT_FALSE(info.isReference);
+    EXPECT_TRUE(info.isPictureStart);
+}
+
+// TC-H264-006 - The parameter set cache rebuilds a decoder configuration
+TEST_F(H264ParserTest, CachesParameterSets) {
+    const auto sps = baselineSps(80, 45, 31);
+    const auto config = annexB({sps, pps});
+    const auto keyFrame = annexB({sps, pps, idrSlice});
+
+    H264ParameterSets parameterSets;
+    EXPECT_FALSE(parameterSets.isComplete());
+
+    auto info = H264Parser::inspect(config.data(), config.size(), &parameterSets);
+    EXPECT_TRUE(info.sequenceChanged);
+    ASSERT_TRUE(parameterSets.isComplete());
+    EXPECT_EQ(parameterSets.getSequenceInfo().width, 1280u);
+    EXPECT_EQ(parameterSets.getAnnexB(), config);
+
+    // repeated with every IDR, nothing changes
+    info = H264Parser::inspect(keyFrame.data(), keyFrame.size(), &parameterSets);
+    EXPECT_FALSE(info.sequenceChanged);
+
+    const auto resized = annexB({baselineSps(50, 30, 31), pps});
+    info = H264Parser::inspect(resized.data(), resized.size(), &parameterSets);
+    EXPECT_TRUE(info.sequenceChanged);
+    EXPECT_EQ(parameterSets.getSequenceInfo().width, 800u);
+    EXPECT_EQ(parameterSets.getAnnexB(), resized);
+
+    parameterSets.clear();
+    EXPECT_FALSE(parameterSets.isComplete());
+    EXPECT_TRUE(parameterSets.getAnnexB().empty());
+}
+
+// TC-H264-007 - H.265 access units are classified from the two byte NAL header
+TEST_F(H264ParserTest, InspectsH265AccessUnits) {
+    // VPS, SPS, PPS, IDR_W_RADL slice
+    const std::vector<uint8_t> keyFrame = {0, 0, 0, 1, 0x40, 0x01, 0x0C, 0, 0, 0, 1, 0x42, 0x01, 0x01,
+                                           0, 0, 0, 1, 0x44, 0x01, 0xC1, 0, 0, 0, 1, 0x26, 0x01, 0xAF};
+    // TRAIL_R and TRAIL_N slices
+    const std::vector<uint8_t> reference = {0, 0, 0, 1, 0x02, 0x01, 0xD0};
+    const std::vector<uint8_t> disposable = {0, 0, 0, 1, 0x00, 0x01, 0xE0};
+
+    auto info = H264Parser::inspectH265(keyFrame.data(), keyFrame.size());
+    EXPECT_TRUE(info.hasParameterSets);
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_TRUE(info.isIdr);
+    EXPECT_TRUE(info.isPictureStart);
+
+    info = H264Parser::inspectH265(reference.data(), reference.size());
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_FALSE(info.isIdr);
+    EXPECT_TRUE(info.isReference);
+
+    info = H264Parser::inspectH265(disposable.data(), disposable.size());
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_FALSE(info.isReference);
+}
+
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <f1x/openauto/autoapp/Service/MediaSink/MediaFlowController.hpp>
+
+namespace f1x::openauto::autoapp::service::mediasink {
+
+namespace {
+
+// Plays the phone side: sends while fewer than max_unacked frames are unacked.
+struct Phone {
+    explicit Phone(MediaFlowController& controller) : controller(controller) {}
+
+    bool canSend() const { return sent - acked < controller.getMaxUnacked(); }
+
+    void send(MediaFlowController::Clock::time_point now) {
+        ++sent;
+        controller.onReceived(now);
+    }
+
+    void consume(size_t backlog = 0) {
+        const auto count = controller.onConsumed(backlog);
+        if (count > 0) {
+            acked += count;
+            ++ackMessages;
+        }
+    }
+
+    MediaFlowController& controller;
+    uint64_t sent = 0;
+    uint64_t acked = 0;
+    uint64_t ackMessages = 0;
+};
+
+}
+
+// TC-FLOW-001 - Window 1 acks every frame on its own
+TEST(MediaFlowControllerTest, SingleFrameWindowAcksEveryFrame) {
+    MediaFlowController controller(1, false);
+    EXPECT_EQ(controller.getMaxUnacked(), 1u);
+
+    for (int i = 0; i < 10; ++i) {
+        controller.onReceived();
+        EXPECT_EQ(controller.onConsumed(), 1u);
+    }
+}
+
+// TC-FLOW-002 - Acks are batched by half a window
+TEST(MediaFlowControllerTest, AcksAreBatched) {
+    MediaFlowController controller(8, false);
+    Phone phone(controller);
+    auto now = MediaFlowController::Clock::now();
+
+    for (int i = 0; i < 800; ++i) {
+        ASSERT_TRUE(phone.canSend()) << "frame " << i;
+        phone.send(now += std::chrono::milliseconds(16));
+        phone.consume();
+    }
+
+    EXPECT_EQ(phone.acked, 800u);
+    EXPECT_EQ(phone.ackMessages, 200u);
+}
+
+// TC-FLOW-003 - A slow decoder shrinks the window, the phone is never left without credit
+TEST(MediaFlowControllerTest, BacklogShrinksWindowWithoutStalling) {
+    MediaFlowController controller(8, true);
+    Phone phone(controller);
+    auto now = MediaFlowController::Clock::now();
+
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_TRUE(phone.canSend()) << "frame " << i;
+        phone.send(now += std::chrono::milliseconds(16));
+        phone.consume(4);
+    }
+
+    EXPECT_EQ(controller.getWindow(), 1u);
+    EXPECT_GE(phone.acked + controller.getMaxUnacked() - controller.getWindow(), phone.sent);
+}
+
+// TC-FLOW-004 - The window settles at a round trip worth of frames
+TEST(MediaFlowControllerTest, WindowCoversRoundTrip) {
+    auto roundTripEstimator = std::make_shared<RoundTripEstimator>();
+    const auto pingSent = RoundTripEstimator::Clock::now();
+    const auto pingSentUs = std::chrono::duration_cast<std::chrono::microseconds>(pingSent.time_since_epoch()).count();
+    roundTripEstimator->onPingResponse(pingSentUs, pingSent + std::chrono::milliseconds(50));
+    EXPECT_EQ(roundTripEstimator->get(), std::chrono::milliseconds(50));
+
+    MediaFlowController controller(16, true, roundTripEstimator);
+    Phone phone(controller);
+    auto now = MediaFlowController::Clock::now();
+
+    for (int i = 0; i < 600; ++i) {
+        ASSERT_TRUE(phone.canSend()) << "frame " << i;
+        phone.send(now += std::chrono::microseconds(16667));
+        phone.consume();
+    }
+
+    // 50 ms at 60 fps is 3 frames, plus one decoding and one arriving
+    EXPECT_EQ(controller.getWindow(), 5u);
+}
+
+// TC-FLOW-005 - A new session starts from the full window again
+TEST(MediaFlowControllerTest, ResetRestoresWindow) {
+    MediaFlowController controller(4, true);
+    for (int i = 0; i < 100; ++i) {
+        controller.onReceived();
+        controller.onConsumed(4);
+    }
+    EXPECT_LT(controller.getWindow(), 4u);
+
+    controller.reset();
+    EXPECT_EQ(controller.getWindow(), 4u);
+}
+
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/FileVideoOutput.hpp>
+#include <f1x/openauto/autoapp/Projection/NullVideoOutput.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+using namespace aap_protobuf::service::media::sink::message;
+
+// TC-NVOUT-001 - Frames are counted and timestamped, open() starts over
+TEST(NullVideoOutputTest, CountsFrames) {
+    NullVideoOutput output(VIDEO_1280x720, VIDEO_FPS_60, 140);
+    const std::vector<uint8_t> frame(100, 0x41);
+
+    ASSERT_TRUE(output.open());
+    output.write(1000, aasdk::common::DataConstBuffer(frame));
+    output.write(34333, aasdk::common::DataConstBuffer(frame));
+
+    auto statistics = output.getStatistics();
+    EXPECT_EQ(statistics.frames, 2u);
+    EXPECT_EQ(statistics.bytes, 200u);
+    EXPECT_EQ(statistics.firstTimestamp, 1000u);
+    EXPECT_EQ(statistics.lastTimestamp, 34333u);
+
+    output.open();
+    EXPECT_EQ(output.getStatistics().frames, 0u);
+}
+
+// TC-NVOUT-002 - Every codec and size up to the configured one is accepted
+TEST(NullVideoOutputTest, AcceptsAllModesUpToConfigured) {
+    NullVideoOutput output(VIDEO_1920x1080, VIDEO_FPS_60, 140);
+    const auto modes = output.getCapabilities().selectModes(output.getVideoResolution(), output.getVideoFPS());
+
+    ASSERT_EQ(modes.size(), 6u);
+    EXPECT_EQ(VideoCapabilities::describe(modes[0]), "H.265 1920x1080@60");
+    EXPECT_EQ(VideoCapabilities::describe(modes[3]), "H.264 1920x1080@60");
+}
+
+// TC-NVOUT-003 - The stream and its index are written as the messages arrive
+TEST(NullVideoOutputTest, FileOutputWritesIndex) {
+    const std::string path = ::testing::TempDir() + "file_video_output.h264";
+    const std::vector<uint8_t> first = {0, 0, 0, 1, 0x65, 0x88};
+    const std::vector<uint8_t> second = {0, 0, 1, 0x41, 0x9A};
+
+    FileVideoOutput output(path, VIDEO_800x480, VIDEO_FPS_30, 140);
+    ASSERT_TRUE(output.open());
+    output.write(0, aasdk::common::DataConstBuffer(first));
+    output.write(33333, aasdk::common::DataConstBuffer(second));
+    output.stop();
+
+    std::ifstream stream(path, std::ios::binary);
+    const std::vector<uint8_t> written((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(written.size(), first.size() + second.size());
+
+    std::ifstream index(path + FileVideoOutput::cIndexSuffix);
+    uint64_t timestamp = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    ASSERT_TRUE(index >> timestamp >> offset >> size);
+    EXPECT_EQ(timestamp, 0u);
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(size, first.size());
+    ASSERT_TRUE(index >> timestamp >> offset >> size);
+    EXPECT_EQ(timestamp, 33333u);
+    EXPECT_EQ(offset, first.size());
+    EXPECT_EQ(size, second.size());
+
+    std::remove(path.c_str());
+    std::remove((path + FileVideoOutput::cIndexSuffix).c_str());
+}
+
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <f1x/openauto/autoapp/Projection/DriftCorrector.hpp>
+#include <f1x/openauto/autoapp/Projection/MediaClock.hpp>
+#include <f1x/openauto/autoapp/Projection/PlayoutScheduler.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+class PlayoutSchedulerTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t cSampleRate = 48000;
+    static constexpr uint32_t cBytesPerFrame = 4;
+    // 1 ms per read
+    static constexpr uint64_t cBlockBytes = 48 * cBytesPerFrame;
+
+    // one 20 ms message per 20 reads, timestamps from `base` on
+    void writeMessage(uint64_t index, uint64_t base = 1000000) {
+        scheduler.mark(base + index * 20000, written);
+        written += 20 * cBlockBytes;
+    }
+
+    // the read of block `index`, heard `latency` after it is taken
+    int32_t play(uint64_t index, size_t queuedBytes, std::chrono::microseconds latency = std::chrono::milliseconds(30)) {
+        const auto now = start + std::chrono::milliseconds(index);
+        return scheduler.onPlay(index * cBlockBytes, now + latency, queuedBytes);
+    }
+
+    MediaClock::Pointer clock = std::make_shared<MediaClock>();
+    PlayoutScheduler scheduler{cSampleRate, cBytesPerFrame, clock};
+    // the clock works in whole microseconds
+    MediaClock::Clock::time_point start =
+        std::chrono::time_point_cast<std::chrono::microseconds>(MediaClock::Clock::now());
+    uint64_t written = 0;
+};
+
+// TC-PLAY-001 - The clock maps a timestamp to when it is heard
+TEST_F(PlayoutSchedulerTest, PublishesPlayoutTime) {
+    for (uint64_t i = 0; i < 10; ++i) {
+        writeMessage(i);
+    }
+    for (uint64_t i = 0; i < 150; ++i) {
+        play(i, 40 * cBlockBytes);
+    }
+
+    // timestamp 1.1 s is block 100, heard 30 ms after it was read
+    MediaClock::Clock::time_point playout;
+    ASSERT_TRUE(clock->map(1100000, start + std::chrono::milliseconds(150), playout));
+    EXPECT_EQ(playout - start, std::chrono::milliseconds(130));
+    EXPECT_EQ(clock->getResyncCount(), 0u);
+}
+
+// TC-PLAY-002 - Callback jitter is smoothed, a restarted timeline is followed at once
+TEST_F(PlayoutSchedulerTest, ClockSmoothsJitterAndResyncs) {
+    for (uint64_t i = 0; i < 100; ++i) {
+        const auto jitter = std::chrono::microseconds(i % 2 == 0 ? 2000 : -2000);
+        clock->update(i * 1000, start + std::chrono::milliseconds(i) + jitter);
+    }
+    MediaClock::Clock::time_point playout;
+    ASSERT_TRUE(clock->map(100000, start + std::chrono::milliseconds(100), playout));
+    EXPECT_LT(std::chrono::abs(playout - (start + std::chrono::milliseconds(100))), std::chrono::microseconds(500));
+
+    clock->update(5000000, start + std::chrono::milliseconds(101));
+    ASSERT_TRUE(clock->map(5000000, start + std::chrono::milliseconds(101), playout));
+    EXPECT_EQ(playout - start, std::chrono::milliseconds(101));
+    EXPECT_EQ(clock->getResyncCount(), 1u);
+}
+
+// TC-PLAY-003 - A clock nobody updates any more maps nothing
+TEST_F(PlayoutSchedulerTest, StaleClockIsIgnored) {
+    MediaClock::Clock::time_point playout;
+    EXPECT_FALSE(clock->map(0, start, playout));
+
+    clock->update(0, start);
+    EXPECT_TRUE(clock->map(0, start + std::chrono::milliseconds(100), playout));
+    EXPECT_FALSE(clock->map(0, start + std::chrono::milliseconds(300), playout));
+
+    clock->invalidate();
+    EXPECT_FALSE(clock->map(0, start, playout));
+}
+
+// TC-PLAY-004 - A queue growing past its settled length asks for a positive skew
+TEST_F(PlayoutSchedulerTest, GrowingQueueIsDrained) {
+    uint64_t i = 0;
+    for (; i < 3000; ++i) {
+        EXPECT_EQ(play(i, 40 * cBlockBytes), 0) << "read " << i;
+    }
+    EXPECT_EQ(scheduler.getStatistics().target, std::chrono::milliseconds(40));
+
+    // 10 ms more queued than at the start
+    int32_t skew = 0;
+    for (; i < 6000; ++i) {
+        skew = play(i, 50 * cBlockBytes);
+    }
+    EXPECT_GT(skew, 0);
+    EXPECT_LE(skew, DriftCorrector::cMaxSkew);
+
+    for (; i < 9000; ++i) {
+        skew = play(i, 30 * cBlockBytes);
+    }
+    EXPECT_LT(skew, 0);
+    EXPECT_EQ(scheduler.getStatistics().skew, skew);
+}
+
+// TC-PLAY-005 - Reset forgets the marks and the settled queue length
+TEST_F(PlayoutSchedulerTest, ResetStartsOver) {
+    writeMessage(0);
+    for (uint64_t i = 0; i < 2500; ++i) {
+        play(i, 40 * cBlockBytes);
+    }
+    ASSERT_GT(scheduler.getStatistics().target.count(), 0);
+
+    scheduler.reset();
+    EXPECT_EQ(scheduler.getStatistics().target.count(), 0);
+    EXPECT_EQ(scheduler.getStatistics().skew, 0);
+    MediaClock::Clock::time_point playout;
+    EXPECT_FALSE(clock->map(1000000, start + std::chrono::milliseconds(2500), playout));
+}
+
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/PresentationPolicy.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+class PresentationPolicyTest : public ::testing::Test {
+protected:
+    static constexpr uint64_t cFrameDuration = 33333;
+
+    static PresentationPolicy::FrameInfo frame(bool isIdr, bool isReference) {
+        PresentationPolicy::FrameInfo info;
+        info.hasSlice = true;
+        info.isIdr = isIdr;
+        info.isReference = isReference || isIdr;
+        return info;
+    }
+
+    // feeds a frame whose submission is `delay` behind its nominal arrival
+    PresentationDecision submit(uint64_t index, const PresentationPolicy::FrameInfo& info, std::chrono::milliseconds delay) {
+        const auto timestamp = index * cFrameDuration;
+        return policy.onFrame(timestamp, info, start + std::chrono::microseconds(timestamp) + delay);
+    }
+
+    PresentationPolicy policy{std::chrono::milliseconds(50), std::chrono::milliseconds(250), std::chrono::milliseconds(1000)};
+    PresentationPolicy::Clock::time_point start = PresentationPolicy::Clock::now();
+};
+
+// TC-PRES-001 - Frames on time are all decoded
+TEST_F(PresentationPolicyTest, OnTimeFramesAreDecoded) {
+    EXPECT_EQ(submit(0, frame(true, true), std::chrono::milliseconds(0)), PresentationDecision::DECODE);
+    for (uint64_t i = 1; i < 100; ++i) {
+        EXPECT_EQ(submit(i, frame(false, i % 2 == 0), std::chrono::milliseconds(10)), PresentationDecision::DECODE);
+    }
+
+    EXPECT_EQ(policy.getStatistics().dropped, 0u);
+    EXPECT_EQ(policy.getStatistics().late, 0u);
+}
+
+// TC-PRES-002 - Late non-reference frames are skipped, late reference frames are not
+TEST_F(PresentationPolicyTest, LateNonReferenceFramesAreDropped) {
+    submit(0, frame(true, true), std::chrono::milliseconds(0));
+
+    EXPECT_EQ(submit(1, frame(false, false), std::chrono::milliseconds(100)), PresentationDecision::DROP);
+    EXPECT_EQ(submit(2, frame(false, true), std::chrono::milliseconds(100)), PresentationDecision::DECODE);
+
+    EXPECT_EQ(policy.getStatistics().dropped, 1u);
+    EXPECT_EQ(policy.getStatistics().late, 2u);
+}
+
+// TC-PRES-003 - Far behind: skip everything until the next IDR
+TEST_F(PresentationPolicyTest, FarBehindSkipsToNextIdr) {
+    submit(0, frame(true, true), std::chrono::milliseconds(0));
+
+    EXPECT_EQ(submit(1, frame(false, true), std::chrono::milliseconds(300)), PresentationDecision::DROP);
+    EXPECT_EQ(submit(2, frame(false, true), std::chrono::milliseconds(0)), PresentationDecision::DROP);
+    EXPECT_EQ(submit(3, frame(true, true), std::chrono::milliseconds(0)), PresentationDecision::RESYNC);
+    EXPECT_EQ(submit(4, frame(false, true), std::chrono::milliseconds(0)), PresentationDecision::DECODE);
+
+    EXPECT_EQ(policy.getStatistics().dropped, 2u);
+    EXPECT_EQ(policy.getStatistics().resyncs, 1u);
+}
+
+// TC-PRES-004 - Without an IDR decoding resumes after the wait limit
+TEST_F(PresentationPolicyTest, GivesUpWaitingForIdr) {
+    submit(0, frame(true, true), std::chrono::milliseconds(0));
+    EXPECT_EQ(submit(1, frame(false, true), std::chrono::milliseconds(300)), PresentationDecision::DROP);
+
+    uint64_t index = 2;
+    while (submit(index, frame(false, true), std::chrono::milliseconds(300)) == PresentationDecision::DROP) {
+        ASSERT_LT(++index, 100u);
+    }
+
+    // ~1 s of frames at 30 fps
+    EXPECT_GE(index, 30u);
+    EXPECT_LE(index, 33u);
+}
+
+// TC-PRES-005 - A phone clock running slow is not mistaken for a growing backlog
+TEST_F(PresentationPolicyTest, SlowDriftIsAbsorbed) {
+    submit(0, frame(true, true), std::chrono::milliseconds(0));
+
+    // 500 ppm: after 10 minutes the frames arrive 300 ms "late"
+    for (uint64_t i = 1; i < 30 * 600; ++i) {
+        const auto drift = std::chrono::microseconds(i * cFrameDuration / 2000);
+        const auto decision = policy.onFrame(i * cFrameDuration, frame(false, false),
+                                             start + std::chrono::microseconds(i * cFrameDuration) + drift);
+        ASSERT_EQ(decision, PresentationDecision::DECODE) << "frame " << i;
+    }
+}
+
+// TC-PRES-006 - Timestamp restarts re-anchor instead of being treated as late or early
+TEST_F(PresentationPolicyTest, TimestampRestartReanchors) {
+    submit(0, frame(true, true), std::chrono::milliseconds(0));
+    submit(1, frame(false, false), std::chrono::milliseconds(0));
+
+    const auto now = start + std::chrono::seconds(5);
+    EXPECT_EQ(policy.onFrame(0, frame(true, true), now), PresentationDecision::DECODE);
+    EXPECT_EQ(policy.onFrame(cFrameDuration, frame(false, false), now + std::chrono::microseconds(cFrameDuration)),
+              PresentationDecision::DECODE);
+}
+
+// TC-PRES-007 - NAL headers of an Annex-B access unit
+TEST_F(PresentationPolicyTest, InspectsNalHeaders) {
+    const std::vector<uint8_t> idr = {0, 0, 0, 1, 0x67, 0x42, 0, 0, 1, 0x68, 0xCE, 0, 0, 0, 1, 0x65, 0x88, 0x84};
+    const std::vector<uint8_t> reference = {0, 0, 0, 1, 0x41, 0x9A, 0x02};
+    const std::vector<uint8_t> disposable = {0, 0, 1, 0x01, 0x9E, 0x02};
+    const std::vector<uint8_t> config = {0, 0, 0, 1, 0x67, 0x42, 0, 0, 0, 1, 0x68, 0xCE};
+
+    auto info = PresentationPolicy::inspect(idr.data(), idr.size());
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_TRUE(info.isIdr);
+    EXPECT_TRUE(info.hasParameterSets);
+
+    info = PresentationPolicy::inspect(reference.data(), reference.size());
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_FALSE(info.isIdr);
+    EXPECT_TRUE(info.isReference);
+
+    info = PresentationPolicy::inspect(disposable.data(), disposable.size());
+    EXPECT_TRUE(info.hasSlice);
+    EXPECT_FALSE(info.isReference);
+
+    info = PresentationPolicy::inspect(config.data(), config.size());
+    EXPECT_FALSE(info.hasSlice);
+    EXPECT_TRUE(info.hasParameterSets);
+}
+
+// TC-PRES-008 - A lasting step in latency is taken over at the next IDR instead of freezing every GOP
+TEST_F(PresentationPolicyTest, PersistentLatencyStepReanchors) {
+    for (uint64_t i = 0; i < 30; ++i) {
+        submit(i, frame(i == 0, true), std::chrono::milliseconds(0));
+    }
+
+    // from here on every frame arrives 400 ms later than before, an IDR every 30 frames
+    uint64_t decoded = 0;
+    for (uint64_t i = 30; i < 300; ++i) {
+        const auto decision = submit(i, frame(i % 30 == 0, true), std::chrono::milliseconds(400));
+        if (i >= 60) {
+            EXPECT_NE(decision, PresentationDecision::DROP) << "frame " << i;
+        }
+        decoded += decision == PresentationDecision::DROP ? 0 : 1;
+    }
+
+    EXPECT_GE(decoded, 240u);
+    EXPECT_EQ(policy.getStatistics().resyncs, 1u);
+}
+
+// TC-PRES-009 - After a frame is lost on the way to the decoder, nothing is decoded before the next IDR
+TEST_F(PresentationPolicyTest, SkipToIdrAfterLoss) {
+    submit(0, frame(true, true), std::chrono::milliseconds(0));
+    submit(1, frame(false, true), std::chrono::milliseconds(0));
+
+    policy.skipToIdr(start + std::chrono::microseconds(cFrameDuration));
+    EXPECT_EQ(submit(2, frame(false, true), std::chrono::milliseconds(0)), PresentationDecision::DROP);
+    EXPECT_EQ(submit(3, frame(false, false), std::chrono::milliseconds(0)), PresentationDecision::DROP);
+    EXPECT_EQ(submit(4, frame(true, true), std::chrono::milliseconds(0)), PresentationDecision::RESYNC);
+    EXPECT_EQ(submit(5, frame(false, true), std::chrono::milliseconds(0)), PresentationDecision::DECODE);
+}
+
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <f1x/openauto/Common/SpscByteRing.hpp>
+
+namespace f1x::openauto::common {
+
+static std::vector<uint8_t> sequence(size_t length, uint8_t first) {
+    std::vector<uint8_t> data(length);
+    std::iota(data.begin(), data.end(), first);
+    return data;
+}
+
+// TC-RING-001 - Data comes out in order across the wrap point
+TEST(SpscByteRingTest, ReadsAcrossWrap) {
+    SpscByteRing ring(8);
+    std::vector<uint8_t> out(16);
+
+    for (uint8_t round = 0; round < 10; ++round) {
+        const auto in = sequence(7, round * 7);
+        ASSERT_EQ(ring.write(in.data(), in.size()), 7u);
+        ASSERT_EQ(ring.read(out.data(), out.size()), 7u);
+        EXPECT_TRUE(std::equal(in.begin(), in.end(), out.begin())) << "round " << int(round);
+    }
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.getStatistics().writtenBytes, 70u);
+    EXPECT_EQ(ring.getStatistics().readBytes, 70u);
+}
+
+// TC-RING-002 - Above the latency bound the oldest bytes are skipped on the next read
+TEST(SpscByteRingTest, DropsOldestAboveLatencyBound) {
+    SpscByteRing ring(8, 2);
+    const auto in = sequence(12, 0);
+    ASSERT_EQ(ring.write(in.data(), in.size()), 12u);
+
+    std::vector<uint8_t> out(16);
+    ASSERT_EQ(ring.read(out.data(), out.size()), 8u);
+    EXPECT_EQ(out[0], 4);
+    EXPECT_EQ(out[7], 11);
+
+    const auto statistics = ring.getStatistics();
+    EXPECT_EQ(statistics.droppedBytes, 4u);
+    EXPECT_EQ(statistics.peakFill, 12u);
+    EXPECT_EQ(statistics.readBytes, 8u);
+}
+
+// TC-RING-003 - Drops stay on whole frames
+TEST(SpscByteRingTest, DropsWholeFrames) {
+    SpscByteRing ring(8, 4);
+    const auto in = sequence(10, 0);
+    ring.write(in.data(), in.size());
+
+    std::vector<uint8_t> out(16);
+    ASSERT_EQ(ring.read(out.data(), out.size()), 6u);
+    EXPECT_EQ(out[0], 4);
+}
+
+// TC-RING-004 - With a stalled reader new data is refused, nothing is overwritten
+TEST(SpscByteRingTest, RefusesWhenStorageIsFull) {
+    SpscByteRing ring(4);
+    const auto in = sequence(12, 0);
+    EXPECT_EQ(ring.write(in.data(), in.size()), 8u);
+    EXPECT_EQ(ring.write(in.data(), in.size()), 0u);
+    EXPECT_EQ(ring.getStatistics().refusedBytes, 16u);
+
+    std::vector<uint8_t> out(8);
+    ASSERT_EQ(ring.read(out.data(), out.size()), 4u);
+    EXPECT_EQ(out[0], 4);
+}
+
+// TC-RING-005 - Lowering the bound takes effect with the next write
+TEST(SpscByteRingTest, LatencyBoundCanChange) {
+    SpscByteRing ring(64);
+    const auto in = sequence(32, 0);
+    ring.write(in.data(), in.size());
+
+    ring.setLatencyBound(16);
+    ring.write(in.data(), 1);
+
+    std::vector<uint8_t> out(64);
+    EXPECT_EQ(ring.read(out.data(), out.size()), 16u);
+    EXPECT_EQ(out[15], 0);
+}
+
+// TC-RING-006 - One producer and one consumer thread see every byte once, in order
+TEST(SpscByteRingTest, ConcurrentProducerConsumer) {
+    constexpr size_t cTotal = 4 * 1024 * 1024;
+    SpscByteRing ring(4096);
+
+    std::thread producer([&ring]() {
+        std::vector<uint8_t> chunk(1000);
+        size_t written = 0;
+        while (written < cTotal) {
+            const auto length = std::min(chunk.size(), cTotal - written);
+            for (size_t i = 0; i < length; ++i) {
+                chunk[i] = static_cast<uint8_t>((written + i) % 251);
+            }
+
+            // keep below the bound so nothing is dropped
+            while (ring.size() + length > ring.getLatencyBound()) {
+                std::this_thread::yield();
+            }
+            written += ring.write(chunk.data(), length);
+        }
+    });
+
+    std::vector<uint8_t> out(777);
+    size_t received = 0;
+    bool ordered = true;
+    while (received < cTotal) {
+        const auto count = ring.read(out.data(), out.size());
+        for (size_t i = 0; i < count; ++i) {
+            ordered = ordered && out[i] == static_cast<uint8_t>((received + i) % 251);
+        }
+        received += count;
+    }
+
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(ring.getStatistics().droppedBytes, 0u);
+}
+
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <f1x/openauto/Common/SpscQueue.hpp>
+
+namespace f1x::openauto::common {
+
+// TC-SPSC-001 - Elements come out in order across the wrap point
+TEST(SpscQueueTest, PopsInOrderAcrossWrap) {
+    SpscQueue<int> queue(3);
+    int next = 0;
+    int expected = 0;
+
+    for (int round = 0; round < 10; ++round) {
+        ASSERT_TRUE(queue.push(int(next++)));
+        ASSERT_TRUE(queue.push(int(next++)));
+        EXPECT_EQ(queue.size(), 2u);
+
+        int value = -1;
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, expected++);
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, expected++);
+    }
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+// TC-SPSC-002 - A full queue refuses and leaves the element alone, an empty one has nothing to pop
+TEST(SpscQueueTest, FullAndEmpty) {
+    SpscQueue<std::string> queue(2);
+    std::string value = "untouched";
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_EQ(value, "untouched");
+
+    ASSERT_TRUE(queue.push(std::string("a")));
+    ASSERT_TRUE(queue.push(std::string("b")));
+    EXPECT_EQ(queue.size(), queue.capacity());
+
+    std::string refused = "c";
+    EXPECT_FALSE(queue.push(std::move(refused)));
+    EXPECT_EQ(refused, "c");
+
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, "a");
+    ASSERT_TRUE(queue.push(std::move(refused)));
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, "b");
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, "c");
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+// TC-SPSC-003 - Move-only elements are handed over, a popped slot keeps nothing alive
+TEST(SpscQueueTest, MoveOnlyElements) {
+    SpscQueue<std::unique_ptr<int>> queue(1);
+    ASSERT_TRUE(queue.push(std::make_unique<int>(7)));
+
+    auto refused = std::make_unique<int>(8);
+    EXPECT_FALSE(queue.push(std::move(refused)));
+    ASSERT_NE(refused, nullptr);
+    EXPECT_EQ(*refused, 8);
+
+    std::unique_ptr<int> value;
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, 7);
+
+    SpscQueue<std::shared_ptr<int>> shared(1);
+    const auto owner = std::make_shared<int>(9);
+    ASSERT_TRUE(shared.push(std::shared_ptr<int>(owner)));
+    EXPECT_EQ(owner.use_count(), 2);
+
+    std::shared_ptr<int> popped;
+    ASSERT_TRUE(shared.pop(popped));
+    popped.reset();
+    EXPECT_EQ(owner.use_count(), 1);
+}
+
+// TC-SPSC-004 - One producer and one consumer thread see every element once, in order
+TEST(SpscQueueTest, ConcurrentProducerConsumer) {
+    constexpr int cTotal = 1000000;
+    SpscQueue<int> queue(64);
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < cTotal; ++i) {
+            while (!queue.push(int(i))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    while (expected < cTotal) {
+        int value = -1;
+        if (queue.pop(value)) {
+            ordered = ordered && value == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(queue.empty());
+}
+
+}
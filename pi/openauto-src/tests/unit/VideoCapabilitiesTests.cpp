@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <f1x/openauto/autoapp/Projection/VideoCapabilities.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+using aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H264_BP;
+using aap_protobuf::service::media::shared::message::MEDIA_CODEC_VIDEO_H265;
+using namespace aap_protobuf::service::media::sink::message;
+
+namespace {
+
+DecoderCapability decoder(aap_protobuf::service::media::shared::message::MediaCodecType codec,
+                          uint32_t maxWidth, uint32_t maxHeight, uint64_t maxPixelRate) {
+    DecoderCapability capability;
+    capability.codec = codec;
+    capability.maxWidth = maxWidth;
+    capability.maxHeight = maxHeight;
+    capability.maxPixelRate = maxPixelRate;
+    return capability;
+}
+
+}
+
+// TC-VCAP-001 - Without a usable decoder the configured H.264 mode is still offered
+TEST(VideoCapabilitiesTest, FallsBackToConfiguredMode) {
+    VideoCapabilities capabilities;
+    const auto modes = capabilities.selectModes(VIDEO_1280x720, VIDEO_FPS_30);
+
+    ASSERT_EQ(modes.size(), 1u);
+    EXPECT_EQ(modes[0].codec, MEDIA_CODEC_VIDEO_H264_BP);
+    EXPECT_EQ(modes[0].resolution, VIDEO_1280x720);
+    EXPECT_EQ(modes[0].frameRate, VIDEO_FPS_30);
+}
+
+// TC-VCAP-002 - H.265 comes first, sizes are capped by the configuration and the decoder
+TEST(VideoCapabilitiesTest, OrdersModesByCodecAndSize) {
+    VideoCapabilities capabilities;
+    capabilities.add(decoder(MEDIA_CODEC_VIDEO_H265, 3840, 2160, 0));
+    capabilities.add(decoder(MEDIA_CODEC_VIDEO_H264_BP, 1920, 1080, 0));
+
+    const auto modes = capabilities.selectModes(VIDEO_2560x1440, VIDEO_FPS_30);
+
+    ASSERT_EQ(modes.size(), 7u);
+    EXPECT_EQ(VideoCapabilities::describe(modes[0]), "H.265 2560x1440@30");
+    EXPECT_EQ(VideoCapabilities::describe(modes[3]), "H.265 800x480@30");
+    EXPECT_EQ(VideoCapabilities::describe(modes[4]), "H.264 1920x1080@30");
+    EXPECT_EQ(VideoCapabilities::describe(modes[6]), "H.264 800x480@30");
+}
+
+// TC-VCAP-003 - A size the decoder cannot sustain at 60 fps is offered at 30 fps
+TEST(VideoCapabilitiesTest, DropsToThirtyFpsWhenTooSlow) {
+    VideoCapabilities capabilities;
+    capabilities.add(decoder(MEDIA_CODEC_VIDEO_H264_BP, 1920, 1080, 1920ull * 1080 * 30));
+
+    const auto modes = capabilities.selectModes(VIDEO_1920x1080, VIDEO_FPS_60);
+
+    ASSERT_EQ(modes.size(), 3u);
+    EXPECT_EQ(VideoCapabilities::describe(modes[0]), "H.264 1920x1080@30");
+    EXPECT_EQ(VideoCapabilities::describe(modes[1]), "H.264 1280x720@60");
+    EXPECT_EQ(VideoCapabilities::describe(modes[2]), "H.264 800x480@60");
+}
+
+// TC-VCAP-004 - Measured throughput replaces the nominal limit, with headroom
+TEST(VideoCapabilitiesTest, MeasuredThroughputDecides) {
+    VideoCapabilities capabilities;
+    capabilities.add(decoder(MEDIA_CODEC_VIDEO_H265, 3840, 2160, 0));
+
+    VideoMode mode;
+    mode.codec = MEDIA_CODEC_VIDEO_H265;
+    mode.resolution = VIDEO_1920x1080;
+    mode.frameRate = VIDEO_FPS_30;
+    EXPECT_TRUE(capabilities.supports(mode));
+
+    // exactly enough is not enough
+    capabilities.setMeasuredPixelRate(MEDIA_CODEC_VIDEO_H265, 1920ull * 1080 * 30);
+    EXPECT_FALSE(capabilities.supports(mode));
+
+    capabilities.setMeasuredPixelRate(MEDIA_CODEC_VIDEO_H265, 1920ull * 1080 * 40);
+    EXPECT_TRUE(capabilities.supports(mode));
+}
+
+// TC-VCAP-005 - Portrait configurations get portrait modes within the rotated decoder limits
+TEST(VideoCapabilitiesTest, PortraitModes) {
+    VideoCapabilities capabilities;
+    capabilities.add(decoder(MEDIA_CODEC_VIDEO_H264_BP, 1920, 1080, 0));
+
+    const auto modes = capabilities.selectModes(VIDEO_1440x2560, VIDEO_FPS_30);
+
+    ASSERT_EQ(modes.size(), 2u);
+    EXPECT_EQ(VideoCapabilities::describe(modes[0]), "H.264 1080x1920@30");
+    EXPECT_EQ(VideoCapabilities::describe(modes[1]), "H.264 720x1280@30");
+}
+
+// TC-VCAP-006 - A pixel rate limit pushes the selection down to the modes below it
+TEST(VideoCapabilitiesTest, PixelRateLimit) {
+    VideoCapabilities capabilities;
+    capabilities.add(decoder(MEDIA_CODEC_VIDEO_H264_BP, 1920, 1080, 0));
+    capabilities.setPixelRateLimit(1920ull * 1080 * 60 - 1);
+
+    const auto modes = capabilities.selectModes(VIDEO_1920x1080, VIDEO_FPS_60);
+
+    ASSERT_EQ(modes.size(), 3u);
+    EXPECT_EQ(VideoCapabilities::describe(modes[0]), "H.264 1920x1080@30");
+    EXPECT_EQ(VideoCapabilities::describe(modes[1]), "H.264 1280x720@60");
+}
+
+// TC-VCAP-007 - Sizes beyond the smallest one covering the display are not offered
+TEST(VideoCapabilitiesTest, DisplaySizeCapsResolution) {
+    VideoCapabilities capabilities;
+    capabilities.add(decoder(MEDIA_CODEC_VIDEO_H264_BP, 1920, 1080, 0));
+    capabilities.setDisplaySize(1024, 600);
+
+    auto modes = capabilities.selectModes(VIDEO_1920x1080, VIDEO_FPS_30);
+
+    ASSERT_EQ(modes.size(), 2u);
+    EXPECT_EQ(VideoCapabilities::describe(modes[0]), "H.264 1280x720@30");
+    EXPECT_EQ(VideoCapabilities::describe(modes[1]), "H.264 800x480@30");
+
+    // nothing covers a larger display, the configured ceiling stays
+    capabilities.setDisplaySize(2560, 1600);
+    modes = capabilities.selectModes(VIDEO_1920x1080, VIDEO_FPS_30);
+    ASSERT_EQ(modes.size(), 3u);
+    EXPECT_EQ(VideoCapabilities::describe(modes[0]), "H.264 1920x1080@30");
+}
+
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <f1x/openauto/autoapp/Projection/VideoDecodeThread.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+using namespace aap_protobuf::service::media::sink::message;
+
+// Records what it is given; while held, write() blocks until released.
+class StubVideoOutput : public IVideoOutput {
+public:
+    bool open() override { return true; }
+    bool init() override { return true; }
+
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer&) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++entered_;
+        changed_.notify_all();
+        changed_.wait(lock, [this]() { return !held_; });
+        timestamps_.push_back(timestamp);
+    }
+
+    void stop() override {}
+    bool suspend() override { return false; }
+    void resume() override {}
+    VideoCapabilities getCapabilities() override { return VideoCapabilities(); }
+    void setVideoMode(const VideoMode&) override {}
+    void setMediaClock(MediaClock::Pointer) override {}
+    VideoFrameRateType getVideoFPS() const override { return VIDEO_FPS_30; }
+    VideoCodecResolutionType getVideoResolution() const override { return VIDEO_800x480; }
+    size_t getScreenDPI() const override { return 140; }
+    QRect getVideoMargins(const VideoMode&) const override { return QRect(); }
+    QRect getDisplayGeometry() const override { return QRect(); }
+
+    void hold() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = true;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = false;
+        changed_.notify_all();
+    }
+
+    bool waitEntered(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return changed_.wait_for(lock, std::chrono::seconds(5), [&]() { return entered_ >= count; });
+    }
+
+    std::vector<uint64_t> timestamps() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timestamps_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool held_ = false;
+    size_t entered_ = 0;
+    std::vector<uint64_t> timestamps_;
+};
+
+class VideoDecodeThreadTest : public ::testing::Test {
+protected:
+    QueuedVideoFrame frame(uint64_t timestamp) {
+        QueuedVideoFrame value;
+        value.timestamp = timestamp;
+        value.buffer = aasdk::common::DataConstBuffer(payload);
+        value.owner = owner;
+        value.received = std::chrono::steady_clock::now();
+        return value;
+    }
+
+    // the space handler runs on the decode thread, the test waits for it here
+    void onSpace() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++spaceSignals;
+        space.notify_all();
+    }
+
+    bool waitSpace(size_t seen) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return space.wait_for(lock, std::chrono::seconds(5), [&]() { return spaceSignals != seen; });
+    }
+
+    size_t getSpaceSignals() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return spaceSignals;
+    }
+
+    bool waitWritten(const VideoDecodeThread& thread, uint64_t count) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (thread.getWrittenFrameCount() < count) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> payload = std::vector<uint8_t>(64, 0x41);
+    std::shared_ptr<const void> owner = std::make_shared<int>(0);
+    std::shared_ptr<StubVideoOutput> output = std::make_shared<StubVideoOutput>();
+
+    std::mutex mutex;
+    std::condition_variable space;
+    size_t spaceSignals = 0;
+};
+
+// TC-VDT-001 - Frames reach the output in the order they were pushed
+TEST_F(VideoDecodeThreadTest, WritesInOrder) {
+    VideoDecodeThread thread(output, 8);
+    thread.start();
+
+    for (uint64_t i = 0; i < 100; ++i) {
+        auto value = frame(i);
+        while (!thread.push(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    ASSERT_TRUE(waitWritten(thread, 100));
+    thread.stop();
+
+    const auto timestamps = output->timestamps();
+    ASSERT_EQ(timestamps.size(), 100u);
+    for (uint64_t i = 0; i < timestamps.size(); ++i) {
+        EXPECT_EQ(timestamps[i], i);
+    }
+}
+
+// TC-VDT-002 - A full queue refuses the frame untouched and calls the space handler once a slot frees up
+TEST_F(VideoDecodeThreadTest, FullQueueSignalsSpace) {
+    VideoDecodeThread thread(output, 2);
+    thread.setSpaceHandler([this]() { this->onSpace(); });
+    output->hold();
+    thread.start();
+
+    // the first one is taken off the queue and held in write()
+    ASSERT_TRUE(thread.push(frame(0)));
+    ASSERT_TRUE(output->waitEntered(1));
+    ASSERT_TRUE(thread.push(frame(1)));
+    ASSERT_TRUE(thread.push(frame(2)));
+    EXPECT_EQ(thread.getQueuedFrameCount(), 2u);
+
+    auto refused = frame(3);
+    EXPECT_FALSE(thread.push(std::move(refused)));
+    EXPECT_EQ(refused.timestamp, 3u);
+    EXPECT_EQ(refused.owner, owner);
+    EXPECT_EQ(getSpaceSignals(), 0u);
+
+    output->release();
+    ASSERT_TRUE(waitSpace(0));
+    ASSERT_TRUE(thread.push(std::move(refused)));
+
+    ASSERT_TRUE(waitWritten(thread, 4));
+    thread.stop();
+    EXPECT_EQ(getSpaceSignals(), 1u);
+    EXPECT_EQ(output->timestamps(), (std::vector<uint64_t>{0, 1, 2, 3}));
+}
+
+// TC-VDT-003 - A producer that only retries when told there is space loses no frame and no wakeup
+TEST_F(VideoDecodeThreadTest, ProducerConsumerStress) {
+    constexpr uint64_t cTotal = 100000;
+    VideoDecodeThread thread(output, 4);
+    thread.setSpaceHandler([this]() { this->onSpace(); });
+    thread.start();
+
+    for (uint64_t i = 0; i < cTotal; ++i) {
+        auto value = frame(i);
+        for (;;) {
+            const auto seen = getSpaceSignals();
+            if (thread.push(std::move(value))) {
+                break;
+            }
+            // a lost wakeup leaves the producer waiting here
+            ASSERT_TRUE(waitSpace(seen)) << "frame " << i;
+        }
+    }
+
+    ASSERT_TRUE(waitWritten(thread, cTotal));
+    thread.stop();
+
+    const auto timestamps = output->timestamps();
+    ASSERT_EQ(timestamps.size(), cTotal);
+    bool ordered = true;
+    for (uint64_t i = 0; i < cTotal; ++i) {
+        ordered = ordered && timestamps[i] == i;
+    }
+    EXPECT_TRUE(ordered);
+}
+
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <f1x/openauto/autoapp/Projection/VideoGeometry.hpp>
+
+namespace f1x::openauto::autoapp::projection {
+
+// TC-VGEO-001 - Margins give the drawn area the aspect ratio of odd displays
+TEST(VideoGeometryTest, FitsMarginsToDisplay) {
+    // 1024x600 is wider than 16:9, the picture keeps the full height
+    auto margins = VideoGeometry::fitMargins(1280, 720, 1024, 600);
+    EXPECT_EQ(margins.width(), 52);
+    EXPECT_EQ(margins.height(), 0);
+
+    // 1280x480 (8:3) uses the full width of 720p, a third of the height is margin
+    margins = VideoGeometry::fitMargins(1280, 720, 1280, 480);
+    EXPECT_EQ(margins.width(), 0);
+    EXPECT_EQ(margins.height(), 240);
+
+    margins = VideoGeometry::fitMargins(800, 480, 800, 480);
+    EXPECT_EQ(margins.width(), 0);
+    EXPECT_EQ(margins.height(), 0);
+
+    margins = VideoGeometry::fitMargins(1280, 720, 0, 0);
+    EXPECT_EQ(margins.width(), 0);
+    EXPECT_EQ(margins.height(), 0);
+}
+
+// TC-VGEO-002 - Fitted content fills the display without bars
+TEST(VideoGeometryTest, FittedContentFillsDisplay) {
+    const auto content = VideoGeometry::contentRect(1280, 720, VideoGeometry::fitMargins(1280, 720, 1024, 600));
+    EXPECT_EQ(content.x(), 26);
+    EXPECT_EQ(content.y(), 0);
+    EXPECT_EQ(content.width(), 1228);
+    EXPECT_EQ(content.height(), 720);
+
+    const auto target = VideoGeometry::displayRect(content.width(), content.height(), 1024, 600);
+    EXPECT_EQ(target.x(), 0);
+    EXPECT_EQ(target.y(), 0);
+    EXPECT_EQ(target.width(), 1024);
+    EXPECT_EQ(target.height(), 600);
+}
+
+// TC-VGEO-003 - Content of another aspect ratio is centered between bars
+TEST(VideoGeometryTest, LetterboxesMismatchedContent) {
+    // 16:9 on 1280x480: pillarbox
+    auto target = VideoGeometry::displayRect(1280, 720, 1280, 480);
+    EXPECT_EQ(target.width(), 853);
+    EXPECT_EQ(target.height(), 480);
+    EXPECT_EQ(target.x(), (1280 - 853) / 2);
+    EXPECT_EQ(target.y(), 0);
+
+    // 16:9 on 4:3: letterbox
+    target = VideoGeometry::displayRect(1280, 720, 1024, 768);
+    EXPECT_EQ(target.width(), 1024);
+    EXPECT_EQ(target.height(), 576);
+    EXPECT_EQ(target.x(), 0);
+    EXPECT_EQ(target.y(), 96);
+}
+
+// TC-VGEO-004 - Configured margins scale with the mode, impossible ones are ignored
+TEST(VideoGeometryTest, ScalesAndValidatesMargins) {
+    const auto margins = VideoGeometry::scaleMargins(QRect(0, 0, 96, 48), 1920, 1080, 1280, 720);
+    EXPECT_EQ(margins.width(), 64);
+    EXPECT_EQ(margins.height(), 32);
+
+    const auto content = VideoGeometry::contentRect(800, 480, QRect(0, 0, 800, 40));
+    EXPECT_EQ(content.x(), 0);
+    EXPECT_EQ(content.y(), 20);
+    EXPECT_EQ(content.width(), 800);
+    EXPECT_EQ(content.height(), 440);
+}
+
+}
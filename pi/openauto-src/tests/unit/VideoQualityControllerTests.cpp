@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <f1x/openauto/autoapp/Service/MediaSink/VideoQualityController.hpp>
+
+namespace f1x::openauto::autoapp::service::mediasink {
+
+using namespace aap_protobuf::service::media::sink::message;
+
+class VideoQualityControllerTest : public ::testing::Test {
+protected:
+    static projection::VideoMode mode(VideoCodecResolutionType resolution, VideoFrameRateType frameRate) {
+        projection::VideoMode videoMode;
+        videoMode.resolution = resolution;
+        videoMode.frameRate = frameRate;
+        return videoMode;
+    }
+
+    static VideoQualityController::Sample sample(int64_t decodeLagMs, int64_t ackLatencyMs, int64_t roundTripMs) {
+        VideoQualityController::Sample value;
+        value.decodeLag = std::chrono::milliseconds(decodeLagMs);
+        value.ackLatency = std::chrono::milliseconds(ackLatencyMs);
+        value.roundTrip = std::chrono::milliseconds(roundTripMs);
+        return value;
+    }
+
+    // one sample per frame at 30 fps
+    void feed(const VideoQualityController::Sample& value, std::chrono::seconds duration) {
+        const auto end = now + duration;
+        while (now < end) {
+            controller.onSample(value, now);
+            now += std::chrono::microseconds(33333);
+        }
+    }
+
+    VideoQualityController controller{std::chrono::seconds(10), std::chrono::seconds(60)};
+    VideoQualityController::Clock::time_point now = VideoQualityController::Clock::now();
+};
+
+// TC-VQC-001 - Short spikes do not change anything
+TEST_F(VideoQualityControllerTest, IgnoresShortPressure) {
+    controller.onModeSelected(mode(VIDEO_1920x1080, VIDEO_FPS_60));
+    feed(sample(300, 300, 300), std::chrono::seconds(5));
+    feed(sample(0, 10, 20), std::chrono::seconds(5));
+    feed(sample(300, 300, 300), std::chrono::seconds(5));
+
+    EXPECT_EQ(controller.getPixelRateLimit(), 0u);
+    EXPECT_TRUE(controller.getDecisions().empty());
+}
+
+// TC-VQC-002 - Sustained pressure limits the next session below the streamed mode, once
+TEST_F(VideoQualityControllerTest, SustainedPressureDowngrades) {
+    controller.onModeSelected(mode(VIDEO_1920x1080, VIDEO_FPS_60));
+    feed(sample(0, 20, 250), std::chrono::seconds(30));
+
+    EXPECT_EQ(controller.getPixelRateLimit(), 1920u * 1080 * 60 - 1);
+    const auto decisions = controller.getDecisions();
+    ASSERT_EQ(decisions.size(), 1u);
+    EXPECT_EQ(decisions[0].action, VideoQualityController::Action::DOWNGRADE);
+    EXPECT_EQ(decisions[0].previousLimit, 0u);
+    EXPECT_GT(decisions[0].smoothed.roundTrip, std::chrono::milliseconds(200));
+
+    // the next session streams below the limit and is still congested
+    controller.onModeSelected(mode(VIDEO_1920x1080, VIDEO_FPS_30));
+    feed(sample(150, 20, 20), std::chrono::seconds(30));
+    EXPECT_EQ(controller.getPixelRateLimit(), 1920u * 1080 * 30 - 1);
+    EXPECT_EQ(controller.getDecisions().size(), 2u);
+}
+
+// TC-VQC-003 - A healthy stream steps back up one level at a time
+TEST_F(VideoQualityControllerTest, RecoveryUpgrades) {
+    controller.onModeSelected(mode(VIDEO_1920x1080, VIDEO_FPS_60));
+    feed(sample(200, 200, 20), std::chrono::seconds(15));
+    controller.onModeSelected(mode(VIDEO_1920x1080, VIDEO_FPS_30));
+    feed(sample(200, 200, 20), std::chrono::seconds(15));
+    ASSERT_EQ(controller.getDecisions().size(), 2u);
+
+    controller.onModeSelected(mode(VIDEO_1280x720, VIDEO_FPS_60));
+    feed(sample(0, 10, 20), std::chrono::seconds(30));
+    EXPECT_EQ(controller.getPixelRateLimit(), 1920u * 1080 * 30 - 1);
+    feed(sample(0, 10, 20), std::chrono::seconds(40));
+    EXPECT_EQ(controller.getPixelRateLimit(), 1920u * 1080 * 60 - 1);
+
+    controller.onModeSelected(mode(VIDEO_1920x1080, VIDEO_FPS_30));
+    feed(sample(0, 10, 20), std::chrono::seconds(70));
+    EXPECT_EQ(controller.getPixelRateLimit(), 0u);
+
+    const auto decisions = controller.getDecisions();
+    ASSERT_EQ(decisions.size(), 4u);
+    EXPECT_EQ(decisions[3].action, VideoQualityController::Action::UPGRADE);
+}
+
+// TC-VQC-004 - The lowest mode is never limited further
+TEST_F(VideoQualityControllerTest, StopsAtLowestMode) {
+    controller.onModeSelected(mode(VIDEO_800x480, VIDEO_FPS_30));
+    feed(sample(500, 500, 500), std::chrono::seconds(60));
+
+    EXPECT_EQ(controller.getPixelRateLimit(), 0u);
+    EXPECT_TRUE(controller.getDecisions().empty());
+}
+
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <f1x/openauto/autoapp/Diagnostics/VideoStatistics.hpp>
+
+namespace f1x::openauto::autoapp::diagnostics {
+
+class VideoStatisticsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        VideoStatistics::reset();
+    }
+
+    void TearDown() override {
+        VideoStatistics::reset();
+    }
+
+    VideoStatistics::Clock::time_point start = VideoStatistics::Clock::now();
+};
+
+// TC-VSTAT-001 - Rates are taken over the time between two samples
+TEST_F(VideoStatisticsTest, RatesOverSampleInterval) {
+    const auto previous = VideoStatistics::sample(start);
+
+    for (int i = 0; i < 60; ++i) {
+        VideoStatistics::onFrameReceived(12500);
+        VideoStatistics::onFrameDecoded(std::chrono::milliseconds(i % 2 == 0 ? 10 : 20));
+        if (i % 6 == 0) {
+            VideoStatistics::onFrameDropped();
+        } else {
+            VideoStatistics::onFrameShown();
+        }
+    }
+    VideoStatistics::setRoundTrip(std::chrono::microseconds(4500));
+
+    const auto rates = VideoStatistics::rates(previous, VideoStatistics::sample(start + std::chrono::seconds(2)));
+    EXPECT_DOUBLE_EQ(rates.receivedFps, 30.0);
+    EXPECT_DOUBLE_EQ(rates.decodedFps, 30.0);
+    EXPECT_DOUBLE_EQ(rates.shownFps, 25.0);
+    EXPECT_EQ(rates.droppedFrames, 10u);
+    EXPECT_DOUBLE_EQ(rates.bitrateKbps, 3000.0);
+    EXPECT_DOUBLE_EQ(rates.decodeLatencyMs, 15.0);
+    EXPECT_DOUBLE_EQ(rates.maxDecodeLatencyMs, 20.0);
+    EXPECT_DOUBLE_EQ(rates.roundTripMs, 4.5);
+}
+
+// TC-VSTAT-002 - The maximum latency only covers the window since the previous sample
+TEST_F(VideoStatisticsTest, MaxLatencyStartsOverEachSample) {
+    VideoStatistics::onFrameDecoded(std::chrono::milliseconds(80));
+    auto previous = VideoStatistics::sample(start);
+    EXPECT_EQ(previous.maxDecodeLatencyMicroseconds, 80000u);
+
+    VideoStatistics::onFrameDecoded(std::chrono::milliseconds(5));
+    const auto current = VideoStatistics::sample(start + std::chrono::seconds(1));
+    EXPECT_EQ(current.maxDecodeLatencyMicroseconds, 5000u);
+    EXPECT_DOUBLE_EQ(VideoStatistics::rates(previous, current).decodeLatencyMs, 5.0);
+}
+
+// TC-VSTAT-003 - Nothing received, no division by zero
+TEST_F(VideoStatisticsTest, IdleStreamHasZeroRates) {
+    const auto previous = VideoStatistics::sample(start);
+    auto rates = VideoStatistics::rates(previous, VideoStatistics::sample(start + std::chrono::seconds(1)));
+    EXPECT_DOUBLE_EQ(rates.receivedFps, 0.0);
+    EXPECT_DOUBLE_EQ(rates.decodedFps, 0.0);
+    EXPECT_DOUBLE_EQ(rates.decodeLatencyMs, 0.0);
+
+    // two samples at the same instant
+    rates = VideoStatistics::rates(previous, previous);
+    EXPECT_DOUBLE_EQ(rates.shownFps, 0.0);
+}
+
+// TC-VSTAT-004 - The last quality decision and its limit are passed through
+TEST_F(VideoStatisticsTest, QualityDecisionPassedThrough) {
+    const auto previous = VideoStatistics::sample(start);
+    auto rates = VideoStatistics::rates(previous, VideoStatistics::sample(start + std::chrono::seconds(1)));
+    EXPECT_EQ(rates.qualityDecisions, 0u);
+
+    VideoStatistics::onQualityDecision(true, 27000000);
+    rates = VideoStatistics::rates(previous, VideoStatistics::sample(start + std::chrono::seconds(1)));
+    EXPECT_EQ(rates.qualityDecisions, 1u);
+    EXPECT_TRUE(rates.lastQualityDowngrade);
+    EXPECT_DOUBLE_EQ(rates.pixelRateLimitMpx, 27.0);
+
+    VideoStatistics::onQualityDecision(false, 0);
+    rates = VideoStatistics::rates(previous, VideoStatistics::sample(start + std::chrono::seconds(2)));
+    EXPECT_EQ(rates.qualityDecisions, 2u);
+    EXPECT_FALSE(rates.lastQualityDowngrade);
+    EXPECT_DOUBLE_EQ(rates.pixelRateLimitMpx, 0.0);
+}
+
+}